@@ -998,6 +998,7 @@ NMLumassEngine::doMOSObatch()
         }
     }
     QThreadPool::globalInstance()->waitForDone();
+    MOSORunnable::releaseSharedDataSets();
 
     return 0;
 }
@@ -1050,6 +1051,7 @@ NMLumassEngine::doMOSOsingle()
                "", levels, 1, 1, mosra->getLosSettings());
     QThreadPool::globalInstance()->start(m);
     QThreadPool::globalInstance()->waitForDone();
+    MOSORunnable::releaseSharedDataSets();
 
     return 0;
 }
@@ -51,6 +51,27 @@ namespace lupy = lumass_python;
 namespace bmi
 {
 
+    namespace
+    {
+        /*! wraps numel items of src into a 1D NumPy array; unless
+         *  zerocopy is set, NumPy copies the buffer, otherwise the
+         *  (no-op) capsule passed as base object turns the array
+         *  into a view onto src
+         */
+        template<class T>
+        py::array_t<T> wrapBuffer(void* src, py::ssize_t numel, bool zerocopy)
+        {
+            if (zerocopy)
+            {
+                py::capsule nocopy(src, [](void*) {});
+                return py::array_t<T>({ numel }, { static_cast<py::ssize_t>(sizeof(T)) },
+                                      static_cast<T*>(src), nocopy);
+            }
+            return py::array_t<T>({ numel }, { static_cast<py::ssize_t>(sizeof(T)) },
+                                  static_cast<T*>(src));
+        }
+    }
+
     PythonBMI::PythonBMI(std::string pymodulename,
         std::vector<std::string> pythonpath,
         std::string bmiclass,
@@ -60,7 +81,8 @@ namespace bmi
         mBMIClass(bmiclass),
         mBMIWrapperName(wrappername),
         mBMIWrap(nullptr),
-        mWrapLogFunc(nullptr)
+        mWrapLogFunc(nullptr),
+        mbZeroCopy(false)
     {}
 
     void
@@ -90,6 +112,8 @@ namespace bmi
             return;
         }
 
+        mVarInfoCache.clear();
+
         try
         {
             std::stringstream msg;
@@ -337,6 +361,22 @@ namespace bmi
     }
 
 
+    const PythonBMI::VarInfo&
+        PythonBMI::getVarInfo(const std::string& name)
+    {
+        std::map<std::string, VarInfo>::iterator it = mVarInfoCache.find(name);
+        if (it == mVarInfoCache.end())
+        {
+            VarInfo vinfo;
+            vinfo.type = this->GetVarType(name);
+            vinfo.itemsize = this->GetVarItemsize(name);
+            vinfo.gridsize = this->GetGridSize(this->GetVarGrid(name));
+            it = mVarInfoCache.insert(std::pair<std::string, VarInfo>(name, vinfo)).first;
+        }
+        return it->second;
+    }
+
+
     std::string
         PythonBMI::GetVarLocation(std::string name)
     {
@@ -552,40 +592,21 @@ namespace bmi
         {
             if (typepart.empty())
             {
-                std::string vtype = this->GetVarType(namepart);
-                int vsize = this->GetVarItemsize(namepart);
-                int vgsize = this->GetGridSize(GetVarGrid(namepart));
+                const VarInfo& vinfo = this->getVarInfo(namepart);
+                const std::string& vtype = vinfo.type;
+                const int vsize = vinfo.itemsize;
+                const py::ssize_t vgsize = vinfo.gridsize;
                 if (    vtype.find("float") != std::string::npos
                      || vtype.find("double") != std::string::npos
                    )
                 {
                     if (vsize == 4)
                     {
-                        py::array_t<float> decar(
-                            py::buffer_info(
-                                src,
-                                sizeof(float),
-                                py::format_descriptor<float>::format(),
-                                1,
-                                { vgsize },
-                                { sizeof(float) }
-                            )
-                        );
-                        pymod.attr("set_value")(namepart, decar);
+                        pymod.attr("set_value")(namepart, wrapBuffer<float>(src, vgsize, mbZeroCopy));
                     }
                     else if (vsize == 8)
                     {
-                        py::array_t<double> dar(
-                            py::buffer_info(
-                                src,
-                                sizeof(double),
-                                py::format_descriptor<double>::format(),
-                                1,
-                                { vgsize },
-                                { sizeof(double) }
-                            )
-                        );
-                        pymod.attr("set_value")(namepart, dar);
+                        pymod.attr("set_value")(namepart, wrapBuffer<double>(src, vgsize, mbZeroCopy));
                     }
                 }
                 else if (    vtype.find("int") != std::string::npos
@@ -595,36 +616,19 @@ namespace bmi
                 {
                     if (vsize == 4)
                     {
-                        py::array_t<int> iar(
-                            py::buffer_info(
-                                src,
-                                sizeof(int),
-                                py::format_descriptor<int>::format(),
-                                1,
-                                { vgsize },
-                                { sizeof(int) }
-                            )
-                        );
-                        pymod.attr("set_value")(namepart, iar);
+                        pymod.attr("set_value")(namepart, wrapBuffer<int>(src, vgsize, mbZeroCopy));
                     }
                     else if (vsize == 8)
                     {
-                        py::array_t<long long> llar(
-                            py::buffer_info(
-                                src,
-                                sizeof(long long),
-                                py::format_descriptor<long long>::format(),
-                                1,
-                                { vgsize },
-                                { sizeof(long long) }
-                            )
-                        );
-                        pymod.attr("set_value")(namepart, llar);
+                        pymod.attr("set_value")(namepart, wrapBuffer<long long>(src, vgsize, mbZeroCopy));
                     }
                 }
             }
             else
             {
+                // the model's view of the variable is about to change
+                mVarInfoCache.erase(namepart);
+
                 if (typepart.compare("type") == 0)
                 {
                     const std::string tname = static_cast<char*>(src);
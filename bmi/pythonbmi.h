@@ -23,6 +23,7 @@
 //#include "NMLogger.h"
 #include <string>
 #include <vector>
+#include <map>
 //#include "bmi.hxx"
 
 #include "Python_wrapper.h"
@@ -129,12 +130,31 @@ namespace bmi
 
         std::string getBMIWrapperName(void) { return mBMIWrapperName; }
 
+        /*! When enabled, SetValue() hands the model a NumPy view
+         *  onto the caller's buffer rather than a copy of it, i.e.
+         *  the buffer must stay valid while the model uses it and
+         *  the model may write straight into it.
+         */
+        void setZeroCopy(bool zerocopy) { mbZeroCopy = zerocopy; }
+        bool getZeroCopy(void) { return mbZeroCopy; }
+
         //void setPyObjects(std::map<std::string, pybind11::object> *pyobjects);
         //std::map<std::string, py::object>* getPyObjects();
         //void setPyObjectSinkMap(std::map<std::string, bool>* sinkmap);
         //bool isPyObjectSink(std::string objname);
 
     private:
+        /*! type, itemsize and grid size of a model variable as
+         *  required by SetValue(); cached per variable until its
+         *  metadata is set again or the model is re-initialised */
+        struct VarInfo
+        {
+            std::string type;
+            int itemsize;
+            int gridsize;
+        };
+        const VarInfo& getVarInfo(const std::string& name);
+
         std::string mPyModuleName;
         std::vector<std::string> mPythonPath;
         std::string mBMIClass;
@@ -143,6 +163,9 @@ namespace bmi
         NMBMIWrapper* mBMIWrap;
         WrapLogFunc mWrapLogFunc;
 
+        std::map<std::string, VarInfo> mVarInfoCache;
+        bool mbZeroCopy;
+
     };
 
 }   // end of namespace bmi
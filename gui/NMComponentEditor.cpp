@@ -267,7 +267,7 @@ void NMComponentEditor::readComponentProperties(QObject* obj, NMModelComponent*
         QStringList ptoNoProps;
         if (pto != nullptr)
         {
-            ptoNoProps << "Description" << "Inputs" << "IsStreamable";
+            ptoNoProps << "Description" << "Inputs" << "IsStreamable" << "MemoryMapped";
         }
 
         const QMetaObject* meta = obj->metaObject();
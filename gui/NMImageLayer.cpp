@@ -437,6 +437,7 @@ NMImageLayer::NMImageLayer(vtkRenderWindow* renWin,
     this->mScalarBand = 1;
 
     this->mScalarColIdx = -1;
+    this->mbUpdateScalars = false;
     this->mScalarBufferFile = 0;
 
     this->mZSliceIdx = 0;
@@ -2274,15 +2275,15 @@ NMImageLayer::setScalars(vtkImageData* img)
         }
     }
 
-    if (colidx != mScalarColIdx)
+    // (re-)build the scalar look-up table only when the
+    // legend (attribute) has changed, rather than on every
+    // render
+    if (colidx != mScalarColIdx || mbUpdateScalars)
     {
         mScalarColIdx = colidx;
-        if (1)//mNumRecords <= 1e6)
-        {
-            mScalarDoubleMap.clear();
-            mScalarLongLongMap.clear();
-            updateScalarBuffer();
-        }
+        mScalarDoubleLUT.clear();
+        mScalarLongLongLUT.clear();
+        updateScalarBuffer();
     }
 
     vtkDataSetAttributes* dsa = img->GetAttributes(vtkDataSet::POINT);
@@ -2302,7 +2303,6 @@ NMImageLayer::setScalars(vtkImageData* img)
             double* out = static_cast<double*>(ar->GetVoidPointer(0));
             const double nodata = this->getNodata();
 
-            std::map<long long, double>::iterator it;
             switch(idxScalars->GetDataType())
             {
             vtkTemplateMacro(setDoubleScalars(static_cast<VTK_TT*>(buf),
@@ -2314,12 +2314,7 @@ NMImageLayer::setScalars(vtkImageData* img)
                     for (int i=0; i < numPix; ++i)
                     {
                         const long idx = idxScalars->GetVariantValue(i).ToLong();
-                        it = mScalarDoubleMap.find(idx);
-                        if (it != mScalarDoubleMap.end())
-                        {
-                            out[i] = it->second;
-                        }
-                        else
+                        if (!mScalarDoubleLUT.lookup(idx, out[i]))
                         {
                             out[i] = nodata;
                         }
@@ -2348,7 +2343,6 @@ NMImageLayer::setScalars(vtkImageData* img)
             long long* out = static_cast<long long*>(ar->GetVoidPointer(0));
             long long nodata = static_cast<long long>(this->getNodata());
 
-            std::map<long long, long long>::iterator it;
             switch(idxScalars->GetDataType())
             {
             vtkTemplateMacro(
@@ -2361,12 +2355,7 @@ NMImageLayer::setScalars(vtkImageData* img)
                     for (int i=0; i < numPix; ++i)
                     {
                         const long idx = idxScalars->GetVariantValue(i).ToLong();
-                        it = mScalarLongLongMap.find(idx);
-                        if (it != mScalarLongLongMap.end())
-                        {
-                            out[i] = it->second;
-                        }
-                        else
+                        if (!mScalarLongLongLUT.lookup(idx, out[i]))
                         {
                             out[i] = nodata;
                         }
@@ -2435,37 +2424,33 @@ NMImageLayer::updateScalarBuffer()
             return;
         }
 
-        double dnodata = 0;
-        long long inodata = 0;
+        const QVariant::Type coltype = this->getColumnType(mScalarColIdx);
+        const bool bDouble = coltype == QVariant::Double;
 
-        const int rep = mNumRecords / 20;
-        for (int r=0; r < mNumRecords; ++r)
+        std::vector<long long> keys;
+        std::vector<long long> longValues;
+        std::vector<double> doubleValues;
+        keys.reserve(mNumRecords);
+        if (bDouble)
+        {
+            doubleValues.reserve(mNumRecords);
+        }
+        else
         {
-            q.next();
+            longValues.reserve(mNumRecords);
+        }
 
-            switch(this->getColumnType(mScalarColIdx))
+        const int rep = mNumRecords / 20;
+        for (int r=0; r < mNumRecords && q.next(); ++r)
+        {
+            keys.push_back(q.value(0).toLongLong());
+            if (bDouble)
             {
-            case QVariant::Int:
-            case QVariant::LongLong:
-            case QVariant::UInt:
-            case QVariant::ULongLong:
-
-                    mScalarLongLongMap.insert(
-                                std::pair<long long, long long>(
-                                q.value(0).toLongLong(),
-                                q.value(1).toLongLong()));
-                    break;
-
-            case QVariant::Double:
-
-                    mScalarDoubleMap.insert(
-                                   std::pair<long long, double>(
-                                   q.value(0).toLongLong(),
-                                   q.value(1).toDouble()));
-                   break;
-
-            default:
-                break;
+                doubleValues.push_back(q.value(1).toDouble());
+            }
+            else
+            {
+                longValues.push_back(q.value(1).toLongLong());
             }
 
             if (r % (rep > 0 ? rep : 1) == 0)
@@ -2475,6 +2460,23 @@ NMImageLayer::updateScalarBuffer()
         }
         q.finish();
         db.commit();
+
+        switch(coltype)
+        {
+        case QVariant::Int:
+        case QVariant::LongLong:
+        case QVariant::UInt:
+        case QVariant::ULongLong:
+            mScalarLongLongLUT.build(keys, longValues);
+            break;
+
+        case QVariant::Double:
+            mScalarDoubleLUT.build(keys, doubleValues);
+            break;
+
+        default:
+            break;
+        }
     }
     NMGlobalHelper::getMainWindow()->removeDbConnection(sqlModel->getDatabaseName(), conname);
 
@@ -2482,136 +2484,14 @@ NMImageLayer::updateScalarBuffer()
     NMDebugCtx(ctxNMImageLayer, << "done!");
 }
 
-// worker function for scalars setting
+// worker functions for scalars setting
 template<class T>
 void
 NMImageLayer::setLongScalars(T* buf, long long *out,
                                      long long numPix,
                                      long long nodata)
 {
-    //CALLGRIND_START_INSTRUMENTATION;
-    if (0)//mNumRecords > 1e6)
-    {
-        int nthreads = QThread::idealThreadCount();
-        long long threadpix = numPix / nthreads;
-        long long rest = numPix - (threadpix * nthreads);
-
-        QList<QFuture<void> > flist;
-        for (int t=0; t < nthreads; ++t)
-        {
-            flist << QFuture<void>();
-        }
-
-        long long start=0, end=0;
-        for (int th=0; th < nthreads; ++th)
-        {
-            end = start+threadpix-1;
-
-            if (th == nthreads-1)
-            {
-                end += rest;
-            }
-
-            flist[th] = QtConcurrent::run(this, &NMImageLayer::setLongDBScalars<T>,
-                                           buf, out, start, end, nodata);
-
-            start = end+1;
-        }
-
-        for (int th=0; th < nthreads; ++th)
-        {
-            flist[th].waitForFinished();
-        }
-    }
-    else
-    {
-        std::map<long long, long long>::iterator it;
-        for (int i=0; i < numPix; ++i)
-        {
-            it = mScalarLongLongMap.find(buf[i]);
-            if (it != mScalarLongLongMap.end())
-            {
-                out[i] = it->second;
-            }
-            else
-            {
-                out[i] = nodata;
-            }
-        }
-    }
-}
-
-template<class T>
-void
-NMImageLayer::setLongDBScalars(T* buf,
-                               long long* out,
-                               long long start,
-                               long long end,
-                               long long nodata
-                               )
-{
-    NMSqlTableModel* sqlModel = qobject_cast<NMSqlTableModel*>(mTableModel);
-
-    QString conname = QString("NMImageLayer_%1").arg(NMGlobalHelper::getRandomString(8));
-
-    // db scope
-    // without db and q going out of scope, we cannot remove
-    // db without Qt complaining
-    {
-        NMQSQLiteDriver* drv = new NMQSQLiteDriver();
-        QSqlDatabase db = QSqlDatabase::addDatabase(drv, conname);
-        db.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE;"
-                                "QSQLITE_INIT_SPATIALITE;"
-                                "QSQLITE_OPEN_URI;"
-                                "QSQLITE_OPEN_READONLY");
-        db.setDatabaseName(sqlModel->getDatabaseName());
-        if (!db.open())
-        {
-            NMLogError(<< ctxNMImageLayer << "::" << __FUNCTION__ << "() - setLongDBScalars '"
-                       << sqlModel->getDatabaseName().toStdString() << "' failed: "
-                       << db.lastError().text().toStdString());
-        }
-
-        QString prepStr = QString("SELECT %1 from %2 where %3 = :row")
-                            .arg(drv->escapeIdentifier(mLegendValueField, QSqlDriver::FieldName))
-                            .arg(drv->escapeIdentifier(sqlModel->tableName(), QSqlDriver::TableName))
-                            .arg(drv->escapeIdentifier(sqlModel->getNMPrimaryKey(), QSqlDriver::FieldName));
-
-        db.transaction();
-        QSqlQuery q(db);
-        if (q.prepare(prepStr))
-        {
-            for (int i=start; i <= end; ++i)
-            {
-                q.bindValue(0, QVariant::fromValue(buf[i]));
-                if (q.exec())
-                {
-                    if (q.next())
-                    {
-                        out[i] = q.value(0).toLongLong();
-                    }
-                    else
-                    {
-                        out[i] = nodata;
-                    }
-                }
-                else
-                {
-                    out[i] = nodata;
-                }
-                q.finish();
-            }
-        }
-        else
-        {
-            std::string err = q.lastError().text().toStdString();
-            NMLogError(<< ctxNMImageLayer << ": " << err);
-        }
-        q.finish();
-        db.commit();
-        db.close();
-    }
-    QSqlDatabase::removeDatabase(conname);
+    mScalarLongLongLUT.map(buf, out, numPix, nodata);
 }
 
 template<class T>
@@ -2619,128 +2499,7 @@ void
 NMImageLayer::setDoubleScalars(T* buf, double* out,
                                long long numPix, double nodata)
 {
-    if (0)//mNumRecords > 1e6)
-    {
-        int nthreads = QThread::idealThreadCount();
-        long long threadpix = numPix / nthreads;
-        long long rest = numPix - (threadpix * nthreads);
-
-        QList<QFuture<void> > flist;
-        for (int t=0; t < nthreads; ++t)
-        {
-            flist << QFuture<void>();
-        }
-
-        long long start=0, end=0;
-        for (int th=0; th < nthreads; ++th)
-        {
-            end = start+threadpix-1;
-
-            if (th == nthreads-1)
-            {
-                end += rest;
-            }
-
-            flist[th] = QtConcurrent::run(this, &NMImageLayer::setDoubleDBScalars<T>,
-                                           buf, out, start, end, nodata);
-            start = end+1;
-        }
-
-        for (int th=0; th < nthreads; ++th)
-        {
-            flist[th].waitForFinished();
-        }
-    }
-    else
-    {
-        std::map<long long, double>::iterator it;
-        for (int i=0; i < numPix; ++i)
-        {
-            it = mScalarDoubleMap.find(buf[i]);
-            if (it != mScalarDoubleMap.end())
-            {
-                out[i] = it->second;
-            }
-            else
-            {
-                out[i] = nodata;
-            }
-        }
-    }
-}
-
-template<class T>
-void
-NMImageLayer::setDoubleDBScalars(T* buf,
-                                 double* out,
-                                 long long start,
-                                 long long end,
-                                 double nodata
-                                 )
-{
-    NMSqlTableModel* sqlModel = qobject_cast<NMSqlTableModel*>(mTableModel);
-
-    QString conname = QString("NMImageLayer_%1").arg(NMGlobalHelper::getRandomString(8));
-
-    // db scope
-    // without db and q going out of scope, we cannot remove
-    // db without Qt complaining
-    {
-        NMQSQLiteDriver* drv = new NMQSQLiteDriver();
-        QSqlDatabase db = QSqlDatabase::addDatabase(drv, conname);
-        db.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE;"
-                                "QSQLITE_INIT_SPATIALITE;"
-                                "QSQLITE_OPEN_URI;"
-                                "QSQLITE_OPEN_READONLY");
-        db.setDatabaseName(sqlModel->getDatabaseName());
-        if (!db.open())
-        {
-            NMLogError(<< ctxNMImageLayer << "::" << __FUNCTION__ << "() - setDoubleDBScalars '"
-                       << sqlModel->getDatabaseName().toStdString() << "' failed: "
-                       << db.lastError().text().toStdString());
-        }
-
-        QString prepStr = QString("SELECT %1 from %2 where %3 = :row")
-                            .arg(drv->escapeIdentifier(mLegendValueField, QSqlDriver::FieldName))
-                            .arg(drv->escapeIdentifier(sqlModel->tableName(), QSqlDriver::TableName))
-                            .arg(drv->escapeIdentifier(sqlModel->getNMPrimaryKey(), QSqlDriver::FieldName));
-
-
-        db.transaction();
-        QSqlQuery q(db);
-        if (q.prepare(prepStr))
-        {
-            for (int i=start; i <= end; ++i)
-            {
-                q.bindValue(0, QVariant::fromValue(buf[i]));
-                if (q.exec())
-                {
-                    if (q.next())
-                    {
-                        out[i] = q.value(0).toDouble();
-                    }
-                    else
-                    {
-                        out[i] = nodata;
-                    }
-                }
-                else
-                {
-                    out[i] = nodata;
-                }
-                q.finish();
-            }
-        }
-        else
-        {
-            std::string err = q.lastError().text().toStdString();
-            NMLogError(<< ctxNMImageLayer << ": " << err);
-        }
-        q.finish();
-        db.commit();
-        db.close();
-    }
-    QSqlDatabase::removeDatabase(conname);
+    mScalarDoubleLUT.map(buf, out, numPix, nodata);
 }
 
 template<class T>
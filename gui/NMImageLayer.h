@@ -30,6 +30,7 @@
 #include <NMImageReader.h>
 #include <NMItk2VtkConnector.h>
 #include <NMDataComponent.h>
+#include "NMScalarLUT.h"
 
 #include "itkDataObject.h"
 #include "otbImage.h"
@@ -172,15 +173,9 @@ protected:
     template<class T>
     void setLongScalars(T* buf, long long* out, long long numPix, long long nodata);
 
-    template<class T>
-    void setLongDBScalars(T* buf, long long* out, long long start, long long end, long long nodata);
-
     template<class T>
     void setDoubleScalars(T* buf, double* out, long long numPix, double nodata);
 
-    template<class T>
-    void setDoubleDBScalars(T* buf, double* out, long long start, long long end, double nodata);
-
     template<class T>
     void mapScalarsToRGB(T* in, unsigned char* out, int numPix, int numComp,
                          const std::vector<double>& minmax);
@@ -278,8 +273,8 @@ protected:
     static const int mMaxLayerDimensions;
     FILE* mScalarBufferFile;
 
-    std::map<long long, long long> mScalarLongLongMap;
-    std::map<long long, double> mScalarDoubleMap;
+    NMScalarLUT<long long> mScalarLongLongLUT;
+    NMScalarLUT<double> mScalarDoubleLUT;
 
 protected slots:
     int updateAttributeTable(void);
@@ -0,0 +1,213 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef NMSCALARLUT_H
+#define NMSCALARLUT_H
+
+#include <vector>
+#include <algorithm>
+
+#include <QList>
+#include <QThread>
+#include <QFuture>
+#include <QtConcurrent>
+
+/*!
+    maps (RAT) keys, i.e. the pixel values of an
+    image layer, onto attribute values;
+
+    for (mostly) contiguous keys, values are looked up
+    in a dense array indexed by key - min(key); for
+    sparse keys, in a sorted array of keys by binary
+    search
+*/
+
+template<class TValue>
+class NMScalarLUT
+{
+public:
+    NMScalarLUT()
+        : mOffset(0), mbDense(true)
+    {}
+
+    void clear()
+    {
+        mOffset = 0;
+        mbDense = true;
+        std::vector<TValue>().swap(mValues);
+        std::vector<unsigned char>().swap(mValid);
+        std::vector<long long>().swap(mKeys);
+    }
+
+    bool isEmpty() const
+    {return mValues.empty();}
+
+    /*!
+        builds the table from key-value pairs; for
+        duplicate keys, the first value is used
+     */
+    void build(const std::vector<long long>& keys,
+               const std::vector<TValue>& values)
+    {
+        this->clear();
+        const size_t n = std::min(keys.size(), values.size());
+        if (n == 0)
+        {
+            return;
+        }
+
+        const long long minKey = *std::min_element(keys.begin(), keys.begin()+n);
+        const long long maxKey = *std::max_element(keys.begin(), keys.begin()+n);
+        const unsigned long long range = static_cast<unsigned long long>(maxKey)
+                                       - static_cast<unsigned long long>(minKey) + 1;
+
+        // we accept up to ~3/4 of unused entries
+        // (~ 1 byte per pixel) for the dense table
+        mbDense = range > 0 && range <= 4 * static_cast<unsigned long long>(n) + 1024;
+        if (mbDense)
+        {
+            mOffset = minKey;
+            mValues.assign(range, TValue());
+            mValid.assign(range, 0);
+            for (size_t i=0; i < n; ++i)
+            {
+                const size_t k = static_cast<unsigned long long>(keys[i])
+                               - static_cast<unsigned long long>(mOffset);
+                if (!mValid[k])
+                {
+                    mValues[k] = values[i];
+                    mValid[k] = 1;
+                }
+            }
+        }
+        else
+        {
+            std::vector<size_t> order(n);
+            for (size_t i=0; i < n; ++i)
+            {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&keys](size_t a, size_t b){return keys[a] < keys[b];});
+
+            mKeys.reserve(n);
+            mValues.reserve(n);
+            for (size_t i=0; i < n; ++i)
+            {
+                const long long key = keys[order[i]];
+                if (mKeys.empty() || mKeys.back() != key)
+                {
+                    mKeys.push_back(key);
+                    mValues.push_back(values[order[i]]);
+                }
+            }
+        }
+    }
+
+    inline bool lookup(long long key, TValue& val) const
+    {
+        if (mbDense)
+        {
+            const unsigned long long k = static_cast<unsigned long long>(key)
+                                       - static_cast<unsigned long long>(mOffset);
+            if (k < mValid.size() && mValid[k])
+            {
+                val = mValues[k];
+                return true;
+            }
+        }
+        else
+        {
+            std::vector<long long>::const_iterator it =
+                    std::lower_bound(mKeys.begin(), mKeys.end(), key);
+            if (it != mKeys.end() && *it == key)
+            {
+                val = mValues[it - mKeys.begin()];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*!
+        maps numPix keys of in onto out; keys not
+        found in the table are mapped onto nodata
+     */
+    template<class TKey>
+    void map(const TKey* in, TValue* out, long long numPix, TValue nodata) const
+    {
+        // not worth spawning threads for small viewports
+        const long long minChunk = 1 << 16;
+        long long nthreads = std::min<long long>(QThread::idealThreadCount(),
+                                                 numPix / minChunk);
+        if (nthreads < 2)
+        {
+            this->mapRange(in, out, 0, numPix, nodata);
+            return;
+        }
+
+        QList<QFuture<void> > flist;
+        const long long chunk = numPix / nthreads;
+        for (long long th=0; th < nthreads; ++th)
+        {
+            const long long start = th * chunk;
+            const long long end = th == nthreads-1 ? numPix : start + chunk;
+            flist << QtConcurrent::run(this, &NMScalarLUT<TValue>::template mapRange<TKey>,
+                                       in, out, start, end, nodata);
+        }
+
+        for (int th=0; th < flist.size(); ++th)
+        {
+            flist[th].waitForFinished();
+        }
+    }
+
+protected:
+
+    template<class TKey>
+    void mapRange(const TKey* in, TValue* out, long long start,
+                  long long end, TValue nodata) const
+    {
+        if (mbDense)
+        {
+            const size_t size = mValid.size();
+            const unsigned long long offset = static_cast<unsigned long long>(mOffset);
+            const TValue* values = mValues.data();
+            const unsigned char* valid = mValid.data();
+            for (long long i=start; i < end; ++i)
+            {
+                const unsigned long long k = static_cast<unsigned long long>(
+                            static_cast<long long>(in[i])) - offset;
+                out[i] = k < size && valid[k] ? values[k] : nodata;
+            }
+        }
+        else
+        {
+            TValue val;
+            for (long long i=start; i < end; ++i)
+            {
+                out[i] = this->lookup(static_cast<long long>(in[i]), val) ? val : nodata;
+            }
+        }
+    }
+
+    long long mOffset;
+    bool mbDense;
+    std::vector<TValue> mValues;
+    std::vector<unsigned char> mValid;
+    std::vector<long long> mKeys;
+};
+
+#endif // NMSCALARLUT_H
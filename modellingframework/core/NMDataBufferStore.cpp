@@ -0,0 +1,224 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+#include "NMDataBufferStore.h"
+
+#include <QMutexLocker>
+#include <QSet>
+
+NMDataBufferStore::NMDataBufferStore()
+    : mMaxSize(0), mSize(0), mTick(0)
+{
+}
+
+NMDataBufferStore::~NMDataBufferStore()
+{
+}
+
+void
+NMDataBufferStore::setMaxSize(qint64 bytes)
+{
+    QMutexLocker lock(&mMutex);
+    mMaxSize = bytes < 0 ? 0 : bytes;
+}
+
+qint64
+NMDataBufferStore::getMaxSize(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mMaxSize;
+}
+
+qint64
+NMDataBufferStore::getSize(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mSize;
+}
+
+bool
+NMDataBufferStore::insert(const void* owner, const void* group,
+                          QSharedPointer<NMItkDataObjectWrapper> buffer,
+                          const QString& spillDir, bool bMapped)
+{
+    QMutexLocker lock(&mMutex);
+
+    QHash<const void*, Entry>::iterator it = mEntries.find(owner);
+    if (it != mEntries.end())
+    {
+        if (!it.value().mapped)
+        {
+            mSize -= it.value().size;
+        }
+        mEntries.erase(it);
+    }
+
+    if (buffer.isNull() || buffer->getDataObject() == nullptr)
+    {
+        return false;
+    }
+
+    Entry e;
+    e.buffer = buffer;
+    e.group = group;
+    e.spillDir = spillDir;
+    e.size = buffer->getBufferSize();
+    e.mapped = buffer->isBufferMapped();
+    e.lastUsed = ++mTick;
+
+    if (!e.mapped && e.size > 0)
+    {
+        if (!bMapped && mMaxSize > 0 && mSize + e.size > mMaxSize)
+        {
+            if (!mSuspended.contains(group))
+            {
+                this->evict(group, e.size);
+            }
+            bMapped = mSize + e.size > mMaxSize;
+        }
+
+        if (bMapped)
+        {
+            e.mapped = buffer->mapBuffer(spillDir);
+        }
+
+        if (!e.mapped)
+        {
+            mSize += e.size;
+        }
+    }
+
+    mEntries.insert(owner, e);
+    return e.mapped;
+}
+
+void
+NMDataBufferStore::touch(const void* owner)
+{
+    QMutexLocker lock(&mMutex);
+    QHash<const void*, Entry>::iterator it = mEntries.find(owner);
+    if (it != mEntries.end())
+    {
+        it.value().lastUsed = ++mTick;
+    }
+}
+
+void
+NMDataBufferStore::remove(const void* owner)
+{
+    QMutexLocker lock(&mMutex);
+    QHash<const void*, Entry>::iterator it = mEntries.find(owner);
+    if (it != mEntries.end())
+    {
+        if (!it.value().mapped)
+        {
+            mSize -= it.value().size;
+        }
+        mEntries.erase(it);
+    }
+}
+
+void
+NMDataBufferStore::removeGroup(const void* group)
+{
+    QMutexLocker lock(&mMutex);
+    QHash<const void*, Entry>::iterator it = mEntries.begin();
+    while (it != mEntries.end())
+    {
+        if (it.value().group == group)
+        {
+            if (!it.value().mapped)
+            {
+                mSize -= it.value().size;
+            }
+            it = mEntries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    mSuspended.remove(group);
+}
+
+void
+NMDataBufferStore::clear(void)
+{
+    QMutexLocker lock(&mMutex);
+    mEntries.clear();
+    mSize = 0;
+}
+
+void
+NMDataBufferStore::suspendEviction(const void* group)
+{
+    QMutexLocker lock(&mMutex);
+    ++mSuspended[group];
+}
+
+void
+NMDataBufferStore::resumeEviction(const void* group)
+{
+    QMutexLocker lock(&mMutex);
+    QHash<const void*, int>::iterator it = mSuspended.find(group);
+    if (it != mSuspended.end() && --it.value() <= 0)
+    {
+        mSuspended.erase(it);
+    }
+}
+
+void
+NMDataBufferStore::evict(const void* group, qint64 required)
+{
+    // map the least recently used RAM buffers of the group
+    // until the required space is available
+    QSet<const void*> skipped;
+    while (mSize + required > mMaxSize)
+    {
+        QHash<const void*, Entry>::iterator lru = mEntries.end();
+        QHash<const void*, Entry>::iterator it = mEntries.begin();
+        for (; it != mEntries.end(); ++it)
+        {
+            const Entry& e = it.value();
+            if (    !e.mapped
+                 && !skipped.contains(it.key())
+                 && e.size > 0
+                 && e.group == group
+                 && (lru == mEntries.end() || e.lastUsed < lru.value().lastUsed)
+               )
+            {
+                lru = it;
+            }
+        }
+
+        if (lru == mEntries.end())
+        {
+            break;
+        }
+
+        // if we can't map it (e.g. because it's still shared with
+        // another image), we leave it in RAM (and accounted for),
+        // but don't consider it again this time
+        Entry& e = lru.value();
+        if (e.buffer->mapBuffer(e.spillDir))
+        {
+            mSize -= e.size;
+            e.mapped = true;
+        }
+        else
+        {
+            skipped.insert(lru.key());
+        }
+    }
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+#ifndef NMDATABUFFERSTORE_H_
+#define NMDATABUFFERSTORE_H_
+
+#include <QHash>
+#include <QString>
+#include <QSharedPointer>
+#include <QMutex>
+
+#include "NMItkDataObjectWrapper.h"
+#include "nmmodframecore_export.h"
+
+/*!
+ * \brief The NMDataBufferStore class keeps track of the images
+ *        buffered by the data components (DataBuffer) of a model
+ *        and limits the RAM they occupy
+ *
+ * Data components register their image buffers with the store.
+ * Buffers are kept in RAM as long as the total size of all RAM buffers
+ * fits into the budget (bytes). Otherwise, the least recently used
+ * buffers are moved into memory-mapped temporary files (cf.
+ * NMItkDataObjectWrapper::mapBuffer), i.e. they're paged out to
+ * those files instead of the swap space when memory gets tight.
+ * Buffers of data components whose storage is file-backed anyway
+ * are mapped right away and don't count towards the budget.
+ *
+ * A budget of 0 disables the limit. The store is shared between
+ * a controller and its worker controllers, but only buffers
+ * registered by the same controller (group) are evicted in
+ * favour of a new one, since the others may be in use on another
+ * thread. For the same reason, eviction can be suspended while
+ * components of the same group are executed concurrently, in which
+ * case buffers which don't fit are mapped themselves.
+ */
+class NMMODFRAMECORE_EXPORT NMDataBufferStore
+{
+public:
+    NMDataBufferStore();
+    virtual ~NMDataBufferStore();
+
+    /*! Sets the RAM budget (bytes); 0 means unlimited */
+    void setMaxSize(qint64 bytes);
+    qint64 getMaxSize(void) const;
+
+    /*! Size (bytes) of all buffers currently kept in RAM */
+    qint64 getSize(void) const;
+
+    /*! Registers (or updates) the buffer of owner, which belongs to
+     *  group (e.g. the model controller) and maps it into a temporary
+     *  file in spillDir, if bMapped is true or if it doesn't fit into
+     *  the budget; returns true, if the buffer is memory-mapped
+     */
+    bool insert(const void* owner, const void* group,
+                QSharedPointer<NMItkDataObjectWrapper> buffer,
+                const QString& spillDir, bool bMapped);
+
+    /*! Marks owner's buffer as recently used */
+    void touch(const void* owner);
+    void remove(const void* owner);
+
+    /*! Removes all buffers registered by group */
+    void removeGroup(const void* group);
+    void clear(void);
+
+    void suspendEviction(const void* group);
+    void resumeEviction(const void* group);
+
+protected:
+    struct Entry
+    {
+        QSharedPointer<NMItkDataObjectWrapper> buffer;
+        const void* group;
+        QString spillDir;
+        qint64 size;
+        bool mapped;
+        quint64 lastUsed;
+    };
+
+    void evict(const void* group, qint64 required);
+
+    QHash<const void*, Entry> mEntries;
+    QHash<const void*, int> mSuspended;
+    qint64 mMaxSize;
+    qint64 mSize;
+    quint64 mTick;
+
+    mutable QMutex mMutex;
+
+private:
+    NMDataBufferStore(const NMDataBufferStore&); //purposely not implemented
+    void operator=(const NMDataBufferStore&); //purposely not implemented
+};
+
+#endif /* NMDATABUFFERSTORE_H_ */
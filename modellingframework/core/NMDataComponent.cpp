@@ -32,10 +32,14 @@
 #include <string>
 #include <sstream>
 
+#include <QDir>
+#include <QFileInfo>
+
 #include "NMModelController.h"
 #include "NMDataComponent.h"
 #include "NMIterableComponent.h"
 #include "NMMfwException.h"
+#include "NMDataBufferStore.h"
 #include "otbSQLiteTable.h"
 #include "itkNMLogEvent.h"
 
@@ -68,6 +72,7 @@ NMDataComponent::initAttributes(void)
     mTabMinPK = itk::NumericTraits<long long>::max();
     mTabMaxPK = itk::NumericTraits<long long>::NonpositiveMin();
     mIsStreamable = false;
+    mMemoryMapped = false;
 }
 
 void
@@ -90,6 +95,8 @@ NMDataComponent::setNthInput(unsigned int idx, QSharedPointer<NMItkDataObjectWra
 
     if (!mDataWrapper.isNull())
     {
+        this->registerDataBuffer();
+
         if (mDataWrapper->getDataObject())
         {
             // add an observer to keep track of any internal log worthy events
@@ -465,13 +472,77 @@ NMDataComponent::fetchData(NMModelComponent* comp)
 QSharedPointer<NMItkDataObjectWrapper>
 NMDataComponent::getOutput(unsigned int idx)
 {
+    if (    !mDataWrapper.isNull()
+         && this->getModelController() != nullptr
+       )
+    {
+        this->getModelController()->getDataBufferStore()->touch(this);
+    }
     return mDataWrapper;
 }
 
 QSharedPointer<NMItkDataObjectWrapper>
 NMDataComponent::getOutput(const QString& name)
 {
-    return mDataWrapper;
+    return this->getOutput(0u);
+}
+
+bool
+NMDataComponent::shareData(NMDataComponent* source)
+{
+    if (    source == nullptr
+        ||  source->mDataWrapper.isNull()
+        ||  source->mDataWrapper->getDataObject() == nullptr
+       )
+    {
+        return false;
+    }
+
+    NMItkDataObjectWrapper* view = source->mDataWrapper->createBufferView();
+    if (view == nullptr)
+    {
+        return false;
+    }
+
+    if (!mDataWrapper.isNull())
+    {
+        this->reset();
+    }
+
+    // without any inputs, we keep the data as if it had
+    // been set from outside the pipeline (cf. linkComponents)
+    this->setInputs(QList<QStringList>());
+    mDataWrapper = QSharedPointer<NMItkDataObjectWrapper>(view);
+
+    emit NMDataComponentChanged();
+    return true;
+}
+
+void
+NMDataComponent::registerDataBuffer(void)
+{
+    NMModelController* ctrl = this->getModelController();
+    if (ctrl == nullptr || mDataWrapper->getDataObject() == nullptr)
+    {
+        return;
+    }
+
+    // buffers which don't fit into the RAM budget are
+    // spilled into memory-mapped files in the workspace
+    QString spillDir = ctrl->getSetting("Workspace").toString();
+    if (spillDir.isEmpty() || !QFileInfo(spillDir).isWritable())
+    {
+        spillDir = QDir::tempPath();
+    }
+
+    const bool bMapped = ctrl->getDataBufferStore()->insert(
+                this, ctrl, mDataWrapper, spillDir, mMemoryMapped);
+    if (bMapped)
+    {
+        NMDebugAI(<< this->objectName().toStdString()
+                  << ": data buffer memory-mapped in '"
+                  << spillDir.toStdString() << "'" << std::endl);
+    }
 }
 
 void
@@ -560,6 +631,10 @@ NMDataComponent::reset(void)
             otb::SQLiteTable::Pointer sqltab = static_cast<otb::SQLiteTable*>(mDataWrapper->getOTBTab().GetPointer());
             sqltab->CloseTable();
         }
+        if (this->getModelController() != nullptr)
+        {
+            this->getModelController()->getDataBufferStore()->remove(this);
+        }
         mDataWrapper.clear();
     }
     this->mbLinked = false;
@@ -42,12 +42,20 @@ class NMMODFRAMECORE_EXPORT NMDataComponent: public NMModelComponent
 {
     Q_OBJECT
     Q_PROPERTY(bool IsStreamable READ getIsStreamable WRITE setIsStreamable)
+    Q_PROPERTY(bool MemoryMapped READ getMemoryMapped WRITE setMemoryMapped)
 
     friend class NMDataRefComponent;
 public:
 
     NMPropertyGetSet( IsStreamable, bool )
 
+    /*! Keeps the image buffer in a memory-mapped file (in the
+     *  workspace) rather than in RAM; buffers are also moved into
+     *  mapped files when they exceed the 'DataBufferMemory' budget
+     *  (cf. NMDataBufferStore)
+     */
+    NMPropertyGetSet( MemoryMapped, bool )
+
     signals:
     void NMDataComponentChanged();
 
@@ -62,12 +70,21 @@ public:
     virtual void update(const QMap<QString, NMModelComponent*>& repo);
     virtual void reset(void);
 
+    /*! Uses a view of source's image buffer instead of fetching
+     *  the data from upstream, e.g. in the model copies of worker
+     *  threads (cf. NMParallelIterComponent); the buffer is owned
+     *  by source, hence it isn't registered with the data buffer
+     *  store; returns false, if source hasn't got any image
+     */
+    bool shareData(NMDataComponent* source);
+
 protected:
 
     QSharedPointer<NMItkDataObjectWrapper> mDataWrapper;
     //QStringList mInputSpec;
 
     bool mIsStreamable;
+    bool mMemoryMapped;
 
     long long mTabMinPK;
     long long mTabMaxPK;
@@ -84,6 +101,7 @@ protected:
 
     virtual void initAttributes(void);
     void fetchData(NMModelComponent* comp);
+    void registerDataBuffer(void);
 
 private:
     static const std::string ctx;
@@ -21,6 +21,12 @@
 #include <iostream>
 #include <sstream>
 #include <QSet>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QMetaProperty>
+#include <QtConcurrentRun>
 
 #ifndef NM_ENABLE_LOGGER
 #   define NM_ENABLE_LOGGER
@@ -34,11 +40,93 @@
 #include "NMDataComponent.h"
 #include "NMSequentialIterComponent.h"
 #include "NMMfwException.h"
+#include "NMDataBufferStore.h"
 #include "NMProcessFactory.h"
 #include "NMImageReader.h"
 #include "nmNetCDFIO.h"
 #include "utils/muParser/muParserError.h"
 
+namespace
+{
+
+/*! releases a (locked) mutex for the life time of the
+ *  object, if there is one */
+class BranchUnlocker
+{
+public:
+    BranchUnlocker(QMutex* mutex) : mMutex(mutex)
+    {
+        if (mMutex != nullptr)
+        {
+            mMutex->unlock();
+        }
+    }
+
+    ~BranchUnlocker()
+    {
+        if (mMutex != nullptr)
+        {
+            mMutex->lock();
+        }
+    }
+
+private:
+    QMutex* mMutex;
+};
+
+/*! concatenates all of proc's parameters containing
+ *  parameter expressions, i.e. references to other
+ *  model components
+ */
+QString paramExpressionText(QObject* proc)
+{
+    QStringList exprs;
+    const QMetaObject* meta = proc->metaObject();
+    for (int p=0; p < meta->propertyCount(); ++p)
+    {
+        const QVariant val = meta->property(p).read(proc);
+
+        QStringList strs;
+        if (val.userType() == qMetaTypeId<QList<QList<QStringList> > >())
+        {
+            foreach(const QList<QStringList>& ll, val.value<QList<QList<QStringList> > >())
+            {
+                foreach(const QStringList& l, ll)
+                {
+                    strs << l;
+                }
+            }
+        }
+        else if (val.userType() == qMetaTypeId<QList<QStringList> >())
+        {
+            foreach(const QStringList& l, val.value<QList<QStringList> >())
+            {
+                strs << l;
+            }
+        }
+        else if (val.userType() == QMetaType::QStringList)
+        {
+            strs = val.toStringList();
+        }
+        else if (val.userType() == QMetaType::QString)
+        {
+            strs << val.toString();
+        }
+
+        foreach(const QString& str, strs)
+        {
+            if (str.contains(QStringLiteral("$[")))
+            {
+                exprs << str;
+            }
+        }
+    }
+
+    return exprs.join(QChar(' '));
+}
+
+} // end of anonymous namespace
+
 ///////////////////////////////////////////////
 /// NMModelComponentIterator implementation
 ///////////////////////////////////////////////
@@ -93,6 +181,7 @@ void NMIterableComponent::initAttributes(void)
     this->mIterationStepExpression.clear();
     this->mNumIterations = 1;
     this->mNumIterationsExpression.clear();
+    this->mBranchMutex = nullptr;
 }
 
 NMIterableComponent::~NMIterableComponent(void)
@@ -232,6 +321,10 @@ void NMIterableComponent::addModelComponent(NMModelComponent* comp)
     NMDebugAI(<< "  -> add child:  '" << comp->objectName().toStdString() << "'" << std::endl);
 //	NMDebugAI(<< "new chain: ");
     comp->setHostComponent(this);
+    if (this->mController != nullptr)
+    {
+        this->mController->invalidateParameterCache();
+    }
 
     NMModelComponentIterator cit = this->getComponentIterator();
     NMModelComponent* lastComp = *cit;
@@ -498,6 +591,10 @@ void NMIterableComponent::insertModelComponent(NMModelComponent* insertComp,
         insertComp->setTimeLevel(this->getTimeLevel());
 
     insertComp->setHostComponent(this);
+    if (this->mController != nullptr)
+    {
+        this->mController->invalidateParameterCache();
+    }
 
     emit NMModelComponentChanged();
 }
@@ -672,6 +769,10 @@ NMModelComponent* NMIterableComponent::removeModelComponent(const QString& compN
     comp->setHostComponent(nullptr);
     comp->setUpstreamModelComponent(nullptr);
     comp->setDownstreamModelComponent(nullptr);
+    if (this->mController != nullptr)
+    {
+        this->mController->invalidateParameterCache();
+    }
 
     NMDebugCtx(ctx, << "done!");
     emit NMModelComponentChanged();
@@ -743,7 +844,16 @@ NMIterableComponent::getOutput(unsigned int idx)
         NMLogDebug(<< this->objectName().toStdString()
                 << "->getOutput(" << idx << ")" << std::endl);
 
-        ret = mProcess->getOutput(idx);
+        // results taken from the result cache are
+        // already disconnected from their pipeline
+        if (mProcess->isResultCached())
+        {
+            ret = mProcess->getCachedOutput(idx);
+        }
+        if (ret.isNull())
+        {
+            ret = mProcess->getOutput(idx);
+        }
         if (!ret.isNull())
         {
             if (ret->getOTBTab().IsNotNull())
@@ -1209,8 +1319,12 @@ NMIterableComponent::componentUpdateLogic(const QMap<QString, NMModelComponent*>
         controller->getLogger()->logProvN(NMLogger::NM_PROV_START, args, attrs);
 
 
-        // execute process / pipeline
-        this->mProcess->update();
+        // execute process / pipeline; when we're one of several concurrently
+        // executed pipelines, we let the others carry on in the meantime
+        {
+            BranchUnlocker unlocker(mBranchMutex);
+            this->mProcess->update();
+        }
 
         // more provenenace
         endTime = QDateTime::currentDateTime();
@@ -1616,141 +1730,130 @@ NMIterableComponent::componentUpdateLogic(const QMap<QString, NMModelComponent*>
         //          PROCESS COMPS and PIPES sequential or parallel
         // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-        foreach(const QStringList& pipeline, execList)
+        // on a single process, independent pipelines (i.e. branches of the
+        // model) may be executed concurrently on up to 'MaxBranchThreads'
+        // threads; worker controllers (cf. NMParallelIterComponent) already
+        // run on their own thread, so they stick to sequential execution
+        const int maxBranchThreads = controller->getSetting(
+                    QStringLiteral("MaxBranchThreads")).toInt();
+        if (    maxBranchThreads > 1
+             && commProcs == 1
+             && execList.size() > 1
+             && !controller->isWorkerController()
+           )
         {
-            // skip this pipeline, if it's not this rank's business!
-            if (!rankExecComps.contains(pipeline.last()))
+            if (!this->concurrentPipelineUpdate(repo, execList, step, maxBranchThreads))
             {
-                wulog(-1, "lr" << commRank << ": >> skip " << pipeline.last().toStdString());
-                continue;
+                NMDebugAI(<< ">>>> END ITERATION #" << step+1 << std::endl);
+                NMDebugCtx(this->objectName().toStdString(), << "done!");
+                return;
             }
-
-            // for each pipeline, we first link each individual component
-            // (from head to toe), before we finally call update on the
-            // last (i.e. executable) component of the pipeline
-            std::vector<otb::NetCDFIO::Pointer> parallelReaders;
-
-            comp = nullptr;
-            for (int c=0; c < pipeline.size(); ++c)
+        }
+        else
+        {
+            foreach(const QStringList& pipeline, execList)
             {
-                QString in = pipeline.at(c);
-                comp = controller->getComponent(in);
-                if (comp == 0)
+                // skip this pipeline, if it's not this rank's business!
+                if (!rankExecComps.contains(pipeline.last()))
                 {
-                    NMMfwException e(NMMfwException::NMModelController_UnregisteredModelComponent);
-                    e.setSource(in.toStdString());
-                    std::stringstream msg;
-                    msg << "'" << in.toStdString() << "'";
-                    e.setDescription(msg.str());
-                    NMDebugCtx(this->objectName().toStdString(), << "done!");
-                    emit signalExecutionStopped();
-                    throw e;
+                    wulog(-1, "lr" << commRank << ": >> skip " << pipeline.last().toStdString());
+                    continue;
                 }
-                // link component
-                comp->linkComponents(step, repo);
 
-                // if comp is a reader in a parallel write pipeline and
-                // if comp is reading a netcdf file, initiate parallel read!
-                if (rankPioWriters.contains(pipeline.last()))
+                // for each pipeline, we first link each individual component
+                // (from head to toe), before we finally call update on the
+                // last (i.e. executable) component of the pipeline
+                std::vector<otb::NetCDFIO::Pointer> parallelReaders;
+
+                comp = nullptr;
+                for (int c=0; c < pipeline.size(); ++c)
                 {
-                    NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
-                    if (ic != nullptr && ic->objectName().startsWith("ImageReader"))
+                    QString in = pipeline.at(c);
+                    comp = controller->getComponent(in);
+                    if (comp == 0)
                     {
-                        NMImageReader* reader = qobject_cast<NMImageReader*>(ic->getProcess());
-                        if (reader != nullptr)
-                        {
-                            otb::ImageIOBase* bio = const_cast<otb::ImageIOBase*>(reader->getImageIOBase());
-                            otb::NetCDFIO::Pointer nio = dynamic_cast<otb::NetCDFIO*>(bio);
+                        NMMfwException e(NMMfwException::NMModelController_UnregisteredModelComponent);
+                        e.setSource(in.toStdString());
+                        std::stringstream msg;
+                        msg << "'" << in.toStdString() << "'";
+                        e.setDescription(msg.str());
+                        NMDebugCtx(this->objectName().toStdString(), << "done!");
+                        emit signalExecutionStopped();
+                        throw e;
+                    }
+                    // link component
+                    comp->linkComponents(step, repo);
 
-                            if (nio.GetPointer() != nullptr)
+                    // if comp is a reader in a parallel write pipeline and
+                    // if comp is reading a netcdf file, initiate parallel read!
+                    if (rankPioWriters.contains(pipeline.last()))
+                    {
+                        NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
+                        if (ic != nullptr && ic->objectName().startsWith("ImageReader"))
+                        {
+                            NMImageReader* reader = qobject_cast<NMImageReader*>(ic->getProcess());
+                            if (reader != nullptr)
                             {
+                                otb::ImageIOBase* bio = const_cast<otb::ImageIOBase*>(reader->getImageIOBase());
+                                otb::NetCDFIO::Pointer nio = dynamic_cast<otb::NetCDFIO*>(bio);
+
+                                if (nio.GetPointer() != nullptr)
+                                {
 wulog(-1, "lr" << commRank << ": '" << nio->GetFileName() << "' needs opening in parallel mode ...!");
-                                MPI_Comm niopioComm = this->mController->getNextUpstrMPIComm(comp->objectName());
-                                MPI_Info info = MPI_INFO_NULL;
-                                bool bpio = nio->InitParallelIO(niopioComm, info, false);
+                                    MPI_Comm niopioComm = this->mController->getNextUpstrMPIComm(comp->objectName());
+                                    MPI_Info info = MPI_INFO_NULL;
+                                    bool bpio = nio->InitParallelIO(niopioComm, info, false);
 wulog(-1, "lr" << commRank << ": init parallel IO " << (bpio ? " successful!" : " failed!"));
-                                parallelReaders.push_back(nio);
+                                    parallelReaders.push_back(nio);
+                                }
                             }
                         }
                     }
-                }
-
-
-                // gather some info, we could use for debugging purposes in case
-                // the execution fails
-                hostName = QStringLiteral("Unknown");
-                hostStep = -1;
-                if (comp->getHostComponent())
-                {
-                    hostName = comp->getHostComponent()->objectName();
-                    hostStep = comp->getHostComponent()->getIterationStep();
-                }
-
-                NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
-                NMProcess* pc = ic == nullptr ? nullptr : ic->getProcess();
 
-                // log provenance
-                args.clear();
-                attrs = controller->getProvNAttributes(comp);
 
-                QString respId = QString("nm:%1").arg(this->objectName());
-
-
-                actId = QString("nm:%1_Update-%2").arg(comp->objectName()).arg(this->getIterationStep());
-                agId = QString("nm:%1").arg(comp->objectName());
-
-
-                args << agId;
-                controller->getLogger()->logProvN(NMLogger::NM_PROV_AGENT, args, attrs);
-
-                attrs.clear();
-                args.clear();
-                args << agId << respId << "-";
-                controller->getLogger()->logProvN(NMLogger::NM_PROV_DELEGATION, args, attrs);
+                    // gather some info, we could use for debugging purposes in case
+                    // the execution fails
+                    hostName = QStringLiteral("Unknown");
+                    hostStep = -1;
+                    if (comp->getHostComponent())
+                    {
+                        hostName = comp->getHostComponent()->objectName();
+                        hostStep = comp->getHostComponent()->getIterationStep();
+                    }
 
-                attrs.clear();
-                if (pc != nullptr)
-                {
-                    attrs.append(pc->getRunTimeParaProvN());
+                    // log provenance
+                    this->logPipelineProvN(comp);
                 }
-                args.clear();
-                args << actId << "-" << "-";
-                controller->getLogger()->logProvN(NMLogger::NM_PROV_ACTIVITY, args, attrs);
-
-                attrs.clear();
-                args.clear();
-                args << actId << agId << "-";
-                controller->getLogger()->logProvN(NMLogger::NM_PROV_ASSOCIATION, args, attrs);
-            }
 
-            // calling update on the last component of the pipeline
-            // (the most downstream)
-            if (!controller->isModelAbortionRequested())
-            {
-                wulog(-1, "lr" << commRank << ": >> " << pipeline.last().toStdString() << "::update() ...");
-                comp->update(repo);
+                // calling update on the last component of the pipeline
+                // (the most downstream)
+                if (!controller->isModelAbortionRequested())
+                {
+                    wulog(-1, "lr" << commRank << ": >> " << pipeline.last().toStdString() << "::update() ...");
+                    comp->update(repo);
 
-                // clase parallel readers, if any
-                for (int pr=0; pr < parallelReaders.size(); ++pr)
+                    // clase parallel readers, if any
+                    for (int pr=0; pr < parallelReaders.size(); ++pr)
+                    {
+                        parallelReaders.at(pr)->FinaliseParallelIO();
+                    }
+                }
+                else
                 {
-                    parallelReaders.at(pr)->FinaliseParallelIO();
+                    NMDebugAI(<< ">>>> END ITERATION #" << step+1 << std::endl);
+                    NMDebugCtx(this->objectName().toStdString(), << "done!");
+                    return;
                 }
-            }
-            else
-            {
-                NMDebugAI(<< ">>>> END ITERATION #" << step+1 << std::endl);
-                NMDebugCtx(this->objectName().toStdString(), << "done!");
-                return;
-            }
 
-            // release resources
-            foreach (const QString in, pipeline)
-            {
-                comp = controller->getComponent(in);
-                NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
-                if (ic && ic->getProcess() != 0)
+                // release resources
+                foreach (const QString in, pipeline)
                 {
-                    ic->getProcess()->reset();
+                    comp = controller->getComponent(in);
+                    NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
+                    if (ic && ic->getProcess() != 0)
+                    {
+                        ic->getProcess()->reset();
+                    }
                 }
             }
         }
@@ -1865,6 +1968,393 @@ wulog(-1, "lr" << commRank << ": init parallel IO " << (bpio ? " successful!" :
     }
 }
 
+void
+NMIterableComponent::logPipelineProvN(NMModelComponent* comp)
+{
+    NMModelController* controller = this->getModelController();
+    NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
+    NMProcess* pc = ic == nullptr ? nullptr : ic->getProcess();
+
+    QStringList args;
+    QStringList attrs = controller->getProvNAttributes(comp);
+
+    QString respId = QString("nm:%1").arg(this->objectName());
+    QString actId = QString("nm:%1_Update-%2").arg(comp->objectName()).arg(this->getIterationStep());
+    QString agId = QString("nm:%1").arg(comp->objectName());
+
+    args << agId;
+    controller->getLogger()->logProvN(NMLogger::NM_PROV_AGENT, args, attrs);
+
+    attrs.clear();
+    args.clear();
+    args << agId << respId << "-";
+    controller->getLogger()->logProvN(NMLogger::NM_PROV_DELEGATION, args, attrs);
+
+    attrs.clear();
+    if (pc != nullptr)
+    {
+        attrs.append(pc->getRunTimeParaProvN());
+    }
+    args.clear();
+    args << actId << "-" << "-";
+    controller->getLogger()->logProvN(NMLogger::NM_PROV_ACTIVITY, args, attrs);
+
+    attrs.clear();
+    args.clear();
+    args << actId << agId << "-";
+    controller->getLogger()->logProvN(NMLogger::NM_PROV_ASSOCIATION, args, attrs);
+}
+
+bool
+NMIterableComponent::isConcurrentPipeline(const QStringList& pipeline)
+{
+    NMModelController* controller = this->getModelController();
+    for (int c=0; c < pipeline.size(); ++c)
+    {
+        NMModelComponent* comp = controller->getComponent(pipeline.at(c));
+
+        // data components upstream of the pipeline have been
+        // updated by one of the preceding pipelines
+        if (    qobject_cast<NMDataComponent*>(comp) != nullptr
+             && c < pipeline.size()-1
+           )
+        {
+            continue;
+        }
+
+        // aggregate components and non-itk processes (e.g. SQL processors
+        // or external executables) may well be using the controller while
+        // they're updating, so we don't let them run concurrently
+        NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
+        if (    ic == nullptr
+             || ic->getProcess() == nullptr
+             || ic->getProcess()->getInternalProc() == nullptr
+             || !ic->getProcess()->isConcurrentUpdateSafe()
+           )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*! state shared by the main thread and the worker threads
+ *  of concurrentPipelineUpdate */
+struct NMIterableComponent::BranchTaskQueue
+{
+    // guards any access to the model (i.e. components and controller)
+    QMutex linkMutex;
+
+    QMutex doneMutex;
+    QWaitCondition doneCond;
+    QList<int> finished;
+
+    bool bError;
+    NMMfwException error;
+};
+
+bool
+NMIterableComponent::concurrentPipelineUpdate(const QMap<QString, NMModelComponent*>& repo,
+            const QList<QStringList>& execList, unsigned int step, int maxThreads)
+{
+    NMModelController* controller = this->getModelController();
+    const int npipes = execList.size();
+
+    // ------------------------------------------------------------------
+    // build the dependency graph: a pipeline depends on any preceding
+    // pipeline it shares a component with (e.g. a data buffer filled by
+    // the preceding pipeline), or whose components either of them refers
+    // to by parameter expressions; pipelines which can't be executed
+    // concurrently, depend on all preceding pipelines and vice versa
+    QVector<bool> concurrent(npipes);
+    QVector<QStringList> ids(npipes);
+    QVector<QString> exprs(npipes);
+    for (int p=0; p < npipes; ++p)
+    {
+        concurrent[p] = this->isConcurrentPipeline(execList.at(p));
+        foreach(const QString& name, execList.at(p))
+        {
+            NMModelComponent* comp = controller->getComponent(name);
+            if (comp == nullptr)
+            {
+                continue;
+            }
+
+            ids[p] << QString("$[%1").arg(comp->objectName());
+            if (!comp->getUserID().isEmpty())
+            {
+                ids[p] << QString("$[%1").arg(comp->getUserID());
+            }
+
+            NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(comp);
+            if (ic != nullptr && ic->getProcess() != nullptr)
+            {
+                exprs[p] += paramExpressionText(ic->getProcess());
+            }
+        }
+    }
+
+    QVector<QVector<int> > deps(npipes);
+    for (int p=1; p < npipes; ++p)
+    {
+        for (int u=0; u < p; ++u)
+        {
+            bool bDepends = !concurrent[p] || !concurrent[u];
+            for (int n=0; !bDepends && n < execList.at(p).size(); ++n)
+            {
+                bDepends = execList.at(u).contains(execList.at(p).at(n));
+            }
+            for (int i=0; !bDepends && i < ids[u].size(); ++i)
+            {
+                bDepends = exprs[p].contains(ids[u].at(i));
+            }
+            for (int i=0; !bDepends && i < ids[p].size(); ++i)
+            {
+                bDepends = exprs[u].contains(ids[p].at(i));
+            }
+
+            if (bDepends)
+            {
+                deps[p] << u;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // execute the pipelines as soon as they're ready
+    enum {PIPE_PENDING, PIPE_RUNNING, PIPE_DONE};
+    QVector<int> state(npipes, PIPE_PENDING);
+    int numRunning = 0;
+    int numDone = 0;
+    bool bAbort = false;
+
+    BranchTaskQueue queue;
+    queue.bError = false;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(maxThreads);
+
+    NMDebugAI(<< "executing " << npipes << " pipelines on up to "
+              << maxThreads << " threads ..." << std::endl);
+
+    // data buffers may be in use by any of the running pipelines,
+    // so we don't map any of them into files behind their back
+    NMDataBufferStore* bufferStore = controller->getDataBufferStore();
+    bufferStore->suspendEviction(controller);
+
+    try
+    {
+        while (numDone < npipes)
+        {
+            for (int p=0; p < npipes && numRunning < maxThreads && !bAbort; ++p)
+            {
+                if (state[p] != PIPE_PENDING)
+                {
+                    continue;
+                }
+
+                bool bReady = true;
+                for (int d=0; bReady && d < deps[p].size(); ++d)
+                {
+                    bReady = state[deps[p].at(d)] == PIPE_DONE;
+                }
+                if (!bReady)
+                {
+                    continue;
+                }
+
+                const QStringList& pipeline = execList.at(p);
+
+                // since a non-concurrent pipeline depends on all preceding
+                // pipelines and all succeeding pipelines depend on it,
+                // we're the only one running now
+                QMutexLocker lock(&queue.linkMutex);
+                NMModelComponent* comp = nullptr;
+                foreach(const QString& in, pipeline)
+                {
+                    comp = controller->getComponent(in);
+                    if (comp == nullptr)
+                    {
+                        NMMfwException e(NMMfwException::NMModelController_UnregisteredModelComponent);
+                        e.setSource(in.toStdString());
+                        std::stringstream msg;
+                        msg << "'" << in.toStdString() << "'";
+                        e.setDescription(msg.str());
+                        throw e;
+                    }
+                    comp->linkComponents(step, repo);
+                    this->logPipelineProvN(comp);
+                }
+
+                if (controller->isModelAbortionRequested())
+                {
+                    bAbort = true;
+                    break;
+                }
+
+                if (!concurrent[p])
+                {
+                    lock.unlock();
+                    comp->update(repo);
+                    lock.relock();
+
+                    foreach (const QString& in, pipeline)
+                    {
+                        NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(
+                                    controller->getComponent(in));
+                        if (ic && ic->getProcess() != nullptr)
+                        {
+                            ic->getProcess()->reset();
+                        }
+                    }
+                    state[p] = PIPE_DONE;
+                    ++numDone;
+                }
+                else
+                {
+                    NMIterableComponent* execComp = qobject_cast<NMIterableComponent*>(comp);
+                    execComp->mBranchMutex = &queue.linkMutex;
+                    state[p] = PIPE_RUNNING;
+                    ++numRunning;
+                    QtConcurrent::run(&pool, this, &NMIterableComponent::branchComponentUpdate,
+                                      execComp, repo, &queue, p);
+                }
+            }
+
+            if (numRunning == 0)
+            {
+                if (bAbort || queue.bError)
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // wait for any of the running pipelines to finish and
+            // pass on any request to abort the model
+            QList<int> finished;
+            {
+                QMutexLocker lock(&queue.doneMutex);
+                if (queue.finished.isEmpty())
+                {
+                    queue.doneCond.wait(&queue.doneMutex, 250);
+                }
+                finished.swap(queue.finished);
+            }
+
+            if (!bAbort && controller->isModelAbortionRequested())
+            {
+                bAbort = true;
+                for (int p=0; p < npipes; ++p)
+                {
+                    if (state[p] != PIPE_RUNNING)
+                    {
+                        continue;
+                    }
+                    foreach(const QString& in, execList.at(p))
+                    {
+                        NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(
+                                    controller->getComponent(in));
+                        if (ic && ic->getProcess() != nullptr)
+                        {
+                            ic->getProcess()->abortExecution();
+                        }
+                    }
+                }
+            }
+
+            QMutexLocker lock(&queue.linkMutex);
+            bAbort = bAbort || queue.bError;
+            foreach(const int& p, finished)
+            {
+                foreach (const QString& in, execList.at(p))
+                {
+                    NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(
+                                controller->getComponent(in));
+                    if (ic && ic->getProcess() != nullptr)
+                    {
+                        ic->getProcess()->reset();
+                    }
+                }
+                qobject_cast<NMIterableComponent*>(
+                            controller->getComponent(execList.at(p).last()))->mBranchMutex = nullptr;
+                state[p] = PIPE_DONE;
+                --numRunning;
+                ++numDone;
+            }
+        }
+    }
+    catch (...)
+    {
+        // don't leave any pipelines behind
+        pool.waitForDone();
+        for (int p=0; p < npipes; ++p)
+        {
+            if (state[p] == PIPE_RUNNING)
+            {
+                qobject_cast<NMIterableComponent*>(
+                            controller->getComponent(execList.at(p).last()))->mBranchMutex = nullptr;
+            }
+        }
+        bufferStore->resumeEviction(controller);
+        throw;
+    }
+    bufferStore->resumeEviction(controller);
+
+    if (queue.bError)
+    {
+        if (queue.error.getExecStackInfo().empty())
+        {
+            std::stringstream stackInfo;
+            stackInfo << this->objectName().toStdString() << " step #" << step+1
+                      << ": " << queue.error.getSource();
+            queue.error.setExecStackInfo(stackInfo.str());
+        }
+        throw queue.error;
+    }
+
+    return !bAbort;
+}
+
+void
+NMIterableComponent::branchComponentUpdate(NMIterableComponent* execComp,
+            const QMap<QString, NMModelComponent*>& repo,
+            BranchTaskQueue* queue, int pipeIdx)
+{
+    try
+    {
+        // the process component releases the lock
+        // while its process is being executed
+        QMutexLocker lock(&queue->linkMutex);
+        execComp->update(repo);
+    }
+    catch (NMMfwException& nmerr)
+    {
+        QMutexLocker lock(&queue->linkMutex);
+        if (!queue->bError)
+        {
+            queue->error = nmerr;
+            queue->bError = true;
+        }
+    }
+    catch (std::exception& e)
+    {
+        QMutexLocker lock(&queue->linkMutex);
+        if (!queue->bError)
+        {
+            queue->error.setType(NMMfwException::NMProcess_ExecutionError);
+            queue->error.setSource(execComp->objectName().toStdString());
+            queue->error.setDescription(e.what());
+            queue->bError = true;
+        }
+    }
+
+    QMutexLocker lock(&queue->doneMutex);
+    queue->finished << pipeIdx;
+    queue->doneCond.wakeAll();
+}
+
 const QStringList
 NMIterableComponent::findExecutableComponents(unsigned int timeLevel,
         int step)
@@ -35,6 +35,8 @@
 #include "NMItkDataObjectWrapper.h"
 #include "nmmodframecore_export.h"
 
+class QMutex;
+
 /*! \brief NMModelComponentIterator
  *
  *  Iterates over the internal components of
@@ -327,6 +329,40 @@ protected:
             const QString& compName);
 
 
+    /*! serialises linking, parameter evaluation and logging
+     *  of concurrently executed pipelines; it is released while
+     *  the process is executed (cf. concurrentPipelineUpdate)
+     */
+    QMutex* mBranchMutex;
+
+    struct BranchTaskQueue;
+
+    /*! indicates whether pipeline may be executed concurrently
+     *  with other pipelines, i.e. whether it consists of
+     *  itk::ProcessObject-based process components (and upstream
+     *  data components) only
+     */
+    bool isConcurrentPipeline(const QStringList& pipeline);
+
+    /*! executes the pipelines of execList on up to maxThreads
+     *  threads; pipelines are started once all preceding pipelines
+     *  they share components with or whose components they reference
+     *  in parameter expressions have finished; pipelines which can't
+     *  be run concurrently are executed sequentially in the calling
+     *  thread; returns false, if model execution has been aborted
+     */
+    bool concurrentPipelineUpdate(const QMap<QString, NMModelComponent*>& repo,
+            const QList<QStringList>& execList, unsigned int step, int maxThreads);
+
+    void branchComponentUpdate(NMIterableComponent* execComp,
+            const QMap<QString, NMModelComponent*>& repo,
+            BranchTaskQueue* queue, int pipeIdx);
+
+    /*! logs comp's provenance as part of one of this
+     *  component's pipelines
+     */
+    void logPipelineProvN(NMModelComponent* comp);
+
     virtual void iterativeComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
             unsigned int minLevel, unsigned int maxLevel)=0;//{};
     virtual void componentUpdateLogic(const QMap<QString, NMModelComponent*>& repo,
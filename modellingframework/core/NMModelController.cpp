@@ -26,6 +26,7 @@
 #include <QtConcurrentRun>
 #include <QFileInfo>
 #include <QString>
+#include <QMutexLocker>
 
 #ifndef NM_ENABLE_LOGGER
 #   define NM_ENABLE_LOGGER
@@ -45,11 +46,14 @@ namespace lupy = lumass_python;
 #include <QRegularExpressionMatchIterator>
 
 #include "NMModelController.h"
+#include "NMModelSerialiser.h"
 #include "NMIterableComponent.h"
 #include "NMSequentialIterComponent.h"
 #include "NMParameterTable.h"
 #include "NMDataComponent.h"
 #include "NMMfwException.h"
+#include "NMProcessResultCache.h"
+#include "NMDataBufferStore.h"
 #include "NMImageReader.h"
 #include "NMTableReader.h"
 
@@ -62,17 +66,34 @@ NMModelController::NMModelController(QObject* parent)
       mRootComponent(0), mbAbortionRequested(false),
       mbLogProv(false),
       mRank(0),
-      mNumProcs(1)
+      mNumProcs(1),
+      mbIsWorker(false)
 {
     this->setParent(parent);
     this->mModelStarted = QDateTime::currentDateTime();
     this->mModelStopped = this->mModelStarted;
     mLogger = new NMLogger(this);
+    mResultCache = QSharedPointer<NMProcessResultCache>(new NMProcessResultCache());
+    mDataBufferStore = QSharedPointer<NMDataBufferStore>(new NMDataBufferStore());
+
+    // parameter expression syntax (cf. processStringParameter)
+    mParamExprRegex.setPattern(QString(
+                    "((?<open>\\$\\[)*"
+                    "(?(<open>)|\\b)"
+                    "(?<comp>[a-zA-Z]+(?>[a-zA-Z0-9]|_(?!_))*)"
+                    "(?<sep1>(?(<open>):|(?>__)))*"
+                    "(?<arith>(?(<sep1>)|([ ]*(?<opr>[+\\-])?[ ]*(?<sum>[\\d]+))))*"
+                    "(?<prop>(?(?<!math:|func:)(?(<sep1>)\\g<comp>)|([a-zA-Z0-9_ \\\\\\/\\(\\)&%\\|\\>\\!\\=\\<\\-\\+\\*\\^\\?:;.,'\"])*))*"
+                    "(?<sep2>(?(<prop>)(?(<open>):)))*"
+                    "(?(<sep2>)((?<numidx>[0-9]+)(?:\\]\\$|\\$\\[)|(?<stridx>[^\\r\\n\\$\\[\\]]*))|([ ]*(?<opr2>[+\\\\-]+)[ ]*(?<sum2>[\\d]+))*))(?>\\]\\$)*"));
+    mParamExprRegex.optimize();
 }
 
 NMModelController::~NMModelController()
 {
-
+    // release the buffers of our data components; the store
+    // may be shared with other controllers
+    mDataBufferStore->removeGroup(this);
 
 }
 
@@ -127,6 +148,7 @@ NMModelController::isModelRunning(void)
 void
 NMModelController::reportExecutionStopped(const QString & compName)
 {
+    QMutexLocker lock(&mExecutionStackMutex);
     for (int i=0; i < this->mExecutionStack.size(); ++i)
     {
         if (compName.compare(this->mExecutionStack.at(i)) == 0)
@@ -140,6 +162,7 @@ NMModelController::reportExecutionStopped(const QString & compName)
 void
 NMModelController::reportExecutionStarted(const QString & compName)
 {
+    QMutexLocker lock(&mExecutionStackMutex);
     this->mExecutionStack.push(compName);
 }
 
@@ -151,8 +174,10 @@ NMModelController::abortModel(void)
     if (this->mbModelIsRunning)
     {
         QString name;
+        mExecutionStackMutex.lock();
         if (this->mExecutionStack.size() > 0)
             name = this->mExecutionStack.pop();
+        mExecutionStackMutex.unlock();
 
         NMIterableComponent* comp =
                 qobject_cast<NMIterableComponent*>(this->getComponent(name));
@@ -177,10 +202,14 @@ NMModelController::resetExecutionStack(void)
 {
     // we take all remaining component names from the stack and
     // signal that they're actually not running any more
-    for (int n=0; n < this->mExecutionStack.size(); ++n)
+    QStack<QString> stack;
+    mExecutionStackMutex.lock();
+    stack.swap(this->mExecutionStack);
+    mExecutionStackMutex.unlock();
+
+    while (!stack.isEmpty())
     {
-        QString name = this->mExecutionStack.pop();
-        emit signalExecutionStopped(name);
+        emit signalExecutionStopped(stack.pop());
     }
 }
 
@@ -262,6 +291,9 @@ NMModelController::clearModelSettings(void)
             emit settingsUpdated(key, QVariant());
         }
     }
+
+    mResultCache->setMaxSize(0);
+    mDataBufferStore->setMaxSize(0);
 }
 
 void
@@ -282,6 +314,20 @@ NMModelController::updateSettings(const QString& key, QVariant value)
         }
     }
 
+    if (key.compare(QStringLiteral("ResultCacheSize"), Qt::CaseInsensitive) == 0)
+    {
+        // budget in MiB; 0 (or no setting) disables the cache
+        const qint64 mib = mSettings.contains(key) ? mSettings[key].toLongLong() : 0;
+        mResultCache->setMaxSize(mib * 1024 * 1024);
+    }
+    else if (key.compare(QStringLiteral("DataBufferMemory"), Qt::CaseInsensitive) == 0)
+    {
+        // RAM budget in MiB for data buffers; 0 (or no setting)
+        // keeps all buffers in RAM
+        const qint64 mib = mSettings.contains(key) ? mSettings[key].toLongLong() : 0;
+        mDataBufferStore->setMaxSize(mib * 1024 * 1024);
+    }
+
     emit settingsUpdated(key, value);
 }
 
@@ -583,6 +629,7 @@ NMModelController::addComponent(NMModelComponent* comp,
 
     this->mComponentMap.insert(tname, comp);
     this->mUserIdMap.insert(comp->getUserID(), tname);
+    this->invalidateParameterCache();
     connect(comp, SIGNAL(ComponentUserIDChanged(QString, QString)),
             this, SLOT(setUserId(QString, QString)));
 
@@ -619,6 +666,7 @@ void NMModelController::setUserId(const QString& oldId, const QString& newId)
     //                  << comp->objectName().toStdString() << "'!");
     //    }
     mUserIdMap.insert(newId, comp->objectName());
+    this->invalidateParameterCache();
 }
 
 QStringList
@@ -703,6 +751,7 @@ bool NMModelController::removeComponent(const QString& name)
     }
 
     this->mPythonComponents.removeOne(name);
+    this->invalidateParameterCache();
 
     delete comp;
 
@@ -835,6 +884,46 @@ MPI_Comm NMModelController::getNextUpstrMPIComm(const QString &compName)
 }
 
 
+NMModelController*
+NMModelController::createWorkerController(void)
+{
+    NMModelController* worker = new NMModelController();
+    worker->setLogger(mLogger);
+    worker->mSettings = mSettings;
+    worker->mResultCache = mResultCache;
+    worker->mDataBufferStore = mDataBufferStore;
+    worker->mbIsWorker = true;
+    worker->mbModelIsRunning = mbModelIsRunning;
+
+    NMSequentialIterComponent* root = new NMSequentialIterComponent();
+    root->setObjectName("root");
+    root->setDescription("Top level model component managed by the ModelController");
+    worker->addComponent(root);
+
+    // we copy the model through its xml representation, which
+    // captures the current iteration step of all components
+    QDomDocument doc;
+    QDomElement modElem = doc.createElement("Model");
+    modElem.setAttribute("description", "the one and only model element");
+    doc.appendChild(modElem);
+
+    NMModelSerialiser xmlS;
+    xmlS.setModelController(this);
+    xmlS.setLogger(mLogger);
+    foreach(NMModelComponent* comp, mComponentMap.values())
+    {
+        xmlS.serialiseComponent(comp, doc);
+    }
+
+    NMModelSerialiser workerS;
+    workerS.setModelController(worker);
+    workerS.setLogger(mLogger);
+    QMap<QString, QString> nameRegister;
+    workerS.parseModelDocument(nameRegister, doc, 0);
+
+    return worker;
+}
+
 void
 NMModelController::registerParallelGroup(const QString &compName,
         MPI_Comm comm)
@@ -1534,9 +1623,100 @@ NMModelController::parseQuotedArguments(const QString& args, const QChar &sep)
     return retList;
 }
 
+NMModelController::ParamExprTerm
+NMModelController::parseParamExprTerm(const QString& expr)
+{
+    QHash<QString, ParamExprTerm>::const_iterator it = mParamExprTerms.constFind(expr);
+    if (it != mParamExprTerms.cend())
+    {
+        return it.value();
+    }
+
+    ParamExprTerm term;
+    term.valid = false;
+    term.sep1 = false;
+    term.sep2 = false;
+
+    QRegularExpressionMatchIterator mit = mParamExprRegex.globalMatch(expr);
+    if (mit.hasNext())
+    {
+        QRegularExpressionMatch match = mit.next();
+        term.valid = true;
+        term.wholeText = match.captured(0);
+
+        term.m << match.capturedRef("comp").toString(); // 0
+        term.m << match.capturedRef("prop").toString(); // 1
+
+        QStringRef numidx = match.capturedRef("numidx");
+        QStringRef stridx = match.capturedRef("stridx");
+
+        if (!numidx.isEmpty())                          // 2
+        {
+            term.m << numidx.toString();
+        }
+        else
+        {
+            term.m << stridx.toString();
+        }
+
+        term.sep1 = match.capturedRef("sep1").toString().isEmpty() ? false : true;
+        term.sep2 = match.capturedRef("sep2").toString().isEmpty() ? false : true;
+
+        // in case we've got arithmetics right after the component name
+        term.m << match.capturedRef("opr").toString();  // 3
+        term.m << match.capturedRef("sum").toString();  // 4
+
+        // in case the arithmetic expression is specified after the property name
+        term.m << match.capturedRef("opr2").toString(); // 5
+        term.m << match.capturedRef("sum2").toString(); // 6
+    }
+
+    // the terms depend on the text only, so we just make sure
+    // the cache doesn't grow indefinitely
+    if (mParamExprTerms.size() >= 50000)
+    {
+        mParamExprTerms.clear();
+    }
+    mParamExprTerms.insert(expr, term);
+
+    return term;
+}
+
+NMModelComponent*
+NMModelController::findParamExprComponent(NMIterableComponent* host,
+                                          const QString& userId)
+{
+    const QString key = QString("%1:%2").arg(host->objectName()).arg(userId);
+    QHash<QString, QPointer<NMModelComponent> >::const_iterator it =
+            mParamExprComps.constFind(key);
+    if (it != mParamExprComps.cend() && !it.value().isNull())
+    {
+        return it.value().data();
+    }
+
+    NMModelComponent* mc = host->findUpstreamComponentByUserId(userId);
+    if (mc != nullptr)
+    {
+        mParamExprComps.insert(key, mc);
+    }
+    return mc;
+}
+
+void
+NMModelController::invalidateParameterCache(void)
+{
+    mParamExprComps.clear();
+}
+
 QString
 NMModelController::processStringParameter(const QObject* obj, const QString& str)
 {
+    // most parameters don't contain any expression at all
+    if (!str.contains(QStringLiteral("$[")))
+    {
+        return str;
+    }
+
     QString nested = str;
 
     // count the number of ParameterExpressions to be evaluated
@@ -1569,64 +1749,15 @@ NMModelController::processStringParameter(const QObject* obj, const QString& str
             tStr = tStr.simplified();
             //tStr.replace(QString(" "), QString(""));
 
-//            QRegularExpression rexexp("((?<open>\\$\\[)*"
-//                                         "(?(<open>)|\\b)"
-//                                         "(?<comp>[a-zA-Z]+(?>[a-zA-Z0-9]|_(?!_))*)"
-//                                         "(?<sep1>(?(<open>):|(?>__)))*"
-//                                         "(?<arith>(?(<sep1>)|([ ]*(?<opr>[+\\-])?[ ]*(?<sum>[\\d]+))))*"
-//                                         "(?<prop>(?(?<!math:|func:)(?(<sep1>)\\g<comp>)|([a-zA-Z0-9_ \\/\\(\\)&%\\|\\>\\!\\=\\<\\-\\+\\*\\^\\?:;.,'\"])*))*"
-//                                         "(?<sep2>(?(<prop>)(?(<open>)):))*"
-//                                         "(?(<sep2>)(?<idx>[0-9]+)*|([ ]*(?<opr2>[+\\-]+)[ ]*(?<sum2>[\\d]+))*))(?>\\]\\$)*");
-
-            QRegularExpression rexexp("((?<open>\\$\\[)*"
-                                            "(?(<open>)|\\b)"
-                                            "(?<comp>[a-zA-Z]+(?>[a-zA-Z0-9]|_(?!_))*)"
-                                            "(?<sep1>(?(<open>):|(?>__)))*"
-                                            "(?<arith>(?(<sep1>)|([ ]*(?<opr>[+\\-])?[ ]*(?<sum>[\\d]+))))*"
-                                            "(?<prop>(?(?<!math:|func:)(?(<sep1>)\\g<comp>)|([a-zA-Z0-9_ \\\\\\/\\(\\)&%\\|\\>\\!\\=\\<\\-\\+\\*\\^\\?:;.,'\"])*))*"
-                                            "(?<sep2>(?(<prop>)(?(<open>):)))*"
-                                            "(?(<sep2>)((?<numidx>[0-9]+)(?:\\]\\$|\\$\\[)|(?<stridx>[^\\r\\n\\$\\[\\]]*))|([ ]*(?<opr2>[+\\\\-]+)[ ]*(?<sum2>[\\d]+))*))(?>\\]\\$)*");
-
-            int pos = 0;
             bool bRecognisedExpression = false;
-            //while((pos = rex.indexIn(tStr, pos)) != -1)
-            QRegularExpressionMatchIterator mit = rexexp.globalMatch(tStr);
-            //while (mit.hasNext())
             // we ever only expect to have one match here!
-            if (mit.hasNext())
+            const ParamExprTerm term = this->parseParamExprTerm(tStr);
+            if (term.valid)
             {
-                QRegularExpressionMatch match = mit.next();
-                QString wholeText = match.captured(0);
-
-                QStringList m;
-                m << match.capturedRef("comp").toString(); // 0
-                m << match.capturedRef("prop").toString(); // 1
-
-                QStringRef numidx = match.capturedRef("numidx");
-                QStringRef stridx = match.capturedRef("stridx");
-
-                if (!numidx.isEmpty())                     // 2
-                {
-                    m << numidx.toString();
-                }
-                else
-                {
-                    m << stridx.toString();
-                }
-
-                //m << match.capturedRef("idx").toString();  // 2
-
-                bool sep1 = match.capturedRef("sep1").toString().isEmpty() ? false : true;
-                bool sep2 = match.capturedRef("sep2").toString().isEmpty() ? false : true;
-
-                // in case we've got arithmetics right after the component name
-                m << match.capturedRef("opr").toString();  // 3
-                m << match.capturedRef("sum").toString();  // 4
-
-                // in case the arithmetic expression is specified after the property name
-                m << match.capturedRef("opr2").toString(); // 5
-                m << match.capturedRef("sum2").toString(); // 6
-
+                const QString& wholeText = term.wholeText;
+                const QStringList& m = term.m;
+                const bool sep1 = term.sep1;
+                const bool sep2 = term.sep2;
 
                 NMDebugAI(<< m.join(" | ").toStdString() << std::endl);
                 //NMDebugAI(<< "---------------" << std::endl);
@@ -1739,7 +1870,7 @@ NMModelController::processStringParameter(const QObject* obj, const QString& str
                     {
                         if (host)
                         {
-                            mc = host->findUpstreamComponentByUserId(m.at(0));
+                            mc = this->findParamExprComponent(host, m.at(0));
                         }
                         else
                         {
@@ -2453,13 +2584,35 @@ QString
 NMModelController::evalMuParserExpression(const QObject *obj, const QString& expr, double* resVal)
 {
     QString tStr;
-    otb::MultiParser::Pointer parser = otb::MultiParser::New();
+
+    // re-use the parser (and thereby its byte code) for
+    // expressions we've evaluated before
+    otb::MultiParser::Pointer parser;
+    QHash<QString, otb::MultiParser::Pointer>::const_iterator pit = mMathParsers.constFind(expr);
+    const bool bCached = pit != mMathParsers.cend();
     try
     {
-        parser->SetExpr(expr.toStdString());
+        if (bCached)
+        {
+            parser = pit.value();
+        }
+        else
+        {
+            parser = otb::MultiParser::New();
+            parser->SetExpr(expr.toStdString());
+        }
         otb::MultiParser::ValueType res = parser->Eval();
         *resVal = static_cast<double>(res);
         tStr = QString("%1").arg(*resVal, 0, 'g', 15);
+
+        if (!bCached)
+        {
+            if (mMathParsers.size() >= 1024)
+            {
+                mMathParsers.clear();
+            }
+            mMathParsers.insert(expr, parser);
+        }
     }
     catch (mu::ParserError& evalerr)
     {
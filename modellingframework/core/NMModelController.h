@@ -27,17 +27,23 @@
 
 #include <string>
 #include <iostream>
+#include <atomic>
 
 #include <QObject>
 #include <QMetaObject>
 #include <QMetaProperty>
 #include <QThread>
 #include <QMap>
+#include <QMutex>
 #include <QStack>
 #include <QString>
 #include <QStringList>
 #include <QDateTime>
 #include <QFile>
+#include <QSharedPointer>
+#include <QHash>
+#include <QPointer>
+#include <QRegularExpression>
 
 #ifndef _WIN32
 #include <mpi.h>
@@ -52,8 +58,15 @@ class NMItkDataObjectWrapper;
 class NMModelComponent;
 class NMIterableComponent;
 class NMProcess;
+class NMProcessResultCache;
+class NMDataBufferStore;
 class NMLogger;
 
+namespace otb
+{
+class MultiParser;
+}
+
 /*! \brief NMModelController is responsible for managing and
  *   running a single LUMASS model.
  *
@@ -291,6 +304,12 @@ public:
                      const NMIterableComponent* host = nullptr);
     QStringList parseQuotedArguments(const QString& args, const QChar& sep= ',');
 
+    /*! Clears the parameter expression caches (cf. processStringParameter);
+     *  needs to be called whenever the model structure or any
+     *  component's UserID changes
+     */
+    void invalidateParameterCache(void);
+
 public slots:
 
 	/*! Requests the execution of the named component. */
@@ -366,6 +385,16 @@ public slots:
     QVariant getSetting(const QString& key) const
         {return mSettings[key];}
 
+    /*! Cache of process component results, enabled by the
+     *  'ResultCacheSize' (MiB) model setting */
+    NMProcessResultCache* getResultCache(void)
+        {return mResultCache.data();}
+
+    /*! Keeps track of the data components' image buffers, limited
+     *  by the 'DataBufferMemory' (MiB) model setting */
+    NMDataBufferStore* getDataBufferStore(void)
+        {return mDataBufferStore.data();}
+
     bool isLogProvOn(){return mbLogProv;}
     void setLogProvOn() {mbLogProv = true;}
     void setLogProvOff() {mbLogProv = false;}
@@ -390,6 +419,15 @@ public slots:
 
     MPI_Comm getNextUpstrMPIComm(const QString& compName);
 
+    /*! Creates a new controller hosting a copy of this controller's
+     *  model, e.g. for running iterations of a component concurrently;
+     *  the copy shares this controller's logger and settings and
+     *  reports the current iteration step of any host component;
+     *  the caller takes ownership of the new controller
+     */
+    NMModelController* createWorkerController(void);
+    bool isWorkerController(void) {return mbIsWorker;}
+
 signals:
 	/*! Signals whether any of the process components controlled
 	 *  by this controller is currently running or not */
@@ -415,16 +453,39 @@ protected:
      */
     QString evalMuParserExpression(const QObject* obj, const QString& expr, double* resVal);
 
+    /*! parsed (inner most, i.e. non-nested) parameter expression */
+    struct ParamExprTerm
+    {
+        bool valid;
+        bool sep1;
+        bool sep2;
+        QString wholeText;
+        /*! comp | prop | idx | opr | sum | opr2 | sum2 */
+        QStringList m;
+    };
+
+    /*! parses the non-nested parameter expression expr once
+     *  and returns the cached result on subsequent calls */
+    ParamExprTerm parseParamExprTerm(const QString& expr);
+
+    /*! looks up the component identified by userId upstream
+     *  of host (cf. NMIterableComponent::findUpstreamComponentByUserId)
+     *  and caches the result until the model is edited */
+    NMModelComponent* findParamExprComponent(NMIterableComponent* host,
+                                             const QString& userId);
+
     /*! maps ComponentName to model component object */
 	QMap<QString, NMModelComponent*> mComponentMap;
     /*! maps userId to ComponentName */
     QMultiMap<QString, QString> mUserIdMap;
 
 	QStack<QString> mExecutionStack;
+	/*! worker controllers are aborted from the main thread */
+	QMutex mExecutionStackMutex;
 	NMIterableComponent* mRootComponent;
 
 	bool mbModelIsRunning;
-	bool mbAbortionRequested;
+	std::atomic<bool> mbAbortionRequested;
 
 	QDateTime mModelStarted;
 	QDateTime mModelStopped;
@@ -433,6 +494,14 @@ protected:
     QStringList mPythonComponents;
 
     QMap<QString, QVariant> mSettings;
+    QSharedPointer<NMProcessResultCache> mResultCache;
+    QSharedPointer<NMDataBufferStore> mDataBufferStore;
+
+    // parameter expression caches
+    QRegularExpression mParamExprRegex;
+    QHash<QString, ParamExprTerm> mParamExprTerms;
+    QHash<QString, QPointer<NMModelComponent> > mParamExprComps;
+    QHash<QString, itk::SmartPointer<otb::MultiParser> > mMathParsers;
 
     bool mbLogProv;
     QFile mProvFile;
@@ -442,6 +511,7 @@ protected:
     // parallel processing
     int mRank;
     int mNumProcs;
+    bool mbIsWorker;
     //int mUsedProcs;
 
     // maps communicator for pipeline/AggrComp for each rank
@@ -34,12 +34,28 @@
 #include "NMModelController.h"
 #include "NMMfwException.h"
 
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
 const std::string NMParallelIterComponent::ctx = "NMParallelIterComponent";
 
 NMParallelIterComponent::NMParallelIterComponent(QObject* parent)
 {
     this->setParent(parent);
     NMIterableComponent::initAttributes();
+
+    mSchedulingType = QStringLiteral("STATIC");
+    mSchedulingEnum << QStringLiteral("STATIC")
+                    << QStringLiteral("DYNAMIC")
+                    << QStringLiteral("STEALING");
+    mMaxThreads = 0;
 }
 
 NMParallelIterComponent::~NMParallelIterComponent()
@@ -66,7 +82,10 @@ NMParallelIterComponent::iterativeComponentUpdate(const QMap<QString, NMModelCom
     }
 
     // let's catch-up with all the other ranks assigned to this task
-    MPI_Barrier(comm);
+    if (comm != MPI_COMM_NULL)
+    {
+        MPI_Barrier(comm);
+    }
 
     // de-register comm
     mController->deregisterParallelGroup(this->objectName());
@@ -80,6 +99,40 @@ NMParallelIterComponent::iterativeComponentUpdate(const QMap<QString, NMModelCom
     }
 
     int ntasks = numIterations - (mIterationStep - 1);
+
+    // with more iterations than ranks, we can hand out iterations
+    // on demand; otherwise every rank (group) gets one iteration anyway
+    if (    mSchedulingType.compare(QStringLiteral("STATIC")) != 0
+         && comm != MPI_COMM_NULL
+         && procs > 1
+         && ntasks > procs
+       )
+    {
+        this->dynamicComponentUpdate(repo, minLevel, maxLevel, comm,
+                                     mIterationStep - 1, numIterations);
+        mController->registerParallelGroup(this->objectName(), comm);
+        return;
+    }
+
+    // without other ranks to share the work, we run iterations
+    // on multiple threads; note: models copied for threads don't
+    // spawn any further threads
+    if (    mMaxThreads > 1
+         && procs == 1
+         && ntasks > 1
+         && !mController->isWorkerController()
+         && this->isThreadedUpdateSafe()
+       )
+    {
+        this->threadedComponentUpdate(repo, minLevel, maxLevel,
+                                      mIterationStep - 1, numIterations);
+        if (comm != MPI_COMM_NULL)
+        {
+            mController->registerParallelGroup(this->objectName(), comm);
+        }
+        return;
+    }
+
     int nsplits = std::min(ntasks, procs);
     QMap<int, QPair<int, QVector<int>>> mapTaskSplitRanks;
 
@@ -172,6 +225,8 @@ NMParallelIterComponent::iterativeComponentUpdate(const QMap<QString, NMModelCom
     //    BARRIER - IterComm
 
     QVector<int> busyRanks;
+    QVector<int> taskIds;
+    QVector<double> taskTimes;
     unsigned int niter = numIterations;
     mIterationStepRun = mIterationStep;
     for (unsigned int i = mIterationStepRun-1; i < niter && !mController->isModelAbortionRequested(); ++i)
@@ -190,7 +245,11 @@ NMParallelIterComponent::iterativeComponentUpdate(const QMap<QString, NMModelCom
 
                 busyRanks.push_back(rank);
                 emit signalProgress(mIterationStepRun);
+                const auto tstart = std::chrono::steady_clock::now();
                 this->componentUpdateLogic(repo, minLevel, maxLevel, i);
+                taskIds.push_back(i);
+                taskTimes.push_back(std::chrono::duration<double>(
+                                        std::chrono::steady_clock::now() - tstart).count());
             }
         }
 
@@ -225,9 +284,431 @@ NMParallelIterComponent::iterativeComponentUpdate(const QMap<QString, NMModelCom
         MPI_Comm_free(&iterComm);
     }
 
+    this->gatherTaskTimings(comm, taskIds, taskTimes);
+
     if (comm != MPI_COMM_NULL)
     {
         mController->registerParallelGroup(this->objectName(), comm);
     }
 }
 
+void
+NMParallelIterComponent::dynamicComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
+            unsigned int minLevel, unsigned int maxLevel,
+            MPI_Comm comm, int firstTask, int endTask)
+{
+    int worldRank = 0;
+    int rank = 0;
+    int procs = 1;
+    MPI_Comm_size(comm, &procs);
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_rank(MPI_COMM_WORLD, &worldRank);
+
+    const bool bStealing = mSchedulingType.compare(QStringLiteral("STEALING")) == 0;
+
+    // each rank hosts nested parallel components on its own
+    MPI_Comm iterComm = MPI_COMM_NULL;
+    MPI_Comm_split(comm, rank, rank, &iterComm);
+    mController->registerParallelGroup(this->objectName(), iterComm);
+
+    // the task queue lives in a window on rank 0: DYNAMIC uses a single
+    // counter for all tasks; STEALING uses one counter per rank, indexing
+    // into the rank's block of tasks, which other ranks may also advance
+    // once they've finished their own block
+    const int ncounters = bStealing ? procs : 1;
+    const long long ntasks = endTask - firstTask;
+    auto blockStart = [&](int c) -> long long
+    {
+        return firstTask + ntasks * c / ncounters;
+    };
+
+    long long* counters = nullptr;
+    MPI_Win win;
+    const MPI_Aint winSize = rank == 0 ? ncounters * sizeof(long long) : 0;
+    MPI_Win_allocate(winSize, sizeof(long long), MPI_INFO_NULL, comm, &counters, &win);
+    if (rank == 0)
+    {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+        for (int c=0; c < ncounters; ++c)
+        {
+            counters[c] = blockStart(c);
+        }
+        MPI_Win_unlock(0, win);
+    }
+    MPI_Barrier(comm);
+
+    wulog(-1, "<<" << this->objectName().toStdString() << ">> lr" << rank
+          << ": " << mSchedulingType.toStdString() << " scheduling of tasks "
+          << firstTask << " to " << endTask-1)
+
+    QVector<int> taskIds;
+    QVector<double> taskTimes;
+
+    int victim = bStealing ? rank : 0;
+    int nvisited = 1;
+    while (!mController->isModelAbortionRequested())
+    {
+        const long long one = 1;
+        long long task = 0;
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+        MPI_Fetch_and_op(&one, &task, MPI_LONG_LONG, 0, victim, MPI_SUM, win);
+        MPI_Win_unlock(0, win);
+
+        // this block is done, so we move on to the next one (STEALING)
+        // or we're done altogether (DYNAMIC)
+        if (task >= blockStart(victim + 1))
+        {
+            if (!bStealing || nvisited >= procs)
+            {
+                break;
+            }
+            victim = victim < procs-1 ? victim+1 : 0;
+            ++nvisited;
+            continue;
+        }
+
+        wulog(-1, " lr" << rank << ": " << this->objectName().toStdString()
+              << " step #" << task << (victim != rank && bStealing ? " (stolen)" : ""))
+
+        mIterationStepRun = task + 1;
+        emit signalProgress(mIterationStepRun);
+        const auto tstart = std::chrono::steady_clock::now();
+        this->componentUpdateLogic(repo, minLevel, maxLevel, task);
+        taskIds.push_back(task);
+        taskTimes.push_back(std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - tstart).count());
+    }
+    mIterationStepRun = mIterationStep;
+    emit signalProgress(mIterationStep);
+
+    MPI_Win_free(&win);
+
+    mController->deregisterParallelGroup(this->objectName());
+    MPI_Comm_free(&iterComm);
+
+    this->gatherTaskTimings(comm, taskIds, taskTimes);
+}
+
+/*! task queue shared by the worker threads of threadedComponentUpdate */
+struct NMParallelIterComponent::ThreadTaskQueue
+{
+    std::atomic<int> next;
+    int end;
+    std::atomic<int> numDone;
+    std::atomic<bool> bAbort;
+
+    QMutex mutex;
+    QString errorMsg;
+    int lastWorker;
+    QVector<QVector<int> > tasks;
+    QVector<QVector<double> > times;
+};
+
+void
+NMParallelIterComponent::threadedComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
+            unsigned int minLevel, unsigned int maxLevel,
+            int firstTask, int endTask)
+{
+    const int nthreads = std::min(mMaxThreads, endTask - firstTask);
+
+    // each thread gets its own copy of the model; we create them here,
+    // since the component and process factories aren't thread-safe
+    QVector<NMModelController*> workers;
+    for (int w=0; w < nthreads; ++w)
+    {
+        workers.push_back(mController->createWorkerController());
+        this->shareUpstreamData(workers.last());
+    }
+
+    ThreadTaskQueue queue;
+    queue.next = firstTask;
+    queue.end = endTask;
+    queue.numDone = 0;
+    queue.bAbort = false;
+    queue.lastWorker = -1;
+    queue.tasks.resize(nthreads);
+    queue.times.resize(nthreads);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(nthreads);
+    for (int w=0; w < nthreads; ++w)
+    {
+        QtConcurrent::run(&pool, this, &NMParallelIterComponent::workerComponentUpdate,
+                          workers[w], &queue, w, minLevel, maxLevel);
+    }
+
+    // report progress and pass on any request to abort the model
+    while (!pool.waitForDone(250))
+    {
+        if (mController->isModelAbortionRequested() && !queue.bAbort)
+        {
+            queue.bAbort = true;
+            foreach(NMModelController* worker, workers)
+            {
+                worker->abortModel();
+            }
+        }
+        emit signalProgress(firstTask + queue.numDone);
+    }
+    emit signalProgress(mIterationStep);
+
+    this->logTaskTimings(queue.tasks, queue.times, "thread");
+
+    // like after a sequential run, this component's data
+    // components hold the output of the last iteration
+    if (queue.lastWorker >= 0 && queue.errorMsg.isEmpty())
+    {
+        NMModelController* last = workers[queue.lastWorker];
+        QVector<NMIterableComponent*> hosts;
+        hosts.push_back(this);
+        while (!hosts.isEmpty())
+        {
+            NMIterableComponent* host = hosts.takeLast();
+            NMModelComponentIterator cit = host->getComponentIterator();
+            while (*cit != nullptr)
+            {
+                NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(*cit);
+                NMDataComponent* dc = qobject_cast<NMDataComponent*>(*cit);
+                if (ic != nullptr && ic->getProcess() == nullptr)
+                {
+                    hosts.push_back(ic);
+                }
+                else if (dc != nullptr)
+                {
+                    NMDataComponent* wdc = qobject_cast<NMDataComponent*>(
+                                last->getComponent(dc->objectName()));
+                    if (wdc != nullptr && !wdc->getOutput(0).isNull())
+                    {
+                        dc->setNthInput(0, wdc->getOutput(0));
+                    }
+                }
+                ++cit;
+            }
+        }
+    }
+
+    foreach(NMModelController* worker, workers)
+    {
+        delete worker;
+    }
+
+    if (!queue.errorMsg.isEmpty())
+    {
+        NMMfwException e(NMMfwException::NMProcess_ExecutionError);
+        e.setSource(this->objectName().toStdString());
+        e.setDescription(queue.errorMsg.toStdString());
+        throw e;
+    }
+}
+
+void
+NMParallelIterComponent::shareUpstreamData(NMModelController* worker)
+{
+    QMapIterator<QString, NMModelComponent*> it(mController->getRepository());
+    while (it.hasNext())
+    {
+        it.next();
+        NMDataComponent* dc = qobject_cast<NMDataComponent*>(it.value());
+        if (dc == nullptr || dc->getOutput(0).isNull())
+        {
+            continue;
+        }
+
+        // data components within this subtree are updated
+        // by each iteration of the workers themselves
+        NMModelComponent* host = dc->getHostComponent();
+        while (host != nullptr && host != this)
+        {
+            host = host->getHostComponent();
+        }
+        if (host == this)
+        {
+            continue;
+        }
+
+        NMDataComponent* wdc = qobject_cast<NMDataComponent*>(
+                    worker->getComponent(dc->objectName()));
+        if (wdc != nullptr && wdc->shareData(dc))
+        {
+            NMDebugAI(<< this->objectName().toStdString() << ": worker shares '"
+                      << dc->objectName().toStdString() << "'" << std::endl);
+        }
+    }
+}
+
+bool
+NMParallelIterComponent::isThreadedUpdateSafe(void)
+{
+    QVector<NMIterableComponent*> hosts;
+    hosts.push_back(this);
+    while (!hosts.isEmpty())
+    {
+        NMIterableComponent* host = hosts.takeLast();
+        NMModelComponentIterator cit = host->getComponentIterator();
+        while (*cit != nullptr)
+        {
+            NMIterableComponent* ic = qobject_cast<NMIterableComponent*>(*cit);
+            if (ic != nullptr && ic->getProcess() == nullptr)
+            {
+                hosts.push_back(ic);
+            }
+            else if (    ic != nullptr
+                      && !ic->getProcess()->isConcurrentUpdateSafe()
+                    )
+            {
+                NMLogInfo(<< this->objectName().toStdString()
+                          << ": '" << ic->objectName().toStdString()
+                          << "' can't be updated concurrently, so we're "
+                          << "running the iterations one after another!");
+                return false;
+            }
+            ++cit;
+        }
+    }
+
+    return true;
+}
+
+void
+NMParallelIterComponent::workerComponentUpdate(NMModelController* worker,
+            ThreadTaskQueue* queue, int workerId,
+            unsigned int minLevel, unsigned int maxLevel)
+{
+    NMParallelIterComponent* comp = qobject_cast<NMParallelIterComponent*>(
+                worker->getComponent(this->objectName()));
+    if (comp == nullptr)
+    {
+        QMutexLocker lock(&queue->mutex);
+        queue->errorMsg = QString("Failed copying '%1' for a worker thread!")
+                                .arg(this->objectName());
+        queue->bAbort = true;
+        return;
+    }
+    const QMap<QString, NMModelComponent*>& repo = worker->getRepository();
+
+    while (!queue->bAbort)
+    {
+        const int task = queue->next++;
+        if (task >= queue->end)
+        {
+            break;
+        }
+
+        const auto tstart = std::chrono::steady_clock::now();
+        try
+        {
+            comp->setIterationStep(task + 1);
+            comp->componentUpdateLogic(repo, minLevel, maxLevel, task);
+        }
+        catch (std::exception& e)
+        {
+            QMutexLocker lock(&queue->mutex);
+            if (queue->errorMsg.isEmpty())
+            {
+                queue->errorMsg = QString("Iteration #%1 failed: %2")
+                                    .arg(task + 1).arg(e.what());
+            }
+            queue->bAbort = true;
+            break;
+        }
+
+        QMutexLocker lock(&queue->mutex);
+        queue->tasks[workerId].push_back(task);
+        queue->times[workerId].push_back(std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - tstart).count());
+        if (task == queue->end - 1)
+        {
+            queue->lastWorker = workerId;
+        }
+        ++queue->numDone;
+    }
+}
+
+void
+NMParallelIterComponent::gatherTaskTimings(MPI_Comm comm, const QVector<int>& tasks,
+        const QVector<double>& times)
+{
+    int rank = 0;
+    int procs = 1;
+    if (comm != MPI_COMM_NULL)
+    {
+        MPI_Comm_size(comm, &procs);
+        MPI_Comm_rank(comm, &rank);
+    }
+
+    if (procs == 1)
+    {
+        this->logTaskTimings(QVector<QVector<int> >() << tasks,
+                             QVector<QVector<double> >() << times, "rank");
+        return;
+    }
+
+    // gather (task, time) pairs on rank 0
+    int ntasks = tasks.size();
+    std::vector<int> counts(procs, 0);
+    std::vector<int> displs(procs, 0);
+    MPI_Gather(&ntasks, 1, MPI_INT, &counts[0], 1, MPI_INT, 0, comm);
+
+    int total = 0;
+    for (int r=0; r < procs; ++r)
+    {
+        displs[r] = total;
+        total += counts[r];
+    }
+    std::vector<int> allTasks(rank == 0 ? std::max(total, 1) : 1);
+    std::vector<double> allTimes(rank == 0 ? std::max(total, 1) : 1);
+
+    MPI_Gatherv(tasks.constData(), ntasks, MPI_INT,
+                &allTasks[0], &counts[0], &displs[0], MPI_INT, 0, comm);
+    MPI_Gatherv(times.constData(), ntasks, MPI_DOUBLE,
+                &allTimes[0], &counts[0], &displs[0], MPI_DOUBLE, 0, comm);
+
+    if (rank != 0)
+    {
+        return;
+    }
+
+    QVector<QVector<int> > rankTasks(procs);
+    QVector<QVector<double> > rankTimes(procs);
+    for (int r=0; r < procs; ++r)
+    {
+        for (int t=displs[r]; t < displs[r] + counts[r]; ++t)
+        {
+            rankTasks[r].push_back(allTasks[t]);
+            rankTimes[r].push_back(allTimes[t]);
+        }
+    }
+    this->logTaskTimings(rankTasks, rankTimes, "rank");
+}
+
+void
+NMParallelIterComponent::logTaskTimings(const QVector<QVector<int> >& tasks,
+        const QVector<QVector<double> >& times, const std::string& unit)
+{
+    const int nworkers = tasks.size();
+    double sum = 0;
+    double maxBusy = 0;
+    for (int w=0; w < nworkers; ++w)
+    {
+        double busy = 0;
+        for (int t=0; t < tasks[w].size(); ++t)
+        {
+            NMLogDebug(<< this->objectName().toStdString() << ": task #"
+                       << tasks[w][t] << " on " << unit << " " << w << " took "
+                       << times[w][t] << " s");
+            busy += times[w][t];
+        }
+        NMLogDebug(<< this->objectName().toStdString() << ": " << unit << " " << w
+                   << " ran " << tasks[w].size() << " tasks in " << busy << " s");
+        sum += busy;
+        maxBusy = std::max(maxBusy, busy);
+    }
+
+    // imbalance: the longest busy time relative to the mean
+    const double mean = nworkers > 0 ? sum / nworkers : 0;
+    const std::string mode = unit.compare("thread") == 0
+            ? std::string("THREADS") : mSchedulingType.toStdString();
+    NMLogInfo(<< this->objectName().toStdString() << " (" << mode << "): "
+              << "max. " << unit << " busy time " << maxBusy << " s, mean "
+              << mean << " s, imbalance " << (mean > 0 ? maxBusy / mean : 1.0));
+}
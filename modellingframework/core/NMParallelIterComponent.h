@@ -31,6 +31,9 @@
 #include "NMIterableComponent.h"
 
 #include <QMap>
+#include <QVector>
+
+#include <mpi.h>
 
 #include "nmmodframecore_export.h"
 
@@ -38,6 +41,28 @@ class NMMODFRAMECORE_EXPORT NMParallelIterComponent: public NMIterableComponent
 {
 	Q_OBJECT
 
+    /*! How iterations are allocated to ranks
+     *
+     *  STATIC   - fixed round-robin allocation of iterations to ranks
+     *  DYNAMIC  - idle ranks fetch the next iteration from a task counter
+     *             hosted by rank 0
+     *  STEALING - each rank works through its own contiguous block of
+     *             iterations and, once done, takes iterations from
+     *             other ranks' blocks
+     */
+    Q_PROPERTY(QString SchedulingType READ getSchedulingType WRITE setSchedulingType)
+    Q_PROPERTY(QStringList SchedulingEnum READ getSchedulingEnum)
+
+    /*! Maximum number of threads running iterations concurrently
+     *  within this process, using a copy of the model per thread;
+     *  0 (default) uses MPI ranks instead
+     */
+    Q_PROPERTY(int MaxThreads READ getMaxThreads WRITE setMaxThreads)
+
+public:
+    NMPropertyGetSet(SchedulingType, QString)
+    NMPropertyGetSet(SchedulingEnum, QStringList)
+    NMPropertyGetSet(MaxThreads, int)
 
 public:
 	signals:
@@ -54,6 +79,48 @@ protected:
     void iterativeComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
     		unsigned int minLevel, unsigned int maxLevel);
 
+    /*! on-demand allocation of iterations [firstTask, endTask)
+     *  to the ranks of comm (DYNAMIC and STEALING scheduling)
+     */
+    void dynamicComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
+            unsigned int minLevel, unsigned int maxLevel,
+            MPI_Comm comm, int firstTask, int endTask);
+
+    /*! runs iterations [firstTask, endTask) concurrently on up to
+     *  MaxThreads threads, each working on its own copy of the model
+     */
+    void threadedComponentUpdate(const QMap<QString, NMModelComponent*>& repo,
+            unsigned int minLevel, unsigned int maxLevel,
+            int firstTask, int endTask);
+
+    /*! checks whether all processes of this component's
+     *  subtree may be updated concurrently by model copies
+     */
+    bool isThreadedUpdateSafe(void);
+
+    /*! hands the data held by data components outside this
+     *  component's subtree to their copies in worker, so the
+     *  workers don't run the upstream pipeline again
+     */
+    void shareUpstreamData(NMModelController* worker);
+
+    struct ThreadTaskQueue;
+    void workerComponentUpdate(NMModelController* worker, ThreadTaskQueue* queue,
+            int workerId, unsigned int minLevel, unsigned int maxLevel);
+
+    /*! gathers the run time of each task on rank 0 of comm
+     *  and logs them together with the load of each rank
+     */
+    void gatherTaskTimings(MPI_Comm comm, const QVector<int>& tasks,
+            const QVector<double>& times);
+
+    void logTaskTimings(const QVector<QVector<int> >& tasks,
+            const QVector<QVector<double> >& times, const std::string& unit);
+
+    QString mSchedulingType;
+    QStringList mSchedulingEnum;
+    int mMaxThreads;
+
 private:
 	static const std::string ctx;
 
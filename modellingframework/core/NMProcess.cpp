@@ -26,6 +26,10 @@
 #include "otbImageIOBase.h"
 
 #include <QDateTime>
+#include <QFileInfo>
+#include <QMetaProperty>
+#include <QCryptographicHash>
+#include <QRegularExpression>
 
 #include "nmtypeinfo.h"
 #include "NMProcess.h"
@@ -39,7 +43,9 @@
 #include <algorithm>
 
 NMProcess::NMProcess(QObject *parent)
-    : mbAbortExecution(false), mbLinked(false)
+    : mbAbortExecution(false), mbLinked(false),
+      mbCacheResult(true), mbResultCacheHit(false),
+      mbUpdateSucceeded(false), mbConcurrentUpdate(true)
 {
     this->mInputComponentType = otb::ImageIOBase::UNKNOWNCOMPONENTTYPE;
     this->mOutputComponentType = otb::ImageIOBase::UNKNOWNCOMPONENTTYPE;
@@ -135,10 +141,23 @@ NMProcess::linkInPipeline(unsigned int step,
 
     // clear provenance info before this run
     mRuntimeParaProv.clear();
+    mInputResultKeys.clear();
+    mbUpdateSucceeded = false;
 
     this->linkParameters(step, repo);
     this->linkInputs(step, repo);
 
+    // check whether we've produced the same result before
+    this->computeResultKey();
+    mCachedOutputs.clear();
+    mbResultCacheHit = !mResultKey.isEmpty()
+            && this->getModelController()->getResultCache()->lookup(mResultKey, mCachedOutputs);
+    if (mbResultCacheHit)
+    {
+        NMLogInfo(<< this->parent()->objectName().toStdString()
+                  << ": inputs and parameters unchanged - re-using cached result");
+    }
+
 #ifdef LUMASS_DEBUG
     if (this->mOtbProcess.IsNotNull())
     {
@@ -549,6 +568,7 @@ void NMProcess::linkInputs(unsigned int step, const QMap<QString, NMModelCompone
                         QString inputImgProv = QString("nm:InputImage-%1=\"nm:%2\"")
                                                     .arg(effTargetIdx).arg(ic->objectName());
                         mRuntimeParaProv << inputImgProv;
+                        mInputResultKeys << this->getInputResultKey(ic, iw, inputSrc);
                     }
                     else
                     {
@@ -565,6 +585,10 @@ void NMProcess::linkInputs(unsigned int step, const QMap<QString, NMModelCompone
                         QString inputTabProv = QString("nm:InputTable-%1=\"nm:%2\"")
                                                     .arg(effTargetIdx).arg(ic->objectName());
                         mRuntimeParaProv << inputTabProv;
+                        if (iw->getDataObject() == 0)
+                        {
+                            mInputResultKeys << this->getInputResultKey(ic, iw, inputSrc);
+                        }
                     }
                     else
                     {
@@ -638,6 +662,230 @@ void NMProcess::linkInputs(unsigned int step, const QMap<QString, NMModelCompone
     NMDebugCtx(this->parent()->objectName().toStdString(), << "done!");
 }
 
+QByteArray
+NMProcess::getInputResultKey(NMModelComponent* ic,
+                             QSharedPointer<NMItkDataObjectWrapper> iw,
+                             const QString& inputSrc)
+{
+    QByteArray key;
+
+    // we can't tell what a streamed input is going to deliver
+    if (iw->getIsStreaming())
+    {
+        return key;
+    }
+
+    // an upstream process is identified by its own result key ...
+    NMIterableComponent* itc = qobject_cast<NMIterableComponent*>(ic);
+    if (    itc != nullptr
+         && itc->getProcess() != nullptr
+         && !itc->getProcess()->getResultKey().isEmpty()
+       )
+    {
+        key = itc->getProcess()->getResultKey();
+        key.append(inputSrc.toUtf8());
+        return key;
+    }
+
+    // ... any other input by the identity and modification
+    // time of its data objects
+    itk::DataObject* obj = iw->getDataObject();
+    if (obj != nullptr)
+    {
+        key.append(QByteArray::number(reinterpret_cast<qulonglong>(obj)));
+        key.append(':');
+        key.append(QByteArray::number(static_cast<qulonglong>(obj->GetMTime())));
+    }
+
+    otb::AttributeTable::Pointer tab = iw->getOTBTab();
+    if (tab.IsNotNull())
+    {
+        key.append(';');
+        key.append(QByteArray::number(reinterpret_cast<qulonglong>(tab.GetPointer())));
+        key.append(':');
+        key.append(QByteArray::number(static_cast<qulonglong>(tab->GetMTime())));
+    }
+
+    return key;
+}
+
+void
+NMProcess::computeResultKey(void)
+{
+    mResultKey.clear();
+
+    NMModelController* ctrl = this->getModelController();
+    if (    !mbCacheResult
+         || mIsSink
+         || mOtbProcess.IsNull()
+         || ctrl == nullptr
+         || !ctrl->getResultCache()->isEnabled()
+       )
+    {
+        return;
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(this->metaObject()->className()));
+    hash.addData(this->parent()->objectName().toUtf8());
+
+    // the random number functions provided by otb::MultiParser
+    static const QRegularExpression rxRandom(
+                QStringLiteral("\\b(rand|unifdist_int|unifdist_real|lndist|normdist)\\s*\\("));
+
+    // the property values (i.e. parameter lists and expressions) ...
+    bool bStepDependent = false;
+    const QMetaObject* meta = this->metaObject();
+    for (int p=0; p < meta->propertyCount(); ++p)
+    {
+        const QMetaProperty prop = meta->property(p);
+        const QVariant val = prop.read(this);
+
+        QString strVal;
+        if (val.userType() == qMetaTypeId<QList<QList<QStringList> > >())
+        {
+            const QList<QList<QStringList> > lll = val.value<QList<QList<QStringList> > >();
+            bStepDependent = bStepDependent || lll.size() > 1;
+            foreach(const QList<QStringList>& ll, lll)
+            {
+                foreach(const QStringList& l, ll)
+                {
+                    strVal.append(l.join(QChar('\x1f')));
+                    strVal.append(QChar('\x1e'));
+                }
+            }
+        }
+        else if (val.userType() == qMetaTypeId<QList<QStringList> >())
+        {
+            const QList<QStringList> ll = val.value<QList<QStringList> >();
+            bStepDependent = bStepDependent || ll.size() > 1;
+            foreach(const QStringList& l, ll)
+            {
+                strVal.append(l.join(QChar('\x1f')));
+                strVal.append(QChar('\x1e'));
+            }
+        }
+        else if (val.userType() == QMetaType::QStringList)
+        {
+            const QStringList l = val.toStringList();
+            bStepDependent = bStepDependent || l.size() > 1;
+            strVal = l.join(QChar('\x1f'));
+        }
+        else
+        {
+            strVal = val.toString();
+        }
+
+        // expressions drawing random numbers give a different
+        // result on every run, so there's nothing to re-use
+        if (strVal.contains(rxRandom))
+        {
+            return;
+        }
+
+        hash.addData(QByteArray(prop.name()));
+        hash.addData(strVal.toUtf8());
+    }
+
+    // parameter lists are processed according to the iteration step
+    if (bStepDependent)
+    {
+        hash.addData(QByteArray::number(mStepIndex));
+    }
+
+    // ... their evaluated values for this run, and the
+    // modification time of any files they refer to
+    static const QRegularExpression rxQuoted(QStringLiteral("\"([^\"]*)\""));
+    foreach(const QString& prov, mRuntimeParaProv)
+    {
+        if (prov.contains(rxRandom))
+        {
+            return;
+        }
+        hash.addData(prov.toUtf8());
+
+        QRegularExpressionMatchIterator mit = rxQuoted.globalMatch(prov);
+        while (mit.hasNext())
+        {
+            const QString val = mit.next().captured(1);
+            if (val.isEmpty() || val.startsWith(QStringLiteral("nm:")))
+            {
+                continue;
+            }
+
+            const QFileInfo fi(val);
+            if (fi.isFile())
+            {
+                hash.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+                hash.addData(QByteArray::number(fi.size()));
+            }
+        }
+    }
+
+    // the identity of the inputs
+    foreach(const QByteArray& ik, mInputResultKeys)
+    {
+        if (ik.isEmpty())
+        {
+            return;
+        }
+        hash.addData(ik);
+    }
+
+    mResultKey = hash.result();
+}
+
+void
+NMProcess::cacheResult(void)
+{
+    NMModelController* ctrl = this->getModelController();
+    if (    mResultKey.isEmpty()
+         || mbResultCacheHit
+         || !mbUpdateSucceeded
+         || mOtbProcess.IsNull()
+         || ctrl == nullptr
+         || ctrl->isModelAbortionRequested()
+       )
+    {
+        return;
+    }
+
+    NMProcessResultCache::OutputMap outputs;
+    const unsigned int numOutputs = mOtbProcess->GetNumberOfIndexedOutputs();
+    for (unsigned int i=0; i < numOutputs; ++i)
+    {
+        if (mOtbProcess->GetOutput(i) == nullptr)
+        {
+            continue;
+        }
+
+        QSharedPointer<NMItkDataObjectWrapper> dw = this->getOutput(i);
+        if (!dw.isNull() && dw->getDataObject() != nullptr)
+        {
+            outputs.insert(i, dw);
+        }
+    }
+
+    if (NMProcessResultCache::estimateSize(outputs) < 0)
+    {
+        return;
+    }
+
+    // detach the outputs from this process object, so
+    // they don't get re-generated by downstream requests
+    NMProcessResultCache::OutputMap::iterator oit = outputs.begin();
+    for (; oit != outputs.end(); ++oit)
+    {
+        oit.value()->getDataObject()->DisconnectPipeline();
+    }
+
+    if (ctrl->getResultCache()->insert(mResultKey, outputs))
+    {
+        NMDebugAI(<< this->parent()->objectName().toStdString()
+                  << ": result cached" << std::endl);
+    }
+}
+
 /**
  * Get the value of mInputComponentType
  * \return the value of mInputComponentType
@@ -651,6 +899,13 @@ NMProcess::getInputComponentType(void)
 void NMProcess::reset(void)
 {
     //NMDebugCtx(this->parent()->objectName().toStdString(), << "...");
+    this->cacheResult();
+    this->mResultKey.clear();
+    this->mInputResultKeys.clear();
+    this->mCachedOutputs.clear();
+    this->mbResultCacheHit = false;
+    this->mbUpdateSucceeded = false;
+
     this->mParamPos = 0;
     this->mbIsInitialised = false;
     this->mbLinked = false;
@@ -665,6 +920,15 @@ void NMProcess::update(void)
 {
     NMDebugCtx(this->parent()->objectName().toStdString(), << "...");
 
+    if (this->mbResultCacheHit)
+    {
+        NMDebugAI(<< "result taken from cache - no need to execute!" << std::endl);
+        this->mMTime = QDateTime::currentDateTime();
+        this->mbLinked = false;
+        NMDebugCtx(this->parent()->objectName().toStdString(), << "done!");
+        return;
+    }
+
     if (this->mbIsInitialised && this->mOtbProcess.IsNotNull())
     {
         try
@@ -678,6 +942,7 @@ void NMProcess::update(void)
             throw;
         }
 
+        this->mbUpdateSucceeded = true;
         this->mMTime = QDateTime::currentDateTime();
         QString tstring = mMTime.toString("dd.MM.yyyy hh:mm:ss.zzz");
         NMDebugAI(<< "modified at: " << tstring.toStdString() << std::endl);
@@ -744,10 +1009,14 @@ NMProcess::UpdateProgressInfo(itk::Object* obj,
     }
     else if (typeid(event) == typeid(itk::StartEvent))
     {
+        this->mbUpdateSucceeded = false;
         emit signalExecutionStarted(objName);
     }
     else if (typeid(event) == typeid(itk::EndEvent))
     {
+        // itk::ProcessObject only fires the EndEvent once
+        // GenerateData() has returned without error
+        this->mbUpdateSucceeded = !this->mbAbortExecution;
         emit signalExecutionStopped(objName);
         emit signalProgress(0);
         this->mOtbProcess->SetAbortGenerateData(false);
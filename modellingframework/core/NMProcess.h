@@ -50,6 +50,7 @@
 #include "NMModelObject.h"
 #include "NMModelComponent.h"
 #include "NMItkDataObjectWrapper.h"
+#include "NMProcessResultCache.h"
 #include "itkProcessObject.h"
 #include "itkDataObject.h"
 #include "otbImageIOBase.h"
@@ -252,6 +253,31 @@ public:
     QStringList getRunTimeParaProvN(void){return mRuntimeParaProv;}
     void addRunTimeParaProvN(const QString& provNAttr){mRuntimeParaProv << provNAttr;}
 
+    /*! \brief Key identifying this process' result for the current
+     *         run, i.e. its evaluated parameters and inputs; empty,
+     *         if the result is not cached (cf. NMProcessResultCache)
+     */
+    const QByteArray& getResultKey(void)
+        {return mResultKey;}
+
+    /*! \brief Indicates whether this process' result for the
+     *         current run has been found in the result cache, in
+     *         which case the process isn't executed and its outputs
+     *         are provided by getCachedOutput()
+     */
+    bool isResultCached(void)
+        {return mbResultCacheHit;}
+
+    QSharedPointer<NMItkDataObjectWrapper> getCachedOutput(unsigned int idx)
+        {return mCachedOutputs.value(idx);}
+
+    /*! \brief Indicates whether this process may be executed on
+     *         another thread concurrently with other (independent)
+     *         processes of the model (cf. NMIterableComponent)
+     */
+    bool isConcurrentUpdateSafe(void)
+        {return mbConcurrentUpdate;}
+
     int getAuxDataIdx(void)
         {return this->mAuxDataIdx;}
 
@@ -312,6 +338,28 @@ protected:
 
     QStringList mRuntimeParaProv;
 
+    /*! \brief Whether the result of this process may be cached;
+     *         subclasses whose result doesn't only depend on their
+     *         parameters and linked inputs should set this to false
+     */
+    bool mbCacheResult;
+    bool mbResultCacheHit;
+
+    /*! \brief Set when the otb process has run to completion (itk::EndEvent)
+     *         or was updated without error; only then is its result cached
+     */
+    bool mbUpdateSucceeded;
+    QByteArray mResultKey;
+    QList<QByteArray> mInputResultKeys;
+    NMProcessResultCache::OutputMap mCachedOutputs;
+
+    /*! \brief Whether this process may be executed concurrently
+     *         with other processes; subclasses relying on resources
+     *         which can't be used from more than one thread at a time
+     *         should set this to false
+     */
+    bool mbConcurrentUpdate;
+
 //    QStringList mInputNames;
     QStringList mOutputNames;
 
@@ -348,6 +396,21 @@ protected:
      */
     virtual void linkParameters(unsigned int step, const QMap<QString, NMModelComponent*>& repo);
 
+    /*! \brief Identifies the data provided by an input component */
+    QByteArray getInputResultKey(NMModelComponent* ic,
+                                 QSharedPointer<NMItkDataObjectWrapper> iw,
+                                 const QString& inputSrc);
+
+    /*! \brief Hashes the evaluated parameters and inputs of the
+     *         linked process into mResultKey
+     */
+    void computeResultKey(void);
+
+    /*! \brief Stores the (fully buffered) outputs of the executed
+     *         process in the controller's result cache
+     */
+    void cacheResult(void);
+
 
     //virtual void setInputName(unsigned int idx, const QString& name);
     //virtual void setOutputName(unsigned int idx, const QString& name);
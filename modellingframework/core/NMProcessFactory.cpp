@@ -378,11 +378,13 @@ NMProcess* NMProcessFactory::createProcess(const QString& procClass)
         if (facIt != mFactoryRegister.constEnd())
         {
             proc = (*facIt)->createWrapper();
-        }
 
-        if(proc && this->isSink(procClass))
-        {
-            proc->mIsSink = true;
+            // mSinks holds component aliases rather
+            // than wrapper class names
+            if (proc && (*facIt)->isSinkProcess())
+            {
+                proc->mIsSink = true;
+            }
         }
     }
 
@@ -0,0 +1,245 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+#include "NMProcessResultCache.h"
+
+#include <QMutexLocker>
+
+#include "itkImageBase.h"
+
+namespace
+{
+
+qint64 componentSize(otb::ImageIOBase::IOComponentType type)
+{
+    switch (type)
+    {
+    case otb::ImageIOBase::UCHAR:
+    case otb::ImageIOBase::CHAR:
+        return 1;
+    case otb::ImageIOBase::USHORT:
+    case otb::ImageIOBase::SHORT:
+        return 2;
+    case otb::ImageIOBase::UINT:
+    case otb::ImageIOBase::INT:
+    case otb::ImageIOBase::FLOAT:
+        return 4;
+    case otb::ImageIOBase::ULONG:
+    case otb::ImageIOBase::LONG:
+        return sizeof(long);
+    default:
+        return 8;
+    }
+}
+
+/*! determines the number of buffered pixels of an image
+ *  (-1, if it is not fully buffered); returns false, if
+ *  obj is not an image of dimension VDim
+ */
+template <unsigned int VDim>
+bool bufferedPixels(itk::DataObject* obj, qint64& numPix)
+{
+    itk::ImageBase<VDim>* img = dynamic_cast<itk::ImageBase<VDim>*>(obj);
+    if (img == nullptr)
+    {
+        return false;
+    }
+
+    numPix = static_cast<qint64>(img->GetBufferedRegion().GetNumberOfPixels());
+    if (    numPix == 0
+         || img->GetBufferedRegion() != img->GetLargestPossibleRegion()
+       )
+    {
+        numPix = -1;
+    }
+    return true;
+}
+
+} // end of anonymous namespace
+
+NMProcessResultCache::NMProcessResultCache()
+    : mMaxSize(0), mSize(0), mTick(0)
+{
+}
+
+NMProcessResultCache::~NMProcessResultCache()
+{
+}
+
+void
+NMProcessResultCache::setMaxSize(qint64 bytes)
+{
+    QMutexLocker lock(&mMutex);
+    mMaxSize = bytes < 0 ? 0 : bytes;
+    this->evict(0);
+}
+
+qint64
+NMProcessResultCache::getMaxSize(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mMaxSize;
+}
+
+qint64
+NMProcessResultCache::getSize(void) const
+{
+    QMutexLocker lock(&mMutex);
+    return mSize;
+}
+
+bool
+NMProcessResultCache::lookup(const QByteArray& key, OutputMap& outputs)
+{
+    QMutexLocker lock(&mMutex);
+
+    QHash<QByteArray, Entry>::iterator it = mEntries.find(key);
+    if (it == mEntries.end())
+    {
+        return false;
+    }
+
+    // downstream filters running in-place release
+    // the (overwritten) data of their inputs
+    if (estimateSize(it.value().outputs) < 0)
+    {
+        mSize -= it.value().size;
+        mEntries.erase(it);
+        return false;
+    }
+
+    it.value().lastUsed = ++mTick;
+    outputs = it.value().outputs;
+    return true;
+}
+
+bool
+NMProcessResultCache::insert(const QByteArray& key, const OutputMap& outputs)
+{
+    const qint64 size = estimateSize(outputs);
+    if (size < 0 || outputs.isEmpty())
+    {
+        return false;
+    }
+
+    QMutexLocker lock(&mMutex);
+    if (size > mMaxSize)
+    {
+        return false;
+    }
+
+    QHash<QByteArray, Entry>::iterator it = mEntries.find(key);
+    if (it != mEntries.end())
+    {
+        mSize -= it.value().size;
+        mEntries.erase(it);
+    }
+
+    this->evict(size);
+
+    Entry e;
+    e.outputs = outputs;
+    e.size = size;
+    e.lastUsed = ++mTick;
+    mEntries.insert(key, e);
+    mSize += size;
+
+    return true;
+}
+
+void
+NMProcessResultCache::remove(const QByteArray& key)
+{
+    QMutexLocker lock(&mMutex);
+    QHash<QByteArray, Entry>::iterator it = mEntries.find(key);
+    if (it != mEntries.end())
+    {
+        mSize -= it.value().size;
+        mEntries.erase(it);
+    }
+}
+
+void
+NMProcessResultCache::clear(void)
+{
+    QMutexLocker lock(&mMutex);
+    mEntries.clear();
+    mSize = 0;
+}
+
+void
+NMProcessResultCache::evict(qint64 required)
+{
+    // evict the least recently used results until
+    // the required space is available
+    while (!mEntries.isEmpty() && mSize + required > mMaxSize)
+    {
+        QHash<QByteArray, Entry>::iterator lru = mEntries.begin();
+        QHash<QByteArray, Entry>::iterator it = mEntries.begin();
+        for (; it != mEntries.end(); ++it)
+        {
+            if (it.value().lastUsed < lru.value().lastUsed)
+            {
+                lru = it;
+            }
+        }
+
+        mSize -= lru.value().size;
+        mEntries.erase(lru);
+    }
+}
+
+qint64
+NMProcessResultCache::estimateSize(const OutputMap& outputs)
+{
+    qint64 total = 0;
+    OutputMap::const_iterator oit = outputs.cbegin();
+    for (; oit != outputs.cend(); ++oit)
+    {
+        const QSharedPointer<NMItkDataObjectWrapper>& dw = oit.value();
+        if (dw.isNull() || dw->getIsStreaming())
+        {
+            return -1;
+        }
+
+        itk::DataObject* obj = dw->getDataObject();
+        if (obj != nullptr)
+        {
+            qint64 numPix = 0;
+            if (    bufferedPixels<2>(obj, numPix)
+                 || bufferedPixels<3>(obj, numPix)
+                 || bufferedPixels<1>(obj, numPix)
+               )
+            {
+                if (numPix < 0)
+                {
+                    return -1;
+                }
+
+                const qint64 numBands = dw->getNumBands() > 0 ? dw->getNumBands() : 1;
+                total += numPix * numBands * componentSize(dw->getItkComponentType());
+            }
+        }
+
+        otb::AttributeTable::Pointer tab = dw->getOTBTab();
+        if (    tab.IsNotNull()
+             && tab->GetTableType() == otb::AttributeTable::ATTABLE_TYPE_RAM
+           )
+        {
+            total += tab->GetNumRows() * tab->GetNumCols() * 8;
+        }
+    }
+
+    return total;
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+#ifndef NMPROCESSRESULTCACHE_H_
+#define NMPROCESSRESULTCACHE_H_
+
+#include <QMap>
+#include <QHash>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QMutex>
+
+#include "NMItkDataObjectWrapper.h"
+#include "nmmodframecore_export.h"
+
+/*!
+ * \brief The NMProcessResultCache class keeps the outputs of
+ *        executed process components for re-use in subsequent
+ *        model runs or iterations
+ *
+ * Results are looked up by a key (cf. NMProcess::linkInPipeline),
+ * which hashes the process' evaluated parameters, the identity and
+ * modification time of its inputs and the modification time of any
+ * files referred to by its parameters. Only fully buffered outputs
+ * are cached; they are disconnected from the pipeline that produced
+ * them, so downstream components can use them without triggering
+ * any upstream execution.
+ *
+ * The cache is bounded by a memory budget (bytes); when a new result
+ * doesn't fit, the least recently used results are evicted. A budget
+ * of 0 disables the cache. The cache is shared between a controller
+ * and its worker controllers and hence access is serialised.
+ */
+class NMMODFRAMECORE_EXPORT NMProcessResultCache
+{
+public:
+    typedef QMap<unsigned int, QSharedPointer<NMItkDataObjectWrapper> > OutputMap;
+
+    NMProcessResultCache();
+    virtual ~NMProcessResultCache();
+
+    /*! Sets the memory budget (bytes) and evicts results as required */
+    void setMaxSize(qint64 bytes);
+    qint64 getMaxSize(void) const;
+    qint64 getSize(void) const;
+
+    bool isEnabled(void) const
+        {return getMaxSize() > 0;}
+
+    /*! Fetches the outputs cached for key; returns false, if
+     *  there are none or their data has been released in the
+     *  meantime
+     */
+    bool lookup(const QByteArray& key, OutputMap& outputs);
+
+    /*! Caches outputs under key, if their (estimated) size fits
+     *  into the budget; returns false otherwise
+     */
+    bool insert(const QByteArray& key, const OutputMap& outputs);
+
+    void remove(const QByteArray& key);
+    void clear(void);
+
+    /*! Estimates the memory (bytes) occupied by outputs; returns
+     *  -1, if any of the outputs is not fully buffered
+     */
+    static qint64 estimateSize(const OutputMap& outputs);
+
+protected:
+    struct Entry
+    {
+        OutputMap outputs;
+        qint64 size;
+        quint64 lastUsed;
+    };
+
+    void evict(qint64 required);
+
+    QHash<QByteArray, Entry> mEntries;
+    qint64 mMaxSize;
+    qint64 mSize;
+    quint64 mTick;
+
+    mutable QMutex mMutex;
+
+private:
+    NMProcessResultCache(const NMProcessResultCache&); //purposely not implemented
+    void operator=(const NMProcessResultCache&); //purposely not implemented
+};
+
+#endif /* NMPROCESSRESULTCACHE_H_ */
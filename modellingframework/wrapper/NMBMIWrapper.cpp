@@ -328,13 +328,22 @@ LinkInternalParametersWrap( NMBMIWrapper, NMBMIWrapper_Internal )
 
 NMBMIWrapper
 ::NMBMIWrapper(QObject* parent)
-    : mPtrBMILib(nullptr)
+    : mbZeroCopy(false),
+      mPtrBMILib(nullptr)
 {
     this->setParent(parent);
     this->setObjectName("NMBMIWrapper");
     this->mInputNumBands = 1;
     this->mParameterHandling = NMProcess::NM_USE_UP;
 
+    // outputs may refer to the model's own memory, which
+    // is released when the model is finalised
+    this->mbCacheResult = false;
+
+    // the model may be implemented in python and share the
+    // interpreter with other components
+    this->mbConcurrentUpdate = false;
+
     mUserProperties.clear();
     mUserProperties.insert(QStringLiteral("NMInputComponentType"), QStringLiteral("InputPixelType"));
     mUserProperties.insert(QStringLiteral("NMOutputComponentType"), QStringLiteral("OutputPixelType"));
@@ -399,13 +408,14 @@ NMBMIWrapper::initialiseBMILibrary()
                                    mBMIClassName.toStdString(),
                                    compName));
 
-        if (this->mLogger != nullptr)
+        bmi::PythonBMI* pybmi = static_cast<bmi::PythonBMI*>(mPtrBMILib.get());
+        if (pybmi != nullptr)
         {
-            bmi::PythonBMI* pybmi = static_cast<bmi::PythonBMI*>(mPtrBMILib.get());
-            if (pybmi != nullptr)
+            if (this->mLogger != nullptr)
             {
                 pybmi->setWrapLog(this, &NMBMIWrapper::bmilog);
             }
+            pybmi->setZeroCopy(mbZeroCopy);
         }
 
         try
@@ -553,6 +563,12 @@ NMBMIWrapper::parseYamlConfig()
                   mbIsThreadable = config["threadable"].as<bool>();
               }
               NMLogDebug(<< "threadable = " << mbIsThreadable);
+
+              if (config["zerocopy"])
+              {
+                  mbZeroCopy = config["zerocopy"].as<bool>();
+              }
+              NMLogDebug(<< "zerocopy = " << mbZeroCopy);
         }
 
         if (bmitype.compare("bmi-python") == 0)
@@ -99,6 +99,7 @@ protected:
 
     bool mbIsStreamable;
     bool mbIsThreadable; // no for python
+    bool mbZeroCopy; // python only: pass NumPy views instead of copies
     NMBMIComponetType mBMIComponentType;
 
     std::shared_ptr<bmi::Bmi> mPtrBMILib;
@@ -188,6 +188,18 @@ public:
         // since we know both variables are boolean and that they are assigned
         // default values, we can rely on them being valid in any case
 
+        QVariant curProcessingModeTypeVar = p->getParameter("ProcessingModeType");
+        if (curProcessingModeTypeVar.isValid())
+        {
+            QString curProcessingModeType = curProcessingModeTypeVar.toString().simplified();
+            if (!curProcessingModeType.isEmpty())
+            {
+                f->SetProcessingMode(curProcessingModeType.toStdString());
+                QString provN = QString("nm:ProcessingModeType=\"%1\"").arg(curProcessingModeType);
+                p->addRunTimeParaProvN(provN);
+            }
+        }
+
         QVariant curUseImgSpacVar = p->getParameter("UseImageSpacing");
         if (curUseImgSpacVar.isValid())
         {
@@ -713,6 +725,13 @@ NMCostDistanceBufferImageWrapper::NMCostDistanceBufferImageWrapper(QObject* pare
     this->mInputNumBands = 1;
     this->mOutputNumBands = 1;
 
+    // reads its input data itself (cf. linkInputs)
+    this->mbCacheResult = false;
+
+    mProcessingModeType = "SWEEP";
+    mProcessingModeEnum.clear();
+    mProcessingModeEnum << "SWEEP" << "EXACT";
+
     mUserProperties.clear();
     mUserProperties.insert(QStringLiteral("NMInputComponentType"), QStringLiteral("InputPixelType"));
     mUserProperties.insert(QStringLiteral("InputImageFileName"), QStringLiteral("InputImageFileName"));
@@ -723,6 +742,7 @@ NMCostDistanceBufferImageWrapper::NMCostDistanceBufferImageWrapper(QObject* pare
     mUserProperties.insert(QStringLiteral("UseImageSpacing"), QStringLiteral("UseImageSpacing"));
     mUserProperties.insert(QStringLiteral("CreateBuffer"), QStringLiteral("CreateBuffer"));
     mUserProperties.insert(QStringLiteral("BufferZoneIndicator"), QStringLiteral("BufferZoneIndicator"));
+    mUserProperties.insert(QStringLiteral("ProcessingModeType"), QStringLiteral("ProcessingMode"));
 
 
 #ifdef BUILD_RASSUPPORT
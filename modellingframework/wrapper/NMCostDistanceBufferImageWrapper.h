@@ -60,6 +60,8 @@ class NMCOSTDISTANCEBUFFERIMAGEWRAPPER_EXPORT NMCostDistanceBufferImageWrapper :
     Q_PROPERTY(bool UseImageSpacing READ getUseImageSpacing WRITE setUseImageSpacing);
     Q_PROPERTY(bool CreateBuffer READ getCreateBuffer WRITE setCreateBuffer);
     Q_PROPERTY(QStringList BufferZoneIndicator READ getBufferZoneIndicator WRITE setBufferZoneIndicator);
+    Q_PROPERTY(QString ProcessingModeType READ getProcessingModeType WRITE setProcessingModeType);
+    Q_PROPERTY(QStringList ProcessingModeEnum READ getProcessingModeEnum);
 #ifdef BUILD_RASSUPPORT
     Q_PROPERTY(NMRasdamanConnectorWrapper* RasConnector READ getRasConnector WRITE setRasConnector);
 #endif
@@ -72,6 +74,8 @@ public:
     NMPropertyGetSet( UseImageSpacing, bool )
     NMPropertyGetSet( CreateBuffer, bool )
     NMPropertyGetSet( BufferZoneIndicator, QStringList)
+    NMPropertyGetSet( ProcessingModeType, QString)
+    NMPropertyGetSet( ProcessingModeEnum, QStringList)
     NMPropertyGetSet( InputImageFileName, QStringList)
     NMPropertyGetSet( OutputImageFileName, QStringList)
     NMPropertyGetSet( CostImageFileName, QStringList)
@@ -109,6 +113,8 @@ protected:
     bool mCreateBuffer;
     QStringList mBufferZoneIndicator;
     QStringList mMaxDistance;
+    QString mProcessingModeType;
+    QStringList mProcessingModeEnum;
     QStringList mInputImageFileName;
     QStringList mOutputImageFileName;
     QStringList mCostImageFileName;
@@ -48,6 +48,9 @@ NMExternalExecWrapper::NMExternalExecWrapper(QObject* parent)
     mUserProperties.clear();
     mUserProperties.insert(QStringLiteral("Command"), QStringLiteral("Command"));
     mUserProperties.insert(QStringLiteral("Environment"), QStringLiteral("Environment"));
+
+    // the command has to be executed every time
+    this->mbCacheResult = false;
 }
 
 NMExternalExecWrapper::~NMExternalExecWrapper()
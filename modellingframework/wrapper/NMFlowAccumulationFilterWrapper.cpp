@@ -189,6 +189,37 @@ public:
            p->addRunTimeParaProvN(provN);
         }
 
+        QVariant curProcessingModeTypeVar = p->getParameter("ProcessingModeType");
+        std::string curProcessingModeType;
+        if (curProcessingModeTypeVar.isValid())
+        {
+            curProcessingModeType = curProcessingModeTypeVar.toString().simplified().toStdString();
+            f->SetProcessingMode(curProcessingModeType);
+            QString provN = QString("nm:ProcessingModeType=\"%1\"").arg(curProcessingModeType.c_str());
+            p->addRunTimeParaProvN(provN);
+        }
+
+        QVariant curTileSizeVar = p->getParameter("TileSize");
+        long curTileSize;
+        if (curTileSizeVar.isValid())
+        {
+           curTileSize = curTileSizeVar.toLongLong(&bok);
+            if (bok && curTileSize > 0)
+            {
+                f->SetTileSize(curTileSize);
+                QString provN = QString("nm:TileSize=\"%1\"").arg(curTileSize);
+                p->addRunTimeParaProvN(provN);
+            }
+            else
+            {
+                NMLogError(<< "NMFlowAccumulationFilterWrapper_Internal: " << "Invalid value for 'TileSize'!");
+                NMMfwException e(NMMfwException::NMProcess_InvalidParameter);
+                e.setSource(p->parent()->objectName().toStdString());
+                e.setDescription("Invalid value for 'TileSize'!");
+                throw e;
+            }
+        }
+
         /*$<ForwardInputUserIDs_Body>$*/
 
 
@@ -226,8 +257,13 @@ NMFlowAccumulationFilterWrapper
     mFlowLengthEnum.clear();
     mFlowLengthEnum << "NO_FLOWLENGTH" << "DOWNSTREAM" << "UPSTREAM";
 
+    mProcessingModeType = "SORTED";
+    mProcessingModeEnum.clear();
+    mProcessingModeEnum << "SORTED" << "TOPOLOGICAL" << "TILED";
+
     mFlowExponent << "4";
     mNodata << "0";
+    mTileSize << "1024";
 
     mUserProperties.clear();
     mUserProperties.insert(QStringLiteral("NMInputComponentType"), QStringLiteral("PixelType"));
@@ -235,6 +271,8 @@ NMFlowAccumulationFilterWrapper
     mUserProperties.insert(QStringLiteral("FlowExponent"), QStringLiteral("FlowExponent"));
     mUserProperties.insert(QStringLiteral("FlowLengthType"), QStringLiteral("FlowLength"));
     mUserProperties.insert(QStringLiteral("Nodata"), QStringLiteral("Nodata"));
+    mUserProperties.insert(QStringLiteral("ProcessingModeType"), QStringLiteral("ProcessingMode"));
+    mUserProperties.insert(QStringLiteral("TileSize"), QStringLiteral("TileSize"));
 }
 
 NMFlowAccumulationFilterWrapper
@@ -53,6 +53,9 @@ NMFlowAccumulationFilterWrapper
     Q_PROPERTY(QStringList FlowExponent READ getFlowExponent WRITE setFlowExponent)
     Q_PROPERTY(QString FlowLengthType READ getFlowLengthType WRITE setFlowLengthType)
     Q_PROPERTY(QStringList FlowLengthEnum READ getFlowLengthEnum)
+    Q_PROPERTY(QString ProcessingModeType READ getProcessingModeType WRITE setProcessingModeType)
+    Q_PROPERTY(QStringList ProcessingModeEnum READ getProcessingModeEnum)
+    Q_PROPERTY(QStringList TileSize READ getTileSize WRITE setTileSize)
 
 
 public:
@@ -63,6 +66,9 @@ public:
     NMPropertyGetSet( FlowExponent,   QStringList )
     NMPropertyGetSet( FlowLengthType, QString     )
     NMPropertyGetSet( FlowLengthEnum, QStringList )
+    NMPropertyGetSet( ProcessingModeType, QString     )
+    NMPropertyGetSet( ProcessingModeEnum, QStringList )
+    NMPropertyGetSet( TileSize,       QStringList )
 
 public:
     NMFlowAccumulationFilterWrapper(QObject* parent=0);
@@ -90,6 +96,9 @@ protected:
     QStringList mFlowExponent;
     QString mFlowLengthType;
     QStringList mFlowLengthEnum;
+    QString mProcessingModeType;
+    QStringList mProcessingModeEnum;
+    QStringList mTileSize;
 
     void linkParameters(unsigned int step,
             const QMap<QString, NMModelComponent*>& repo);
@@ -27,9 +27,15 @@
 #include "NMItkDataObjectWrapper.h"
 
 #include <array>
+#include <cstring>
+
+#include <QDir>
+#include <QTemporaryFile>
+#include <QScopedPointer>
 
 #include "itkDataObject.h"
 #include "itkImageRegion.h"
+#include "itkImportImageContainer.h"
 #include "otbImage.h"
 #include "otbVectorImage.h"
 #include "itkRGBPixel.h"
@@ -37,6 +43,66 @@
 #include "NMMacros.h"
 #include "nmtypeinfo.h"
 
+/*! \brief Pixel container whose memory is mapped onto a
+ *         temporary file, so the (virtual) memory manager pages
+ *         the pixels out to that file rather than to the swap
+ *         space; the file is removed with the container
+ */
+template <class TElementIdentifier, class TElement>
+class NMMappedImageContainer
+        : public itk::ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+    typedef NMMappedImageContainer                                  Self;
+    typedef itk::ImportImageContainer<TElementIdentifier, TElement> Superclass;
+    typedef itk::SmartPointer<Self>                                 Pointer;
+    typedef itk::SmartPointer<const Self>                           ConstPointer;
+
+    itkNewMacro(Self)
+    itkTypeMacro(NMMappedImageContainer, ImportImageContainer)
+
+    /*! copies size elements from src into a temporary file
+     *  in directory dir and imports its mapped memory */
+    bool Map(const QString& dir, const TElement* src, TElementIdentifier size)
+    {
+        const qint64 bytes = static_cast<qint64>(size) * sizeof(TElement);
+        mFile.reset(new QTemporaryFile(QDir(dir).absoluteFilePath(
+                                           QStringLiteral("nmbuffer_XXXXXX.raw"))));
+        if (    bytes == 0
+             || !mFile->open()
+             || !mFile->resize(bytes)
+           )
+        {
+            mFile.reset();
+            return false;
+        }
+
+        uchar* mem = mFile->map(0, bytes);
+        if (mem == nullptr)
+        {
+            mFile.reset();
+            return false;
+        }
+
+        std::memcpy(mem, src, bytes);
+        this->SetImportPointer(reinterpret_cast<TElement*>(mem), size, false);
+        return true;
+    }
+
+protected:
+    NMMappedImageContainer() {}
+
+    // the file is unmapped and removed when it's deleted; since the
+    // container doesn't manage the memory, the superclass leaves it alone
+    ~NMMappedImageContainer() {}
+
+    QScopedPointer<QTemporaryFile> mFile;
+
+private:
+    NMMappedImageContainer(const Self&); //purposely not implemented
+    void operator=(const Self&); //purposely not implemented
+};
+
 template <class PixelType, unsigned int ImageDimension>
 class NMItkDataObjectWrapper_Internal
 {
@@ -285,8 +351,131 @@ public:
             }
         }
     }
+
+    template <class TImage>
+    static qint64 getImageBufferSize(itk::DataObject* dataObj, bool& bMapped)
+    {
+        typedef typename TImage::PixelContainer ContainerType;
+        typedef NMMappedImageContainer<typename ContainerType::ElementIdentifier,
+                                       typename ContainerType::Element> MappedType;
+
+        TImage* img = dynamic_cast<TImage*>(dataObj);
+        if (img == nullptr || img->GetPixelContainer() == nullptr)
+        {
+            return 0;
+        }
+
+        bMapped = dynamic_cast<MappedType*>(img->GetPixelContainer()) != nullptr;
+        return static_cast<qint64>(img->GetPixelContainer()->Size())
+                * sizeof(typename ContainerType::Element);
+    }
+
+    template <class TImage>
+    static bool mapImageBuffer(itk::DataObject* dataObj, const QString& dir)
+    {
+        typedef typename TImage::PixelContainer ContainerType;
+        typedef NMMappedImageContainer<typename ContainerType::ElementIdentifier,
+                                       typename ContainerType::Element> MappedType;
+
+        // we don't map buffers which are shared with other images
+        // (i.e. the image isn't the only owner of the pixel container),
+        // since those would keep the RAM buffer alive and wouldn't
+        // see any changes made to the mapped copy
+        TImage* img = dynamic_cast<TImage*>(dataObj);
+        if (    img == nullptr
+             || img->GetPixelContainer() == nullptr
+             || img->GetPixelContainer()->GetReferenceCount() > 1
+             || dynamic_cast<MappedType*>(img->GetPixelContainer()) != nullptr
+           )
+        {
+            return false;
+        }
+
+        ContainerType* buf = img->GetPixelContainer();
+        typename MappedType::Pointer mapped = MappedType::New();
+        if (!mapped->Map(dir, buf->GetBufferPointer(), buf->Size()))
+        {
+            return false;
+        }
+
+        // this releases the RAM buffer
+        img->SetPixelContainer(mapped);
+        return true;
+    }
+
+    static void getBufferSize(itk::DataObject* dataObj, unsigned int numBands,
+                              bool rgbMode, qint64& size, bool& bMapped)
+    {
+        if (numBands == 1)
+        {
+            size = getImageBufferSize<ImgType>(dataObj, bMapped);
+        }
+        else if (numBands == 3 && rgbMode)
+        {
+            size = getImageBufferSize<RGBImgType>(dataObj, bMapped);
+        }
+        else
+        {
+            size = getImageBufferSize<VecType>(dataObj, bMapped);
+        }
+    }
+
+    static void mapBuffer(itk::DataObject* dataObj, unsigned int numBands,
+                          bool rgbMode, const QString& dir, bool& bMapped)
+    {
+        if (numBands == 1)
+        {
+            bMapped = mapImageBuffer<ImgType>(dataObj, dir);
+        }
+        else if (numBands == 3 && rgbMode)
+        {
+            bMapped = mapImageBuffer<RGBImgType>(dataObj, dir);
+        }
+        else
+        {
+            bMapped = mapImageBuffer<VecType>(dataObj, dir);
+        }
+    }
 };
 
+#define DWGetBufferSize( comptype ) \
+{ \
+    switch(mNumDimensions) \
+    { \
+    case 1: \
+        NMItkDataObjectWrapper_Internal<comptype, 1>::getBufferSize( \
+            dataObj, mNumBands, mIsRGBImage, size, bMapped); \
+        break; \
+    case 2: \
+        NMItkDataObjectWrapper_Internal<comptype, 2>::getBufferSize( \
+            dataObj, mNumBands, mIsRGBImage, size, bMapped); \
+        break; \
+    case 3: \
+        NMItkDataObjectWrapper_Internal<comptype, 3>::getBufferSize( \
+            dataObj, mNumBands, mIsRGBImage, size, bMapped); \
+        break; \
+    }\
+}
+
+#define DWMapBuffer( comptype ) \
+{ \
+    switch(mNumDimensions) \
+    { \
+    case 1: \
+        NMItkDataObjectWrapper_Internal<comptype, 1>::mapBuffer( \
+            dataObj, mNumBands, mIsRGBImage, dir, bMapped); \
+        break; \
+    case 2: \
+        NMItkDataObjectWrapper_Internal<comptype, 2>::mapBuffer( \
+            dataObj, mNumBands, mIsRGBImage, dir, bMapped); \
+        break; \
+    case 3: \
+        NMItkDataObjectWrapper_Internal<comptype, 3>::mapBuffer( \
+            dataObj, mNumBands, mIsRGBImage, dir, bMapped); \
+        break; \
+    }\
+}
+
 #define DWCreateBufferFilterInstance( comptype ) \
 { \
     switch(mNumDimensions) \
@@ -568,6 +757,110 @@ NMItkDataObjectWrapper::getDataObject()
     return mDataObject;
 }
 
+itk::DataObject*
+NMItkDataObjectWrapper::getBufferedDataObject()
+{
+    // when streaming, mDataObject is the output of the
+    // buffer filter, which copies from the actual buffer
+    if (    mbIsStreaming
+         && mItkProcess.IsNotNull()
+         && mItkProcess->GetNumberOfInputs() > 0
+       )
+    {
+        return mItkProcess->GetInputs()[0];
+    }
+    return mDataObject;
+}
+
+qint64
+NMItkDataObjectWrapper::getBufferSize(void)
+{
+    qint64 size = 0;
+    bool bMapped = false;
+    itk::DataObject* dataObj = this->getBufferedDataObject();
+    if (dataObj == nullptr)
+    {
+        return size;
+    }
+
+    switch(this->getItkComponentType())
+    {
+        LocalMacroPerSingleType( DWGetBufferSize )
+        default:
+            break;
+    }
+
+    return size;
+}
+
+bool
+NMItkDataObjectWrapper::isBufferMapped(void)
+{
+    qint64 size = 0;
+    bool bMapped = false;
+    itk::DataObject* dataObj = this->getBufferedDataObject();
+    if (dataObj == nullptr)
+    {
+        return bMapped;
+    }
+
+    switch(this->getItkComponentType())
+    {
+        LocalMacroPerSingleType( DWGetBufferSize )
+        default:
+            break;
+    }
+
+    return bMapped;
+}
+
+bool
+NMItkDataObjectWrapper::mapBuffer(const QString& dir)
+{
+    bool bMapped = false;
+    itk::DataObject* dataObj = this->getBufferedDataObject();
+    if (dataObj == nullptr)
+    {
+        return bMapped;
+    }
+
+    switch(this->getItkComponentType())
+    {
+        LocalMacroPerSingleType( DWMapBuffer )
+        default:
+            break;
+    }
+
+    return bMapped;
+}
+
+NMItkDataObjectWrapper*
+NMItkDataObjectWrapper::createBufferView(void)
+{
+    itk::DataObject* dataObj = this->getBufferedDataObject();
+    if (dataObj == nullptr)
+    {
+        return nullptr;
+    }
+
+    // the grafted image has got its own regions, so pipelines
+    // of different threads don't modify a shared image object
+    itk::DataObject::Pointer view = dynamic_cast<itk::DataObject*>(
+                dataObj->CreateAnother().GetPointer());
+    if (view.IsNull())
+    {
+        return nullptr;
+    }
+    view->Graft(dataObj);
+
+    NMItkDataObjectWrapper* dw = new NMItkDataObjectWrapper(nullptr, view,
+                this->getItkComponentType(), mNumDimensions, mNumBands);
+    dw->setIsRGBImage(mIsRGBImage);
+    dw->setIsStreaming(true);
+
+    return dw;
+}
+
 void
 NMItkDataObjectWrapper::setImageRegion(NMRegionType regType, void *regObj)
 {
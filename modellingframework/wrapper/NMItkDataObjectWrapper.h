@@ -94,6 +94,25 @@ public:
     void setIsStreaming(bool stream);
     bool getIsStreaming(){return this->mbIsStreaming;}
 
+    /*! Size (bytes) of the image's pixel buffer */
+    qint64 getBufferSize(void);
+
+    /*! Moves the image's pixel buffer into a memory-mapped
+     *  temporary file in directory dir, i.e. the pixels are
+     *  paged out to that file rather than kept in RAM;
+     *  returns false, if the buffer couldn't be mapped or is
+     *  shared with another image
+     */
+    bool mapBuffer(const QString& dir);
+    bool isBufferMapped(void);
+
+    /*! Creates a streaming wrapper of a new image sharing this
+     *  image's pixel buffer, i.e. downstream filters (e.g. of
+     *  another thread) only get copies of the shared pixels;
+     *  returns nullptr, if there's no image to share
+     */
+    NMItkDataObjectWrapper* createBufferView(void);
+
 signals:
     void nmChanged();
 
@@ -111,6 +130,7 @@ protected:
     QString mStringObject;
 
     void setupBufferFilter();
+    itk::DataObject* getBufferedDataObject();
 
     itk::DataObject* getBufferFilterOutput();
     void createBufferFilterInstance();
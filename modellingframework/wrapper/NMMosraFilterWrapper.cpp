@@ -284,6 +284,9 @@ NMMosraFilterWrapper
     mUserProperties.insert(QStringLiteral("TimeOut"), QStringLiteral("TimeOut"));
     mUserProperties.insert(QStringLiteral("ScenarioName"), QStringLiteral("ScenarioName"));
     mUserProperties.insert(QStringLiteral("GenerateReports"), QStringLiteral("GenerateReports"));
+
+    // writes the optimisation results and reports
+    this->mbCacheResult = false;
 }
 
 NMMosraFilterWrapper
@@ -22,6 +22,16 @@
  *      Author: alex
  */
 
+#ifndef NM_ENABLE_LOGGER
+#   define NM_ENABLE_LOGGER
+#   include "nmlog.h"
+#   undef NM_ENABLE_LOGGER
+#else
+#   include "nmlog.h"
+#endif
+
+#include <QRegularExpression>
+
 #include "NMNeighbourhoodCountingWrapper.h"
 #include "NMMacros.h"
 
@@ -53,14 +63,14 @@ public:
 	}
 
 	static void setInternalTestValue(itk::ProcessObject::Pointer& otbFilter,
-			int testvalue)
+			const std::vector<int>& testvalues)
 	{
 		FilterType* filter = dynamic_cast<FilterType*>(otbFilter.GetPointer());
-		filter->SetTestvalue(testvalue);
+		filter->SetTestvalues(testvalues);
 	}
 
 	static void setInternalRadius(itk::ProcessObject::Pointer& otbFilter,
-			std::vector<unsigned int> userradius)
+			std::vector<unsigned int> userradius, bool circular)
 	{
 		FilterType* filter = dynamic_cast<FilterType*>(otbFilter.GetPointer());
 		InImgSizeType radius;
@@ -69,6 +79,7 @@ public:
 			radius[r] = userradius[r];
 		}
 		filter->SetRadius(radius);
+		filter->SetCircular(circular);
 	}
 
 	static void setNthInput(itk::ProcessObject::Pointer& otbFilter,
@@ -403,17 +414,17 @@ SetNthInputWrap( NMNeighbourhoodCountingWrapper, NMNeighbourhoodCountingWrapper_
 	if (this->mInputNumDimensions == 1)                                     \
 	{                                                                       \
 		wrapperName< inputType, outputType, 1>::setInternalRadius(       \
-				this->mOtbProcess, kernelsize);                       \
+				this->mOtbProcess, kernelsize, this->mCircularKernel);                 \
 	}                                                                       \
 	else if (this->mInputNumDimensions == 2)                                \
 	{                                                                       \
 		wrapperName< inputType, outputType, 2>::setInternalRadius(       \
-				this->mOtbProcess, kernelsize);                       \
+				this->mOtbProcess, kernelsize, this->mCircularKernel);                 \
 	}                                                                       \
 	else if (this->mInputNumDimensions == 3)                                \
 	{                                                                       \
 		wrapperName< inputType, outputType, 3>::setInternalRadius(       \
-				this->mOtbProcess, kernelsize);                       \
+				this->mOtbProcess, kernelsize, this->mCircularKernel);                 \
 	}                                                                       \
 }
 
@@ -426,23 +437,24 @@ SetNthInputWrap( NMNeighbourhoodCountingWrapper, NMNeighbourhoodCountingWrapper_
 	if (this->mInputNumDimensions == 1)                                     \
 	{                                                                       \
 		wrapperName< inputType, outputType, 1>::setInternalTestValue(       \
-				this->mOtbProcess, this->mTestValue);                       \
+				this->mOtbProcess, this->mTestValues);                       \
 	}                                                                       \
 	else if (this->mInputNumDimensions == 2)                                \
 	{                                                                       \
 		wrapperName< inputType, outputType, 2>::setInternalTestValue(       \
-				this->mOtbProcess, this->mTestValue);                       \
+				this->mOtbProcess, this->mTestValues);                       \
 	}                                                                       \
 	else if (this->mInputNumDimensions == 3)                                \
 	{                                                                       \
 		wrapperName< inputType, outputType, 3>::setInternalTestValue(       \
-				this->mOtbProcess, this->mTestValue);                       \
+				this->mOtbProcess, this->mTestValues);                       \
 	}                                                                       \
 }
 
 
 NMNeighbourhoodCountingWrapper::NMNeighbourhoodCountingWrapper(QObject* parent)
-	: mTestValue(0), mKernelSizeX(1), mKernelSizeY(1), mKernelSizeZ(1)
+	: mTestValue(0), mKernelSizeX(1), mKernelSizeY(1), mKernelSizeZ(1),
+	  mCircularKernel(false)
 {
 	this->setParent(parent);
 	this->ctx = "NMNeighbourhoodCountingWrapper";
@@ -559,15 +571,37 @@ NMNeighbourhoodCountingWrapper::linkParameters(unsigned int step,
     //if (step > this->mTestValueList.size()-1)
     //	step = 0;
 
+    this->mTestValues.clear();
     if (this->mTestValueList.size())
 	{
         int pos = this->mapHostIndexToPolicyIndex(step, mTestValueList.size());
 
-		bool bok;
-        int val = this->mTestValueList.at(pos).toInt(&bok);
-		if (bok)
-			this->mTestValue = val;
+        // we count several values in one go
+        QStringList vals = this->mTestValueList.at(pos).split(
+                    QRegularExpression("[\\s,]+"), Qt::SkipEmptyParts);
+        foreach(const QString& v, vals)
+        {
+            bool bok;
+            int val = v.toInt(&bok);
+            if (bok)
+            {
+                this->mTestValues.push_back(val);
+            }
+            else
+            {
+                NMLogWarn(<< ctx << ": Invalid test value '"
+                          << v.toStdString() << "' ignored!");
+            }
+        }
+        if (this->mTestValues.size() == 1)
+        {
+            this->mTestValue = this->mTestValues[0];
+        }
 	}
+    if (this->mTestValues.empty())
+    {
+        this->mTestValues.push_back(this->mTestValue);
+    }
 	this->internalSetTestValue();
 	this->internalSetRadius();
 
@@ -29,6 +29,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 #include <QStringList>
 #include <QList>
 
@@ -47,6 +48,7 @@ class NMNEIGHBOURHOODCOUNTINGWRAPPER_EXPORT NMNeighbourhoodCountingWrapper: publ
     Q_PROPERTY(unsigned int KernelSizeX READ getKernelSizeX WRITE setKernelSizeX)
     Q_PROPERTY(unsigned int KernelSizeY READ getKernelSizeY WRITE setKernelSizeY)
     Q_PROPERTY(unsigned int KernelSizeZ READ getKernelSizeZ WRITE setKernelSizeZ)
+    Q_PROPERTY(bool CircularKernel READ getCircularKernel WRITE setCircularKernel)
 
 public:
     NMPropertyGetSet( TestValueList, QStringList );
@@ -54,6 +56,7 @@ public:
     NMPropertyGetSet( KernelSizeX, unsigned int );
     NMPropertyGetSet( KernelSizeY, unsigned int );
     NMPropertyGetSet( KernelSizeZ, unsigned int );
+    NMPropertyGetSet( CircularKernel, bool );
 
 signals:
 
@@ -82,6 +85,11 @@ protected:
     unsigned int mKernelSizeX;
     unsigned int mKernelSizeY;
     unsigned int mKernelSizeZ;
+    bool mCircularKernel;
+
+    // test values of the current step; a TestValueList entry
+    // may list several values separated by blanks or commas
+    std::vector<int> mTestValues;
 };
 
 #endif /* NMNEIGHBOURHOODCOUNTINGWRAPPER_H_ */
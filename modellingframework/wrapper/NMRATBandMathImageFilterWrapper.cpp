@@ -78,6 +78,13 @@ public:
             filter->SetUseTableColumnCache(useCache);
         }
 
+    static void setTableCacheSize(itk::ProcessObject::Pointer& otbFilter,
+            int cacheSize)
+        {
+            FilterType* filter = dynamic_cast<FilterType*>(otbFilter.GetPointer());
+            filter->SetTableCacheSize(cacheSize);
+        }
+
     static void setNthInput(itk::ProcessObject::Pointer& otbFilter,
             unsigned int numBands, unsigned int idx, itk::DataObject* dataObj, const QString& name)
         {
@@ -276,6 +283,26 @@ else if (this->mInputNumDimensions == 3)
 }
 
 
+#define callSetTableCacheSize( filterPixelType, wrapName ) \
+{ \
+    if (this->mInputNumDimensions == 1) \
+    { \
+        NMRATBandMathImageFilterWrapper_Internal< filterPixelType, filterPixelType, 1 >::setTableCacheSize( \
+                this->mOtbProcess, cacheSize); \
+    } \
+    else if (this->mInputNumDimensions == 2) \
+    { \
+        NMRATBandMathImageFilterWrapper_Internal< filterPixelType, filterPixelType, 2 >::setTableCacheSize( \
+                this->mOtbProcess, cacheSize); \
+    } \
+    else if (this->mInputNumDimensions == 3) \
+    { \
+        NMRATBandMathImageFilterWrapper_Internal< filterPixelType, filterPixelType, 3 >::setTableCacheSize( \
+                this->mOtbProcess, cacheSize); \
+    }\
+}
+
+
 #define callSetNthInputName( filterPixelType, wrapName ) \
 { \
     if (this->mInputNumDimensions == 1) \
@@ -313,6 +340,7 @@ NMRATBandMathImageFilterWrapper::NMRATBandMathImageFilterWrapper(QObject* parent
     this->mOutputNumBands = 1;
     this->mParamPos = 0;
     this->mUseTableColumnCache = false;
+    this->mTableCacheSize = 0;
     this->mParameterHandling = NMProcess::NM_USE_UP;
 
     mUserProperties.clear();
@@ -322,6 +350,7 @@ NMRATBandMathImageFilterWrapper::NMRATBandMathImageFilterWrapper(QObject* parent
     mUserProperties.insert(QStringLiteral("UserOutputNames"), QStringLiteral("OutputNames"));
     mUserProperties.insert(QStringLiteral("MapExpressions"), QStringLiteral("MapExpressions"));
     mUserProperties.insert(QStringLiteral("UseTableColumnCache"), QStringLiteral("UseTableColumnCache"));
+    mUserProperties.insert(QStringLiteral("TableCacheSize"), QStringLiteral("TableCacheSize"));
 }
 
 NMRATBandMathImageFilterWrapper::~NMRATBandMathImageFilterWrapper(void)
@@ -376,6 +405,21 @@ NMRATBandMathImageFilterWrapper
     }
 }
 
+void
+NMRATBandMathImageFilterWrapper
+::setInternalTableCacheSize(int cacheSize)
+{
+    if (!this->mbIsInitialised)
+        return;
+
+    switch(this->mInputComponentType)
+    {
+    MacroPerType( callSetTableCacheSize, NMRATBandMathImageFilterWrapper_Internal )
+    default:
+        break;
+    }
+}
+
 void
 NMRATBandMathImageFilterWrapper
 ::setInternalNthInputName(unsigned int idx, const QString& varName)
@@ -519,6 +563,10 @@ NMRATBandMathImageFilterWrapper
     QString useCacheProvN = QString("nm:UseTableColumnCache=\"%1\"").arg(useCache);
     this->addRunTimeParaProvN(useCacheProvN);
 
+    this->setInternalTableCacheSize(mTableCacheSize);
+    QString cacheSizeProvN = QString("nm:TableCacheSize=\"%1\"").arg(mTableCacheSize);
+    this->addRunTimeParaProvN(cacheSizeProvN);
+
 
     NMModelController* ctrl = this->getModelController();
     if (ctrl == 0)
@@ -72,6 +72,7 @@ class NMRATBANDMATHIMAGEFILTERWRAPPER_EXPORT NMRATBandMathImageFilterWrapper : p
     Q_PROPERTY(QStringList MapExpressions READ getMapExpressions WRITE setMapExpressions )
     Q_PROPERTY(QStringList NumExpressions READ getNumExpressions WRITE setNumExpressions )
     Q_PROPERTY(bool UseTableColumnCache READ getUseTableColumnCache WRITE setUseTableColumnCache )
+    Q_PROPERTY(int TableCacheSize READ getTableCacheSize WRITE setTableCacheSize )
 
 public:
     // NMPropertyGetSet( InputImgVarNames, QList<QStringList> )
@@ -80,6 +81,7 @@ public:
     NMPropertyGetSet( MapExpressions, QStringList )
     NMPropertyGetSet( NumExpressions, QStringList )
     NMPropertyGetSet( UseTableColumnCache, bool )
+    NMPropertyGetSet( TableCacheSize, int )
 
 signals:
 //	void InputImgVarNamesChanged(QList<QStringList>);
@@ -110,6 +112,7 @@ protected:
     void setInternalNumExpression(unsigned int numExpr);
     void setInternalNthInputName(unsigned int idx, const QString& varName);
     void setInternalUseTableCache(bool useCache);
+    void setInternalTableCacheSize(int cacheSize);
     void setInternalOutputNames(const QStringList& outputNames);
 
     std::string ctx;
@@ -119,6 +122,7 @@ protected:
     QStringList 		mMapExpressions;
     QStringList			mNumExpressions;
     bool                mUseTableColumnCache;
+    int                 mTableCacheSize;
 
 //    void setTableParams( const QMap<QString,
 //    		NMModelComponent*>& repo);
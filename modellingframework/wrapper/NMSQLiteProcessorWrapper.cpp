@@ -195,6 +195,9 @@ NMSQLiteProcessorWrapper
     mUserProperties.insert(QStringLiteral("InputNumDimensions"), QStringLiteral("NumDimensions"));
     mUserProperties.insert(QStringLiteral("SQLStatement"), QStringLiteral("SQLStatement"));
 
+    // the statement modifies the table, so
+    // it has to be executed every time
+    this->mbCacheResult = false;
 }
 
 NMSQLiteProcessorWrapper
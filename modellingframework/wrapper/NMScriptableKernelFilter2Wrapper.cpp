@@ -184,6 +184,16 @@ public:
             p->addRunTimeParaProvN(kernelShapeProvN);
         }
 
+        QVariant curExecutionModeVar = p->getParameter("ExecutionModeType");
+        std::string curExecutionMode;
+        if (curExecutionModeVar.isValid())
+        {
+            curExecutionMode = curExecutionModeVar.toString().toStdString();
+            f->SetExecutionMode(curExecutionMode);
+            QString executionModeProvN = QString("nm:ExecutionModeType=\"%1\"").arg(curExecutionMode.c_str());
+            p->addRunTimeParaProvN(executionModeProvN);
+        }
+
         QVariant curOutputVarNameVar = p->getParameter("OutputVarName");
         std::string curOutputVarName;
         if (curOutputVarNameVar.isValid())
@@ -584,6 +594,9 @@ NMScriptableKernelFilter2Wrapper
     mKernelShapeType = QString(tr("RECTANGULAR"));
     mKernelShapeEnum.clear();
     mKernelShapeEnum << "RECTANGULAR" << "CIRCULAR";
+    mExecutionModeType = QString(tr("PARSER"));
+    mExecutionModeEnum.clear();
+    mExecutionModeEnum << "PARSER" << "COMPILED" << "VERIFY";
     mNumThreads = QThread::idealThreadCount() < 0 ? (unsigned int)1 : (unsigned int)QThread::idealThreadCount();
     this->mAuxDataIdx = 1;
     this->mInputNumBands = 1;
@@ -598,11 +611,15 @@ NMScriptableKernelFilter2Wrapper
     mUserProperties.insert(QStringLiteral("OutputNumDimensions"), QStringLiteral("NumDimensions"));
     mUserProperties.insert(QStringLiteral("Radius"), QStringLiteral("KernelRadius"));
     mUserProperties.insert(QStringLiteral("KernelShapeType"), QStringLiteral("KernelShape"));
+    mUserProperties.insert(QStringLiteral("ExecutionModeType"), QStringLiteral("ExecutionMode"));
     mUserProperties.insert(QStringLiteral("InitScript"), QStringLiteral("InitScript"));
     mUserProperties.insert(QStringLiteral("KernelScript"), QStringLiteral("KernelScript"));
     mUserProperties.insert(QStringLiteral("Nodata"), QStringLiteral("NodataValue"));
     mUserProperties.insert(QStringLiteral("NumThreads"), QStringLiteral("NumThreads"));
 
+    // the filter keeps its neighbourhood and table data in
+    // static maps shared by all instances
+    this->mbConcurrentUpdate = false;
 }
 
 NMScriptableKernelFilter2Wrapper
@@ -51,6 +51,8 @@ NMScriptableKernelFilter2Wrapper
     Q_PROPERTY(QStringList InitScript READ getInitScript WRITE setInitScript)
     Q_PROPERTY(QString KernelShapeType READ getKernelShapeType WRITE setKernelShapeType)
     Q_PROPERTY(QStringList KernelShapeEnum READ getKernelShapeEnum)
+    Q_PROPERTY(QString ExecutionModeType READ getExecutionModeType WRITE setExecutionModeType)
+    Q_PROPERTY(QStringList ExecutionModeEnum READ getExecutionModeEnum)
     Q_PROPERTY(QStringList OutputVarName READ getOutputVarName WRITE setOutputVarName)
     Q_PROPERTY(QStringList Nodata READ getNodata WRITE setNodata)
     Q_PROPERTY(unsigned int NumThreads READ getNumThreads WRITE setNumThreads)
@@ -65,6 +67,8 @@ public:
     NMPropertyGetSet( Nodata, QStringList )
     NMPropertyGetSet( KernelShapeType, QString )
     NMPropertyGetSet( KernelShapeEnum, QStringList )
+    NMPropertyGetSet( ExecutionModeType, QString )
+    NMPropertyGetSet( ExecutionModeEnum, QStringList )
     NMPropertyGetSet( NumThreads, unsigned int )
 
 
@@ -100,6 +104,8 @@ protected:
     QStringList mNodata;
     QString mKernelShapeType;
     QStringList mKernelShapeEnum;
+    QString mExecutionModeType;
+    QStringList mExecutionModeEnum;
 
 };
 
@@ -421,6 +421,27 @@ public:
             }
         }
 
+    static void setWriteBuffers(itk::ProcessObject::Pointer& otbFilter,
+                                  unsigned int numBands, const int numBuffers, bool rgbMode)
+        {
+            const unsigned int nbuf = numBuffers < 0 ? 0 : numBuffers;
+            if (numBands == 1)
+            {
+                FilterType* filter = dynamic_cast<FilterType*>(otbFilter.GetPointer());
+                filter->SetNumberOfWriteBuffers(nbuf);
+            }
+            else if (numBands == 3 && rgbMode)
+            {
+                RGBFilterType* filter = dynamic_cast<RGBFilterType*>(otbFilter.GetPointer());
+                filter->SetNumberOfWriteBuffers(nbuf);
+            }
+            else
+            {
+                VecFilterType* filter = dynamic_cast<VecFilterType*>(otbFilter.GetPointer());
+                filter->SetNumberOfWriteBuffers(nbuf);
+            }
+        }
+
     static void setForcedLPR(itk::ProcessObject::Pointer& otbFilter,
                                   unsigned int numBands, itk::ImageIORegion& ior, bool rgbMode)
         {
@@ -649,6 +670,25 @@ public:
     }\
 }
 
+#define callSetWriteBuffers( imgType, wrapName ) \
+{ \
+    if (this->mOutputNumDimensions == 1) \
+    { \
+        wrapName< imgType, imgType, 1 >::setWriteBuffers( \
+                this->mOtbProcess, this->mOutputNumBands, mWriteBuffers, mRGBMode); \
+    } \
+    else if (this->mOutputNumDimensions == 2) \
+    { \
+        wrapName< imgType, imgType, 2 >::setWriteBuffers( \
+                this->mOtbProcess, this->mOutputNumBands, mWriteBuffers, mRGBMode); \
+    } \
+    else if (this->mOutputNumDimensions == 3) \
+    { \
+        wrapName< imgType, imgType, 3 >::setWriteBuffers( \
+                this->mOtbProcess, this->mOutputNumBands, mWriteBuffers, mRGBMode); \
+    }\
+}
+
 #define callSetForcedLPR( imgType, wrapName ) \
 { \
     if (this->mOutputNumDimensions == 1) \
@@ -730,8 +770,12 @@ NMStreamingImageFileWriterWrapper
     this->mParallelIO = false;
 
     this->mStreamingSize = 512;
+    this->mWriteBuffers = 0;
     this->mWriteProcs = 1;
 
+    // the image has to be written every time
+    this->mbCacheResult = false;
+
     this->mPyramidResamplingType = QString(tr("NEAREST"));
     mPyramidResamplingEnum.clear();
     mPyramidResamplingEnum
@@ -759,6 +803,7 @@ NMStreamingImageFileWriterWrapper
     mUserProperties.insert(QStringLiteral("WriteTable"), QStringLiteral("WriteTable"));
     mUserProperties.insert(QStringLiteral("StreamingMethodType"), QStringLiteral("StreamingMethod"));
     mUserProperties.insert(QStringLiteral("StreamingSize"), QStringLiteral("PipelineMemoryFootprint"));
+    mUserProperties.insert(QStringLiteral("WriteBuffers"), QStringLiteral("WriteBuffers"));
     mUserProperties.insert(QStringLiteral("PyramidResamplingType"), QStringLiteral("PyramidResampling"));
     //mUserProperties.insert(QStringLiteral("ParallelIO"), QStringLiteral("ParallelIO"));
     mUserProperties.insert(QStringLiteral("WriteProcs"), QStringLiteral("WriteProcs"));
@@ -791,8 +836,12 @@ NMStreamingImageFileWriterWrapper
     this->mParallelIO = false;
 
     this->mStreamingSize = 512;
+    this->mWriteBuffers = 0;
     this->mWriteProcs = 1;
 
+    // the image has to be written every time
+    this->mbCacheResult = false;
+
     this->mPyramidResamplingType = QString(tr("NEAREST"));
     mPyramidResamplingEnum.clear();
     mPyramidResamplingEnum
@@ -820,6 +869,7 @@ NMStreamingImageFileWriterWrapper
     mUserProperties.insert(QStringLiteral("WriteTable"), QStringLiteral("WriteTable"));
     mUserProperties.insert(QStringLiteral("StreamingMethodType"), QStringLiteral("StreamingMethod"));
     mUserProperties.insert(QStringLiteral("StreamingSize"), QStringLiteral("PipelineMemoryFootprint"));
+    mUserProperties.insert(QStringLiteral("WriteBuffers"), QStringLiteral("WriteBuffers"));
     mUserProperties.insert(QStringLiteral("PyramidResamplingType"), QStringLiteral("PyramidResampling"));
     //mUserProperties.insert(QStringLiteral("ParallelIO"), QStringLiteral("ParallelIO"));
     mUserProperties.insert(QStringLiteral("WriteProcs"), QStringLiteral("WriteProcs"));
@@ -946,6 +996,21 @@ NMStreamingImageFileWriterWrapper
     }
 }
 
+void
+NMStreamingImageFileWriterWrapper
+::setInternalWriteBuffers()
+{
+    if (!this->mbIsInitialised)
+        return;
+
+    switch(this->mOutputComponentType)
+    {
+    MacroPerType( callSetWriteBuffers, NMStreamingImageFileWriterWrapper_Internal )
+    default:
+        break;
+    }
+}
+
 void
 NMStreamingImageFileWriterWrapper
 ::setInternalForcedLargestPossibleRegion(itk::ImageIORegion &ior)
@@ -1309,6 +1374,11 @@ NMStreamingImageFileWriterWrapper
                           .arg(mStreamingSize);
     this->addRunTimeParaProvN(streamSizeProvNAttr);
 
+    this->setInternalWriteBuffers();
+    QString writeBufProvNAttr = QString("nm:WriteBuffers=\"%1\"")
+                          .arg(mWriteBuffers);
+    this->addRunTimeParaProvN(writeBufProvNAttr);
+
     this->setInternalParallelIO();
 
     NMDebugCtx(this->parent()->objectName().toStdString(), << "done!");
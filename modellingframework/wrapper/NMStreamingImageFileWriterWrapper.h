@@ -64,6 +64,7 @@ class NMSTREAMINGIMAGEFILEWRITERWRAPPER_EXPORT NMStreamingImageFileWriterWrapper
     Q_PROPERTY(QString StreamingMethodType READ getStreamingMethodType WRITE setStreamingMethodType)
     Q_PROPERTY(QStringList StreamingMethodEnum READ getStreamingMethodEnum)
     Q_PROPERTY(int StreamingSize READ getStreamingSize WRITE setStreamingSize)
+    Q_PROPERTY(int WriteBuffers READ getWriteBuffers WRITE setWriteBuffers)
     Q_PROPERTY(QString PyramidResamplingType READ getPyramidResamplingType WRITE setPyramidResamplingType)
     Q_PROPERTY(QStringList PyramidResamplingEnum READ getPyramidResamplingEnum)
     Q_PROPERTY(bool RGBMode READ getRGBMode WRITE setRGBMode)
@@ -83,6 +84,7 @@ public:
     NMPropertyGetSet( StreamingMethodType, QString )
     NMPropertyGetSet( StreamingMethodEnum, QStringList)
     NMPropertyGetSet( StreamingSize, int )
+    NMPropertyGetSet( WriteBuffers, int )
     //NMPropertyGetSet( NumProcs, int )
 
     void setWriteProcs(int procs);
@@ -131,6 +133,7 @@ protected:
     QStringList mPyramidResamplingEnum;
 
     int mStreamingSize;
+    int mWriteBuffers;
     int mWriteProcs;
     QString mStreamingMethodType;
     QStringList mStreamingMethodEnum;
@@ -174,6 +177,7 @@ protected:
                                const QMap<QString, NMModelComponent*>& repo);
     void setInternalStreamingMethod();
     void setInternalStreamingSize();
+    void setInternalWriteBuffers();
     void setInternalForcedLargestPossibleRegion(itk::ImageIORegion& ior);
     void setInternalUpdateRegion(itk::ImageIORegion& ior);
     void setInternalParallelIO(void);
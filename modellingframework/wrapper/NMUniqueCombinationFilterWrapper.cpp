@@ -532,6 +532,9 @@ NMUniqueCombinationFilterWrapper
     mUserProperties.insert(QStringLiteral("OutputNumDimensions"), QStringLiteral("NumDimensions"));
     mUserProperties.insert(QStringLiteral("OutputImageFileName"), QStringLiteral("OutputImageFileName"));
     mUserProperties.insert(QStringLiteral("InputNodata"), QStringLiteral("NodataValue"));
+
+    // writes the output image (and its table)
+    this->mbCacheResult = false;
 }
 
 NMUniqueCombinationFilterWrapper
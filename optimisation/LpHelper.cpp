@@ -374,6 +374,43 @@ bool HLpHelper::AddConstraintEx(int count, double *row, int *colno, int constr_t
 		return false;
 }
 
+bool HLpHelper::AddConstraintBlock(int numRows, const long *rowPtr, const double *row, const int *colno,
+								   const int *constr_types, const double *rh, const std::string *names)
+{
+	//check valid lp
+	if (!this->CheckLp())
+		return false;
+
+	const bool bRowmode = is_add_rowmode(this->m_pLp);
+	if (!bRowmode)
+		set_add_rowmode(this->m_pLp, TRUE);
+
+	bool ret = true;
+	int rowno = get_Nrows(this->m_pLp);
+	for (int r=0; r < numRows && ret; ++r)
+	{
+		const int count = static_cast<int>(rowPtr[r+1] - rowPtr[r]);
+		if (!add_constraintex(this->m_pLp, count,
+				const_cast<REAL*>(row + rowPtr[r]), const_cast<int*>(colno + rowPtr[r]),
+				constr_types[r], (REAL)rh[r]))
+		{
+			ret = false;
+			break;
+		}
+
+		++rowno;
+		if (names != 0 && !names[r].empty())
+		{
+			set_row_name(this->m_pLp, rowno, const_cast<char*>(names[r].c_str()));
+		}
+	}
+
+	if (!bRowmode)
+		set_add_rowmode(this->m_pLp, FALSE);
+
+	return ret;
+}
+
 bool HLpHelper::SetColumnEx(int col_no, int count, double *column, int *rowno)
 {
 	//check valid lp
@@ -422,6 +459,30 @@ bool HLpHelper::SetAddRowmode(bool turnon)
 		return false;
 }
 
+bool HLpHelper::GetBasis(int *bascolumn, bool nonbasic)
+{
+	//check valid lp
+	if (!this->CheckLp())
+		return false;
+
+	if (get_basis(m_pLp, bascolumn, nonbasic))
+		return true;
+	else
+		return false;
+}
+
+bool HLpHelper::SetBasis(int *bascolumn, bool nonbasic)
+{
+	//check valid lp
+	if (!this->CheckLp())
+		return false;
+
+	if (set_basis(m_pLp, bascolumn, nonbasic))
+		return true;
+	else
+		return false;
+}
+
 bool HLpHelper::SetInt(int column, bool must_be_int)
 {
 	//check valid lp
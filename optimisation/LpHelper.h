@@ -46,10 +46,20 @@ public:
     bool AddColumn(double* column);
     bool AddColumnEx(int count, double *column, int *rowno);
     bool AddConstraintEx(int count, double *row, int *colno, int constr_type, double rh);
+    /*! adds numRows constraints given in compressed sparse row form, i.e. the
+     *  coefficients of row r are row[rowPtr[r]] ... row[rowPtr[r+1]-1]; all
+     *  rows are added within one add_rowmode section, so lp_solve only
+     *  transposes them into its column storage once; names are optional */
+    bool AddConstraintBlock(int numRows, const long *rowPtr, const double *row, const int *colno,
+                            const int *constr_types, const double *rh, const std::string *names=0);
     bool SetColumnEx(int col_no, int count, double *column, int *rowno);
     bool SetRowEx(int row_no, int count, double *row, int *colno);
     bool SetObjFnEx(int count, double *row, int *colno);
     bool SetAddRowmode(bool turnon);
+    /*! get/set the basis (1 + rows + columns elements, if nonbasic is true);
+     *  a basis set before Solve() is used as starting point (warm start) */
+    bool GetBasis(int *bascolumn, bool nonbasic);
+    bool SetBasis(int *bascolumn, bool nonbasic);
     bool SetColName(int column, std::string new_name);
     bool SetLpName(std::string sLpName);
     bool SetRowName(int row, std::string new_name);
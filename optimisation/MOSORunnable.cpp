@@ -6,10 +6,15 @@
  */
 
 
+#include <vector>
+
 #include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
 #include <QDir>
 #include <QObject>
 #include <QScopedPointer>
+#include <QMutexLocker>
 
 #include "nmlog.h"
 
@@ -26,6 +31,10 @@
 #include "NMMosra.h"
 #include "MOSORunnable.h"
 
+QMutex MOSORunnable::sMutex;
+QMap<QString, vtkSmartPointer<vtkDataSet> > MOSORunnable::sSharedDataSets;
+QSet<QString> MOSORunnable::sSummaryFiles;
+
 MOSORunnable::MOSORunnable()
 	: mLogger(nullptr)
 {
@@ -55,9 +64,29 @@ MOSORunnable::setData(QString dsfileName,
 	mNumRuns = numruns;
 }
 
+void
+MOSORunnable::releaseSharedDataSets()
+{
+    QMutexLocker lock(&sMutex);
+    sSharedDataSets.clear();
+    sSummaryFiles.clear();
+}
+
 bool
 MOSORunnable::loadDataSet(NMMosra* mosra)
 {
+    // we've already got the data set for this chain
+    if (mVtkDS.GetPointer() != nullptr)
+    {
+        mosra->setDataSet(mVtkDS.GetPointer());
+        return true;
+    }
+    else if (mOtbTab.IsNotNull())
+    {
+        mosra->setDataSet(mOtbTab);
+        return true;
+    }
+
     if (mDsFileName.isEmpty())
     {
         return false;
@@ -75,18 +104,33 @@ MOSORunnable::loadDataSet(NMMosra* mosra)
     const QString suffix = dsInfo.suffix();
     if (suffix.compare("vtk") == 0)
     {
-        vtkSmartPointer<vtkPolyDataReader> reader = vtkSmartPointer<vtkPolyDataReader>::New();
-        reader->SetFileName(mDsFileName.toStdString().c_str());
+        // the file is only read once per batch; each chain
+        // works on its own copy, since perturbations and
+        // results are written into the data set
+        QMutexLocker lock(&sMutex);
+        vtkSmartPointer<vtkDataSet> shared = sSharedDataSets.value(mDsFileName);
+        if (shared.GetPointer() == nullptr)
+        {
+            vtkSmartPointer<vtkPolyDataReader> reader = vtkSmartPointer<vtkPolyDataReader>::New();
+            reader->SetFileName(mDsFileName.toStdString().c_str());
 
-        reader->Update();
+            reader->Update();
 
-        vtkPolyData* pd = reader->GetOutput();
-        if (pd == nullptr)
-        {
-            return false;
+            vtkPolyData* pd = reader->GetOutput();
+            if (pd == nullptr)
+            {
+                return false;
+            }
+
+            shared = pd;
+            sSharedDataSets.insert(mDsFileName, shared);
         }
 
-        mosra->setDataSet(pd);
+        vtkSmartPointer<vtkPolyData> pd = vtkSmartPointer<vtkPolyData>::New();
+        pd->DeepCopy(shared);
+        mVtkDS = pd;
+
+        mosra->setDataSet(mVtkDS.GetPointer());
     }
     else if (dbFormats.contains(suffix, Qt::CaseInsensitive))
     {
@@ -96,12 +140,62 @@ MOSORunnable::loadDataSet(NMMosra* mosra)
             return false;
         }
 
-        mosra->setDataSet(stab.GetPointer());
+        mOtbTab = stab.GetPointer();
+        mosra->setDataSet(mOtbTab);
     }
 
     return true;
 }
 
+void
+MOSORunnable::appendBatchSummary(const QString& fileName, const QString& level,
+                                 int run, NMMosra* mosra, vtkTable* totals)
+{
+    QMutexLocker lock(&sMutex);
+
+    // (re-)create the summary with the first run of the batch
+    const bool bNew = !sSummaryFiles.contains(fileName);
+    QFile file(fileName);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | QIODevice::Text;
+    mode |= bNew ? QIODevice::Truncate : QIODevice::Append;
+    if (!file.open(mode))
+    {
+        NMErr("MOSORunnable", << "Failed writing batch summary '"
+              << fileName.toStdString() << "'!");
+        return;
+    }
+    sSummaryFiles.insert(fileName);
+
+    QTextStream out(&file);
+    out.setRealNumberPrecision(15);
+    if (bNew)
+    {
+        out << "perturbation,levels,run,status,objective,option,criterion,value" << endl;
+    }
+
+    const QString runInfo = QString("\"%1\",\"%2\",%3,%4,%5")
+            .arg(mPerturbItem).arg(level).arg(run)
+            .arg(mosra->getLp()->GetLastReturnFromSolve())
+            .arg(mosra->getLp()->GetObjective(), 0, 'g', 15);
+
+    if (totals == nullptr || totals->GetNumberOfColumns() < 2)
+    {
+        out << runInfo << ",,," << endl;
+        return;
+    }
+
+    for (vtkIdType r=0; r < totals->GetNumberOfRows(); ++r)
+    {
+        const QString option = totals->GetValue(r, 0).ToString().c_str();
+        for (vtkIdType c=1; c < totals->GetNumberOfColumns(); ++c)
+        {
+            out << runInfo << ",\"" << option << "\",\""
+                << totals->GetColumnName(c) << "\","
+                << totals->GetValue(r, c).ToString().c_str() << endl;
+        }
+    }
+}
+
 void
 MOSORunnable::run()
 {
@@ -136,6 +230,13 @@ MOSORunnable::run()
 
     NMMsg(<< "Starting run=" << startIdx);
 
+    // each run of a chain starts from the previous run's solution
+    mosra->setWarmStart(numruns > 1);
+
+    // original values of the fields perturbed by each run
+    QStringList perturbFields;
+    std::vector<std::vector<double> > perturbOrigValues;
+
 
     for (int runs=startIdx; runs <= (numruns+startIdx-1); ++runs)
 	{
@@ -160,6 +261,20 @@ MOSORunnable::run()
 
         if (!mPerturbItem.isEmpty())
         {
+            // undo the previous run's perturbation
+            if (runs == startIdx)
+            {
+                perturbFields = mosra->getPerturbationFields(perturbItem);
+                if (!mosra->getFieldValues(perturbFields, perturbOrigValues))
+                {
+                    return;
+                }
+            }
+            else if (!mosra->setFieldValues(perturbFields, perturbOrigValues))
+            {
+                return;
+            }
+
             // bail out, if perturbation doesn't go to plan!
             if (!mosra->perturbCriterion(perturbItem, mflLevels))
             {
@@ -169,7 +284,7 @@ MOSORunnable::run()
 
         // --------------------------------------------------------------------------
         // names for output files
-        QString sRepName, lpName, perturbName, resName, chngName, relName, totName;
+        QString sRepName, lpName, perturbName, resName, chngName, relName, totName, batchName;
 
         if (mosra->doBatch())
         {
@@ -196,6 +311,9 @@ MOSORunnable::run()
 
             totName = QString("%1/tot_%2_p%3-%4.csv").arg(dsInfo.path())
                     .arg(dsInfo.baseName()).arg(level).arg(runs);
+
+            batchName = QString("%1/batch_%2.csv").arg(dsInfo.path())
+                    .arg(dsInfo.baseName());
         }
         else
         {
@@ -258,13 +376,23 @@ MOSORunnable::run()
         if (!mosra->solveLp())
         {
             mosra->writeReport(sRepName);
+            if (!batchName.isEmpty())
+            {
+                appendBatchSummary(batchName, level, runs, mosra.data(), nullptr);
+            }
 			continue;
         }
         mosra->getLp()->WriteLp(lpName.toStdString());
         mosra->writeReport(sRepName);
 
 		if (!mosra->mapLp())
+        {
+            if (!batchName.isEmpty())
+            {
+                appendBatchSummary(batchName, level, runs, mosra.data(), nullptr);
+            }
 			continue;
+        }
 
         vtkSmartPointer<vtkTable> tab = mosra->getDataSetAsTable();
 
@@ -332,6 +460,11 @@ MOSORunnable::run()
         writer->SetFileName(totName.toStdString().c_str());
         writer->Update();
 
+        if (!batchName.isEmpty())
+        {
+            appendBatchSummary(batchName, level, runs, mosra.data(), totals);
+        }
+
         // create table only containing relative changes (%)
         // from original result table
         for (int i=0; i < numCri; ++i)
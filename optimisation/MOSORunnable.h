@@ -10,11 +10,32 @@
 
 #include <qrunnable.h>
 #include <QString>
+#include <QMutex>
+#include <QMap>
+#include <QSet>
+
+#include "vtkSmartPointer.h"
+#include "vtkDataSet.h"
+#include "vtkTable.h"
+#include "otbAttributeTable.h"
 
 #include "NMLogger.h"
 
 class NMMosra;
 
+/*!
+ * \brief MOSORunnable runs a chain of optimisation runs for a
+ *        given perturbation item and set of uncertainty levels
+ *
+ * The data set is loaded once per chain (vtk data sets are
+ * read only once per batch and shared between chains, cf.
+ * releaseSharedDataSets()); before each run, the fields
+ * perturbed by the previous run are restored from their
+ * original values. Each run is warm-started from the
+ * basis of the previous run's solution and its summary is
+ * appended to the batch summary table batch_<data set>.csv.
+ */
+
 class MOSORunnable: public QRunnable
 {
 public:
@@ -30,8 +51,13 @@ public:
 	void run();
 	void setLogger(NMLogger* logger) { mLogger = logger; }
 
+    /*! releases the vtk data sets shared between runnables */
+    static void releaseSharedDataSets();
+
 protected:
     bool loadDataSet(NMMosra* mosra);
+    void appendBatchSummary(const QString& fileName, const QString& level,
+                            int run, NMMosra* mosra, vtkTable* totals);
 
 private:
 	NMLogger* mLogger;
@@ -42,6 +68,14 @@ private:
     QList<float> mflLevels;
 	int mStartIdx;
 	int mNumRuns;
+
+    // the data set of this chain
+    vtkSmartPointer<vtkDataSet> mVtkDS;
+    otb::AttributeTable::Pointer mOtbTab;
+
+    static QMutex sMutex;
+    static QMap<QString, vtkSmartPointer<vtkDataSet> > sSharedDataSets;
+    static QSet<QString> sSummaryFiles;
 };
 
 #endif /* MOSORUNNABLE_H_ */
@@ -81,6 +81,9 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
 #include <QFile>
 #include <QTextStream>
@@ -119,6 +122,7 @@
 #include "vtkDelimitedTextWriter.h"
 
 #include "NMMosra.h"
+#include "NMMosraRowBlock.h"
 
 
 ////////////////////////////////
@@ -653,6 +657,243 @@ NMMosraDataSet::getStrValue(int col, int row)
     return val;
 }
 
+bool
+NMMosraDataSet::getColumnValues(const QStringList &colnames,
+                                std::vector<std::vector<double> > &values)
+{
+    const int nrecs = this->getNumRecs();
+    const int ncols = colnames.size();
+    values.resize(ncols);
+    for (int c=0; c < ncols; ++c)
+    {
+        values[c].assign(nrecs, 0.0);
+    }
+
+    if (ncols == 0 || nrecs == 0)
+    {
+        return true;
+    }
+
+    bool ret = false;
+    switch(mType)
+    {
+    case NM_MOSRA_DS_VTKDS:
+        {
+            vtkDataSetAttributes* dsAttr = mVtkDS->GetAttributes(vtkDataSet::CELL);
+            if (dsAttr == nullptr)
+            {
+                break;
+            }
+
+            ret = true;
+            for (int c=0; c < ncols && ret; ++c)
+            {
+                vtkDataArray* da = vtkDataArray::SafeDownCast(
+                            dsAttr->GetAbstractArray(colnames.at(c).toStdString().c_str()));
+                if (da == nullptr)
+                {
+                    MosraLogError(<< "Failed fetching values of column '"
+                                  << colnames.at(c).toStdString() << "'!");
+                    ret = false;
+                    break;
+                }
+
+                double* pv = values[c].data();
+                for (int r=0; r < nrecs; ++r)
+                {
+                    pv[r] = da->GetTuple1(r);
+                }
+            }
+        }
+        break;
+
+    case NM_MOSRA_DS_OTBTAB:
+        {
+            std::vector<int> colidx(ncols, -1);
+            for (int c=0; c < ncols; ++c)
+            {
+                colidx[c] = mOtbTab->ColumnExists(colnames.at(c).toStdString());
+                if (colidx[c] < 0)
+                {
+                    MosraLogError(<< "Failed fetching values of column '"
+                                  << colnames.at(c).toStdString() << "'!");
+                    return false;
+                }
+            }
+
+            if (mOtbTab->GetTableType() == otb::AttributeTable::ATTABLE_TYPE_SQLITE)
+            {
+                // one pass over the table; rows are put in place
+                // by their primary key, just like getDblValue
+                // would identify them
+                otb::SQLiteTable* sqltab = static_cast<otb::SQLiteTable*>(mOtbTab.GetPointer());
+                std::vector<std::string> vcolnames;
+                vcolnames.push_back(sqltab->GetPrimaryKey());
+                for (int c=0; c < ncols; ++c)
+                {
+                    vcolnames.push_back(colnames.at(c).toStdString());
+                }
+
+                sqltab->BeginTransaction();
+                if (!sqltab->PrepareBulkGet(vcolnames, ""))
+                {
+                    MosraLogError(<< "Failed preparing bulk column fetch!");
+                    sqltab->EndTransaction();
+                    break;
+                }
+
+                std::vector<otb::AttributeTable::ColumnValue> rowvals(vcolnames.size());
+                while (sqltab->DoBulkGet(rowvals))
+                {
+                    const long long row = rowvals[0].type == otb::AttributeTable::ATTYPE_DOUBLE
+                                        ? static_cast<long long>(rowvals[0].dval)
+                                        : rowvals[0].ival;
+                    if (row < 0 || row >= nrecs)
+                    {
+                        continue;
+                    }
+
+                    for (int c=0; c < ncols; ++c)
+                    {
+                        const otb::AttributeTable::ColumnValue& cv = rowvals[c+1];
+                        values[c][row] = cv.type == otb::AttributeTable::ATTYPE_INT
+                                       ? static_cast<double>(cv.ival)
+                                       : cv.dval;
+                    }
+                }
+                sqltab->EndTransaction();
+                ret = true;
+            }
+            else
+            {
+                for (int c=0; c < ncols; ++c)
+                {
+                    double* pv = values[c].data();
+                    for (int r=0; r < nrecs; ++r)
+                    {
+                        pv[r] = mOtbTab->GetDblValue(colidx[c], r);
+                    }
+                }
+                ret = true;
+            }
+        }
+        break;
+
+    case NM_MOSRA_DS_QTSQL:
+        {
+            if (mSqlMod == nullptr)
+            {
+                break;
+            }
+
+            QSqlDatabase db = mSqlMod->database();
+            QSqlDriver* drv = db.driver();
+
+            QString colstr = drv->escapeIdentifier(mPrimaryKey, QSqlDriver::FieldName);
+            for (int c=0; c < ncols; ++c)
+            {
+                colstr += QString(",%1").arg(drv->escapeIdentifier(colnames.at(c), QSqlDriver::FieldName));
+            }
+
+            const QString qStr = QString("SELECT %1 from %2")
+                    .arg(colstr)
+                    .arg(drv->escapeIdentifier(mTableName, QSqlDriver::TableName));
+
+            QSqlQuery q(db);
+            q.setForwardOnly(true);
+            if (!q.exec(qStr))
+            {
+                MosraLogError(<< "Failed fetching column values: "
+                              << qStr.toStdString() << std::endl
+                              << "ERROR: " << q.lastError().text().toStdString());
+                q.finish();
+                break;
+            }
+
+            while (q.next())
+            {
+                const int row = q.value(0).toInt();
+                if (row < 0 || row >= nrecs)
+                {
+                    continue;
+                }
+
+                for (int c=0; c < ncols; ++c)
+                {
+                    values[c][row] = q.value(c+1).toDouble();
+                }
+            }
+            q.finish();
+            ret = true;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+bool
+NMMosraDataSet::setColumnValues(const QStringList &colnames,
+                                const std::vector<std::vector<double> > &values)
+{
+    const int nrecs = this->getNumRecs();
+    const int ncols = std::min<int>(colnames.size(), values.size());
+
+    bool ret = true;
+    if (mType == NM_MOSRA_DS_VTKDS)
+    {
+        vtkDataSetAttributes* dsAttr = mVtkDS->GetAttributes(vtkDataSet::CELL);
+        if (dsAttr == nullptr)
+        {
+            return false;
+        }
+
+        for (int c=0; c < ncols; ++c)
+        {
+            vtkDataArray* da = vtkDataArray::SafeDownCast(
+                        dsAttr->GetAbstractArray(colnames.at(c).toStdString().c_str()));
+            if (da == nullptr || values[c].size() < static_cast<size_t>(nrecs))
+            {
+                MosraLogError(<< "Failed setting values of column '"
+                              << colnames.at(c).toStdString() << "'!");
+                ret = false;
+                continue;
+            }
+
+            for (int r=0; r < nrecs; ++r)
+            {
+                da->SetTuple1(r, values[c][r]);
+            }
+            da->Modified();
+        }
+    }
+    else
+    {
+        this->beginTransaction();
+        for (int c=0; c < ncols; ++c)
+        {
+            if (values[c].size() < static_cast<size_t>(nrecs))
+            {
+                MosraLogError(<< "Failed setting values of column '"
+                              << colnames.at(c).toStdString() << "'!");
+                ret = false;
+                continue;
+            }
+
+            for (int r=0; r < nrecs; ++r)
+            {
+                this->setDblValue(colnames.at(c), r, values[c][r]);
+            }
+        }
+        this->endTransaction();
+    }
+
+    return ret;
+}
+
 QVariant
 NMMosraDataSet::getQSqlTableValue(const QString &column, int row)
 {
@@ -1800,6 +2041,17 @@ NMMosraDataSet::getRowValues(QVariantList &values, const int &row)
 
 const std::string NMMosra::ctxNMMosra = "NMMosra";
 
+// area based coefficients have always been passed through
+// QString("%1").arg(val, 0, 'g') and atof, i.e. rounded to
+// 6 significant digits; this does the same w/o QString, so
+// it can be used by concurrent constraint builders
+static inline double roundAreaCoeff(double val)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%g", val);
+    return std::atof(buf);
+}
+
 NMMosra::NMMosra(QObject* parent) //: QObject(parent)
     : mProblemFilename(""), mProblemType(NM_MOSO_LP)
 {
@@ -1811,6 +2063,7 @@ NMMosra::NMMosra(QObject* parent) //: QObject(parent)
     this->mProcObj = 0;
     this->setParent(parent);
     this->mLp = new HLpHelper();
+    this->mbWarmStart = false;
     this->reset();
 
     mScenarioName = "My Optimisation Scenario";
@@ -1899,6 +2152,7 @@ void NMMosra::reset(void)
     this->mlLpCols = 0;
     this->mdAreaSelected = 0;
     this->mdAreaTotal = 0;
+    this->mvOptFeatRows.clear();
 
     this->muiTimeOut = 60;
     this->miNumOptions = 0;
@@ -2762,15 +3016,38 @@ int NMMosra::configureProblem(void)
         }
     }
 
-    this->mLp->SetPresolve(PRESOLVE_COLS |
-                           PRESOLVE_ROWS |
-                           PRESOLVE_IMPLIEDFREE |
-                           PRESOLVE_REDUCEGCD |
-                           PRESOLVE_MERGEROWS |
-                           PRESOLVE_ROWDOMINATE |
-                           PRESOLVE_COLDOMINATE |
-                           PRESOLVE_KNAPSACK |
-                           PRESOLVE_PROBEFIX);
+    if (this->mbWarmStart)
+    {
+        // lp_solve only accepts (and hands back) the basis
+        // of the full model, so we leave it alone
+        this->mLp->SetPresolve(PRESOLVE_NONE);
+
+        const size_t basisSize = 1 + this->mLp->GetNRows() + this->mLp->GetNColumns();
+        if (this->mvBasis.size() == basisSize)
+        {
+            if (this->mLp->SetBasis(this->mvBasis.data(), true))
+            {
+                MosraLogInfo(<< "solver starts from the previous solution's basis");
+            }
+            else
+            {
+                MosraLogWarn(<< "Failed setting the previous solution's basis - "
+                             << "solver starts from scratch!");
+            }
+        }
+    }
+    else
+    {
+        this->mLp->SetPresolve(PRESOLVE_COLS |
+                               PRESOLVE_ROWS |
+                               PRESOLVE_IMPLIEDFREE |
+                               PRESOLVE_REDUCEGCD |
+                               PRESOLVE_MERGEROWS |
+                               PRESOLVE_ROWDOMINATE |
+                               PRESOLVE_COLDOMINATE |
+                               PRESOLVE_KNAPSACK |
+                               PRESOLVE_PROBEFIX);
+    }
 
     this->mLp->SetScaling(SCALE_GEOMETRIC |
                           SCALE_DYNUPDATE);
@@ -2785,6 +3062,19 @@ void NMMosra::solveProblem(void)
 
     this->mLp->Solve();
 
+    // keep the basis of a (sub-)optimal solution for the next run
+    if (this->mbWarmStart)
+    {
+        const int ret = this->mLp->GetLastReturnFromSolve();
+        this->mvBasis.resize(1 + this->mLp->GetNRows() + this->mLp->GetNColumns());
+        if (    (ret != 0 && ret != 1)
+             || !this->mLp->GetBasis(this->mvBasis.data(), true)
+           )
+        {
+            this->mvBasis.clear();
+        }
+    }
+
     if (this->calcOptPerformanceDb() == 0)
     {
         MosraLogWarn(<< "Hit trouble calculating the optimal performance!"
@@ -4196,6 +4486,40 @@ int NMMosra::makeLp(void)
     bool hole = mDataSet->hasColumn("nm_hole");
     int optFeatIdx = mDataSet->getColumnIndex(this->msOptFeatures);
 
+    // fetch the hole and selection flags in one go and
+    // note the features subject to optimisation, so the
+    // constraint builders don't need to look at them again
+    QStringList maskCols;
+    if (hole)
+    {
+        maskCols << QStringLiteral("nm_hole");
+    }
+    if (optFeatIdx != -1)
+    {
+        maskCols << this->msOptFeatures;
+    }
+
+    std::vector<std::vector<double> > maskValues;
+    if (!mDataSet->getColumnValues(maskCols, maskValues))
+    {
+        MosraLogError(<< "makeLp(): failed fetching the optimisation features!");
+        NMDebugCtx(ctxNMMosra, << "done!");
+        return 0;
+    }
+
+    this->mvOptFeatRows.clear();
+    this->mvOptFeatRows.reserve(this->mlNumOptFeat);
+    for (int of=0; of < lNumCells; ++of)
+    {
+        if (    (hole && static_cast<int>(maskValues[0][of]) == 1)
+             || (optFeatIdx != -1 && static_cast<int>(maskValues.back()[of]) == 0)
+           )
+        {
+            continue;
+        }
+        this->mvOptFeatRows.push_back(of);
+    }
+
     this->mLp->MakeLp(0,this->mlLpCols);
     long colPos = 1;
     int featCount = 0;
@@ -4204,22 +4528,17 @@ int NMMosra::makeLp(void)
     // matches the actual feature rowidx in the dataset, otherwise
     // would have trouble mapping the final results back to the
     // right features!
-    for (int of=0; of < lNumCells; ++of)//, ++colPos)
+    for (size_t k=0; k < this->mvOptFeatRows.size(); ++k)
     {
-        if (    (hole && mDataSet->getIntValue("nm_hole", of) == 1)
-             || (optFeatIdx != -1 && mDataSet->getIntValue(this->msOptFeatures, of) == 0)
-           )
-        {
-            continue;
-        }
+        const std::string sFeat = std::to_string(this->mvOptFeatRows[k]);
 
-        QString colname;
+        std::string colname;
         for (int opt=1; opt <= this->miNumOptions; ++opt, ++colPos)
         {
-            colname = QString(tr("X_%1_%2")).arg(of).arg(opt);
-            this->mLp->SetColName(colPos, colname.toStdString());
+            colname = "X_" + sFeat + "_" + std::to_string(opt);
+            this->mLp->SetColName(colPos, colname);
 
-            //MosraLogInfo(<< "#" << colPos << ": " << colname.toStdString() << std::endl);
+            //MosraLogInfo(<< "#" << colPos << ": " << colname << std::endl);
 
             // set variable type for areal decision variables
             switch(this->meDVType)
@@ -4238,14 +4557,15 @@ int NMMosra::makeLp(void)
         {
             // the LU index here is '0' to indicate this variable
             // refers to the whole parcel!
-            colname = QString(tr("R_%1_0_%2")).arg(of).arg(inc);
-            this->mLp->SetColName(colPos, colname.toStdString());
+            const std::string sInc = std::to_string(inc);
+            colname = "R_" + sFeat + "_0_" + sInc;
+            this->mLp->SetColName(colPos, colname);
             ++colPos;
 
             for (int opt=1; opt <= this->miNumOptions; ++opt, ++colPos)
             {
-                colname = QString(tr("R_%1_%2_%3")).arg(of).arg(opt).arg(inc);
-                this->mLp->SetColName(colPos, colname.toStdString());
+                colname = "R_" + sFeat + "_" + std::to_string(opt) + "_" + sInc;
+                this->mLp->SetColName(colPos, colname);
             }
         }
 
@@ -4290,6 +4610,63 @@ NMMosra::getDataSetAsTable()
 }
 
 
+QStringList
+NMMosra::getPerturbationFields(const QString& criterion)
+{
+    // cf. perturbCriterion for how the fields are identified
+    QStringList fields;
+    const QStringList metaList = criterion.split(",", QString::SkipEmptyParts);
+    if (metaList.size() == 0)
+    {
+        return fields;
+    }
+
+    const QString fstItem = metaList.at(0).trimmed();
+
+    // constraints don't touch the data set
+    if (    fstItem.startsWith(QStringLiteral("OBJ"))
+         || fstItem.startsWith(QStringLiteral("CRI"))
+       )
+    {
+        return fields;
+    }
+    else if (fstItem.startsWith(QStringLiteral("INC")))
+    {
+        for (int m=0; m < metaList.size(); ++m)
+        {
+            const QStringList incDetails = metaList.at(m).trimmed().split(":", QString::SkipEmptyParts);
+            if (incDetails.size() >= 2 && this->mmslIncentives.contains(incDetails.at(1)))
+            {
+                const QString incField = this->mmslIncentives[incDetails.at(1)].at(0);
+                if (!fields.contains(incField))
+                {
+                    fields << incField;
+                }
+            }
+        }
+    }
+    else
+    {
+        for (int ptbItem=0; ptbItem < metaList.size(); ++ptbItem)
+        {
+            const QStringList splitCriterion = metaList.at(ptbItem).trimmed().split(":", QString::SkipEmptyParts);
+            if (splitCriterion.size() < 2)
+            {
+                continue;
+            }
+
+            const int optIdx = this->mslOptions.indexOf(splitCriterion.at(1));
+            const QStringList criFields = this->mmslCriteria.value(splitCriterion.at(0));
+            if (optIdx >= 0 && optIdx < criFields.size() && !fields.contains(criFields.at(optIdx)))
+            {
+                fields << criFields.at(optIdx);
+            }
+        }
+    }
+
+    return fields;
+}
+
 bool
 NMMosra::perturbCriterion(const QString& criterion,
         const QList<float>& percent)
@@ -5428,6 +5805,11 @@ int NMMosra::addZoneCons(void)
     NMDebugCtx(ctxNMMosra, << "...");
     MosraLogInfo(<< "adding non-overlapping zone constraints ...");
 
+    const long lNumFeat = this->mvOptFeatRows.size();
+    const int miNumInc = mmslIncentives.size();
+    const int skipIncColOffset = miNumInc * miNumOptions + miNumInc;
+    const long lFeatColOffset = this->miNumOptions + skipIncColOffset;
+
     // iterate over the table to fetch the data and put it into the maps
     // and vectors
     QMap<QString, QStringList>::ConstIterator zconsIt = mslZoneConstraints.constBegin();
@@ -5435,9 +5817,7 @@ int NMMosra::addZoneCons(void)
     {
         // ... for each zone
         QMap<int, double>           mRHS;
-        QMap<int, QVector<int> >    mZoneRowIds;
-        QMap<int, QStringList>      mvPerformanceFields;
-        QMap<int, QStringList>      mvIncFields;
+        QMap<int, QVector<long> >   mZoneFeatIds;
         QMap<int, QVector<int> >    mvResourceIdx;
         int                         consOp;
 
@@ -5472,202 +5852,130 @@ int NMMosra::addZoneCons(void)
         }
         QStringList allPerfFields = mmslCriteria[zconsIt.value().at(2)];
 
-        //========================================================================================
-        // loop over the data set and identify zone and track required information
-        const int miNumInc = mmslIncentives.size();
-        const int skipIncColOffset = miNumInc * miNumOptions + miNumInc;
-        const bool hole = mDataSet->hasColumn("nm_hole");
-        const int optFeatIdx = mDataSet->getColumnIndex(this->msOptFeatures);
-        const long lNumCells = mDataSet->getNumRecs();
-        long lRowCounter = this->mLp->GetNRows();
-        this->mLp->SetAddRowmode(true);
-
-        for (long f=0; f < lNumCells; ++f)
+        // get the incentives fields, if any, for this constraint
+        QStringList incFields;
+        if (this->mIncNamePair.size() > 0)
         {
-            if (    (hole && mDataSet->getIntValue("nm_hole", f) == 1)
-                    || (optFeatIdx != -1 && mDataSet->getIntValue(optFeatIdx, f) == 0)
-               )
+            QMap<QString, QStringList>::ConstIterator incIt = mIncNamePair.cbegin();
+            while (incIt != mIncNamePair.cend())
             {
-                continue;
+                if (zconsIt.value().at(2).compare(incIt.value().at(0), Qt::CaseInsensitive) == 0)
+                {
+                    incFields.push_back(incIt.value().at(1));
+                }
+                ++incIt;
             }
+        }
+        const int numIncs = incFields.size();
+
+        // fetch zone ids, thresholds, area, performance
+        // indicators and incentives of all features in one go
+        QStringList fetchCols;
+        fetchCols << zoneField << rhsField << this->msAreaField << allPerfFields << incFields;
 
-            int zoneID = mDataSet->getIntValue(zoneField, f);
-            if (mZoneRowIds.contains(zoneID))
+        std::vector<std::vector<double> > colValues;
+        if (!mDataSet->getColumnValues(fetchCols, colValues))
+        {
+            MosraLogError(<< "addZoneCons(): failed fetching the fields of '"
+                          << consLabel.toStdString() << "'!");
+            NMDebugCtx(ctxNMMosra, << "done!");
+            return 0;
+        }
+        const std::vector<double>& vdZone = colValues[0];
+        const std::vector<double>& vdRhs = colValues[1];
+        const std::vector<double>& vdArea = colValues[2];
+        const int perfColOffset = 3;
+        const int incColOffset = perfColOffset + allPerfFields.size();
+
+        //========================================================================================
+        // loop over the optimisation features and identify zones
+        const int resFieldIdx = bAllRes ? -1 : mDataSet->getColumnIndex(resField);
+        for (long k=0; k < lNumFeat; ++k)
+        {
+            const int f = this->mvOptFeatRows[k];
+            const int zoneID = static_cast<int>(vdZone[f]);
+            if (mZoneFeatIds.contains(zoneID))
             {
-                mZoneRowIds[zoneID].push_back(f);
+                mZoneFeatIds[zoneID].push_back(k);
             }
             else
             {
                 // add a new zone to the zone map
-                QVector<int> rows;
-                rows.push_back(f);
-                mZoneRowIds[zoneID] = rows;
+                QVector<long> feats;
+                feats.push_back(k);
+                mZoneFeatIds[zoneID] = feats;
 
                 // add a new rhs value to the rhs map
-                double rhs = mDataSet->getDblValue(rhsField, f);
-                mRHS[zoneID] = rhs;
+                mRHS[zoneID] = vdRhs[f];
 
                 // get the resource indices for this zone
-                // and the associated performance indicator fields
                 if (!bAllRes)
                 {
                     QVector<int> resIdx;
-                    QStringList perfFields;
-                    QStringList zoneRes = mDataSet->getStrValue(resField, f).split(" ", QString::SkipEmptyParts);
+                    QStringList zoneRes = mDataSet->getStrValue(resFieldIdx, f).split(" ", QString::SkipEmptyParts);
                     foreach(const QString& res, zoneRes)
                     {
                         int idx = mslOptions.indexOf(QRegExp(res, Qt::CaseInsensitive,  QRegExp::FixedString));
                         if (idx > 0)
                         {
                             resIdx.push_back(idx);
-                            perfFields.push_back(allPerfFields.at(idx));
                         }
                     }
 
                     mvResourceIdx[zoneID] = resIdx;
-                    mvPerformanceFields[zoneID] = perfFields;
                 }
-
-                // get the incentives fields, if any, for this zone
-                QStringList iFields;
-                if (this->mIncNamePair.size() > 0)
-                {
-                    QMap<QString, QStringList>::ConstIterator incIt = mIncNamePair.cbegin();
-                    while (incIt != mIncNamePair.cend())
-                    {
-                        if (zconsIt.value().at(2).compare(incIt.value().at(0), Qt::CaseInsensitive) == 0)
-                        {
-                            iFields.push_back(incIt.value().at(1));
-                        }
-                        ++incIt;
-                    }
-                }
-                mvIncFields[zoneID] = iFields;
             }
         }
 
         //=================================================================================
         // process identified zones
 
+        NMMosraRowBlock block;
+        std::vector<double> vdRow;
+        std::vector<int> viColno;
+
         int zoneCounter = 0;
-        QMap<int, QVector<int> >::ConstIterator zoneIt = mZoneRowIds.cbegin();
-        while (zoneIt != mZoneRowIds.cend())
+        QMap<int, QVector<long> >::ConstIterator zoneIt = mZoneFeatIds.cbegin();
+        while (zoneIt != mZoneFeatIds.cend())
         {
             const int zoneID = zoneIt.key();
-            double rhs = mRHS[zoneID];
-            int numCoeffs = 0;
-            int numRes = 0;
-            int numIncs = mvIncFields[zoneID].size();
-
-            if (bAllRes)
-            {
-                numRes = allPerfFields.size();
-            }
-            else
-            {
-                numRes = mvPerformanceFields[zoneID].size();
-            }
+            const QVector<int>& resix = bAllRes ? allResIds : mvResourceIdx[zoneID];
+            const int numRes = resix.size();
 
             // ...............................................................
-            // allocate row buffers and populate
-            const QVector<int>& vRows = zoneIt.value();
-            numCoeffs = (numRes + numIncs) * vRows.size();
+            // populate the row buffers
+            const QVector<long>& vFeats = zoneIt.value();
+            vdRow.clear();
+            viColno.clear();
+            vdRow.reserve((numRes + numRes * numIncs) * vFeats.size());
+            viColno.reserve((numRes + numRes * numIncs) * vFeats.size());
 
-            double* pdRow = new double[numCoeffs];
-            int* piColno = new int[numCoeffs];
-
-            long coeffCounter = 0;
-            for (int r=0; r < vRows.size(); ++r)
+            for (int r=0; r < vFeats.size(); ++r)
             {
-                long colPos = 1 + vRows[r] * (this->miNumOptions + (miNumOptions * mmslIncentives.size()) + mmslIncentives.size());
-                double coeff = 0.0;
-                if (bAllRes)
-                {
-                    for (int arpos=0; arpos < numRes; ++arpos)
-                    {
-                        if (this->meDVType == NMMosoDVType::NM_MOSO_BINARY)
-                        {
-                            coeff = mDataSet->getDblValue(this->msAreaField, vRows[r])
-                                    * mDataSet->getDblValue(allPerfFields[arpos], vRows[r]);
-                        }
-                        else
-                        {
-                            coeff = mDataSet->getDblValue(allPerfFields[arpos], vRows[r]);
-                        }
-                        pdRow[coeffCounter] = coeff;
-                        piColno[coeffCounter] = colPos + allResIds[arpos];
-                        ++coeffCounter;
-                    }
-                }
-                else
+                const int f = this->mvOptFeatRows[vFeats[r]];
+                const long colPos = 1 + vFeats[r] * lFeatColOffset;
+                const double areaFactor = this->meDVType == NMMosoDVType::NM_MOSO_BINARY ? vdArea[f] : 1.0;
+
+                for (int arpos=0; arpos < numRes; ++arpos)
                 {
-                    QStringList coeffFields = mvPerformanceFields[zoneID];
-                    QVector<int> resix = mvResourceIdx[zoneID];
-                    for (int arpos=0; arpos < numRes; ++arpos)
-                    {
-                        if (this->meDVType == NMMosoDVType::NM_MOSO_BINARY)
-                        {
-                            coeff = mDataSet->getDblValue(this->msAreaField, vRows[r])
-                                    * mDataSet->getDblValue(coeffFields[arpos], vRows[r]);
-                        }
-                        else
-                        {
-                            coeff = mDataSet->getDblValue(coeffFields[arpos], vRows[r]);
-                        }
-                        pdRow[coeffCounter] = coeff;
-                        piColno[coeffCounter] = colPos + resix[arpos];
-                        ++coeffCounter;
-                    }
+                    vdRow.push_back(areaFactor * colValues[perfColOffset + resix[arpos]][f]);
+                    viColno.push_back(colPos + resix[arpos]);
                 }
 
                 // add incentives, if applicable
-                if (mvIncFields[zoneID].size() > 0)
+                for (int inc=0; inc < numIncs; ++inc)
                 {
-                    QVector<int> optidx = mvResourceIdx[zoneID];
-                    QStringList incFields = mvIncFields[zoneID];
-                    for (int inc=0; inc < numIncs; ++inc)
+                    const double coeff = areaFactor * colValues[incColOffset + inc][f];
+                    for (int opt=0; opt < numRes; ++opt)
                     {
-                        if (this->meDVType == NMMosoDVType::NM_MOSO_BINARY)
-                        {
-                            coeff = mDataSet->getDblValue(incFields[inc], vRows[r])
-                                     * mDataSet->getDblValue(msAreaField, vRows[r]);
-                        }
-                        else
-                        {
-                            coeff = mDataSet->getDblValue(incFields[inc], vRows[r]);
-                        }
-
-                        if (bAllRes)
-                        {
-                            for (int opt=0; opt < numRes; ++opt)
-                            {
-                                pdRow[coeffCounter] = coeff;
-                                piColno[coeffCounter] = colPos + allResIds[opt] + (inc+1) * miNumOptions + 1 + inc;
-                                ++coeffCounter;
-                            }
-                        }
-                        else
-                        {
-                            for (int opt=0; opt < numRes; ++opt)
-                            {
-                                pdRow[coeffCounter] = coeff;
-                                piColno[coeffCounter] = colPos + optidx[opt] + (inc+1) * miNumOptions + 1 + inc;
-                                ++coeffCounter;
-                            }
-                        }
+                        vdRow.push_back(coeff);
+                        viColno.push_back(colPos + resix[opt] + (inc+1) * miNumOptions + 1 + inc);
                     }
                 }
             }
 
-            // add or modify constraint
-            this->mLp->AddConstraintEx(numCoeffs, pdRow, piColno, consOp, rhs);
-            ++lRowCounter;
-
-            QString zoneLabel = QString("%1_%2").arg(consLabel).arg(zoneID);
-            this->mLp->SetRowName(lRowCounter, zoneLabel.toStdString());
-
-            delete[] pdRow;
-            delete[] piColno;
+            block.appendRow(vdRow, viColno, consOp, mRHS[zoneID],
+                            QString("%1_%2").arg(consLabel).arg(zoneID).toStdString());
 
             if (zoneCounter % 200 == 0)
             {
@@ -5676,10 +5984,20 @@ int NMMosra::addZoneCons(void)
             ++zoneCounter;
             ++zoneIt;
         }
+
+        if (!this->mLp->AddConstraintBlock(block.getNumRows(), block.getRowPtr(),
+                                           block.getValues(), block.getColNo(),
+                                           block.getTypes(), block.getRHS(),
+                                           block.getNames()))
+        {
+            MosraLogError(<< "addZoneCons(): failed adding constraints for '"
+                          << consLabel.toStdString() << "'!");
+            NMDebugCtx(ctxNMMosra, << "done!");
+            return 0;
+        }
         ++zconsIt;
     }
 
-    this->mLp->SetAddRowmode(false);
     NMDebugCtx(ctxNMMosra, << "done!");
     return 1;
 }
@@ -5688,15 +6006,11 @@ int NMMosra::addFeatureCons(void)
 {
     NMDebugCtx(ctxNMMosra, << "...");
 
-    const bool hole = mDataSet->hasColumn("nm_hole");
-    const int optFeatIdx = mDataSet->getColumnIndex(this->msOptFeatures);
-
     std::vector<QString> vsConsLabel;
     std::vector<std::vector<unsigned int> > vvnOptionIndex;
     std::vector<unsigned int> vnConsType;
     std::vector<double> vdRHS;
 
-    long lNumCells = mDataSet->getNumRecs();
     double dUserVal;
     double dUserArea = 0.0;
     double dAreaTotal = this->mdAreaTotal;
@@ -5742,18 +6056,19 @@ int NMMosra::addFeatureCons(void)
 
 
     //----------------------------------------------
-    double* pdRow = 0;
-    int* piColno = 0;
-
-    long lId;
-    double dCoeff;
-
-    this->mLp->SetAddRowmode(true);
-    long lRowCounter = this->mLp->GetNRows();
+    std::vector<std::vector<double> > areaValues;
+    if (!mDataSet->getColumnValues(QStringList(this->msAreaField), areaValues))
+    {
+        MosraLogError(<< "addFeatureCons(): failed fetching the feature areas!");
+        NMDebugCtx(ctxNMMosra, << "done!");
+        return 0;
+    }
+    const std::vector<double>& vdArea = areaValues[0];
 
+    const long lNumFeat = this->mvOptFeatRows.size();
     const int iOffset = this->miNumOptions;
     const int skipIncentivesFeatOffset = this->mmslIncentives.size() * miNumOptions + mmslIncentives.size();
-
+    const long lFeatColOffset = iOffset + skipIncentivesFeatOffset;
 
     it = this->mmslFeatCons.constBegin();
     //-------------------------------------------------------------------- for each constraint
@@ -5761,80 +6076,63 @@ int NMMosra::addFeatureCons(void)
     {
         MosraLogDebug( << vsConsLabel.at(r).toStdString() << " - adding constraint" << endl);
 
-        const long numOptions = vvnOptionIndex.at(r).size();
-        pdRow = new double[numOptions];
-        piColno = new int[numOptions];
+        const int numOptions = vvnOptionIndex.at(r).size();
+        const int consType = vnConsType.at(r);
+        const double rhs = vdRHS.at(r);
+        const std::string sConsLabel = vsConsLabel.at(r).toStdString();
 
-        // determine initial offset for current option
+        // initial column of each option (for the first feature)
         std::vector<long> vlCounter;
         for (int no=0; no < numOptions; ++no)
         {
             vlCounter.push_back(vvnOptionIndex.at(r).at(no)+1);
         }
 
-        long nonHoleCounter = 0;
-
-        // --------------------------------- for each feature
-        for (int f=0; f < lNumCells; ++f)
-        {
-            if (    (hole && mDataSet->getIntValue("nm_hole", f) == 1)
-                    || (optFeatIdx != -1 && mDataSet->getIntValue(optFeatIdx, f) == 0)
-               )
-            {
-                continue;
-            }
-
-            dCoeff = mDataSet->getDblValue(this->msAreaField, f);
-            QString sConsVal = QString(tr("%1")).arg(dCoeff, 0, 'g');
-
-            long coeffCounter = 0;
-            for (int opt=0; opt < numOptions; ++opt)
+        // --------------------------------- one row per feature
+        NMMosraRowBlock block;
+        block.resize(lNumFeat, numOptions);
+        NMMosraRowBlock::parallelFor(lNumFeat,
+            [&](long beg, long end)
             {
-                switch(this->meDVType)
+                for (long k=beg; k < end; ++k)
                 {
-                case NMMosra::NM_MOSO_BINARY:
-                    pdRow[coeffCounter] = ::atof(sConsVal.toStdString().c_str());
-                    break;
-                default: // i.e. for all other DV  types (real, integer)
-                    pdRow[coeffCounter] = 1;
-                    break;
-                }
-
-                piColno[coeffCounter] = vlCounter[opt];
-                ++coeffCounter;
-            }
-
-
-            // add the constraint
-            this->mLp->AddConstraintEx(numOptions, pdRow, piColno
-                                       , vnConsType.at(r), vdRHS.at(r));
-
-            ++lRowCounter;
-            QString rowlabel = QString("feat%1_%2").arg(f).arg(vsConsLabel.at(r));
-            this->mLp->SetRowName(lRowCounter, rowlabel.toStdString());
+                    const int f = this->mvOptFeatRows[k];
+                    double* pdRow = block.rowValues(k);
+                    int* piColno = block.rowColNo(k);
 
+                    for (int opt=0; opt < numOptions; ++opt)
+                    {
+                        switch(this->meDVType)
+                        {
+                        case NMMosra::NM_MOSO_BINARY:
+                            pdRow[opt] = roundAreaCoeff(vdArea[f]);
+                            break;
+                        default: // i.e. for all other DV  types (real, integer)
+                            pdRow[opt] = 1;
+                            break;
+                        }
 
-            for (int opt=0; opt < numOptions; ++opt)
-            {
-                vlCounter[opt] += iOffset + skipIncentivesFeatOffset;
-            }
+                        piColno[opt] = vlCounter[opt] + k * lFeatColOffset;
+                    }
 
-            if (f % 500 == 0)
-            {
-                NMDebug(<< ".");
-            }
+                    block.setRow(k, consType, rhs,
+                                 "feat" + std::to_string(f) + "_" + sConsLabel);
+                }
+            });
 
-            ++nonHoleCounter;
+        if (!this->mLp->AddConstraintBlock(block.getNumRows(), block.getRowPtr(),
+                                           block.getValues(), block.getColNo(),
+                                           block.getTypes(), block.getRHS(),
+                                           block.getNames()))
+        {
+            MosraLogError(<< "addFeatureCons(): failed adding constraint '"
+                          << sConsLabel << "'!");
+            NMDebugCtx(ctxNMMosra, << "done!");
+            return 0;
         }
         NMDebug(<< "finished!" << endl);
-
-        delete[] pdRow;
-        delete[] piColno;
     }
 
-    this->mLp->SetAddRowmode(false);
-
-
     NMDebugCtx(ctxNMMosra, << "done!");
     return 1;
 }
@@ -6125,123 +6423,79 @@ int NMMosra::addImplicitAreaCons(void)
 {
     NMDebugCtx(ctxNMMosra, << "...");
 
-    // allocate memory for arrays
-    // we cover each feature separately, so we need miNumOptions coefficients
-    // plus the binary conditional to realise the either zero or all area
-    // constraint for each feature
-    double* pdRow = new double[this->miNumOptions];
-    int* piColno = new int[this->miNumOptions];
-
-    // get the hole array
-    const bool hole = mDataSet->hasColumn("nm_hole");
-    const int optFeatIdx = mDataSet->getColumnIndex(this->msOptFeatures);
-
-    const long lNumCells = mDataSet->getNumRecs();
-    //long lId;
-    double dConsVal;
-    //double dFeatID;
-    //double dVal;
+    // we cover each feature separately, so we need miNumOptions
+    // coefficients per constraint
+    std::vector<std::vector<double> > areaValues;
+    if (!mDataSet->getColumnValues(QStringList(this->msAreaField), areaValues))
+    {
+        MosraLogError(<< "addImplicitAreaCons(): failed fetching the feature areas!");
+        NMDebugCtx(ctxNMMosra, << "done!");
+        return 0;
+    }
+    const std::vector<double>& vdArea = areaValues[0];
 
+    const long lNumFeat = this->mvOptFeatRows.size();
     const int iNumIncentives = this->mmslIncentives.size();
     const int skipIncentivesOffset = iNumIncentives * miNumOptions + iNumIncentives;
+    const long lFeatColOffset = this->miNumOptions + skipIncentivesOffset;
 
-    // set add_row_mode for adding constraints
-    this->mLp->SetAddRowmode(true);
-
-    long lRowCounter = this->mLp->GetNRows();
-    long colpos = 1;
     // --------------------------------------------for each feature
-    for (int f=0; f < lNumCells; f++)
-    {
-        // leap over holes!
-        if (    (hole && mDataSet->getIntValue("nm_hole", f) == 1)
-                || (optFeatIdx != -1 && mDataSet->getIntValue(optFeatIdx, f) == 0)
-           )
-        {
-            continue;
-        }
-
-        // get the area of the current feature
-        dConsVal = mDataSet->getDblValue(this->msAreaField, f);
-
-        // round value when dealing with integer decision variables
-        if (this->meDVType == NMMosra::NM_MOSO_INT)
-            dConsVal = vtkMath::Floor(dConsVal);
-
-        // can't really comprehend this dirty hack again
-        // but it its meaning in the original LUMASS version ...
-        QString sConsVal = QString(tr("%1")).arg(dConsVal, 0, 'g');
-
-        //-----------------------------------------for each option
-        for (int option=0; option < this->miNumOptions; option++, colpos++)
+    NMMosraRowBlock block;
+    block.resize(lNumFeat, this->miNumOptions);
+    NMMosraRowBlock::parallelFor(lNumFeat,
+        [&](long beg, long end)
         {
-            // set the coefficient
-            switch(this->meDVType)
+            for (long k=beg; k < end; ++k)
             {
-            case NMMosra::NM_MOSO_BINARY:
-                pdRow[option] = ::atof(sConsVal.toStdString().c_str());
-                break;
-            default: // i.e. for all other DV  types (real, integer)
-                pdRow[option] = 1;
-                break;
-            }
-
-            // set the column number
-            piColno[option] = colpos;
-
-            //MosraLogInfo( << "feat cons: option | colps = " << option << " | " << lCounter+1 << endl);
-
-        }
-        colpos += skipIncentivesOffset;
-
-        // ......................................................................................
-        // add the first constraint: SUM(x_i_r) - A_i * b_i >= 0
-
-        // set the coefficient for the binary decision variable for the current feature
-        //		pdRow[this->miNumOptions] = ::atof(sConsVal.toStdString().c_str()) * -1;
-        //		piColno[this->miNumOptions] = colpos;
+                const int f = this->mvOptFeatRows[k];
+                double* pdRow = block.rowValues(k);
+                int* piColno = block.rowColNo(k);
 
-        //		this->mLp->AddConstraintEx(this->miNumOptions+1, pdRow,
-        //				piColno, 2, 0);
+                // get the area of the current feature
+                double dConsVal = vdArea[f];
 
-        this->mLp->AddConstraintEx(this->miNumOptions, pdRow,
-                piColno, 1, ::atof(sConsVal.toStdString().c_str()));
+                // round value when dealing with integer decision variables
+                if (this->meDVType == NMMosra::NM_MOSO_INT)
+                    dConsVal = vtkMath::Floor(dConsVal);
 
+                // can't really comprehend this dirty hack again
+                // but it its meaning in the original LUMASS version ...
+                dConsVal = roundAreaCoeff(dConsVal);
 
-        // increment row (constraint) counter
-        lRowCounter++;
-
-        // label the currently added constraint
-        QString sRowName = QString(tr("Feature_%1a")).arg(f);
-        this->mLp->SetRowName(lRowCounter, sRowName.toStdString());
-
-        // ......................................................................................
-        // add the second constraint: SUM(x_i_r) - A_i * b_i <= 0
-        //		pdRow[this->miNumOptions] = ::atof(sConsVal.toStdString().c_str()) * -1;
-
-        //		this->mLp->AddConstraintEx(this->miNumOptions+1, pdRow,
-        //				piColno, 1, 0);
-        //		lRowCounter++;
+                //-----------------------------------------for each option
+                for (int option=0; option < this->miNumOptions; option++)
+                {
+                    // set the coefficient
+                    switch(this->meDVType)
+                    {
+                    case NMMosra::NM_MOSO_BINARY:
+                        pdRow[option] = dConsVal;
+                        break;
+                    default: // i.e. for all other DV  types (real, integer)
+                        pdRow[option] = 1;
+                        break;
+                    }
 
-        //		sRowName = QString(tr("Feature_%1b")).arg(f);
-        //		this->mLp->SetRowName(lRowCounter, sRowName.toStdString());
+                    // set the column number
+                    piColno[option] = 1 + k * lFeatColOffset + option;
+                }
 
-        // ........................................................................................
-        // column position counter
-        //colpos++;
+                // SUM(x_i_r) <= A_i
+                block.setRow(k, 1, dConsVal, "Feature_" + std::to_string(f) + "a");
+            }
+        });
 
-        if (f % 500 == 0)
-            NMDebug(<< ".");
+    if (!this->mLp->AddConstraintBlock(block.getNumRows(), block.getRowPtr(),
+                                       block.getValues(), block.getColNo(),
+                                       block.getTypes(), block.getRHS(),
+                                       block.getNames()))
+    {
+        MosraLogError(<< "addImplicitAreaCons(): failed adding feature constraints!");
+        NMDebugCtx(ctxNMMosra, << "done!");
+        return 0;
     }
     NMDebug(<< " finished!" << endl);
 
-    // turn off row mode
-    this->mLp->SetAddRowmode(false);
-
-    // free memory
-    delete[] pdRow;
-    delete[] piColno;
-
     NMDebugCtx(ctxNMMosra, << "done!");
     return 1;
 }
@@ -6390,18 +6644,12 @@ int NMMosra::addCriCons(void)
         }
     }
 
-    // get the hole array
-    bool hole = mDataSet->hasColumn("nm_hole");
-    int optFeatIdx = mDataSet->getColumnIndex(this->msOptFeatures);
-    long lNumCells = mDataSet->getNumRecs();
-
     // iterate over constraints and process them one at a time
     // (or should we process them while looping over all features)?
 
+    const long lNumFeat = this->mvOptFeatRows.size();
     const int skipIncentiveFeatOffset = this->mmslIncentives.size() * miNumOptions + mmslIncentives.size();
-
-    this->mLp->SetAddRowmode(true);
-    long lRowCounter = this->mLp->GetNRows();
+    const long lFeatColOffset = this->miNumOptions + skipIncentiveFeatOffset;
 
     for (int labelidx = 0; labelidx < vLabels.size(); ++labelidx)
     {
@@ -6416,128 +6664,134 @@ int NMMosra::addCriCons(void)
         const QVector<QString> incFieldNames = vvIncCriterionFieldNames[labelidx];
         const int iNumIncentives = incFieldNames.size();
 
-        // debug
-        const int varspace = (numCriOptions + numCriOptions * iNumIncentives) * this->mlNumOptFeat;
+        // fetch the area, performance indicator and incentive
+        // fields of all features in one go
+        QStringList fetchCols;
+        fetchCols << this->msAreaField;
+        for (int i=0; i < numCriOptions; ++i)
+        {
+            fetchCols << fieldNames[i];
+        }
+        for (int inc=0; inc < iNumIncentives; ++inc)
+        {
+            fetchCols << incFieldNames[inc];
+        }
 
-        double* pdRow = new double[varspace];
-        int* piColno = new int[varspace];
+        std::vector<std::vector<double> > colValues;
+        if (!mDataSet->getColumnValues(fetchCols, colValues))
+        {
+            MosraLogError(<< "addCriCons(): failed fetching the fields of constraint '"
+                          << vLabels[labelidx].toStdString() << "'!");
+            NMDebugCtx(ctxNMMosra, << "done!");
+            return 0;
+        }
+        const std::vector<double>& vdArea = colValues[0];
 
-        long arpos = 0;
-        long colPos = 1;
-        for (long f=0; f < lNumCells; ++f)
+        // check whether we've got zoning and whether the criterion constraint
+        // for the current land use option shall be restricted to this zone
+        std::vector<unsigned char> vbInZone;
+        if (!vZones.at(labelidx).isEmpty())
         {
-            //leap over holes
-            if (    (hole && mDataSet->getIntValue("nm_hole", f) == 1)
-                 || (optFeatIdx != -1 && mDataSet->getIntValue(optFeatIdx, f) == 0)
-               )
+            const int zoneIdx = mDataSet->getColumnIndex(vZones.at(labelidx));
+            vbInZone.assign(lNumFeat * numCriOptions, 0);
+            for (long k=0; k < lNumFeat; ++k)
             {
-                continue;
+                const std::string zoneArVal = mDataSet->getStrValue(zoneIdx, this->mvOptFeatRows[k]).toStdString();
+                for (int i=0; i < numCriOptions; ++i)
+                {
+                    vbInZone[k * numCriOptions + i] =
+                            zoneArVal.find(this->mslOptions.at(landUseIdxs[i]).toStdString()) != std::string::npos;
+                }
             }
+        }
 
-            for(int i=0; i < numCriOptions; ++i)
-            {
-                const int optIdx = landUseIdxs[i];
-                const int performanceIndicatorIdx = mDataSet->getColumnIndex(fieldNames[i]);
-
-                double coeff = 0.0;
-                bool bAddCoeff = true;
+        const int featspace = numCriOptions + numCriOptions * iNumIncentives;
+        const long varspace = featspace * lNumFeat;
+        std::vector<double> vdRow(varspace);
+        std::vector<int> viColno(varspace);
 
-                // check whether, we've got zoning and whether the criterion constraint
-                // for the current land use option shall be restricted to this zone
-                if (!vZones.at(labelidx).isEmpty())
+        NMMosraRowBlock::parallelFor(lNumFeat,
+            [&](long beg, long end)
+            {
+                for (long k=beg; k < end; ++k)
                 {
-                    const std::string zoneArVal = mDataSet->getStrValue(vZones.at(labelidx), f).toStdString();
-                    if (zoneArVal.find(this->mslOptions.at(optIdx).toStdString()) == std::string::npos)
-                    {
-                        bAddCoeff = false;
-                    }
-                }
+                    const int f = this->mvOptFeatRows[k];
+                    const long colPos = 1 + k * lFeatColOffset;
+                    long arpos = k * featspace;
 
-                if (bAddCoeff)
-                {
-                    switch(this->meDVType)
+                    for(int i=0; i < numCriOptions; ++i)
                     {
-                    case NMMosra::NM_MOSO_BINARY:
-                        coeff = mDataSet->getDblValue(this->msAreaField, f) * mDataSet->getDblValue(performanceIndicatorIdx, f);
-                        break;
-                    default:
-                        coeff = mDataSet->getDblValue(performanceIndicatorIdx, f);
-                        break;
-                    }
-                }
+                        const int optIdx = landUseIdxs[i];
+                        const bool bAddCoeff = vbInZone.empty() || vbInZone[k * numCriOptions + i];
 
-                //debug
-                //int criPos = colPos + optIdx;
+                        double coeff = 0.0;
+                        if (bAddCoeff)
+                        {
+                            switch(this->meDVType)
+                            {
+                            case NMMosra::NM_MOSO_BINARY:
+                                coeff = vdArea[f] * colValues[1+i][f];
+                                break;
+                            default:
+                                coeff = colValues[1+i][f];
+                                break;
+                            }
+                        }
 
-                pdRow[arpos] = coeff;
-                piColno[arpos] = colPos + optIdx;
-                ++arpos;
+                        vdRow[arpos] = coeff;
+                        viColno[arpos] = colPos + optIdx;
+                        ++arpos;
 
-                // account for incentives, if applicable
-                for (int inc=0; inc < iNumIncentives; ++inc, ++arpos)
-                {
-                    const int incFieldIdx = mDataSet->getColumnIndex(incFieldNames[inc]);
-                    coeff = 0.0;
-                    if (bAddCoeff)
-                    {
-                        switch(this->meDVType)
+                        // account for incentives, if applicable
+                        for (int inc=0; inc < iNumIncentives; ++inc, ++arpos)
                         {
-                        case NMMosra::NM_MOSO_BINARY:
-                            coeff = mDataSet->getDblValue(this->msAreaField, f) * mDataSet->getDblValue(incFieldIdx, f);
-                            break;
-                        default:
-                            coeff = mDataSet->getDblValue(incFieldIdx, f);
-                            break;
+                            const std::vector<double>& incValues = colValues[1+numCriOptions+inc];
+                            coeff = 0.0;
+                            if (bAddCoeff)
+                            {
+                                switch(this->meDVType)
+                                {
+                                case NMMosra::NM_MOSO_BINARY:
+                                    coeff = vdArea[f] * incValues[f];
+                                    break;
+                                default:
+                                    coeff = incValues[f];
+                                    break;
+                                }
+                            }
+
+                            vdRow[arpos] = coeff;
+                            // viColno:
+                            //  - colpos is start of current feature;
+                            //  - optIdx picks the right decision var for the given landuse at hand
+                            //  - adding ((inc+1) * miNumOptions) jumps at the current base-line reduction decision var
+                            //       (out of the number of incentives and therefore reduction vars per land use)
+                            //  - adding (+1) makes sure we're skipping the whole parcel retirement reduction variable (which is always at
+                            //       the start of the list of reduction variables)
+                            //
+                            viColno[arpos] = colPos + optIdx + (inc+1) * miNumOptions + 1 + inc;
                         }
                     }
-
-                    // arpos is the current postion based on no incentives; + 1 move it to the next pos; +inc positions
-                    // the pointer at the inc+1ths position
-                    pdRow[arpos] = coeff;
-                    // piColno:
-                    //  - colpos is start of current feature;
-                    //  - optIdx picks the right decision var for the given landuse at hand
-                    //  - adding ((inc+1) * miNumOptions) jumps at the current base-line reduction decision var
-                    //       (out of the number of incentives and therefore reduction vars per land use)
-                    //  - adding (+1) makes sure we're skipping the whole parcel retirement reduction variable (which is always at
-                    //       the start of the list of reduction variables)
-                    //
-                    piColno[arpos] = colPos + optIdx + (inc+1) * miNumOptions + 1 + inc;
                 }
-            }
-
-            // jump to the first option of the next feature
-            //          DEPRECATED(keep in mind that we've got one binary decision var (i.e. column) per feature, hence the +1
-            colPos += this->miNumOptions + skipIncentiveFeatOffset;
-
-            if (f % 200 == 0)
-                NMDebug(<< ".");
-
-        }
+            });
         NMDebug(<< " finished!" << std::endl);
 
         // add constraint
         MosraLogDebug(<< "adding constraint to LP ..." << std::endl);
-        this->mLp->AddConstraintEx(varspace, pdRow, piColno, vOperators[labelidx], vRHS[labelidx]);
-
-        // increment the row counter
-        ++lRowCounter;
-
-
-        //  set the constraint label
-        MosraLogDebug(<< "labeling constraint ..." << std::endl);
-        this->mLp->SetRowName(lRowCounter, vLabels[labelidx].toStdString().c_str());
-
-        delete[] pdRow;
-        delete[] piColno;
-        pdRow = nullptr;
-        piColno = nullptr;
-
+        const long rowPtr[2] = {0, varspace};
+        const int consType = vOperators[labelidx];
+        const double rhs = vRHS[labelidx];
+        const std::string sLabel = vLabels[labelidx].toStdString();
+        if (!this->mLp->AddConstraintBlock(1, rowPtr, vdRow.data(), viColno.data(),
+                                           &consType, &rhs, &sLabel))
+        {
+            MosraLogError(<< "addCriCons(): failed adding constraint '"
+                          << sLabel << "'!");
+            NMDebugCtx(ctxNMMosra, << "done!");
+            return 0;
+        }
     }
 
-    // turn off rowmode
-    this->mLp->SetAddRowmode(false);
-
     NMDebugCtx(ctxNMMosra, << "done!");
     return 1;
 }
@@ -43,6 +43,8 @@
 #ifndef NMMOSRA_H_
 #define NMMOSRA_H_
 
+#include <vector>
+
 #include <QObject>
 #include <QMap>
 #include <QStringList>
@@ -123,6 +125,20 @@ public:
     int  getIntValue(int col, int row);
     QString getStrValue(int col, int row);
 
+    /*! fetches the numeric columns colnames of all records in
+     *  one pass over the data set, i.e. values[c][row] holds
+     *  the value of colnames[c] for the given row; returns false
+     *  if any of the columns couldn't be fetched
+     */
+    bool getColumnValues(const QStringList& colnames,
+                         std::vector<std::vector<double> >& values);
+
+    /*! the counterpart of getColumnValues: writes values[c][row]
+     *  into the numeric column colnames[c] of all records
+     */
+    bool setColumnValues(const QStringList& colnames,
+                         const std::vector<std::vector<double> >& values);
+
 
     void setIntValue(const QString& colname, int row, int value);
     void setDblValue(const QString& colname, int row, double value);
@@ -301,6 +317,17 @@ public:
     void setBreakAtFirst(bool breakAtFirst)
         {this->mbBreakAtFirst = breakAtFirst;}
 
+    /*! when enabled, the basis of an (sub-)optimal solution is kept
+     *  and used as starting point for the next solveLp() of a model
+     *  of the same dimensions (e.g. the next perturbation of a batch
+     *  run); note: presolve is disabled in warm start mode, since
+     *  lp_solve can only take and hand back the basis of the full model
+     */
+    void setWarmStart(bool warmStart)
+        {this->mbWarmStart = warmStart; this->mvBasis.clear();}
+    bool getWarmStart(void)
+        {return this->mbWarmStart;}
+
     /*	\brief add uncertainty to performance scores
      *
      *  This function varies the individual performance scores by
@@ -312,6 +339,21 @@ public:
     bool perturbCriterion(const QString& criterion,
                           const QList<float>& percent);
 
+    /*! returns the data set fields altered by
+     *  perturbCriterion for the given criterion
+     */
+    QStringList getPerturbationFields(const QString& criterion);
+
+    /*! bulk access to numeric data set fields, e.g. to
+     *  restore perturbed fields between batch runs
+     */
+    bool getFieldValues(const QStringList& fields,
+                        std::vector<std::vector<double> >& values)
+        {return this->mDataSet->getColumnValues(fields, values);}
+    bool setFieldValues(const QStringList& fields,
+                        const std::vector<std::vector<double> >& values)
+        {return this->mDataSet->setColumnValues(fields, values);}
+
     /* \brief varies a constraint by a given percent
      *
      *  This function varies the named criterion by the given
@@ -367,6 +409,9 @@ private:
     NMMosoScalMeth meScalMeth;
 
     bool mbBreakAtFirst;
+    bool mbWarmStart;
+    // basis of the last solution (warm start mode)
+    std::vector<int> mvBasis;
     unsigned int muiTimeOut;
     int miNumOptions;
     QStringList mslOptions;
@@ -493,6 +538,11 @@ private:
     double mdAreaTotal;
     double mdAreaSelected;
 
+    // data set row indices of the features subject to optimisation
+    // (i.e. no holes), in the order their decision variables are
+    // laid out in the lp matrix; set up by makeLp()
+    std::vector<int> mvOptFeatRows;
+
     // reset internal variables
     void reset(void);
     void createReport(void);
@@ -0,0 +1,131 @@
+/* NMMosraRowBlock.h
+ *
+ * This file is part of 'LUMASS', which is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \brief NMMosraRowBlock assembles a block of constraints (rows) of the
+ *        lp matrix in compressed sparse row form.
+ *
+ * Rows of a fixed length (e.g. one per feature) are allocated up front
+ * by resize() and may then be populated concurrently (cf. parallelFor()),
+ * rows of varying length are appended one at a time by appendRow(). The
+ * block is handed over to lp_solve in one go by
+ * HLpHelper::AddConstraintBlock().
+ */
+
+#ifndef NMMOSRAROWBLOCK_H_
+#define NMMOSRAROWBLOCK_H_
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <algorithm>
+
+class NMMosraRowBlock
+{
+public:
+    NMMosraRowBlock()
+    {
+        mRowPtr.push_back(0);
+    }
+
+    /*! allocates numRows rows with nnzPerRow coefficients each */
+    void resize(long numRows, int nnzPerRow)
+    {
+        mRowPtr.resize(numRows + 1);
+        for (long r=0; r <= numRows; ++r)
+        {
+            mRowPtr[r] = r * nnzPerRow;
+        }
+        mValues.assign(numRows * nnzPerRow, 0.0);
+        mColNo.assign(numRows * nnzPerRow, 0);
+        mTypes.assign(numRows, 1);
+        mRHS.assign(numRows, 0.0);
+        mNames.assign(numRows, std::string());
+    }
+
+    /*! appends a row of varying length */
+    void appendRow(const std::vector<double>& values, const std::vector<int>& colno,
+                   int type, double rhs, const std::string& name)
+    {
+        mValues.insert(mValues.end(), values.begin(), values.end());
+        mColNo.insert(mColNo.end(), colno.begin(), colno.end());
+        mRowPtr.push_back(mValues.size());
+        mTypes.push_back(type);
+        mRHS.push_back(rhs);
+        mNames.push_back(name);
+    }
+
+    long getNumRows() const {return mTypes.size();}
+
+    double* rowValues(long row) {return &mValues[mRowPtr[row]];}
+    int* rowColNo(long row) {return &mColNo[mRowPtr[row]];}
+
+    /*! sets the constraint type (1: <= | 2: >= | 3: =),
+     *  the right hand side and the name of a row */
+    void setRow(long row, int type, double rhs, const std::string& name)
+    {
+        mTypes[row] = type;
+        mRHS[row] = rhs;
+        mNames[row] = name;
+    }
+
+    const long* getRowPtr() const {return mRowPtr.data();}
+    const double* getValues() const {return mValues.data();}
+    const int* getColNo() const {return mColNo.data();}
+    const int* getTypes() const {return mTypes.data();}
+    const double* getRHS() const {return mRHS.data();}
+    const std::string* getNames() const {return mNames.data();}
+
+    /*! calls func(begin, end) for consecutive ranges of [0, n)
+     *  on as many threads as there are cores, but with at least
+     *  minChunk items per thread
+     */
+    template<class TFunc>
+    static void parallelFor(long n, TFunc func, long minChunk=4096)
+    {
+        long nthreads = std::min<long>(std::max<unsigned int>(std::thread::hardware_concurrency(), 1),
+                                       n / std::max<long>(minChunk, 1));
+        if (nthreads < 2)
+        {
+            func(0, n);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        const long chunk = n / nthreads;
+        for (long th=0; th < nthreads; ++th)
+        {
+            const long beg = th * chunk;
+            const long end = th == nthreads-1 ? n : beg + chunk;
+            threads.push_back(std::thread(func, beg, end));
+        }
+
+        for (size_t th=0; th < threads.size(); ++th)
+        {
+            threads[th].join();
+        }
+    }
+
+private:
+    std::vector<long> mRowPtr;
+    std::vector<double> mValues;
+    std::vector<int> mColNo;
+    std::vector<int> mTypes;
+    std::vector<double> mRHS;
+    std::vector<std::string> mNames;
+};
+
+#endif /* NMMOSRAROWBLOCK_H_ */
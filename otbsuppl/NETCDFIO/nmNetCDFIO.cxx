@@ -22,6 +22,8 @@
 #include <cctype>
 #include <limits>
 #include <algorithm>
+#include <map>
+#include <mutex>
 
 #include "NMMacros.h"
 #include "nmlog.h"
@@ -166,6 +168,14 @@
 
 using namespace netCDF;
 
+namespace
+{
+// sequential read handles kept open per container file; netCDF
+// isn't thread-safe anyway, so one lock guards all of them
+std::mutex ncReadHandleMutex;
+std::multimap<std::string, otb::NetCDFIO*> ncReadHandles;
+}
+
 namespace otb
 {
 
@@ -184,6 +194,8 @@ NetCDFIO::NetCDFIO(void)
     m_ComponentType = FLOAT;
     m_ncType = netCDF::NcType::nc_FLOAT;
     m_CompressionLevel = 5;
+    m_ChunkCacheSize = 0;
+    m_MaxChunkBytes = 4 << 20;
 
     // we don't have any info about the image so far ...
     m_bCanRead = false;
@@ -209,11 +221,17 @@ NetCDFIO::NetCDFIO(void)
     this->m_NbOverviews = 0;
     this->m_OverviewIdx = - 1;
     this->m_ZSliceIdx = -1;
+
+    m_bReadFileOpen = false;
+    m_ReadVarOvvIdx = -1;
+    m_ReadChunkBytes = 0;
+    m_ReadCacheBytes = 0;
 }
 
 NetCDFIO::~NetCDFIO()
 {
     NMDebugCtx("NetCDFIO", << "...")
+    this->CloseReadFile();
 //    if (m_bParallelIO)
 //    {
 //        //MPI_Barrier(m_MPIComm);
@@ -236,6 +254,7 @@ void NetCDFIO::SetFileName(const char* filename)
         return;
     }
 
+    this->CloseReadFile();
     if (this->parseImageSpec(filename))
     {
         this->m_FileName = filename;
@@ -274,6 +293,7 @@ bool NetCDFIO::CanReadFile(const char* filename)
     {
         if (!m_bParallelIO)
         {
+            this->CloseReadFile();
             mFile.open(this->m_FileContainerName, NcFile::read);
             NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : opened file '" << this->GetFileName() << "' for sequential reading!" << std::endl);
         }
@@ -425,6 +445,7 @@ void NetCDFIO::ReadImageInformation()
     {
         if (!m_bParallelIO)
         {
+            this->CloseReadFile();
             mFile.open(m_FileContainerName, NcFile::read);
             NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : opened file '" << this->GetFileName() << "' for sequential reading!" << std::endl);
         }
@@ -450,6 +471,16 @@ void NetCDFIO::ReadImageInformation()
         }
 
 
+        // report the native chunking (x, y, z, ...)
+        NcVar::ChunkMode chunkMode;
+        std::vector<size_t> chunkSizes;
+        var.getChunkingParameters(chunkMode, chunkSizes);
+        m_ChunkSizes.clear();
+        if (chunkMode == NcVar::nc_CHUNKED)
+        {
+            m_ChunkSizes.assign(chunkSizes.rbegin(), chunkSizes.rend());
+        }
+
         if (var.getEndianness() == netCDF::NcVar::nc_ENDIAN_BIG)
         {
             this->m_ByteOrder = otb::ImageIOBase::BigEndian;
@@ -880,64 +911,187 @@ void NetCDFIO::Read(void* buffer)
         len[0] = 1;
     }
 
+    const bool bReadOverview =    this->m_OverviewIdx >= 0
+                               && this->m_OverviewIdx < this->m_OvvSize.size();
+
+    // clamp z-slice start index to available overview-z indices
+    if (bReadOverview && m_NumberOfDimensions == 3 && m_ZSliceIdx >= 0)
+    {
+        start[0] = std::min(m_OvvSize[m_OverviewIdx][2]-1,
+                static_cast<unsigned int>(m_ZSliceIdx));
+    }
+
+    // the file (and the variable) is kept open for
+    // subsequent reads until this IO is destroyed, or the
+    // file is about to be written
+    std::unique_lock<std::mutex> lock(ncReadHandleMutex, std::defer_lock);
     try
     {
         if (!m_bParallelIO)
         {
-            mFile.open(this->m_FileContainerName, NcFile::read);
-            NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : opened file '" << this->GetFileName() << "' for sequential reading!" << std::endl);
+            lock.lock();
+            if (!m_bReadFileOpen)
+            {
+                mFile.open(this->m_FileContainerName, NcFile::read);
+                m_bReadFileOpen = true;
+                m_ReadFileName = this->m_FileContainerName;
+                ncReadHandles.insert(std::make_pair(m_ReadFileName, this));
+                NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : opened file '" << this->GetFileName() << "' for sequential reading!" << std::endl);
+            }
         }
-        const int imgGrpId = m_GroupIDs.size() > 0 ? m_GroupIDs.back() : mFile.getId();
-        NcGroup imgGrp(imgGrpId);
 
-        std::stringstream readImgName;
-        NcGroup readGrp;
-
-        // reading overview image
-        if (this->m_OverviewIdx >= 0 && this->m_OverviewIdx < this->m_OvvSize.size())
+        const int readVarOvvIdx = bReadOverview ? m_OverviewIdx : -1;
+        if (m_ReadVar.isNull() || m_ReadVarOvvIdx != readVarOvvIdx)
         {
-            readImgName << m_NcVarName << "_ovv_" << m_OverviewIdx + 1;
-            std::string ovvGrpName = "OVERVIEWS_" + m_NcVarName;
-            readGrp = imgGrp.getGroup(ovvGrpName);
+            const int imgGrpId = m_GroupIDs.size() > 0 ? m_GroupIDs.back() : mFile.getId();
+            NcGroup imgGrp(imgGrpId);
+
+            std::stringstream readImgName;
+            NcGroup readGrp;
 
-            // clamp z-slice start index to available overview-z indices
-            if (m_NumberOfDimensions == 3 && m_ZSliceIdx >= 0)
+            // reading overview image
+            if (bReadOverview)
             {
-                start[0] = std::min(m_OvvSize[m_OverviewIdx][2]-1,
-                        static_cast<unsigned int>(m_ZSliceIdx));
+                readImgName << m_NcVarName << "_ovv_" << m_OverviewIdx + 1;
+                std::string ovvGrpName = "OVERVIEWS_" + m_NcVarName;
+                readGrp = imgGrp.getGroup(ovvGrpName);
+            }
+            else
+            {
+                readImgName << m_NcVarName;
+                readGrp = imgGrp;
+            }
+
+            NcVar var = readGrp.getVar(readImgName.str());
+            if (var.isNull())
+            {
+                NMProcErr(<< "Failed accessing the variable '"
+                           << readImgName.str() << "' in group '"
+                           << readGrp.getName() << "' of file '"
+                           << m_FileContainerName << "'!");
+                NMDebugCtx("NetCDFIO", << "done!")
+                return;
+            }
+
+            m_ReadVar = var;
+            m_ReadVarOvvIdx = readVarOvvIdx;
+            m_ReadCacheBytes = 0;
+
+            NcVar::ChunkMode chunkMode;
+            m_ReadVar.getChunkingParameters(chunkMode, m_ReadChunkSizes);
+            m_ReadChunkBytes = 0;
+            if (chunkMode == NcVar::nc_CHUNKED)
+            {
+                m_ReadChunkBytes = m_ReadVar.getType().getSize();
+                for (int d=0; d < m_ReadChunkSizes.size(); ++d)
+                {
+                    m_ReadChunkBytes *= m_ReadChunkSizes[d];
+                }
             }
-        }
-        else
-        {
-            readImgName << m_NcVarName;
-            readGrp = imgGrp;
         }
 
-        NcVar var = readGrp.getVar(readImgName.str());
-        if (var.isNull())
+        this->UpdateReadChunkCache(start, len);
+        m_ReadVar.getVar(start, len, buffer);
+    }
+    catch(exceptions::NcException& e)
+    {
+        if (lock.owns_lock())
         {
-            NMProcErr(<< "Failed accessing the variable '"
-                       << readImgName.str() << "' in group '"
-                       << readGrp.getName() << "' of file '"
-                       << m_FileContainerName << "'!");
-            NMDebugCtx("NetCDFIO", << "done!")
-            return;
+            this->InternalCloseReadFile();
         }
+        NMDebugCtx("NetCDFIO", << "done!")
+        NMProcErr(<< e.what());
+    }
+    NMDebugCtx("NetCDFIO", << "done!")
+}
 
-        var.getVar(start, len, buffer);
+void NetCDFIO::UpdateReadChunkCache(const std::vector<size_t>& start,
+                                    const std::vector<size_t>& len)
+{
+    if (    m_ReadChunkBytes == 0
+         || m_ReadChunkSizes.size() != start.size()
+       )
+    {
+        return;
+    }
 
-        if (!m_bParallelIO)
+    // number of chunks touched by the region to be read
+    size_t numChunks = 1;
+    for (int d=0; d < start.size(); ++d)
+    {
+        const size_t cs = std::max<size_t>(1, m_ReadChunkSizes[d]);
+        const size_t end = start[d] + std::max<size_t>(1, len[d]) - 1;
+        numChunks *= end / cs - start[d] / cs + 1;
+    }
+
+    // by default, we hold on to all chunks of the current region,
+    // so that chunks shared with the next (stream) region don't
+    // need to be decompressed again
+    size_t cacheBytes = m_ChunkCacheSize;
+    if (cacheBytes == 0)
+    {
+        cacheBytes = numChunks * m_ReadChunkBytes;
+    }
+    else
+    {
+        numChunks = cacheBytes / m_ReadChunkBytes + 1;
+    }
+
+    if (cacheBytes > m_ReadCacheBytes)
+    {
+        m_ReadVar.setChunkCache(cacheBytes, numChunks * 100 + 1, 0.75);
+        m_ReadCacheBytes = cacheBytes;
+    }
+}
+
+void NetCDFIO::CloseReadFile(void)
+{
+    std::lock_guard<std::mutex> lock(ncReadHandleMutex);
+    this->InternalCloseReadFile();
+}
+
+void NetCDFIO::InternalCloseReadFile(void)
+{
+    if (!m_bReadFileOpen)
+    {
+        return;
+    }
+
+    auto range = ncReadHandles.equal_range(m_ReadFileName);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == this)
         {
-            mFile.close();
-            NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : closed file '" << this->GetFileName() << "' opened for parallel acess!" << std::endl);
+            ncReadHandles.erase(it);
+            break;
         }
     }
+
+    try
+    {
+        mFile.close();
+        NMDebugAI(<< "NetCDFIO: closed file '" << m_ReadFileName << "' opened for sequential reading." << std::endl)
+    }
     catch(exceptions::NcException& e)
     {
-        NMDebugCtx("NetCDFIO", << "done!")
-        NMProcErr(<< e.what());
+        NMProcWarn(<< e.what());
+    }
+
+    m_bReadFileOpen = false;
+    m_ReadVar = NcVar();
+    m_ReadVarOvvIdx = -1;
+    m_ReadCacheBytes = 0;
+}
+
+void NetCDFIO::ReleaseReadHandles(const std::string& fileName)
+{
+    std::lock_guard<std::mutex> lock(ncReadHandleMutex);
+    auto it = ncReadHandles.find(fileName);
+    while (it != ncReadHandles.end())
+    {
+        it->second->InternalCloseReadFile();
+        it = ncReadHandles.find(fileName);
     }
-    NMDebugCtx("NetCDFIO", << "done!")
 }
 
 bool NetCDFIO::InitParallelIO(MPI_Comm &comm, MPI_Info &info, bool write)
@@ -976,6 +1130,12 @@ bool NetCDFIO::InitParallelIO(MPI_Comm &comm, MPI_Info &info, bool write)
                       << this->GetFileName() << "'" << std::endl);
         }
 
+        this->CloseReadFile();
+        if (write)
+        {
+            NetCDFIO::ReleaseReadHandles(m_FileContainerName);
+        }
+
         NMDebugAI(<< "proc #" << mrank << "::InitIOBarrier" << std::endl);
         MPI_Barrier(comm);
         mFile.open(comm, info, this->m_FileContainerName, fileMode);
@@ -1020,6 +1180,7 @@ bool NetCDFIO::InitParallelIO(MPI_Comm &comm, MPI_Info &info, bool write)
     this->m_MPIComm = comm;
     this->m_MPIInfo = info;
     this->m_bParallelIO = true;
+    m_ReadVar = NcVar();
     return true;
 
     NMDebugCtx("NetCDFIO", << "done!")
@@ -1040,6 +1201,8 @@ bool NetCDFIO::CanWriteFile(const char* filename)
         return this->m_bCanWrite;
     }
 
+    NetCDFIO::ReleaseReadHandles(m_FileContainerName);
+
     NcFile nc;
     try
     {
@@ -1081,6 +1244,7 @@ void NetCDFIO::FinaliseParallelIO(void)
         mFile.close();
         NMDebugAI(<< "NetCDFIO: closed file '" << this->GetFileName() << "' opened for parallel writing!");
     }
+    m_ReadVar = NcVar();
 
     NMDebugCtx("NetCDFIO", << "done!")
 }
@@ -1431,6 +1595,56 @@ void NetCDFIO::ProcessVarDimDescriptors()
     }
 }
 
+std::vector<size_t>
+NetCDFIO::getWriteChunkSizes(const std::vector<NcDim>& dims, size_t typeSize)
+{
+    std::vector<size_t> chunks;
+    const size_t ndims = dims.size();
+    if (m_ChunkSizes.size() != ndims || typeSize == 0)
+    {
+        return chunks;
+    }
+
+    // maps the itk/otb dimension order of m_ChunkSizes: x, y, z [, d4 [, ...]]
+    // to the netcdf dimension order: [..., [d4,]] z, y, x
+    size_t bytes = typeSize;
+    for (size_t d=0; d < ndims; ++d)
+    {
+        size_t cs = std::max<size_t>(1, m_ChunkSizes[ndims-d-1]);
+        if (!dims[d].isUnlimited() && dims[d].getSize() > 0)
+        {
+            cs = std::min(cs, dims[d].getSize());
+        }
+        chunks.push_back(cs);
+        bytes *= cs;
+    }
+
+    // split oversized chunks along the slowest moving dimension(s);
+    // we prefer sizes dividing the requested ones, so that each
+    // (stream) region is made up of whole chunks
+    const size_t maxBytes = std::max(m_MaxChunkBytes, typeSize);
+    for (size_t d=0; d < ndims && bytes > maxBytes; ++d)
+    {
+        const size_t k = (bytes + maxBytes - 1) / maxBytes;
+        size_t cs = (chunks[d] + k - 1) / k;
+
+        size_t div = cs;
+        while (div > 1 && chunks[d] % div != 0)
+        {
+            --div;
+        }
+        if (div * 2 >= cs)
+        {
+            cs = div;
+        }
+
+        bytes = bytes / chunks[d] * cs;
+        chunks[d] = cs;
+    }
+
+    return chunks;
+}
+
 void NetCDFIO::setVariableAttributes(NcVar &var)
 {
     if (m_VarAttInfoMap.find(var.getName()) != m_VarAttInfoMap.end())
@@ -1484,6 +1698,8 @@ void NetCDFIO::InternalWriteImageInformation()
     {
         if (!m_bParallelIO)
         {
+            this->CloseReadFile();
+            NetCDFIO::ReleaseReadHandles(m_FileContainerName);
             mFile.open(this->m_FileContainerName, NcFile::write, NcFile::nc4);
             NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : file '" << this->GetFileName() << "' opened for sequential writing!");
         }
@@ -1723,12 +1939,27 @@ void NetCDFIO::InternalWriteImageInformation()
 
             if (!m_bParallelIO)
             {
+                std::vector<size_t> chunkSizes = this->getWriteChunkSizes(
+                            dims, valVar.getType().getSize());
+                if (!chunkSizes.empty())
+                {
+                    valVar.setChunking(NcVar::nc_CHUNKED, chunkSizes);
+                }
                 valVar.setCompression(true, true, m_CompressionLevel);
                 valVar.setFill(true, 0);
 
                 // note this may overwrite previously set attributes
                 setVariableAttributes(valVar);
             }
+
+            NcVar::ChunkMode chunkMode;
+            std::vector<size_t> chunkSizes;
+            valVar.getChunkingParameters(chunkMode, chunkSizes);
+            m_ChunkSizes.clear();
+            if (chunkMode == NcVar::nc_CHUNKED)
+            {
+                m_ChunkSizes.assign(chunkSizes.rbegin(), chunkSizes.rend());
+            }
         }
         // ========================================================
         //                 ADJUST VAR's DIMENSION
@@ -1850,6 +2081,8 @@ void NetCDFIO::Write(const void* buffer)
     {
         if (!m_bParallelIO)
         {
+            this->CloseReadFile();
+            NetCDFIO::ReleaseReadHandles(m_FileContainerName);
             mFile.open(this->m_FileContainerName, NcFile::write);
             NMDebugAI(<< "NetCDFIO: m_bParallelIO == false : file '" << this->GetFileName() << "' opened for sequential writing!");
         }
@@ -107,6 +107,39 @@ public:
     itkSetMacro(CompressionLevel, int)
     itkGetMacro(CompressionLevel, int)
 
+    /** Set/Get the chunk cache size (bytes) used for reading the
+     *  image variable; if 0 (default), the cache is sized to hold
+     *  all chunks touched by the IORegion being read
+     */
+    itkSetMacro(ChunkCacheSize, size_t)
+    itkGetMacro(ChunkCacheSize, size_t)
+
+    /** Set/Get the max size (bytes) of a chunk of a newly
+     *  created image variable (default: 4 MiB)
+     */
+    itkSetMacro(MaxChunkBytes, size_t)
+    itkGetMacro(MaxChunkBytes, size_t)
+
+    /** Set the chunk sizes (x, y, z, ...) of a newly created image
+     *  variable, e.g. the size of the writer's stream regions;
+     *  chunks exceeding MaxChunkBytes are split along the slowest
+     *  moving dimension(s) into sizes dividing the given ones
+     */
+    void SetChunkSizes(const std::vector<size_t>& chunkSizes)
+      {m_ChunkSizes = chunkSizes;}
+
+    /** Get the chunk sizes (x, y, z, ...) of the image variable,
+     *  available after ReadImageInformation() or after the variable
+     *  has been created; empty for contiguously stored variables
+     */
+    std::vector<size_t> GetChunkSizes() {return m_ChunkSizes;}
+
+    /** Closes any file handles kept open for reading the
+     *  container file fileName, e.g. before it is opened for writing;
+     *  handles are re-opened with the next call to Read()
+     */
+    static void ReleaseReadHandles(const std::string& fileName);
+
     /** Get total number of components (bands) of source data set */
     int GetTotalNumberOfBands(void) {return m_NbBands;}
 
@@ -198,6 +231,8 @@ protected:
     netCDF::NcType::ncType getNetCDFComponentType(otb::ImageIOBase::IOComponentType otbtype);
     netCDF::NcType::ncType getNetCDFComponentType(const std::string& typeStr);
     void setVariableAttributes(netCDF::NcVar& var);
+    std::vector<size_t> getWriteChunkSizes(const std::vector<netCDF::NcDim>& dims,
+                                           size_t typeSize);
 
     struct DimInfo
     {
@@ -265,6 +300,9 @@ protected:
     std::string m_ImageTypeName;
 
     int m_CompressionLevel;
+    size_t m_ChunkCacheSize;
+    size_t m_MaxChunkBytes;
+    std::vector<size_t> m_ChunkSizes;
     int m_NbBands;
 
     std::vector<int> m_BandMap;
@@ -297,6 +335,23 @@ private:
 
     netCDF::NcFile mFile;
 
+    /** the sequential read handle is kept open between
+     *  calls to Read(), together with the variable read
+     *  last and its chunking
+     */
+    void CloseReadFile(void);
+    void InternalCloseReadFile(void);
+    void UpdateReadChunkCache(const std::vector<size_t>& start,
+                              const std::vector<size_t>& len);
+
+    bool m_bReadFileOpen;
+    std::string m_ReadFileName;
+    netCDF::NcVar m_ReadVar;
+    int m_ReadVarOvvIdx;
+    std::vector<size_t> m_ReadChunkSizes;
+    size_t m_ReadChunkBytes;
+    size_t m_ReadCacheBytes;
+
     MPI_Comm m_MPIComm;
     MPI_Info m_MPIInfo;
 
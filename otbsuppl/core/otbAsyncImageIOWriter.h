@@ -0,0 +1,215 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef OTBASYNCIMAGEIOWRITER_H_
+#define OTBASYNCIMAGEIOWRITER_H_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "itkImageIORegion.h"
+#include "itkMacro.h"
+#include "otbImageIOBase.h"
+
+namespace otb
+{
+
+/** \class AsyncImageIOWriter
+ *  \brief Writes image regions through an ImageIO on a dedicated thread
+ *
+ *  Regions are copied into a ring of NumberOfBuffers region buffers
+ *  and written in the order they were submitted, while the calling
+ *  thread continues to produce the next region. Write() blocks
+ *  while all buffers are waiting to be written, so the memory used
+ *  is bounded by NumberOfBuffers times the largest region submitted.
+ *
+ *  The ImageIO must be fully set up (incl. pixel type info) before
+ *  the first region is submitted, and must not be used by any other
+ *  thread until Finish() has returned.
+ */
+class AsyncImageIOWriter
+{
+public:
+    AsyncImageIOWriter(ImageIOBase* imageIO, unsigned int numBuffers)
+        : m_ImageIO(imageIO), m_Head(0), m_Count(0),
+          m_bDone(false), m_bAbort(false), m_bFailed(false)
+    {
+        m_Slots.resize(numBuffers < 1 ? 1 : numBuffers);
+        m_Thread = std::thread(&AsyncImageIOWriter::Run, this);
+    }
+
+    /** Stops the writer thread without writing
+     *  any pending regions (e.g. when unwinding after
+     *  an upstream exception)
+     */
+    ~AsyncImageIOWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bAbort = true;
+        }
+        m_NotEmpty.notify_all();
+        if (m_Thread.joinable())
+        {
+            m_Thread.join();
+        }
+    }
+
+    /** Queues a copy of buffer for writing into region;
+     *  throws if a previous write has failed
+     */
+    void Write(const itk::ImageIORegion& region, const void* buffer, size_t numBytes)
+    {
+        if (numBytes == 0)
+        {
+            return;
+        }
+
+        size_t slot;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_NotFull.wait(lock, [this]{return m_Count < m_Slots.size() || m_bFailed;});
+            if (m_bFailed)
+            {
+                itkGenericExceptionMacro(<< m_ErrorMsg);
+            }
+            slot = (m_Head + m_Count) % m_Slots.size();
+        }
+
+        // the writer thread doesn't touch this slot
+        // until it has been counted in
+        m_Slots[slot].region = region;
+        m_Slots[slot].data.resize(numBytes);
+        std::memcpy(&m_Slots[slot].data[0], buffer, numBytes);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_Count;
+        }
+        m_NotEmpty.notify_one();
+    }
+
+    /** Waits until all queued regions have been
+     *  written and stops the writer thread; throws
+     *  if any write has failed
+     */
+    void Finish()
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_NotFull.wait(lock, [this]{return m_Count == 0 || m_bFailed;});
+            m_bDone = true;
+        }
+        m_NotEmpty.notify_all();
+        if (m_Thread.joinable())
+        {
+            m_Thread.join();
+        }
+
+        if (m_bFailed)
+        {
+            itkGenericExceptionMacro(<< m_ErrorMsg);
+        }
+    }
+
+protected:
+
+    void Run()
+    {
+        for (;;)
+        {
+            size_t slot;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_NotEmpty.wait(lock, [this]{return m_Count > 0 || m_bDone || m_bAbort;});
+                if (m_Count == 0 || m_bAbort)
+                {
+                    return;
+                }
+                slot = m_Head;
+            }
+
+            try
+            {
+                m_ImageIO->SetIORegion(m_Slots[slot].region);
+                m_ImageIO->Write(&m_Slots[slot].data[0]);
+            }
+            catch (itk::ExceptionObject& e)
+            {
+                this->SetFailed(e.GetDescription());
+                return;
+            }
+            catch (std::exception& e)
+            {
+                this->SetFailed(e.what());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (m_bAbort)
+                {
+                    return;
+                }
+                m_Head = (m_Head + 1) % m_Slots.size();
+                --m_Count;
+            }
+            m_NotFull.notify_one();
+        }
+    }
+
+    void SetFailed(const std::string& msg)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ErrorMsg = msg;
+            m_bFailed = true;
+        }
+        m_NotFull.notify_all();
+    }
+
+    struct RegionBuffer
+    {
+        itk::ImageIORegion region;
+        std::vector<char> data;
+    };
+
+    ImageIOBase::Pointer m_ImageIO;
+    std::vector<RegionBuffer> m_Slots;
+    size_t m_Head;
+    size_t m_Count;
+    bool m_bDone;
+    bool m_bAbort;
+    bool m_bFailed;
+    std::string m_ErrorMsg;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_NotEmpty;
+    std::condition_variable m_NotFull;
+    std::thread m_Thread;
+
+private:
+    AsyncImageIOWriter(const AsyncImageIOWriter&); //purposely not implemented
+    void operator=(const AsyncImageIOWriter&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#endif /* OTBASYNCIMAGEIOWRITER_H_ */
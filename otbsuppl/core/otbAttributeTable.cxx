@@ -418,6 +418,121 @@ void AttributeTable::PrintStructure(std::ostream& os, itk::Indent indent)
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 // ---------------------  PROTECTED FUNCTIONS -----------------------------------------------
 
+// ------------------------------------------------------- bulk column access
+// NOTE: the below are generic (i.e. per cell) fallback implementations
+// for table types not providing a more efficient implementation; at least,
+// the column name is only resolved once per column rather than once per cell
+bool
+AttributeTable::resolveColumns(const std::vector<std::string>& colNames,
+                               size_t numBuffers,
+                               std::vector<int>& colIdx)
+{
+    if (colNames.size() != numBuffers)
+    {
+        return false;
+    }
+
+    colIdx.clear();
+    for (int c=0; c < colNames.size(); ++c)
+    {
+        const int idx = this->ColumnExists(colNames[c]);
+        if (idx < 0)
+        {
+            return false;
+        }
+        colIdx.push_back(idx);
+    }
+    return true;
+}
+
+bool
+AttributeTable::GetColumnRange(const std::vector<std::string>& colNames,
+                               long long startRow, long long numRows,
+                               const std::vector<double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        double* buf = buffers[c];
+        for (long long r=0; r < numRows; ++r)
+        {
+            buf[r] = this->GetDblValue(colIdx[c], startRow + r);
+        }
+    }
+    return true;
+}
+
+bool
+AttributeTable::GetColumnRange(const std::vector<std::string>& colNames,
+                               long long startRow, long long numRows,
+                               const std::vector<long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        long long* buf = buffers[c];
+        for (long long r=0; r < numRows; ++r)
+        {
+            buf[r] = this->GetIntValue(colIdx[c], startRow + r);
+        }
+    }
+    return true;
+}
+
+bool
+AttributeTable::SetColumnRange(const std::vector<std::string>& colNames,
+                               long long startRow, long long numRows,
+                               const std::vector<const double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const double* buf = buffers[c];
+        for (long long r=0; r < numRows; ++r)
+        {
+            this->SetValue(colIdx[c], startRow + r, buf[r]);
+        }
+    }
+    return true;
+}
+
+bool
+AttributeTable::SetColumnRange(const std::vector<std::string>& colNames,
+                               long long startRow, long long numRows,
+                               const std::vector<const long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const long long* buf = buffers[c];
+        for (long long r=0; r < numRows; ++r)
+        {
+            this->SetValue(colIdx[c], startRow + r, buf[r]);
+        }
+    }
+    return true;
+}
+
 std::string AttributeTable::typestr(TableColumnType type)
 {
     switch(type)
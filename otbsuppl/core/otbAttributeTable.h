@@ -123,6 +123,29 @@ public:
 
     } ColumnValue;
 
+    /** Read-only view of a contiguous block of column values,
+     *  i.e. pointer and number of elements; spans are only
+     *  valid as long as the table's structure (number of rows
+     *  or columns) is not changed!
+     */
+    template<class TValue>
+    struct ColumnSpan
+    {
+        ColumnSpan() : data(nullptr), size(0) {}
+        ColumnSpan(const TValue* d, long long n) : data(d), size(n) {}
+
+        bool empty() const {return data == nullptr || size == 0;}
+        const TValue& operator[](long long i) const {return data[i];}
+        const TValue* begin() const {return data;}
+        const TValue* end() const {return data + size;}
+
+        const TValue* data;
+        long long size;
+    };
+
+    typedef ColumnSpan<double>    DblColumnSpan;
+    typedef ColumnSpan<long long> IntColumnSpan;
+
 
     //itkNewMacro(Self);
 	itkTypeMacro(AttributeTable, Superclass);
@@ -157,6 +180,42 @@ public:
     virtual long long GetIntValue(int col, long long row) = 0;
     virtual std::string GetStrValue(int col, long long row) = 0;
 
+    /** Bulk column access
+     *
+     *  Copies the values of rows [startRow, startRow + numRows)
+     *  of each column in colNames into the corresponding caller
+     *  provided buffer (buffers[i] must hold at least numRows
+     *  values); rows not present in the table are set to nodata.
+     *  Returns false, if any of the columns doesn't exist or the
+     *  number of buffers doesn't match the number of columns.
+     *  Note: startRow refers to the same row index as used by
+     *  Get/SetValue, i.e. the table's primary key.
+     */
+    virtual bool GetColumnRange(const std::vector<std::string>& colNames,
+                                long long startRow, long long numRows,
+                                const std::vector<double*>& buffers);
+    virtual bool GetColumnRange(const std::vector<std::string>& colNames,
+                                long long startRow, long long numRows,
+                                const std::vector<long long*>& buffers);
+
+    /** Writes numRows values of each buffer into the
+     *  corresponding column, starting at startRow */
+    virtual bool SetColumnRange(const std::vector<std::string>& colNames,
+                                long long startRow, long long numRows,
+                                const std::vector<const double*>& buffers);
+    virtual bool SetColumnRange(const std::vector<std::string>& colNames,
+                                long long startRow, long long numRows,
+                                const std::vector<const long long*>& buffers);
+
+    /** Zero-copy read-only access to the values of a column;
+     *  only supported by in-memory tables for columns of the
+     *  matching type, otherwise an empty span is returned
+     */
+    virtual DblColumnSpan GetDblColumnSpan(const std::string& sColName)
+        {return DblColumnSpan();}
+    virtual IntColumnSpan GetIntColumnSpan(const std::string& sColName)
+        {return IntColumnSpan();}
+
     double GetDblNodata(void) {return m_dNodata;}
     long long GetIntNodata(void) {return m_iNodata;}
     std::string GetStrNodata(void) {return m_sNodata;}
@@ -211,6 +270,13 @@ protected:
     int valid(const std::string& sColName, int idx);
 	std::string typestr(TableColumnType type);
 
+    // looks up the column indices of the given columns and
+    // checks whether there's a buffer for each column;
+    // returns false if not or if any of the columns doesn't exist
+    bool resolveColumns(const std::vector<std::string>& colNames,
+                        size_t numBuffers,
+                        std::vector<int>& colIdx);
+
 };
 
 }
@@ -33,6 +33,39 @@
 namespace otb
 {
 
+namespace
+{
+// copies the values src[start, start+num) into dest converting
+// them into TDest; positions outside the source vector are set
+// to nodata
+template<class TSrc, class TDest>
+void copyColumnRange(const std::vector<TSrc>& src, long long start,
+                     long long num, TDest* dest, const TDest& nodata)
+{
+    const long long n = static_cast<long long>(src.size());
+    long long first = std::min(std::max(-start, 0LL), num);
+    long long last = std::max(std::min(n - start, num), first);
+
+    std::fill(dest, dest + first, nodata);
+    std::copy(src.begin() + (start + first), src.begin() + (start + last),
+              dest + first);
+    std::fill(dest + last, dest + num, nodata);
+}
+
+// copies src[0, num) into dest[start, start+num); values
+// to be written outside the destination vector are ignored
+template<class TSrc, class TDest>
+void writeColumnRange(std::vector<TDest>& dest, long long start,
+                      long long num, const TSrc* src)
+{
+    const long long n = static_cast<long long>(dest.size());
+    long long first = std::min(std::max(-start, 0LL), num);
+    long long last = std::max(std::min(n - start, num), first);
+
+    std::copy(src + first, src + last, dest.begin() + (start + first));
+}
+}
+
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 // ---------------------  PUBLIC GETTER and SETTER functions to manage the Attribute table
 //int RAMTable::GetNumCols()
@@ -479,6 +512,173 @@ RAMTable::GetRowIdx(const std::string& column, void* value)
 }
 
 
+bool
+RAMTable::GetColumnRange(const std::vector<std::string>& colNames,
+                         long long startRow, long long numRows,
+                         const std::vector<double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const int& tidx = m_vPosition[colIdx[c]];
+        switch(m_vTypes[colIdx[c]])
+        {
+        case ATTYPE_INT:
+            copyColumnRange(*m_mIntCols.at(tidx), startRow, numRows,
+                            buffers[c], m_dNodata);
+            break;
+        case ATTYPE_DOUBLE:
+            copyColumnRange(*m_mDoubleCols.at(tidx), startRow, numRows,
+                            buffers[c], m_dNodata);
+            break;
+        default:
+            for (long long r=0; r < numRows; ++r)
+            {
+                buffers[c][r] = this->GetDblValue(colIdx[c], startRow + r);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool
+RAMTable::GetColumnRange(const std::vector<std::string>& colNames,
+                         long long startRow, long long numRows,
+                         const std::vector<long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const int& tidx = m_vPosition[colIdx[c]];
+        switch(m_vTypes[colIdx[c]])
+        {
+        case ATTYPE_INT:
+            copyColumnRange(*m_mIntCols.at(tidx), startRow, numRows,
+                            buffers[c], m_iNodata);
+            break;
+        case ATTYPE_DOUBLE:
+            copyColumnRange(*m_mDoubleCols.at(tidx), startRow, numRows,
+                            buffers[c], m_iNodata);
+            break;
+        default:
+            for (long long r=0; r < numRows; ++r)
+            {
+                buffers[c][r] = this->GetIntValue(colIdx[c], startRow + r);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool
+RAMTable::SetColumnRange(const std::vector<std::string>& colNames,
+                         long long startRow, long long numRows,
+                         const std::vector<const double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const int& tidx = m_vPosition[colIdx[c]];
+        switch(m_vTypes[colIdx[c]])
+        {
+        case ATTYPE_INT:
+            writeColumnRange(*m_mIntCols.at(tidx), startRow, numRows, buffers[c]);
+            break;
+        case ATTYPE_DOUBLE:
+            writeColumnRange(*m_mDoubleCols.at(tidx), startRow, numRows, buffers[c]);
+            break;
+        default:
+            for (long long r=0; r < numRows; ++r)
+            {
+                this->SetValue(colIdx[c], startRow + r, buffers[c][r]);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool
+RAMTable::SetColumnRange(const std::vector<std::string>& colNames,
+                         long long startRow, long long numRows,
+                         const std::vector<const long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        const int& tidx = m_vPosition[colIdx[c]];
+        switch(m_vTypes[colIdx[c]])
+        {
+        case ATTYPE_INT:
+            writeColumnRange(*m_mIntCols.at(tidx), startRow, numRows, buffers[c]);
+            break;
+        case ATTYPE_DOUBLE:
+            writeColumnRange(*m_mDoubleCols.at(tidx), startRow, numRows, buffers[c]);
+            break;
+        default:
+            for (long long r=0; r < numRows; ++r)
+            {
+                this->SetValue(colIdx[c], startRow + r, buffers[c][r]);
+            }
+            break;
+        }
+    }
+
+    return true;
+}
+
+AttributeTable::DblColumnSpan
+RAMTable::GetDblColumnSpan(const std::string& sColName)
+{
+    const int colidx = this->ColumnExists(sColName);
+    if (colidx < 0 || m_vTypes[colidx] != ATTYPE_DOUBLE)
+    {
+        return DblColumnSpan();
+    }
+
+    const std::vector<double>* col = m_mDoubleCols.at(m_vPosition[colidx]);
+    return DblColumnSpan(col->data(), static_cast<long long>(col->size()));
+}
+
+AttributeTable::IntColumnSpan
+RAMTable::GetIntColumnSpan(const std::string& sColName)
+{
+    const int colidx = this->ColumnExists(sColName);
+    if (colidx < 0 || m_vTypes[colidx] != ATTYPE_INT)
+    {
+        return IntColumnSpan();
+    }
+
+    const std::vector<long long>* col = m_mIntCols.at(m_vPosition[colidx]);
+    return IntColumnSpan(col->data(), static_cast<long long>(col->size()));
+}
+
+
 //void RAMTable::SetBandNumber(int iBand)
 //{
 //	if (iBand > 0)
@@ -101,6 +101,24 @@ public:
     long long GetMinPKValue();
     long long GetMaxPKValue();
 
+    // bulk column access directly from/to the column vectors
+    bool GetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<double*>& buffers);
+    bool GetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<long long*>& buffers);
+    bool SetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<const double*>& buffers);
+    bool SetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<const long long*>& buffers);
+
+    // zero-copy views of the INT and DOUBLE column vectors
+    DblColumnSpan GetDblColumnSpan(const std::string& sColName);
+    IntColumnSpan GetIntColumnSpan(const std::string& sColName);
+
 	bool RemoveColumn(int col);
 	bool RemoveColumn(const std::string& name);
 
@@ -88,6 +88,181 @@ long long SQLiteTable::GetNumRows()
     return m_iNumRows;
 }
 
+// ------------------------------------------------------- page cache
+void
+SQLiteTable::SetCacheSize(long long numPages)
+{
+    m_iCacheSize = numPages > 0 ? numPages : 0;
+    while (m_CacheList.size() > m_iCacheSize)
+    {
+        m_CacheMap.erase(m_CacheList.back().key);
+        m_CacheList.pop_back();
+    }
+}
+
+void
+SQLiteTable::SetCachePageSize(long long numRows)
+{
+    if (numRows > 0 && numRows != m_iCachePageRows)
+    {
+        m_iCachePageRows = numRows;
+        this->ClearCache();
+    }
+}
+
+void
+SQLiteTable::ClearCache(void)
+{
+    if (m_CacheList.empty())
+    {
+        return;
+    }
+    m_CacheList.clear();
+    m_CacheMap.clear();
+}
+
+void
+SQLiteTable::invalidateCache(int col, long long row)
+{
+    if (m_CacheList.empty())
+    {
+        return;
+    }
+
+    if (row < 0)
+    {
+        CacheList::iterator it = m_CacheList.begin();
+        while (it != m_CacheList.end())
+        {
+            if (it->col == col)
+            {
+                m_CacheMap.erase(it->key);
+                it = m_CacheList.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        return;
+    }
+
+    // remove the block for any of the value types
+    const long long block = row / m_iCachePageRows;
+    for (int t=CACHE_DBL; t <= CACHE_STR; ++t)
+    {
+        const unsigned long long key = (static_cast<unsigned long long>(block) << 22)
+                | (static_cast<unsigned long long>(col) << 2) | t;
+        std::unordered_map<unsigned long long, CacheList::iterator>::iterator mit =
+                m_CacheMap.find(key);
+        if (mit != m_CacheMap.end())
+        {
+            m_CacheList.erase(mit->second);
+            m_CacheMap.erase(mit);
+        }
+    }
+}
+
+SQLiteTable::CachePage*
+SQLiteTable::getCachePage(int col, long long row, CacheValueType vtype)
+{
+    const long long block = row / m_iCachePageRows;
+    const unsigned long long key = (static_cast<unsigned long long>(block) << 22)
+            | (static_cast<unsigned long long>(col) << 2) | vtype;
+
+    std::unordered_map<unsigned long long, CacheList::iterator>::iterator mit =
+            m_CacheMap.find(key);
+    if (mit != m_CacheMap.end())
+    {
+        ++m_iCacheHits;
+        // move the page to the front of the list, i.e.
+        // mark it as the most recently used one
+        m_CacheList.splice(m_CacheList.begin(), m_CacheList, mit->second);
+        return &m_CacheList.front();
+    }
+
+    ++m_iCacheMisses;
+    while (m_CacheList.size() >= m_iCacheSize)
+    {
+        m_CacheMap.erase(m_CacheList.back().key);
+        m_CacheList.pop_back();
+    }
+
+    m_CacheList.push_front(CachePage());
+    CachePage& page = m_CacheList.front();
+    page.key = key;
+    page.col = col;
+    page.block = block;
+    page.vtype = vtype;
+
+    if (!this->loadCachePage(page))
+    {
+        m_CacheList.pop_front();
+        return nullptr;
+    }
+
+    m_CacheMap[key] = m_CacheList.begin();
+    return &page;
+}
+
+bool
+SQLiteTable::loadCachePage(CachePage& page)
+{
+    std::vector<std::string> colName;
+    colName.push_back(m_vNames.at(page.col));
+
+    sqlite3_stmt* stmt = this->prepareColumnRangeStmt(colName, false);
+    if (stmt == nullptr)
+    {
+        return false;
+    }
+
+    const long long startRow = page.block * m_iCachePageRows;
+    switch(page.vtype)
+    {
+    case CACHE_DBL:
+        page.dvals.assign(m_iCachePageRows, m_dNodata);
+        break;
+    case CACHE_INT:
+        page.ivals.assign(m_iCachePageRows, m_iNodata);
+        break;
+    default:
+        page.svals.assign(m_iCachePageRows, m_sNodata);
+        break;
+    }
+
+    sqlite3_bind_int64(stmt, 1, startRow);
+    sqlite3_bind_int64(stmt, 2, startRow + m_iCachePageRows - 1);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const long long r = sqlite3_column_int64(stmt, 0) - startRow;
+        switch(page.vtype)
+        {
+        case CACHE_DBL:
+            page.dvals[r] = sqlite3_column_double(stmt, 1);
+            break;
+        case CACHE_INT:
+            page.ivals[r] = sqlite3_column_int64(stmt, 1);
+            break;
+        default:
+            {
+                const unsigned char* sval = sqlite3_column_text(stmt, 1);
+                if (sval)
+                {
+                    page.svals[r] = reinterpret_cast<const char*>(sval);
+                }
+            }
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    // we don't keep incomplete pages
+    return rc == SQLITE_DONE;
+}
+
 bool
 SQLiteTable::sqliteError(const int& rc, sqlite3_stmt** stmt)
 {
@@ -1393,6 +1568,9 @@ SQLiteTable::DoPtrBulkSet(std::vector<int *> &intVals,
         return false;
     }
 
+    // rows may be addressed by arbitrary where clauses
+    this->ClearCache();
+
     int rc;
     for (int i=0; i < colpos.size(); ++i)
     {
@@ -1470,6 +1648,9 @@ SQLiteTable::DoBulkSet(std::vector<ColumnValue> &values, const long long int &ro
         return false;
     }
 
+    // rows may be addressed by arbitrary where clauses
+    this->ClearCache();
+
     int rc;
     for (int i=0; i < values.size(); ++i)
     {
@@ -1546,6 +1727,9 @@ SQLiteTable::DoBulkSet(std::vector< ColumnValue >& values, std::vector< ColumnVa
         return false;
     }
 
+    // rows may be addressed by arbitrary where clauses
+    this->ClearCache();
+
     int rc;
     int valueCounter = 1;
     for (int i=0; i < values.size(); ++i, ++valueCounter)
@@ -1727,6 +1911,8 @@ SQLiteTable::sqliteStepCheck(const int& rc)
     case SQLITE_BUSY:
         sqlite3_step(m_StmtRollback);
         sqlite3_reset(m_StmtRollback);
+        // cached values may be out of date now
+        this->ClearCache();
         break;
 
     case SQLITE_ERROR:
@@ -1759,6 +1945,7 @@ SQLiteTable::SetValue(const std::string& sColName, long long int idx, double val
         return;
     }
     sqlite3_stmt* stmt = m_vStmtUpdate.at(colidx);
+    this->invalidateCache(colidx, idx);
 
     //    int rc = sqlite3_bind_text(m_vStmtUpdate.at(colidx), 1, sColName.c_str(), -1, 0);
     //    if (sqliteError(rc, &m_StmtUpdate)) return;
@@ -1804,6 +1991,7 @@ SQLiteTable::SetValue(const std::string& sColName, long long int idx, long long
         return;
     }
     sqlite3_stmt* stmt = m_vStmtUpdate.at(colidx);
+    this->invalidateCache(colidx, idx);
 
 
     //    int rc = sqlite3_bind_text(m_StmtUpdate, 1, sColName.c_str(), -1, 0);
@@ -1849,6 +2037,7 @@ SQLiteTable::SetValue(const std::string& sColName, long long int idx, std::strin
         return;
     }
     sqlite3_stmt* stmt = m_vStmtUpdate.at(colidx);
+    this->invalidateCache(colidx, idx);
 
     //    int rc = sqlite3_bind_text(m_StmtUpdate, 1, sColName.c_str(), -1, 0);
     //    if (sqliteError(rc, &m_StmtUpdate)) return;
@@ -1895,6 +2084,8 @@ SQLiteTable::SetValue(const std::string& sColName, const std::string& whereClaus
         return;
     }
 
+    this->invalidateCache(colidx);
+
     sqlite3_stmt* stmt_upd;
     std::stringstream ssql;
     ssql <<  "UPDATE main." << "\"" << m_tableName << "\"" << " SET \"" << sColName << "\" = "
@@ -1931,6 +2122,8 @@ SQLiteTable::SetValue(const std::string& sColName, const std::string& whereClaus
         return;
     }
 
+    this->invalidateCache(colidx);
+
     sqlite3_stmt* stmt_upd;
     std::stringstream ssql;
     ssql <<  "UPDATE main." << "\"" << m_tableName << "\"" << " SET \"" << sColName << "\" = "
@@ -1969,6 +2162,8 @@ SQLiteTable::SetValue(const std::string& sColName, const std::string& whereClaus
         return;
     }
 
+    this->invalidateCache(colidx);
+
     sqlite3_stmt* stmt_upd;
     std::stringstream ssql;
     ssql <<  "UPDATE main." << "\"" << m_tableName << "\"" << " SET \"" << sColName << "\" = "
@@ -2060,6 +2255,15 @@ double SQLiteTable::GetDblValue(const std::string& sColName, long long int idx)
     if (colidx < 0)
         return m_dNodata;
 
+    if (m_iCacheSize > 0 && idx >= 0)
+    {
+        CachePage* page = this->getCachePage(colidx, idx, CACHE_DBL);
+        if (page != nullptr)
+        {
+            return page->dvals[idx - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(colidx);
     int rc = sqlite3_bind_int64(stmt, 1, idx);
     if (sqliteError(rc, &stmt)) return m_dNodata;
@@ -2089,6 +2293,15 @@ SQLiteTable::GetIntValue(const std::string& sColName, long long idx)
     if (colidx < 0)// || idx < 0)// || idx > m_iNumRows)
         return m_iNodata;
 
+    if (m_iCacheSize > 0 && idx >= 0)
+    {
+        CachePage* page = this->getCachePage(colidx, idx, CACHE_INT);
+        if (page != nullptr)
+        {
+            return page->ivals[idx - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(colidx);
     int rc = sqlite3_bind_int64(stmt, 1, idx);
     if (sqliteError(rc, &stmt)) return m_iNodata;
@@ -2122,6 +2335,15 @@ SQLiteTable::GetStrValue(const std::string& sColName, long long idx)
     if (colidx < 0)// || idx < 0)// || idx > m_iNumRows)
         return m_sNodata;
 
+    if (m_iCacheSize > 0 && idx >= 0)
+    {
+        CachePage* page = this->getCachePage(colidx, idx, CACHE_STR);
+        if (page != nullptr)
+        {
+            return page->svals[idx - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(colidx);
     int rc = sqlite3_bind_int64(stmt, 1, idx);
     if (sqliteError(rc, &stmt)) return m_sNodata;
@@ -2336,6 +2558,9 @@ SQLiteTable::RemoveColumn(const std::string& name)
         return true;
     }
 
+    // column indices are going to change
+    this->ClearCache();
+
     std::vector<std::string> colsvec = this->m_vNames;
     colsvec.erase(colsvec.begin()+idx);
 
@@ -2386,6 +2611,7 @@ void SQLiteTable::SetValue(int col, long long int row, double value)
 
 
     sqlite3_stmt* stmt = m_vStmtUpdate.at(col);
+    this->invalidateCache(col, row);
 
     int rc = sqlite3_bind_double(stmt, 1, value);
     if (sqliteError(rc, &stmt))
@@ -2419,6 +2645,7 @@ void SQLiteTable::SetValue(int col, long long int row, long long int value)
     }
 
     sqlite3_stmt* stmt = m_vStmtUpdate.at(col);
+    this->invalidateCache(col, row);
 
     int rc = sqlite3_bind_int64(stmt, 1, value);
     if (sqliteError(rc, &stmt))
@@ -2452,6 +2679,7 @@ void SQLiteTable::SetValue(int col, long long int row, std::string value)
     }
 
     sqlite3_stmt* stmt = m_vStmtUpdate.at(col);
+    this->invalidateCache(col, row);
 
     int rc = sqlite3_bind_text(stmt, 1, value.c_str(), -1, 0);
     if (sqliteError(rc, &stmt))
@@ -2482,6 +2710,15 @@ double SQLiteTable::GetDblValue(int col, long long row)
     //	if (row < 0 || row >= m_iNumRows)
     //		return m_dNodata;
 
+    if (m_iCacheSize > 0 && row >= 0)
+    {
+        CachePage* page = this->getCachePage(col, row, CACHE_DBL);
+        if (page != nullptr)
+        {
+            return page->dvals[row - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(col);
     int rc = sqlite3_bind_int64(stmt, 1, row);
     if (sqliteError(rc, &stmt)) return m_dNodata;
@@ -2512,6 +2749,15 @@ SQLiteTable::GetIntValue(int col, long long row)
     //	if (row < 0 || row >= m_iNumRows)
     //		return m_iNodata;
 
+    if (m_iCacheSize > 0 && row >= 0)
+    {
+        CachePage* page = this->getCachePage(col, row, CACHE_INT);
+        if (page != nullptr)
+        {
+            return page->ivals[row - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(col);
     int rc = sqlite3_bind_int64(stmt, 1, row);
     if (sqliteError(rc, &stmt)) return m_iNodata;
@@ -2533,6 +2779,233 @@ SQLiteTable::GetIntValue(int col, long long row)
     return ret;
 }
 
+sqlite3_stmt*
+SQLiteTable::prepareColumnRangeStmt(const std::vector<std::string>& colNames,
+                                    bool bUpdate)
+{
+    if (m_db == 0 || colNames.size() == 0)
+    {
+        return nullptr;
+    }
+
+    std::stringstream ssql;
+    if (bUpdate)
+    {
+        ssql << "UPDATE main." << "\"" << m_tableName << "\"" << " SET ";
+        for (int c=0; c < colNames.size(); ++c)
+        {
+            ssql << "\"" << colNames[c] << "\" = ?" << c+1;
+            if (c < colNames.size()-1)
+            {
+                ssql << ", ";
+            }
+        }
+        ssql << " WHERE " << m_idColName << " = ?" << colNames.size()+1 << " ;";
+    }
+    else
+    {
+        ssql << "SELECT " << m_idColName;
+        for (int c=0; c < colNames.size(); ++c)
+        {
+            ssql << ", \"" << colNames[c] << "\"";
+        }
+        ssql << " FROM main." << "\"" << m_tableName << "\""
+             << " WHERE " << m_idColName << " BETWEEN ?1 AND ?2 ;";
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    int rc = sqlite3_prepare_v2(m_db, ssql.str().c_str(), -1, &stmt, 0);
+    if (sqliteError(rc, &stmt))
+    {
+        sqlite3_finalize(stmt);
+        return nullptr;
+    }
+
+    return stmt;
+}
+
+bool
+SQLiteTable::GetColumnRange(const std::vector<std::string>& colNames,
+                            long long startRow, long long numRows,
+                            const std::vector<double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = this->prepareColumnRangeStmt(colNames, false);
+    if (stmt == nullptr)
+    {
+        return false;
+    }
+
+    for (int c=0; c < buffers.size(); ++c)
+    {
+        std::fill(buffers[c], buffers[c] + numRows, m_dNodata);
+    }
+
+    sqlite3_bind_int64(stmt, 1, startRow);
+    sqlite3_bind_int64(stmt, 2, startRow + numRows - 1);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const long long r = sqlite3_column_int64(stmt, 0) - startRow;
+        for (int c=0; c < buffers.size(); ++c)
+        {
+            buffers[c][r] = sqlite3_column_double(stmt, c+1);
+        }
+    }
+    sqliteStepCheck(rc);
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+bool
+SQLiteTable::GetColumnRange(const std::vector<std::string>& colNames,
+                            long long startRow, long long numRows,
+                            const std::vector<long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = this->prepareColumnRangeStmt(colNames, false);
+    if (stmt == nullptr)
+    {
+        return false;
+    }
+
+    for (int c=0; c < buffers.size(); ++c)
+    {
+        std::fill(buffers[c], buffers[c] + numRows, m_iNodata);
+    }
+
+    sqlite3_bind_int64(stmt, 1, startRow);
+    sqlite3_bind_int64(stmt, 2, startRow + numRows - 1);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const long long r = sqlite3_column_int64(stmt, 0) - startRow;
+        for (int c=0; c < buffers.size(); ++c)
+        {
+            buffers[c][r] = sqlite3_column_int64(stmt, c+1);
+        }
+    }
+    sqliteStepCheck(rc);
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+bool
+SQLiteTable::SetColumnRange(const std::vector<std::string>& colNames,
+                            long long startRow, long long numRows,
+                            const std::vector<const double*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = this->prepareColumnRangeStmt(colNames, true);
+    if (stmt == nullptr)
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        this->invalidateCache(colIdx[c]);
+    }
+
+    // wrap the update into a transaction, unless
+    // the caller has already started one
+    const bool bOwnTransaction = sqlite3_get_autocommit(m_db) != 0;
+    if (bOwnTransaction)
+    {
+        this->BeginTransaction();
+    }
+
+    const int pkIdx = buffers.size() + 1;
+    for (long long r=0; r < numRows; ++r)
+    {
+        for (int c=0; c < buffers.size(); ++c)
+        {
+            sqlite3_bind_double(stmt, c+1, buffers[c][r]);
+        }
+        sqlite3_bind_int64(stmt, pkIdx, startRow + r);
+
+        sqliteStepCheck(sqlite3_step(stmt));
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (bOwnTransaction)
+    {
+        this->EndTransaction();
+    }
+
+    return true;
+}
+
+bool
+SQLiteTable::SetColumnRange(const std::vector<std::string>& colNames,
+                            long long startRow, long long numRows,
+                            const std::vector<const long long*>& buffers)
+{
+    std::vector<int> colIdx;
+    if (!this->resolveColumns(colNames, buffers.size(), colIdx))
+    {
+        return false;
+    }
+
+    sqlite3_stmt* stmt = this->prepareColumnRangeStmt(colNames, true);
+    if (stmt == nullptr)
+    {
+        return false;
+    }
+
+    for (int c=0; c < colIdx.size(); ++c)
+    {
+        this->invalidateCache(colIdx[c]);
+    }
+
+    const bool bOwnTransaction = sqlite3_get_autocommit(m_db) != 0;
+    if (bOwnTransaction)
+    {
+        this->BeginTransaction();
+    }
+
+    const int pkIdx = buffers.size() + 1;
+    for (long long r=0; r < numRows; ++r)
+    {
+        for (int c=0; c < buffers.size(); ++c)
+        {
+            sqlite3_bind_int64(stmt, c+1, buffers[c][r]);
+        }
+        sqlite3_bind_int64(stmt, pkIdx, startRow + r);
+
+        sqliteStepCheck(sqlite3_step(stmt));
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+
+    if (bOwnTransaction)
+    {
+        this->EndTransaction();
+    }
+
+    return true;
+}
+
 long long
 SQLiteTable::GetMinMaxPKValue(bool bmax)
 {
@@ -2599,6 +3072,15 @@ std::string SQLiteTable::GetStrValue(int col, long long row)
     //	if (row < 0 || row >= m_iNumRows)
     //		return m_sNodata;
 
+    if (m_iCacheSize > 0 && row >= 0)
+    {
+        CachePage* page = this->getCachePage(col, row, CACHE_STR);
+        if (page != nullptr)
+        {
+            return page->svals[row - page->block * m_iCachePageRows];
+        }
+    }
+
     sqlite3_stmt* stmt = m_vStmtSelect.at(col);
     int rc = sqlite3_bind_int64(stmt, 1, row);
     if (sqliteError(rc, &stmt)) return m_sNodata;
@@ -2755,6 +3237,8 @@ SQLiteTable::DropTable(const std::string &tablename)
         return false;
     }
 
+    this->ClearCache();
+
     std::stringstream ssql;
 
     ssql << "Drop table ";
@@ -3634,7 +4118,11 @@ SQLiteTable::SQLiteTable()
       m_bOpenReadOnly(false),
       m_lastLogMsg(""),
       m_bPersistentRowIdColName(false),
-      m_bLoadSpatialite(true)
+      m_bLoadSpatialite(true),
+      m_iCacheSize(0),
+      m_iCachePageRows(1024),
+      m_iCacheHits(0),
+      m_iCacheMisses(0)
 {
     //this->createTable("");
     this->m_ATType = ATTABLE_TYPE_SQLITE;
@@ -3746,6 +4234,10 @@ SQLiteTable::resetTableAdmin(void)
     m_vStmtSelect.clear();
     m_vStmtGetRowidx.clear();
 
+    this->ClearCache();
+    m_iCacheHits = 0;
+    m_iCacheMisses = 0;
+
     m_iNumRows = 0;
     m_iStmtBulkGetNumParam = 0;
     m_iStmtCustomRowCountParam = 0;
@@ -4103,6 +4595,9 @@ SQLiteTable::SqlExec(const std::string& sqlstr)
         return false;
     }
 
+    // we've got no idea what the statement is going to do
+    this->ClearCache();
+
     bool ret = true;
 
     char* errMsg;
@@ -4132,6 +4627,8 @@ SQLiteTable::JoinAttributes(const std::string& targetTable,
         return false;
     }
 
+    this->ClearCache();
+
     // attach database if necessary
     std::string sourceDb = "main";
     if (!this->FindTable(sourceTable))
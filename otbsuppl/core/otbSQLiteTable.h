@@ -29,6 +29,8 @@
 #include <map>
 #include <vector>
 #include <fstream>
+#include <list>
+#include <unordered_map>
 #include <sqlite3.h>
 
 #include "otbAttributeTable.h"
@@ -116,6 +118,21 @@ public:
     bool RemoveColumn(int col);
     bool RemoveColumn(const std::string& name);
 
+    /// bulk column access using a single ranged SELECT (UPDATE)
+    /// on the table's primary key
+    bool GetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<double*>& buffers);
+    bool GetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<long long*>& buffers);
+    bool SetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<const double*>& buffers);
+    bool SetColumnRange(const std::vector<std::string>& colNames,
+                        long long startRow, long long numRows,
+                        const std::vector<const long long*>& buffers);
+
 //	// print the table
 //	void Print(std::ostream& os, itk::Indent indent, int nrows);
 //	void PrintStructure(std::ostream& os, itk::Indent indent);
@@ -318,6 +335,26 @@ public:
 
     std::string getLastLogMsg(void){return m_lastLogMsg;}
 
+    /// READ-THROUGH PAGE CACHE FOR CELL ACCESS
+    /*! When enabled (i.e. numPages > 0), Get{Dbl|Int|Str}Value(col, row)
+     *  load blocks of CachePageSize consecutive rows (primary key values)
+     *  of the requested column on a cache miss and serve subsequent
+     *  requests for the same block from memory; at most numPages
+     *  blocks are kept, the least recently used block is evicted first.
+     *  Any write through this object invalidates the affected blocks;
+     *  NOTE: writes through other connections to the same database are
+     *  not tracked!
+     */
+    void SetCacheSize(long long numPages);
+    long long GetCacheSize(void) {return m_iCacheSize;}
+    void SetCachePageSize(long long numRows);
+    long long GetCachePageSize(void) {return m_iCachePageRows;}
+
+    long long GetCacheHits(void) {return m_iCacheHits;}
+    long long GetCacheMisses(void) {return m_iCacheMisses;}
+    void ResetCacheStatistics(void) {m_iCacheHits = 0; m_iCacheMisses = 0;}
+    void ClearCache(void);
+
 protected:
         SQLiteTable();
     virtual ~SQLiteTable();
@@ -346,6 +383,46 @@ protected:
     //std::string formatTableName(const std::string& tableName);
     long long GetMinMaxPKValue(bool bmax);
 
+    /*! prepares 'SELECT pk, col_1, ..., col_n ... WHERE pk BETWEEN ?1 AND ?2'
+     *  or 'UPDATE ... SET col_1 = ?1, ..., col_n = ?n WHERE pk = ?n+1'
+     *  for the bulk column access functions; returns nullptr on error
+     */
+    sqlite3_stmt* prepareColumnRangeStmt(const std::vector<std::string>& colNames,
+                                         bool bUpdate);
+
+    /*! page cache support */
+    typedef enum
+    {
+        CACHE_DBL = 0,
+        CACHE_INT,
+        CACHE_STR
+    } CacheValueType;
+
+    typedef struct
+    {
+        unsigned long long key;
+        int col;
+        long long block;
+        CacheValueType vtype;
+        std::vector<double> dvals;
+        std::vector<long long> ivals;
+        std::vector<std::string> svals;
+    } CachePage;
+
+    typedef std::list<CachePage> CacheList;
+
+    /*! returns the (possibly newly loaded) cache page holding
+     *  the given row of the given column or nullptr if the row
+     *  couldn't be loaded
+     */
+    CachePage* getCachePage(int col, long long row, CacheValueType vtype);
+    bool loadCachePage(CachePage& page);
+
+    /*! removes the page(s) holding the given row of the given column
+     *  from the cache; row < 0 removes all pages of the given column
+     */
+    void invalidateCache(int col, long long row=-1);
+
     inline bool sqliteError(const int& rc, sqlite3_stmt** stmt);
     inline void sqliteStepCheck(const int& rc);
 
@@ -385,6 +462,13 @@ protected:
     const char* m_CurPrepStmt;
     void* m_SpatialiteCache;
 
+    CacheList m_CacheList;
+    std::unordered_map<unsigned long long, CacheList::iterator> m_CacheMap;
+    long long m_iCacheSize;
+    long long m_iCachePageRows;
+    long long m_iCacheHits;
+    long long m_iCacheMisses;
+
 };
 
 }
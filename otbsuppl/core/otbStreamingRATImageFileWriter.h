@@ -293,6 +293,17 @@ public:
   itkSetMacro(ParallelIO, bool)
   itkGetMacro(ParallelIO, bool)
 
+  /** Set the number of region buffers used for asynchronous
+   *  writing (default: 0, i.e. synchronous writing); if > 0,
+   *  each GDAL output is written by a dedicated thread while
+   *  the next stream division is pulled through the pipeline;
+   *  each buffer holds a copy of one stream division.
+   *  NOTE: NetCDF and rasdaman outputs are always written
+   *  synchronously
+   */
+  itkSetMacro(NumberOfWriteBuffers, unsigned int)
+  itkGetMacro(NumberOfWriteBuffers, unsigned int)
+
   itkSetMacro(MpiComm, MPI_Comm)
   itkGetMacro(MpiComm, MPI_Comm)
 
@@ -341,6 +352,9 @@ protected:
   /** Does the real work. */
   virtual void GenerateData(void);
 
+  /** Sets the pixel type info of the idx-th ImageIO */
+  void SetImageIOPixelTypeInfo(unsigned int idx);
+
 
 private:
   StreamingRATImageFileWriter(const StreamingRATImageFileWriter &); //purposely not implemented
@@ -393,6 +407,7 @@ private:
 
   bool m_WriteGeomFile;              // Write a geom file to store the kwl
   bool m_ParallelIO;
+  unsigned int m_NumberOfWriteBuffers;
 
   MPI_Comm m_MpiComm;
 
@@ -36,6 +36,8 @@
 #ifndef __otbStreamingRATImageFileWriter_txx
 #define __otbStreamingRATImageFileWriter_txx
 
+#include <memory>
+
 #include "nmlog.h"
 #define ctxSIFR "StreamingRATImageFileWriter"
 
@@ -48,6 +50,7 @@
 #include "otbImageIOFactory.h"
 #include "otbGDALRATImageIO.h"
 #include "nmNetCDFIO.h"
+#include "otbAsyncImageIOWriter.h"
 #include "itkMultiResolutionPyramidImageFilter.h"
 
 #ifdef BUILD_RASSUPPORT
@@ -93,6 +96,7 @@ StreamingRATImageFileWriter<TInputImage>
     m_StreamingMethod = "STRIPPED";
     m_StreamingSize = 512;
     m_ParallelIO = false;
+    m_NumberOfWriteBuffers = 0;
     m_MpiComm = MPI_COMM_NULL;
 
     m_UseCompression = true;
@@ -1060,6 +1064,17 @@ StreamingRATImageFileWriter<TInputImage>
             {
                 nio->SetVarDimDescriptors(imd.ExtraKeys["VarAndDimDescriptors"]);
             }
+
+            // chunk the image variable like the stream divisions,
+            // so that each division is written in whole chunks
+            OutputImageRegionType splitRegion = outputRegion;
+            m_StreamingManager->GetSplitter()->GetSplit(0, m_NumberOfDivisions, splitRegion);
+            std::vector<size_t> chunkSizes(TInputImage::ImageDimension);
+            for (unsigned int d=0; d < TInputImage::ImageDimension; ++d)
+            {
+                chunkSizes[d] = splitRegion.GetSize(d);
+            }
+            nio->SetChunkSizes(chunkSizes);
         }
 
         m_ImageIOs[ni]->WriteImageInformation();
@@ -1070,6 +1085,15 @@ StreamingRATImageFileWriter<TInputImage>
 
     this->UpdateProgress(0);
 
+    /*  if requested, GDAL outputs are handed over to a dedicated
+     *  writer thread each, so that the next division can be
+     *  computed while the current one is encoded and written
+     */
+    const bool bAsyncWrite =    m_WriteImage
+                             && m_NumberOfWriteBuffers > 0
+                             && m_NumberOfDivisions > 1;
+    std::vector<std::unique_ptr<AsyncImageIOWriter> > asyncWriters(m_NumberOfInputs);
+
     /*  Pulling a piece of the input image(s) through the pipeline
      *  and then writing it out; if the input component happens to
      *  produce additional images, i.e. output[1..n-1], we grab them
@@ -1133,14 +1157,44 @@ StreamingRATImageFileWriter<TInputImage>
             this->SetIORegion(ioRegion);
             m_ImageIOs[ni]->SetIORegion(m_IORegion);
 
+            if (    bAsyncWrite
+                 && m_CurrentDivision == 0
+                 && dynamic_cast<GDALRATImageIO*>(m_ImageIOs[ni].GetPointer()) != nullptr
+               )
+            {
+                this->SetImageIOPixelTypeInfo(ni);
+                asyncWriters[ni].reset(new AsyncImageIOWriter(m_ImageIOs[ni], m_NumberOfWriteBuffers));
+            }
+
             // Start writing stream region in the image file
-            if (m_WriteImage)
+            if (asyncWriters[ni])
+            {
+                const InputImageType* input = this->GetInput(ni);
+                const size_t numBytes = input->GetPixelContainer()->Size()
+                        * sizeof(typename InputImageType::PixelContainer::Element);
+                asyncWriters[ni]->Write(m_IORegion, input->GetBufferPointer(), numBytes);
+
+                if (m_WriteGeomFile)
+                {
+                    this->GetOutput(ni)->SetImageMetadata(input->GetImageMetadata());
+                }
+            }
+            else if (m_WriteImage)
             {
                 this->GenerateData();
             }
         }
     }
 
+    // wait for any outstanding asynchronous writes
+    for (int ni=0; ni < asyncWriters.size(); ++ni)
+    {
+        if (asyncWriters[ni])
+        {
+            asyncWriters[ni]->Finish();
+        }
+    }
+
 
     /**
    * If we ended due to aborting, push the progress up to 1.0 (since
@@ -1302,23 +1356,7 @@ StreamingRATImageFileWriter<TInputImage>
 {
     const InputImageType * input = this->GetInput(m_CurrentWriteImage);
 
-    // Make sure that the image is the right type and no more than
-    // four components.
-    typedef typename InputImageType::PixelType ImagePixelType;
-
-    if (strcmp(input->GetNameOfClass(), "VectorImage") == 0)
-    {
-        typedef typename InputImageType::InternalPixelType VectorImagePixelType;
-        m_ImageIOs[m_CurrentWriteImage]->SetPixelTypeInfo(typeid(VectorImagePixelType));
-
-        typedef typename InputImageType::AccessorFunctorType AccessorFunctorType;
-        m_ImageIOs[m_CurrentWriteImage]->SetNumberOfComponents(AccessorFunctorType::GetVectorLength(input));
-    }
-    else
-    {
-        // Set the pixel and component type; the number of components.
-        m_ImageIOs[m_CurrentWriteImage]->SetPixelTypeInfo(typeid(ImagePixelType));
-    }
+    this->SetImageIOPixelTypeInfo(m_CurrentWriteImage);
 
     // Setup the image IO for writing.
     //
@@ -1344,6 +1382,32 @@ StreamingRATImageFileWriter<TInputImage>
     //this->ReleaseInputs();
 }
 
+template<class TInputImage>
+void
+StreamingRATImageFileWriter<TInputImage>
+::SetImageIOPixelTypeInfo(unsigned int idx)
+{
+    const InputImageType * input = this->GetInput(idx);
+
+    // Make sure that the image is the right type and no more than
+    // four components.
+    typedef typename InputImageType::PixelType ImagePixelType;
+
+    if (strcmp(input->GetNameOfClass(), "VectorImage") == 0)
+    {
+        typedef typename InputImageType::InternalPixelType VectorImagePixelType;
+        m_ImageIOs[idx]->SetPixelTypeInfo(typeid(VectorImagePixelType));
+
+        typedef typename InputImageType::AccessorFunctorType AccessorFunctorType;
+        m_ImageIOs[idx]->SetNumberOfComponents(AccessorFunctorType::GetVectorLength(input));
+    }
+    else
+    {
+        // Set the pixel and component type; the number of components.
+        m_ImageIOs[idx]->SetPixelTypeInfo(typeid(ImagePixelType));
+    }
+}
+
 template<class TInputImage>
 void
 StreamingRATImageFileWriter<TInputImage>
@@ -35,9 +35,13 @@
 #ifndef __itkNMCostDistanceBufferImageFilter_h
 #define __itkNMCostDistanceBufferImageFilter_h
 
+#include <atomic>
 #include <map>
+#include <string>
+#include <vector>
 #include <itkImageToImageFilter.h>
 #include <itkImageRegionIteratorWithIndex.h>
+#include <itkMultiThreader.h>
 #include "nmotbsupplfilters_export.h"
 
 namespace itk
@@ -140,6 +144,22 @@ public:
   /** Set on/off buffer creation */
   itkBooleanMacro( CreateBuffer )
 
+  /** Sets the algorithm used when the whole image is processed
+   *  at once (i.e. neither ProcessDownward nor ProcessUpward is set)
+   *
+   *  SWEEP (default) - two-pass (downward & upward) approximation, which
+   *                    is also used for chunk-wise (up-/downward) processing
+   *  EXACT           - Euclidean distance: exact separable distance
+   *                    transform, which processes blocks of columns
+   *                    and rows concurrently;
+   *                    cost distance: least-cost paths over the 8-neighbourhood
+   *                    using Dijkstra's algorithm with a bucketed
+   *                    priority queue on concurrently processed blocks
+   *                    of rows
+   */
+  itkSetStringMacro( ProcessingMode )
+  itkGetStringMacro( ProcessingMode )
+
   /** reset the number of execution */
   void resetExecCounter(void);
 
@@ -191,7 +211,7 @@ protected:
                          InPixelType* cbuf,
                          double* colDist,
                          double* rowDist,
-                         int** noff,
+                         const int (*noff)[2],
                          bool& bleftright,
                          bool& binit,
                          int& row,
@@ -202,6 +222,77 @@ protected:
                          OutPixelType& userDist,
                          SpacingType& spacing);
 
+  /** returns true, if val denotes a source object */
+  bool isObject(const InPixelType& val) const;
+
+  struct EDTThreadStruct
+  {
+      NMCostDistanceBufferImageFilter* Filter;
+      int phase;
+      const InPixelType* ibuf;
+      OutPixelType* obuf;
+      double* sqdist;
+      long ncols;
+      long nrows;
+      double sx;
+      double sy;
+      OutPixelType maxDist;
+      OutPixelType userDist;
+  };
+
+  /** Euclidean distance (EXACT mode) */
+  void ExactDistance(InPixelType* ibuf,
+                     OutPixelType* obuf,
+                     SpacingType& spacing,
+                     OutPixelType& maxDist,
+                     OutPixelType& userDist,
+                     int ncols, int nrows);
+
+  static ITK_THREAD_RETURN_TYPE EDTFromThreader(void* arg);
+
+  /** distance along columns [col0, col1) to the nearest object */
+  void EDTColumns(EDTThreadStruct* str, long col0, long col1);
+
+  /** lower envelope of the column distances along rows [row0, row1) */
+  void EDTRows(EDTThreadStruct* str, long row0, long row1);
+
+  struct CostThreadStruct
+  {
+      NMCostDistanceBufferImageFilter* Filter;
+      int round;
+      const InPixelType* ibuf;
+      const InPixelType* cbuf;
+      double* dist;
+      int* stamp;
+      double* halo;
+      int* seeded;
+      long ncols;
+      long nrows;
+      long long numpix;
+      double diag;
+      double minstep;
+      long long numBuckets;
+      std::atomic<long long> numDone;
+  };
+
+  /** cost distance (EXACT mode); returns false, if the cost
+   *  surface isn't suitable (negative costs)
+   */
+  bool CostDistance(InPixelType* ibuf,
+                    InPixelType* cbuf,
+                    OutPixelType* obuf,
+                    SpacingType& spacing,
+                    OutPixelType& maxDist,
+                    int ncols, int nrows);
+
+  static ITK_THREAD_RETURN_TYPE CostFromThreader(void* arg);
+
+  /** least-cost paths within rows [row0, row1), starting from
+   *  the objects (first round) or from the rows adjacent to the
+   *  block (halo) of the previous round
+   */
+  void CostRows(CostThreadStruct* str, long block, long row0, long row1);
+
 private:
   NMCostDistanceBufferImageFilter(const Self&);
   void operator=(const Self&);
@@ -229,6 +320,7 @@ private:
   bool m_ProcessDownward;
   bool m_ProcessUpward;
   int  m_BufferZoneIndicator;
+  std::string m_ProcessingMode;
 
   static const std::string ctx;
 
@@ -241,33 +333,35 @@ NMCostDistanceBufferImageFilter<TInputImage, TOutputImage>
             InPixelType* ibuf,
             OutPixelType& maxDist,
             int& cidx)
+{
+    if (isObject(ibuf[cidx]))
+    {
+        obuf[cidx] = 0;
+    }
+    else
+    {
+        obuf[cidx] = maxDist;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+inline bool
+NMCostDistanceBufferImageFilter<TInputImage, TOutputImage>
+::isObject(const InPixelType& val) const
 {
     if (m_NumCategories)
     {
-        bool bObj = false;
         for (int e=0; e < this->m_NumCategories; ++e)
         {
-            if (static_cast<double>(ibuf[cidx]) == m_Categories[e])
+            if (static_cast<double>(val) == m_Categories[e])
             {
-                obuf[cidx] = 0;
-                bObj = true;
-                break;
+                return true;
             }
         }
-
-        if (!bObj)
-        {
-            obuf[cidx] = maxDist;
-        }
-    }
-    else if (ibuf[cidx] > 0)
-    {
-        obuf[cidx] = 0;
-    }
-    else
-    {
-        obuf[cidx] = maxDist;
+        return false;
     }
+
+    return val > 0;
 }
 
 
@@ -280,7 +374,7 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
                     InPixelType* cbuf,
                     double* colDist,
                     double* rowDist,
-                    int** noff,
+                    const int (*noff)[2],
                     bool& bleftright,
                     bool& binit,
                     int& row,
@@ -24,6 +24,9 @@
 
 #include <iostream>
 #include <limits>
+#include <queue>
+#include <algorithm>
+#include <cmath>
 
 #include "itkNMCostDistanceBufferImageFilter.h"
 #include "itkReflectiveImageRegionConstIterator.h"
@@ -63,6 +66,7 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
   m_UseImageSpacing = false;
   m_ProcessDownward = false;
   m_ProcessUpward = false;
+  m_ProcessingMode = "SWEEP";
   m_MaxDistance = itk::NumericTraits<OutPixelType>::max();
 }
 
@@ -210,6 +214,27 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
     int nrows = region.GetSize()[1];
     int maxrows = distanceMap->GetLargestPossibleRegion().GetSize()[1] * 2;
 
+    // the exact algorithms need the whole image at once
+    if (bBiDir && m_ProcessingMode.compare("EXACT") == 0)
+    {
+        bool bDone = true;
+        if (cbuf)
+        {
+            bDone = this->CostDistance(ibuf, cbuf, obuf, spacing, maxDist, ncols, nrows);
+        }
+        else
+        {
+            this->ExactDistance(ibuf, obuf, spacing, maxDist, userDist, ncols, nrows);
+        }
+
+        if (bDone)
+        {
+            this->UpdateProgress(1.0);
+            NMDebugCtx(ctx, << "done!");
+            return;
+        }
+    }
+
     double* colDist = 0;
     double* rowDist = 0;
     if (m_NumExec == 1)
@@ -236,36 +261,21 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
      *  6 7 8
      */
 
-    //int odr[3][2];
-    int** odr = new int*[3];
-    int** odl = new int*[3];
-    int** oul = new int*[3];
-    int** our = new int*[3];
-    for (int i=0; i < 3; ++i)
-    {
-        odr[i] = new int[2];
-        odl[i] = new int[2];
-        oul[i] = new int[2];
-        our[i] = new int[2];
-    }
-    odr[0][0] = -1; odr[0][1] = -1; // idx 0
-    odr[1][0] =  0; odr[1][1] = -1; // idx 1
-    odr[2][0] = -1; odr[2][1] =  0; // idx 3
+    static const int odr[3][2] = {{-1, -1},  // idx 0
+                                  { 0, -1},  // idx 1
+                                  {-1,  0}}; // idx 3
 
-    //int odl[3][2];
-    odl[1][0] = 0; odl[1][1] = -1; // idx 1
-    odl[0][0] = 1; odl[0][1] = -1; // idx 2
-    odl[2][0] = 1; odl[2][1] =  0; // idx 5
+    static const int odl[3][2] = {{ 1, -1},  // idx 2
+                                  { 0, -1},  // idx 1
+                                  { 1,  0}}; // idx 5
 
-    //int oul[3][2];/home/alex/garage/img/
-    oul[2][0] = 1; oul[2][1] = 0; // idx 5
-    oul[1][0] = 0; oul[1][1] = 1; // idx 7
-    oul[0][0] = 1; oul[0][1] = 1; // idx 8
+    static const int oul[3][2] = {{ 1,  1},  // idx 8
+                                  { 0,  1},  // idx 7
+                                  { 1,  0}}; // idx 5
 
-    //int our[3][2];
-    our[2][0] = -1; our[2][1] = 0; // idx 3
-    our[0][0] = -1; our[0][1] = 1; // idx 6
-    our[1][0] =  0; our[1][1] = 1; // idx 7
+    static const int our[3][2] = {{-1,  1},  // idx 6
+                                  { 0,  1},  // idx 7
+                                  {-1,  0}}; // idx 3
 
     int col, row, bufrow;
     bool bleftright;
@@ -365,19 +375,6 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
     ++this->m_NumExec;
 
     cleanup:
-    // clear memory
-    for (int i=0; i < 3; ++i)
-    {
-        delete[] odr[i];
-        delete[] odl[i];
-        delete[] oul[i];
-        delete[] our[i];
-    }
-    delete[] odr;
-    delete[] odl;
-    delete[] oul;
-    delete[] our;
-
     // we keep those for the next
     // execution of this filter in
     // sequential processing mode
@@ -394,6 +391,542 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
 } // end GenerateData()
 
 
+template <class TInputImage,class TOutputImage>
+void
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::ExactDistance(InPixelType* ibuf,
+                OutPixelType* obuf,
+                SpacingType& spacing,
+                OutPixelType& maxDist,
+                OutPixelType& userDist,
+                int ncols, int nrows)
+{
+    // squared distances; the column pass computes the distance
+    // to the nearest object within the same column, the row pass
+    // the minimum over all columns (Felzenszwalb & Huttenlocher 2012)
+    std::vector<double> sqdist(static_cast<size_t>(ncols) * nrows);
+
+    EDTThreadStruct str;
+    str.Filter = this;
+    str.ibuf = ibuf;
+    str.obuf = obuf;
+    str.sqdist = &sqdist[0];
+    str.ncols = ncols;
+    str.nrows = nrows;
+    str.sx = std::abs(static_cast<double>(spacing[0]));
+    str.sy = std::abs(static_cast<double>(spacing[1]));
+    str.maxDist = maxDist;
+    str.userDist = userDist;
+
+    int nthreads = this->GetNumberOfThreads();
+    nthreads = std::max(1, std::min(nthreads, std::min(ncols, nrows)));
+    this->GetMultiThreader()->SetNumberOfThreads(nthreads);
+    this->GetMultiThreader()->SetSingleMethod(this->EDTFromThreader, &str);
+
+    str.phase = 0;
+    this->GetMultiThreader()->SingleMethodExecute();
+    this->UpdateProgress(0.5);
+
+    if (this->GetAbortGenerateData())
+    {
+        return;
+    }
+
+    str.phase = 1;
+    this->GetMultiThreader()->SingleMethodExecute();
+}
+
+template <class TInputImage,class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::EDTFromThreader(void* arg)
+{
+    itk::MultiThreader::ThreadInfoStruct* info =
+            static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    EDTThreadStruct* str = static_cast<EDTThreadStruct*>(info->UserData);
+
+    const long tid = info->ThreadID;
+    const long nt  = info->NumberOfThreads;
+    const long len = str->phase == 0 ? str->ncols : str->nrows;
+    const long beg = len * tid / nt;
+    const long end = len * (tid + 1) / nt;
+
+    if (str->phase == 0)
+    {
+        str->Filter->EDTColumns(str, beg, end);
+    }
+    else
+    {
+        str->Filter->EDTRows(str, beg, end);
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage,class TOutputImage>
+void
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::EDTColumns(EDTThreadStruct* str, long col0, long col1)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const long ncols = str->ncols;
+    const long nrows = str->nrows;
+    double* d = str->sqdist;
+
+    // number of rows to the nearest object above ...
+    for (long row=0; row < nrows; ++row)
+    {
+        const long long off = static_cast<long long>(row) * ncols;
+        for (long col=col0; col < col1; ++col)
+        {
+            const long long idx = off + col;
+            if (isObject(str->ibuf[idx]))
+            {
+                d[idx] = 0;
+            }
+            else
+            {
+                d[idx] = row == 0 ? inf : d[idx - ncols] + 1;
+            }
+        }
+    }
+
+    // ... or below
+    for (long row=nrows-2; row >= 0; --row)
+    {
+        const long long off = static_cast<long long>(row) * ncols;
+        for (long col=col0; col < col1; ++col)
+        {
+            const long long idx = off + col;
+            if (d[idx + ncols] + 1 < d[idx])
+            {
+                d[idx] = d[idx + ncols] + 1;
+            }
+        }
+    }
+
+    const double sy = str->sy;
+    for (long row=0; row < nrows; ++row)
+    {
+        const long long off = static_cast<long long>(row) * ncols;
+        for (long col=col0; col < col1; ++col)
+        {
+            const double dy = d[off + col] * sy;
+            d[off + col] = dy * dy;
+        }
+    }
+}
+
+template <class TInputImage,class TOutputImage>
+void
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::EDTRows(EDTThreadStruct* str, long row0, long row1)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const long ncols = str->ncols;
+    const double sx2 = str->sx * str->sx;
+    const double userDist = static_cast<double>(str->userDist);
+    const double userDist_2 = userDist * userDist;
+
+    // the parabolas forming the lower envelope and their boundaries
+    std::vector<long> v(ncols);
+    std::vector<double> z(ncols + 1);
+
+    for (long row=row0; row < row1; ++row)
+    {
+        const long long off = static_cast<long long>(row) * ncols;
+        const double* f = str->sqdist + off;
+        OutPixelType* out = str->obuf + off;
+
+        long k = -1;
+        for (long q=0; q < ncols; ++q)
+        {
+            if (f[q] == inf)
+            {
+                continue;
+            }
+
+            const double fq = f[q] + sx2 * q * q;
+            double s = -inf;
+            while (k >= 0)
+            {
+                const long p = v[k];
+                s = (fq - (f[p] + sx2 * p * p)) / (2 * sx2 * (q - p));
+                if (s > z[k])
+                {
+                    break;
+                }
+                --k;
+            }
+
+            ++k;
+            v[k] = q;
+            z[k] = k == 0 ? -inf : s;
+            z[k+1] = inf;
+        }
+
+        long j = 0;
+        for (long col=0; col < ncols; ++col)
+        {
+            double dist = inf;
+            if (k >= 0)
+            {
+                while (z[j+1] < col)
+                {
+                    ++j;
+                }
+                const double dx = col - v[j];
+                dist = sx2 * dx * dx + f[v[j]];
+            }
+
+            // same output as the SWEEP algorithm
+            if (dist == 0)
+            {
+                out[col] = 0;
+            }
+            else if (dist <= userDist_2)
+            {
+                out[col] = this->m_CreateBuffer
+                        ? static_cast<OutPixelType>(this->m_BufferZoneIndicator)
+                        : static_cast<OutPixelType>(std::sqrt(dist));
+            }
+            else
+            {
+                out[col] = str->maxDist;
+            }
+        }
+    }
+}
+
+template <class TInputImage,class TOutputImage>
+bool
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::CostDistance(InPixelType* ibuf,
+               InPixelType* cbuf,
+               OutPixelType* obuf,
+               SpacingType& spacing,
+               OutPixelType& maxDist,
+               int ncols, int nrows)
+{
+    const long long numpix = static_cast<long long>(ncols) * nrows;
+
+    // as with the SWEEP algorithm, moving into a cell costs its
+    // cost value, times the diagonal pixel length for diagonal moves
+    const double diag = std::sqrt(static_cast<double>(spacing[0]*spacing[0]
+                                                      + spacing[1]*spacing[1]));
+    const double inf = std::numeric_limits<double>::infinity();
+
+    double mincost = inf;
+    double maxcost = 0;
+    for (long long i=0; i < numpix; ++i)
+    {
+        const double c = static_cast<double>(cbuf[i]);
+        if (c < 0)
+        {
+            NMProcWarn(<< "Negative costs - falling back to the SWEEP algorithm!");
+            return false;
+        }
+        mincost = c < mincost ? c : mincost;
+        maxcost = c > maxcost ? c : maxcost;
+    }
+
+    // a bucket spans the cheapest move, i.e. cells taken from the
+    // current bucket can't improve each other and are final; if
+    // costs are too diverse for this, we use a binary heap instead
+    const double minstep = mincost * std::min(1.0, diag);
+    const double maxstep = maxcost * std::max(1.0, diag);
+    const long long maxBuckets = 1 << 20;
+    const bool bBuckets = minstep > 0 && (maxstep / minstep) < maxBuckets - 2;
+
+    std::vector<double> dist(numpix, inf);
+    std::vector<int> stamp(numpix, 0);
+
+    // each thread works on its own block of rows; paths crossing
+    // into another block are continued in the next round from the
+    // rows adjacent to that block, until no distance improves anymore
+    int nthreads = this->GetNumberOfThreads();
+    nthreads = std::max(1, std::min(nthreads, nrows));
+    std::vector<double> halo(static_cast<size_t>(ncols) * 2 * nthreads, inf);
+    std::vector<int> seeded(nthreads, 0);
+
+    CostThreadStruct str;
+    str.Filter = this;
+    str.round = 0;
+    str.ibuf = ibuf;
+    str.cbuf = cbuf;
+    str.dist = &dist[0];
+    str.stamp = &stamp[0];
+    str.halo = &halo[0];
+    str.seeded = &seeded[0];
+    str.ncols = ncols;
+    str.nrows = nrows;
+    str.numpix = numpix;
+    str.diag = diag;
+    str.minstep = minstep;
+    str.numBuckets = bBuckets ? static_cast<long long>(maxstep / minstep) + 2 : 0;
+    str.numDone = 0;
+
+    this->GetMultiThreader()->SetNumberOfThreads(nthreads);
+    this->GetMultiThreader()->SetSingleMethod(this->CostFromThreader, &str);
+
+    bool bSeeded = true;
+    while (bSeeded && !this->GetAbortGenerateData())
+    {
+        if (str.round > 0)
+        {
+            for (long b=0; b < nthreads; ++b)
+            {
+                const long row0 = static_cast<long>(nrows) * b / nthreads;
+                const long row1 = static_cast<long>(nrows) * (b + 1) / nthreads;
+                double* hdist = &halo[static_cast<size_t>(ncols) * 2 * b];
+                if (row0 > 0)
+                {
+                    std::copy(dist.begin() + static_cast<long long>(row0 - 1) * ncols,
+                              dist.begin() + static_cast<long long>(row0) * ncols,
+                              hdist);
+                }
+                if (row1 < nrows)
+                {
+                    std::copy(dist.begin() + static_cast<long long>(row1) * ncols,
+                              dist.begin() + static_cast<long long>(row1 + 1) * ncols,
+                              hdist + ncols);
+                }
+            }
+        }
+
+        this->GetMultiThreader()->SingleMethodExecute();
+
+        bSeeded = false;
+        for (int b=0; b < nthreads; ++b)
+        {
+            bSeeded = bSeeded || seeded[b] != 0;
+        }
+        ++str.round;
+    }
+
+    for (long long i=0; i < numpix; ++i)
+    {
+        obuf[i] = dist[i] == inf ? maxDist : static_cast<OutPixelType>(dist[i]);
+    }
+
+    return true;
+}
+
+template <class TInputImage,class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::CostFromThreader(void* arg)
+{
+    itk::MultiThreader::ThreadInfoStruct* info =
+            static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    CostThreadStruct* str = static_cast<CostThreadStruct*>(info->UserData);
+
+    const long tid = info->ThreadID;
+    const long nt  = info->NumberOfThreads;
+    str->Filter->CostRows(str, tid, str->nrows * tid / nt, str->nrows * (tid + 1) / nt);
+
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage,class TOutputImage>
+void
+NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
+::CostRows(CostThreadStruct* str, long block, long row0, long row1)
+{
+    const long ncols = str->ncols;
+    const InPixelType* cbuf = str->cbuf;
+    double* dist = str->dist;
+    int* stamp = str->stamp;
+    const double diag = str->diag;
+
+    static const int noff[8][2] = {{-1,-1}, {0,-1}, {1,-1}, {1,0},
+                                   {1,1}, {0,1}, {-1,1}, {-1,0}};
+
+    // cells whose distance has improved: the objects in the first
+    // round and cells reached from the neighbouring blocks later on
+    typedef std::pair<double, long long> HeapEntry;
+    std::vector<HeapEntry> seeds;
+    if (str->round == 0)
+    {
+        for (long long i=static_cast<long long>(row0) * ncols;
+             i < static_cast<long long>(row1) * ncols; ++i)
+        {
+            if (isObject(str->ibuf[i]))
+            {
+                dist[i] = 0;
+                seeds.push_back(HeapEntry(0, i));
+            }
+        }
+    }
+    else
+    {
+        for (int h=0; h < 2; ++h)
+        {
+            const long row = h == 0 ? row0 : row1 - 1;
+            const long hrow = h == 0 ? row0 - 1 : row1;
+            if (hrow < 0 || hrow >= str->nrows)
+            {
+                continue;
+            }
+
+            const double* hdist = str->halo + ncols * (2 * block + h);
+            for (long col=0; col < ncols; ++col)
+            {
+                const long long idx = static_cast<long long>(row) * ncols + col;
+                double best = dist[idx];
+                for (long hcol=std::max(0L, col-1); hcol <= std::min(ncols-1, col+1); ++hcol)
+                {
+                    const double step = hcol != col
+                            ? static_cast<double>(cbuf[idx]) * diag
+                            : static_cast<double>(cbuf[idx]);
+                    best = std::min(best, hdist[hcol] + step);
+                }
+
+                if (best < dist[idx])
+                {
+                    dist[idx] = best;
+                    seeds.push_back(HeapEntry(best, idx));
+                }
+            }
+        }
+    }
+
+    str->seeded[block] = seeds.empty() ? 0 : 1;
+    if (seeds.empty())
+    {
+        return;
+    }
+    std::sort(seeds.begin(), seeds.end());
+
+    // cells are final once per round, since cells reached from
+    // another block in a later round may improve again
+    const int mark = str->round + 1;
+    const long long numpix = str->numpix;
+    const double minstep = str->minstep;
+    const long long numBuckets = str->numBuckets;
+    const bool bBuckets = numBuckets > 0;
+
+    std::vector<std::vector<long long> > buckets(numBuckets);
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+
+    // seeds enter the bucket ring once they're within its range
+    size_t nextSeed = 0;
+    long long numQueued = 0;
+    long long curBucket = 0;
+    if (!bBuckets)
+    {
+        for (; nextSeed < seeds.size(); ++nextSeed)
+        {
+            heap.push(seeds[nextSeed]);
+        }
+        numQueued = seeds.size();
+    }
+
+    const long long reportStep = std::max(numpix / 100, 1LL);
+    long long numDone = 0;
+    std::vector<long long> cur;
+    while (    (numQueued > 0 || nextSeed < seeds.size())
+            && !this->GetAbortGenerateData()
+          )
+    {
+        // fetch the next batch of final cells
+        cur.clear();
+        if (bBuckets)
+        {
+            if (numQueued == 0)
+            {
+                curBucket = std::max(curBucket,
+                        static_cast<long long>(seeds[nextSeed].first / minstep));
+            }
+            while (nextSeed < seeds.size())
+            {
+                const long long b = static_cast<long long>(seeds[nextSeed].first / minstep);
+                if (b >= curBucket + numBuckets - 1)
+                {
+                    break;
+                }
+                buckets[std::max(curBucket, b) % numBuckets].push_back(seeds[nextSeed].second);
+                ++numQueued;
+                ++nextSeed;
+            }
+
+            while (buckets[curBucket % numBuckets].empty())
+            {
+                ++curBucket;
+            }
+            cur.swap(buckets[curBucket % numBuckets]);
+            numQueued -= cur.size();
+        }
+        else
+        {
+            cur.push_back(heap.top().second);
+            heap.pop();
+            --numQueued;
+        }
+
+        for (size_t e=0; e < cur.size(); ++e)
+        {
+            const long long cidx = cur[e];
+            if (stamp[cidx] == mark)
+            {
+                continue;
+            }
+            stamp[cidx] = mark;
+            ++numDone;
+
+            const long col = static_cast<long>(cidx % ncols);
+            const long row = static_cast<long>(cidx / ncols);
+            for (int n=0; n < 8; ++n)
+            {
+                const long ncol = col + noff[n][0];
+                const long nrow = row + noff[n][1];
+                if (ncol < 0 || ncol >= ncols || nrow < row0 || nrow >= row1)
+                {
+                    continue;
+                }
+
+                const long long nidx = static_cast<long long>(nrow) * ncols + ncol;
+                if (stamp[nidx] == mark)
+                {
+                    continue;
+                }
+
+                const double step = (n % 2) == 0
+                        ? static_cast<double>(cbuf[nidx]) * diag
+                        : static_cast<double>(cbuf[nidx]);
+                const double nd = dist[cidx] + step;
+                if (nd < dist[nidx])
+                {
+                    dist[nidx] = nd;
+                    if (bBuckets)
+                    {
+                        const long long b = std::max(curBucket + 1,
+                                                     static_cast<long long>(nd / minstep));
+                        buckets[b % numBuckets].push_back(nidx);
+                    }
+                    else
+                    {
+                        heap.push(HeapEntry(nd, nidx));
+                    }
+                    ++numQueued;
+                }
+            }
+        }
+
+        // cells of later rounds are counted again, hence the cap
+        if (numDone >= reportStep)
+        {
+            const long long total = str->numDone += numDone;
+            numDone = 0;
+            if (block == 0)
+            {
+                this->UpdateProgress(std::min(1.0f, total / static_cast<float>(numpix)));
+            }
+        }
+    }
+    str->numDone += numDone;
+}
+
 template <class TInputImage,class TOutputImage>
 void
 NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
@@ -404,6 +937,7 @@ NMCostDistanceBufferImageFilter<TInputImage,TOutputImage>
   os << indent << "Cost-Distance/Buffer-Map " << std::endl;
   os << indent << "Use Image Spacing : " << m_UseImageSpacing << std::endl;
   os << indent << "Maximum Distance  : " << m_MaxDistance << std::endl;
+  os << indent << "Processing Mode   : " << m_ProcessingMode << std::endl;
   os << indent << "Input source categories (objects): ";
   for (int c=0; c < this->m_NumCategories; ++c)
       os << this->m_Categories[c] << ", ";
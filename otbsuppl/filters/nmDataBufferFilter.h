@@ -41,10 +41,9 @@
  *      the portion of buffered data that is requested by the downstream
  *      processing object;
  *
- *
- *
- *   Note: the downstream proecessing object must not be an in-place processing
- *   filter.
+ *   The requested region is always copied into the output, i.e. the output
+ *   never shares the input's pixel container, since downstream in-place
+ *   filters would otherwise overwrite the buffered data.
  */
 
 namespace otb {
@@ -73,9 +72,12 @@ protected:
 
     void PrintSelf(std::ostream &os, itk::Indent indent) const;
     void GenerateData();
+
+    /*! the output is allocated for the requested
+     *  region in GenerateData() */
+    void AllocateOutputs(){}
     //void GenerateOutputInformation();
     //void GenerateInputRequestedRegion();
-    //void AllocateOutputs(){}
 
 };     // end of class
 
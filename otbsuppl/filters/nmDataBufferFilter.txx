@@ -22,7 +22,6 @@
 #include "nmlog.h"
 #include "nmDataBufferFilter.h"
 #include <itkDataObject.h>
-#include <itkImportImageContainer.h>
 #include <itkImageScanlineConstIterator.h>
 #include <itkImageScanlineIterator.h>
 
@@ -80,25 +79,32 @@ template <class TInputImage>
 void DataBufferFilter<TInputImage>
 ::GenerateData(void)
 {
-    this->AllocateOutputs();
     InputImageType* in = const_cast<InputImageType*>(this->GetInput());
-    InputImageType* out = dynamic_cast<InputImageType*>(this->GetOutput());
+    InputImageType* out = this->GetOutput();
 
+    // the input is disconnected from its pipeline, so we can't
+    // ask for anything that hasn't been buffered already
+    const typename InputImageType::RegionType outReg = out->GetRequestedRegion();
+    if (!in->GetBufferedRegion().IsInside(outReg))
+    {
+        itkExceptionMacro(<< "Requested region " << outReg
+                          << " is outside the buffered region "
+                          << in->GetBufferedRegion() << "!");
+    }
 
+    // we always copy the requested region, since the output may
+    // be consumed by in-place filters, which would otherwise
+    // overwrite the buffered data
+    out->SetBufferedRegion(outReg);
+    out->Allocate();
 
-    using IteratorType = typename itk::ImageScanlineIterator<InputImageType>;
-    using IteratorPixelType = typename IteratorType::InternalPixelType;
-
-    IteratorType inIt(in, in->GetRequestedRegion());
-    IteratorType outIt(out, out->GetRequestedRegion());
-
-    while(!inIt.IsAtEnd())
+    itk::ImageScanlineConstIterator<InputImageType> inIt(in, outReg);
+    itk::ImageScanlineIterator<InputImageType> outIt(out, outReg);
+    while (!inIt.IsAtEnd())
     {
-        while(!inIt.IsAtEndOfLine())
+        while (!inIt.IsAtEndOfLine())
         {
-            //IteratorPixelType *ival = static_cast<IteratorPixelType>(inIt.Value());
             outIt.Set(inIt.Get());
-
             ++inIt;
             ++outIt;
         }
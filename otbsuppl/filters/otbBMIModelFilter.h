@@ -30,6 +30,7 @@
 #include "nmlog.h"
 #include <string>
 #include <memory>
+#include <map>
 #include "bmi.hxx"
 
 #include "itkImageToImageFilter.h"
@@ -141,6 +142,10 @@ protected:
 
     std::shared_ptr<bmi::Bmi> m_BMIModule;
 
+    /*! type (hash code) and number of pixels of the buffers
+     *  last passed on to the BMI module per variable name */
+    std::map<std::string, std::pair<size_t, size_t> > m_BMIVarMeta;
+
     unsigned int m_NumOutputs;
     unsigned long m_PixCount;
 };
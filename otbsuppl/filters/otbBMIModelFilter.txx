@@ -71,6 +71,7 @@
 
 #include <algorithm>
 #include <typeindex>
+#include <map>
 
 namespace otb {
 
@@ -122,6 +123,7 @@ BMIModelFilter<TInputImage, TOutputImage>
     }
 
     m_BMIModule = bmiModule;
+    m_BMIVarMeta.clear();
 
     // set the number of outputs produced by
     // the configured BMI module
@@ -212,6 +214,18 @@ template <class TInputImage, class TOutputImage>
 void BMIModelFilter<TInputImage, TOutputImage>
 ::SetBMIValue(const std::string &bmiName, const std::type_index typeInfo, size_t numPixel, void* buf)
 {
+    // the variable's metadata only need to go over to the
+    // model when they've changed since the last region
+    std::map<std::string, std::pair<size_t, size_t> >::iterator metaIt = m_BMIVarMeta.find(bmiName);
+    if (    metaIt != m_BMIVarMeta.end()
+         && metaIt->second.first == typeInfo.hash_code()
+         && metaIt->second.second == numPixel
+       )
+    {
+        this->m_BMIModule->SetValue(bmiName, buf);
+        return;
+    }
+
     const std::string bmiTypeName = bmiName + " type";
     const std::string bmiItemSizeName = bmiName + " itemsize";
     const std::string bmiGridSizeName = bmiName + " gridsize";
@@ -265,6 +279,8 @@ void BMIModelFilter<TInputImage, TOutputImage>
     this->m_BMIModule->SetValue(bmiGridShapeName, static_cast<void*>(&numPixel));
     this->m_BMIModule->SetValue(bmiGridRankName, static_cast<void*>(&gridRank));
     this->m_BMIModule->SetValue(bmiName, buf);
+
+    m_BMIVarMeta[bmiName] = std::pair<size_t, size_t>(typeInfo.hash_code(), numPixel);
 }
 
 
@@ -411,6 +427,13 @@ BMIModelFilter<TInputImage, TOutputImage>
         const int gsize = this->m_BMIModule->GetGridSize(gid);
         OutputImagePixelType* bmibuf = static_cast<OutputImagePixelType*>(this->m_BMIModule->GetValuePtr(outnames[i]));
 
+        // the model has written straight into the output
+        // buffer (zero-copy exchange), so nothing to graft
+        if (bmibuf == out->GetBufferPointer())
+        {
+            continue;
+        }
+
         // graft the output data from the m_BMIModule onto the output image
         ImportContainerPointer pixCont = ImportContainerType::New();
         pixCont->SetImportPointer(bmibuf, static_cast<OutputImageSizeValueType>(gsize), false);
@@ -425,6 +448,7 @@ BMIModelFilter<TInputImage, TOutputImage>
 {
     m_PixCount = 0;
     m_BMIModule = nullptr;
+    m_BMIVarMeta.clear();
 }
 
 template <class TInputImage, class TOutputImage>
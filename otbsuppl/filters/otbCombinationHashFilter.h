@@ -0,0 +1,245 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+/*  ACKNOWLEDGEMENT
+ *
+ *  This implementation is based on a conceptual algorithm for
+ *  computing unique combinations developed by my brillant colleague
+ *
+ *  Robbie Price (Manaaki Whenua - Landcare Research New Zealand Ltd)
+ *
+ *
+ */
+
+#ifndef OTBCOMBINATIONHASHFILTER_H_
+#define OTBCOMBINATIONHASHFILTER_H_
+
+#include <vector>
+#include <string>
+
+#include "otbSQLiteTable.h"
+#include "otbPackedKeyHashMap.h"
+#include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
+#include "otbImage.h"
+
+#include "nmotbsupplfilters_export.h"
+
+namespace otb
+{
+/*! \class CombinationHashFilter
+ *  \brief Identifies the unique combinations of all input
+ *         images' pixel values in a single (streamed) pass
+ *
+ *  The input values of a pixel are bit-packed into a key of one or
+ *  more 64-bit words (the number of bits per input is derived from its
+ *  value domain, i.e. the number of rows of its RAT). Each thread
+ *  tracks its keys in its own PackedKeyHashMap and writes a
+ *  provisional id (local id * numThreads + threadId + 1) into the
+ *  output image. Once the whole image has been processed, the thread
+ *  maps are merged in parallel and the unique combinations are numbered
+ *  1..N in the lexicographical order of the input values; RemapId()
+ *  translates provisional ids into final ones. Nodata pixels are set
+ *  to 0.
+ *
+ *  If the thread maps grow beyond MemoryBudget (MiB) between two
+ *  streamed regions, they are spilled into an SQLite table in the
+ *  Workspace and the final merge is done in SQL.
+ */
+
+template< class TInputImage, class TOutputImage >
+class NMOTBSUPPLFILTERS_EXPORT CombinationHashFilter
+        : public itk::ImageToImageFilter< TInputImage, TOutputImage >
+{
+public:
+    /** Extract dimension from input and output image. */
+    itkStaticConstMacro(InputImageDimension, unsigned int,
+                        TInputImage::ImageDimension);
+    itkStaticConstMacro(OutputImageDimension, unsigned int,
+                        TOutputImage::ImageDimension);
+
+    typedef TInputImage  InputImageType;
+    typedef TOutputImage OutputImageType;
+
+    /** Standard class typedefs. */
+    typedef CombinationHashFilter                                     Self;
+    typedef itk::ImageToImageFilter< InputImageType, OutputImageType> Superclass;
+    typedef itk::SmartPointer<Self>                                   Pointer;
+    typedef itk::SmartPointer<const Self>                             ConstPointer;
+
+    /** Method for creation through the object factory. */
+    itkNewMacro(Self);
+
+    /** Run-time type information (and related methods). */
+    itkTypeMacro(CombinationHashFilter, itk::ImageToImageFilter);
+
+    /** Image typedef support. */
+    typedef typename InputImageType::PixelType   InputPixelType;
+    typedef typename OutputImageType::PixelType  OutputPixelType;
+
+    typedef typename InputImageType::RegionType  InputImageRegionType;
+    typedef typename OutputImageType::RegionType OutputImageRegionType;
+
+    typedef long long ComboIndexType;
+    typedef PackedKeyHashMap::WordType WordType;
+
+    void SetInputNodata(const std::vector<long long>& inNodata);
+
+    /*! Number of (0-based) values per input, i.e. valid input
+     *  values are 0 .. domain-1; inputs without domain are
+     *  allowed 32 bits
+     */
+    void SetValueDomains(const std::vector<long long>& domains);
+
+    itkGetMacro(Workspace, std::string);
+    itkSetMacro(Workspace, std::string);
+
+    /*! Memory (MiB) the thread maps may occupy before they
+     *  are spilled to disk
+     */
+    itkGetMacro(MemoryBudget, int);
+    itkSetMacro(MemoryBudget, int);
+
+    ComboIndexType GetNumUniqueCombinations(void) const
+    {return m_NumUniqueCombinations;}
+
+    /*! Number of pixels with values outside the value domains;
+     *  they're treated as nodata
+     */
+    ComboIndexType GetNumInvalidPixels(void) const
+    {return m_NumInvalidPixels;}
+
+    /*! Input values of the unique combination uvid (1..N) */
+    void GetCombination(ComboIndexType uvid, std::vector<long long>& values) const;
+
+    /*! Maps a provisional id of the output image onto the final id */
+    inline ComboIndexType RemapId(ComboIndexType pid) const
+    {
+        if (pid <= 0)
+        {
+            return 0;
+        }
+        --pid;
+        return m_vRemap[pid % m_NumThreadMaps][pid / m_NumThreadMaps];
+    }
+
+    virtual void ResetPipeline();
+
+protected:
+    CombinationHashFilter();
+    virtual ~CombinationHashFilter();
+    virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+    void BeforeThreadedGenerateData();
+    void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId );
+    void AfterThreadedGenerateData();
+
+    void SetupKeyLayout(void);
+    void SpillThreadMaps(void);
+    void MergeThreadMaps(void);
+    void MergeSpilledMaps(void);
+
+    static ITK_THREAD_RETURN_TYPE MergeThreaderCallback(void* arg);
+    void BucketThreadMaps(int threadId, int numThreads);
+    void MergePartitions(int threadId, int numThreads);
+    void RemapThreadMaps(int threadId, int numThreads);
+
+    inline int GetPartition(const WordType* key) const
+    {return static_cast<int>((PackedKeyHashMap::Hash(key, m_NumWords) >> 40) % m_vPartMaps.size());}
+
+private:
+    CombinationHashFilter(const Self&); //purposely not implemented
+    void operator=(const Self&); //purposely not implemented
+
+    std::string m_Workspace;
+    int m_MemoryBudget;
+
+    bool m_StreamingProc;
+    std::vector<long long> m_InputNodata;
+    std::vector<long long> m_vValueDomains;
+
+    // key layout: word index, bit shift and
+    // value mask per input
+    int m_NumWords;
+    std::vector<int> m_vColWord;
+    std::vector<int> m_vColShift;
+    std::vector<WordType> m_vColMask;
+
+    int m_NumThreadMaps;
+    std::vector<PackedKeyHashMap> m_vThreadMaps;
+    std::vector<ComboIndexType> m_vNextLocalId;
+    std::vector<ComboIndexType> m_vThreadInvalid;
+    std::vector<ComboIndexType> m_vThreadPixCount;
+    ComboIndexType m_TotalPixCount;
+
+    // merge state
+    int m_MergeStage;
+    std::vector<PackedKeyHashMap> m_vPartMaps;
+    // keys of each thread map by hash partition
+    std::vector<std::vector<std::vector<const WordType*> > > m_vPartKeys;
+    std::vector<WordType> m_vUniqueKeys;
+    std::vector<std::vector<ComboIndexType> > m_vRemap;
+    ComboIndexType m_NumUniqueCombinations;
+    ComboIndexType m_NumInvalidPixels;
+
+    SQLiteTable::Pointer m_SpillTable;
+    std::vector<std::string> m_vSpillColumns;
+
+    static const std::string ctx;
+};
+
+namespace Functor
+{
+
+/*! \class CombinationIdRemap
+ *  \brief Maps provisional combination ids onto final ids
+ *         using a CombinationHashFilter's remap tables
+ */
+template< class TRemapSource, class TOutput >
+class CombinationIdRemap
+{
+public:
+    CombinationIdRemap() : m_Source(0) {}
+    ~CombinationIdRemap() {}
+
+    void SetSource(const TRemapSource* source) {m_Source = source;}
+
+    bool operator!=(const CombinationIdRemap& other) const
+    {return m_Source != other.m_Source;}
+
+    bool operator==(const CombinationIdRemap& other) const
+    {return !(*this != other);}
+
+    template< class TInput >
+    inline TOutput operator()(const TInput& pid) const
+    {return static_cast<TOutput>(m_Source->RemapId(static_cast<long long>(pid)));}
+
+protected:
+    const TRemapSource* m_Source;
+};
+
+} // end namespace Functor
+
+} // end namespace otb
+
+
+template< class TInputImage, class TOutputImage>
+const std::string otb::CombinationHashFilter<TInputImage, TOutputImage>::ctx = "otb::CombinationHashFilter";
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbCombinationHashFilter.txx"
+#endif
+
+#endif /* OTBCOMBINATIONHASHFILTER_H_ */
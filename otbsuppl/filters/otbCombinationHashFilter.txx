@@ -0,0 +1,698 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __otbCombinationHashFilter_txx
+#define __otbCombinationHashFilter_txx
+
+#include "nmlog.h"
+#include "otbCombinationHashFilter.h"
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include "itkNMLogEvent.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace otb
+{
+
+template< class TInputImage, class TOutputImage >
+CombinationHashFilter< TInputImage, TOutputImage >
+::CombinationHashFilter()
+    : m_MemoryBudget(1024),
+      m_StreamingProc(false),
+      m_NumWords(1),
+      m_NumThreadMaps(1),
+      m_TotalPixCount(0),
+      m_MergeStage(0),
+      m_NumUniqueCombinations(0),
+      m_NumInvalidPixels(0),
+      m_SpillTable(0)
+{
+    this->SetNumberOfRequiredInputs(1);
+    this->SetNumberOfRequiredOutputs(1);
+}
+
+template< class TInputImage, class TOutputImage >
+CombinationHashFilter< TInputImage, TOutputImage >
+::~CombinationHashFilter()
+{
+    if (m_SpillTable.IsNotNull())
+    {
+        m_SpillTable->DeleteDatabase();
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+    Superclass::PrintSelf(os, indent);
+
+    os << indent << "MemoryBudget: " << m_MemoryBudget << " MiB" << std::endl;
+    os << indent << "NumUniqueCombinations: " << m_NumUniqueCombinations << std::endl;
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::SetInputNodata(const std::vector<long long>& inNodata)
+{
+    m_InputNodata = inNodata;
+    this->Modified();
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::SetValueDomains(const std::vector<long long>& domains)
+{
+    m_vValueDomains = domains;
+    this->Modified();
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::GetCombination(ComboIndexType uvid, std::vector<long long>& values) const
+{
+    const int nbInputs = m_vColWord.size();
+    values.resize(nbInputs);
+    if (uvid < 1 || uvid > m_NumUniqueCombinations)
+    {
+        return;
+    }
+
+    const WordType* key = &m_vUniqueKeys[(uvid-1) * m_NumWords];
+    for (int c=0; c < nbInputs; ++c)
+    {
+        values[c] = static_cast<long long>((key[m_vColWord[c]] >> m_vColShift[c]) & m_vColMask[c]);
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::SetupKeyLayout()
+{
+    // the number of bits per input is determined by its
+    // value domain; inputs are packed into 63-bit words (so
+    // words fit into SQLite's signed integers when spilled),
+    // the first input of a word occupying the highest bits,
+    // hence keys sort lexicographically by input values
+    const int nbInputs = this->GetNumberOfIndexedInputs();
+    std::vector<int> vBits(nbInputs, 32);
+
+    m_vColWord.assign(nbInputs, 0);
+    m_vColShift.assign(nbInputs, 0);
+    m_vColMask.assign(nbInputs, 0);
+
+    int word = 0;
+    int used = 0;
+    for (int c=0; c < nbInputs; ++c)
+    {
+        if (c < m_vValueDomains.size())
+        {
+            if (m_vValueDomains[c] < 1)
+            {
+                itkExceptionMacro(<< "ValueDomain[" << c << "] < 1 !" << std::endl
+                                  << "Please ensure that each ValueDomain is >= 1!");
+            }
+
+            const unsigned long long maxVal = m_vValueDomains[c] - 1;
+            vBits[c] = 1;
+            while (vBits[c] < 63 && (maxVal >> vBits[c]) != 0)
+            {
+                ++vBits[c];
+            }
+        }
+
+        if (used + vBits[c] > 63)
+        {
+            ++word;
+            used = 0;
+        }
+        m_vColWord[c] = word;
+        m_vColMask[c] = (static_cast<WordType>(1) << vBits[c]) - 1;
+        used += vBits[c];
+    }
+    m_NumWords = word + 1;
+
+    int shift = 0;
+    for (int c=nbInputs-1; c >= 0; --c)
+    {
+        if (c < nbInputs-1 && m_vColWord[c] != m_vColWord[c+1])
+        {
+            shift = 0;
+        }
+        m_vColShift[c] = shift;
+        shift += vBits[c];
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::BeforeThreadedGenerateData()
+{
+    const int nbInputImages = this->GetNumberOfIndexedInputs();
+
+    if (!m_StreamingProc)
+    {
+        // for now, the size of the input regions must be exactly the same
+        InputImageRegionType lprCtrl = this->GetInput(0)->GetLargestPossibleRegion();
+        for (int i=1; i < nbInputImages; ++i)
+        {
+            if (this->GetInput(i)->GetLargestPossibleRegion().GetSize() != lprCtrl.GetSize())
+            {
+                itkExceptionMacro(<< "Input imgages' dimensions don't match!");
+                return;
+            }
+        }
+
+        // nodata values as required
+        for (int n = m_InputNodata.size(); n < nbInputImages; ++n)
+        {
+            m_InputNodata.push_back(itk::NumericTraits<long long>::NonpositiveMin());
+        }
+
+        this->SetupKeyLayout();
+
+        m_NumThreadMaps = this->GetNumberOfThreads();
+        m_vThreadMaps.resize(m_NumThreadMaps);
+        for (int t=0; t < m_NumThreadMaps; ++t)
+        {
+            m_vThreadMaps[t].Init(m_NumWords);
+        }
+        m_vNextLocalId.assign(m_NumThreadMaps, 0);
+        m_vThreadInvalid.assign(m_NumThreadMaps, 0);
+
+        m_vPartMaps.clear();
+        m_vUniqueKeys.clear();
+        m_vRemap.clear();
+        m_TotalPixCount = 0;
+        m_NumUniqueCombinations = 0;
+        m_NumInvalidPixels = 0;
+
+        if (m_SpillTable.IsNotNull())
+        {
+            m_SpillTable->DeleteDatabase();
+            m_SpillTable = 0;
+        }
+
+        m_StreamingProc = true;
+    }
+    else
+    {
+        // we only ever spill in between two streamed regions,
+        // so provisional ids already written remain valid
+        size_t memSize = 0;
+        for (int t=0; t < m_NumThreadMaps; ++t)
+        {
+            memSize += m_vThreadMaps[t].GetMemorySize();
+        }
+
+        if (memSize > (static_cast<size_t>(m_MemoryBudget) << 20))
+        {
+            this->SpillThreadMaps();
+        }
+    }
+
+    m_vThreadPixCount.assign(m_NumThreadMaps, 0);
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId )
+{
+    const int nbInputImages = this->GetNumberOfIndexedInputs();
+    itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+    m_vThreadPixCount[threadId] = outputRegionForThread.GetNumberOfPixels();
+
+    typedef itk::ImageRegionConstIterator<InputImageType> InIteratorType;
+    std::vector<InIteratorType> vInIters;
+    for (int i=0; i < nbInputImages; ++i)
+    {
+        InIteratorType ii(this->GetInput(i), outputRegionForThread);
+        ii.GoToBegin();
+        vInIters.push_back(ii);
+    }
+    itk::ImageRegionIterator<OutputImageType> outIter(this->GetOutput(), outputRegionForThread);
+    outIter.GoToBegin();
+
+    PackedKeyHashMap& map = m_vThreadMaps[threadId];
+    ComboIndexType& nextLocalId = m_vNextLocalId[threadId];
+    ComboIndexType& invalid = m_vThreadInvalid[threadId];
+    const ComboIndexType numMaps = m_NumThreadMaps;
+
+    std::vector<WordType> key(m_NumWords, 0);
+    bool nodata;
+    bool valid;
+    bool inserted;
+    long long val;
+
+    while (!outIter.IsAtEnd() && !this->GetAbortGenerateData())
+    {
+        std::fill(key.begin(), key.end(), 0);
+        nodata = false;
+        valid = true;
+        for (int in=0; in < nbInputImages; ++in)
+        {
+            val = static_cast<long long>(vInIters[in].Get());
+            if (val == m_InputNodata[in])
+            {
+                nodata = true;
+            }
+            else if (val < 0 || static_cast<WordType>(val) > m_vColMask[in])
+            {
+                valid = false;
+            }
+            else
+            {
+                key[m_vColWord[in]] |= static_cast<WordType>(val) << m_vColShift[in];
+            }
+            ++vInIters[in];
+        }
+
+        if (nodata || !valid)
+        {
+            if (!nodata)
+            {
+                ++invalid;
+            }
+            outIter.Set(static_cast<OutputPixelType>(0));
+        }
+        else
+        {
+            const ComboIndexType lid = map.Insert(&key[0], nextLocalId, inserted);
+            if (inserted)
+            {
+                ++nextLocalId;
+            }
+            outIter.Set(static_cast<OutputPixelType>(lid * numMaps + threadId + 1));
+        }
+
+        progress.CompletedPixel();
+        ++outIter;
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::AfterThreadedGenerateData()
+{
+    for (int t=0; t < m_vThreadPixCount.size(); ++t)
+    {
+        m_TotalPixCount += m_vThreadPixCount[t];
+    }
+
+    const long long npix = this->GetInput(0)->GetLargestPossibleRegion().GetNumberOfPixels();
+    if (m_TotalPixCount != npix || this->GetAbortGenerateData())
+    {
+        return;
+    }
+
+    m_NumInvalidPixels = 0;
+    for (int t=0; t < m_NumThreadMaps; ++t)
+    {
+        m_NumInvalidPixels += m_vThreadInvalid[t];
+    }
+
+    if (m_SpillTable.IsNotNull())
+    {
+        this->SpillThreadMaps();
+        this->MergeSpilledMaps();
+    }
+    else
+    {
+        this->MergeThreadMaps();
+    }
+
+    // we don't need the thread maps any longer
+    for (int t=0; t < m_NumThreadMaps; ++t)
+    {
+        m_vThreadMaps[t].Init(m_NumWords, 16);
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+CombinationHashFilter< TInputImage, TOutputImage >
+::MergeThreaderCallback(void* arg)
+{
+    itk::MultiThreader::ThreadInfoStruct* info =
+            static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    Self* filter = static_cast<Self*>(info->UserData);
+
+    switch (filter->m_MergeStage)
+    {
+    case 0:
+        filter->BucketThreadMaps(info->ThreadID, info->NumberOfThreads);
+        break;
+    case 1:
+        filter->MergePartitions(info->ThreadID, info->NumberOfThreads);
+        break;
+    default:
+        filter->RemapThreadMaps(info->ThreadID, info->NumberOfThreads);
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::BucketThreadMaps(int threadId, int numThreads)
+{
+    // each key is hashed once to find its partition
+    for (int t=threadId; t < m_NumThreadMaps; t += numThreads)
+    {
+        std::vector<std::vector<const WordType*> >& buckets = m_vPartKeys[t];
+        buckets.assign(m_vPartMaps.size(), std::vector<const WordType*>());
+        m_vThreadMaps[t].ForEach([this, &buckets](const WordType* key, long long)
+        {
+            buckets[this->GetPartition(key)].push_back(key);
+        });
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::MergePartitions(int threadId, int numThreads)
+{
+    // each thread de-duplicates the keys of all thread
+    // maps falling into its own hash partitions
+    for (int p=threadId; p < m_vPartMaps.size(); p += numThreads)
+    {
+        size_t numKeys = 0;
+        for (int t=0; t < m_NumThreadMaps; ++t)
+        {
+            numKeys += m_vPartKeys[t][p].size();
+        }
+
+        PackedKeyHashMap& part = m_vPartMaps[p];
+        part.Init(m_NumWords, 2 * numKeys + 16);
+
+        bool inserted;
+        for (int t=0; t < m_NumThreadMaps; ++t)
+        {
+            const std::vector<const WordType*>& keys = m_vPartKeys[t][p];
+            for (size_t k=0; k < keys.size(); ++k)
+            {
+                part.Insert(keys[k], 0, inserted);
+            }
+        }
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::RemapThreadMaps(int threadId, int numThreads)
+{
+    for (int t=threadId; t < m_NumThreadMaps; t += numThreads)
+    {
+        std::vector<ComboIndexType>& remap = m_vRemap[t];
+        remap.assign(m_vNextLocalId[t], 0);
+        m_vThreadMaps[t].ForEach([this, &remap](const WordType* key, long long lid)
+        {
+            remap[lid] = *m_vPartMaps[this->GetPartition(key)].Find(key);
+        });
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::MergeThreadMaps()
+{
+    const int numThreads = std::max(static_cast<int>(this->GetNumberOfThreads()), 1);
+
+    m_vPartMaps.resize(numThreads);
+    m_vPartKeys.resize(m_NumThreadMaps);
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(numThreads);
+    threader->SetSingleMethod(this->MergeThreaderCallback, this);
+
+    // sort the keys of each thread map into partitions ...
+    m_MergeStage = 0;
+    threader->SingleMethodExecute();
+
+    // ... and de-duplicate them across threads
+    m_MergeStage = 1;
+    threader->SingleMethodExecute();
+    m_vPartKeys.clear();
+
+    // number the unique combinations in sorted order
+    m_NumUniqueCombinations = 0;
+    for (int p=0; p < numThreads; ++p)
+    {
+        m_NumUniqueCombinations += m_vPartMaps[p].Size();
+    }
+
+    std::vector<WordType> keys;
+    keys.reserve(m_NumUniqueCombinations * m_NumWords);
+    for (int p=0; p < numThreads; ++p)
+    {
+        m_vPartMaps[p].ForEach([this, &keys](const WordType* key, long long)
+        {
+            keys.insert(keys.end(), key, key + m_NumWords);
+        });
+    }
+
+    const int nw = m_NumWords;
+    std::vector<ComboIndexType> order(m_NumUniqueCombinations);
+    for (ComboIndexType i=0; i < m_NumUniqueCombinations; ++i)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&keys, nw](ComboIndexType a, ComboIndexType b)
+    {
+        return std::lexicographical_compare(&keys[a * nw], &keys[a * nw] + nw,
+                                            &keys[b * nw], &keys[b * nw] + nw);
+    });
+
+    m_vUniqueKeys.resize(keys.size());
+    for (ComboIndexType r=0; r < m_NumUniqueCombinations; ++r)
+    {
+        const WordType* key = &keys[order[r] * nw];
+        std::copy(key, key + nw, &m_vUniqueKeys[r * nw]);
+        *m_vPartMaps[this->GetPartition(key)].Find(key) = r + 1;
+    }
+
+    // translate local into final ids
+    m_vRemap.resize(m_NumThreadMaps);
+    m_MergeStage = 2;
+    threader->SingleMethodExecute();
+
+    m_vPartMaps.clear();
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::SpillThreadMaps()
+{
+    if (m_SpillTable.IsNull())
+    {
+        std::string spillName = m_Workspace;
+        if (!spillName.empty() && spillName.at(spillName.size()-1) != '/')
+        {
+            spillName += "/";
+        }
+        spillName += "ucspill_" + SQLiteTable::GetRandomString(10) + ".ldb";
+
+        m_SpillTable = SQLiteTable::New();
+        m_SpillTable->SetUseSharedCache(false);
+        if (m_SpillTable->CreateTable(spillName, "1") == SQLiteTable::ATCREATE_ERROR)
+        {
+            m_SpillTable = 0;
+            itkExceptionMacro(<< "Failed creating the spill table '" << spillName << "'!");
+            return;
+        }
+
+        m_vSpillColumns.clear();
+        m_vSpillColumns.push_back("tid");
+        m_vSpillColumns.push_back("lid");
+        for (int w=0; w < m_NumWords; ++w)
+        {
+            std::stringstream kn;
+            kn << "k" << w;
+            m_vSpillColumns.push_back(kn.str());
+        }
+
+        m_SpillTable->BeginTransaction();
+        for (int c=0; c < m_vSpillColumns.size(); ++c)
+        {
+            m_SpillTable->AddColumn(m_vSpillColumns[c], AttributeTable::ATTYPE_INT);
+        }
+        m_SpillTable->EndTransaction();
+    }
+
+    std::stringstream msg;
+    msg << "Unique combinations exceed the memory budget of "
+        << m_MemoryBudget << " MiB - spilling to disk ...";
+    this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
+
+    std::vector<AttributeTable::ColumnValue> values(m_vSpillColumns.size());
+    for (int c=0; c < values.size(); ++c)
+    {
+        values[c].type = AttributeTable::ATTYPE_INT;
+    }
+
+    m_SpillTable->PrepareBulkSet(m_vSpillColumns, true);
+    m_SpillTable->BeginTransaction();
+    for (int t=0; t < m_NumThreadMaps; ++t)
+    {
+        values[0].ival = t;
+        m_vThreadMaps[t].ForEach([this, &values](const WordType* key, long long lid)
+        {
+            values[1].ival = lid;
+            for (int w=0; w < m_NumWords; ++w)
+            {
+                values[w+2].ival = static_cast<long long>(key[w]);
+            }
+            m_SpillTable->DoBulkSet(values);
+        });
+
+        // release the memory, but keep counting local ids,
+        // i.e. re-occurring keys just get another local id
+        m_vThreadMaps[t].Init(m_NumWords);
+    }
+    m_SpillTable->EndTransaction();
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::MergeSpilledMaps()
+{
+    const std::string st = m_SpillTable->GetTableName();
+
+    std::stringstream keyCols;
+    std::stringstream keyDefs;
+    std::stringstream keyJoin;
+    std::vector<std::string> vKeyCols;
+    for (int w=0; w < m_NumWords; ++w)
+    {
+        const std::string& kn = m_vSpillColumns[w+2];
+        vKeyCols.push_back(kn);
+        keyCols << (w > 0 ? ", " : "") << kn;
+        keyDefs << ", " << kn << " INTEGER";
+        keyJoin << (w > 0 ? " AND " : "") << st << "." << kn << " = uvcombos." << kn;
+    }
+
+    std::stringstream sql;
+    sql << "BEGIN TRANSACTION;";
+    sql << "CREATE TABLE uvcombos (uvid INTEGER PRIMARY KEY" << keyDefs.str() << ");";
+    sql << "INSERT INTO uvcombos (" << keyCols.str() << ") "
+        << "SELECT DISTINCT " << keyCols.str() << " FROM " << st
+        << " ORDER BY " << keyCols.str() << ";";
+    sql << "CREATE UNIQUE INDEX uvcombos_keys ON uvcombos (" << keyCols.str() << ");";
+    sql << "CREATE TABLE uvremap AS SELECT " << st << ".tid AS tid, "
+        << st << ".lid AS lid, uvcombos.uvid AS uvid FROM " << st
+        << " JOIN uvcombos ON " << keyJoin.str() << ";";
+    sql << "END TRANSACTION;";
+
+    NMDebugAI(<< sql.str() << std::endl);
+
+    if (!m_SpillTable->SqlExec(sql.str()))
+    {
+        itkExceptionMacro(<< "Failed merging the spilled unique combinations!");
+        return;
+    }
+
+    // read the sorted unique combinations ...
+    std::vector<AttributeTable::ColumnValue> values(m_NumWords);
+    for (int w=0; w < m_NumWords; ++w)
+    {
+        values[w].type = AttributeTable::ATTYPE_INT;
+    }
+
+    m_vUniqueKeys.clear();
+    m_NumUniqueCombinations = 0;
+    if (    !m_SpillTable->SetTableName("uvcombos")
+        ||  !m_SpillTable->PopulateTableAdmin()
+        ||  !m_SpillTable->PrepareBulkGet(vKeyCols, "ORDER BY uvid")
+       )
+    {
+        itkExceptionMacro(<< "Failed reading the unique combinations!");
+        return;
+    }
+
+    while (m_SpillTable->DoBulkGet(values))
+    {
+        for (int w=0; w < m_NumWords; ++w)
+        {
+            m_vUniqueKeys.push_back(static_cast<WordType>(values[w].ival));
+        }
+        ++m_NumUniqueCombinations;
+    }
+
+    // ... and the mapping of local onto final ids
+    m_vRemap.resize(m_NumThreadMaps);
+    for (int t=0; t < m_NumThreadMaps; ++t)
+    {
+        m_vRemap[t].assign(m_vNextLocalId[t], 0);
+    }
+
+    std::vector<std::string> vRemapCols;
+    vRemapCols.push_back("tid");
+    vRemapCols.push_back("lid");
+    vRemapCols.push_back("uvid");
+    values.resize(3);
+    for (int c=0; c < values.size(); ++c)
+    {
+        values[c].type = AttributeTable::ATTYPE_INT;
+    }
+
+    if (    !m_SpillTable->SetTableName("uvremap")
+        ||  !m_SpillTable->PopulateTableAdmin()
+        ||  !m_SpillTable->PrepareBulkGet(vRemapCols)
+       )
+    {
+        itkExceptionMacro(<< "Failed reading the unique combination ids!");
+        return;
+    }
+
+    while (m_SpillTable->DoBulkGet(values))
+    {
+        m_vRemap[values[0].ival][values[1].ival] = values[2].ival;
+    }
+}
+
+template< class TInputImage, class TOutputImage >
+void CombinationHashFilter< TInputImage, TOutputImage >
+::ResetPipeline()
+{
+    m_StreamingProc = false;
+    m_TotalPixCount = 0;
+
+    m_vThreadMaps.clear();
+    m_vNextLocalId.clear();
+    m_vThreadInvalid.clear();
+    m_vThreadPixCount.clear();
+    m_vPartMaps.clear();
+    m_vUniqueKeys.clear();
+    m_vRemap.clear();
+    m_NumUniqueCombinations = 0;
+    m_NumInvalidPixels = 0;
+
+    if (m_SpillTable.IsNotNull())
+    {
+        m_SpillTable->DeleteDatabase();
+        m_SpillTable = 0;
+    }
+
+    Superclass::ResetPipeline();
+}
+
+} // end namespace otb
+
+#endif /* __otbCombinationHashFilter_txx */
@@ -37,6 +37,8 @@
 #include "otbNMImageReader.h"
 #include "otbStreamingRATImageFileWriter.h"
 #include "otbSortFilter.h"
+#include "otbParallelRadixSort.h"
+#include "otbSortRunMerge.h"
 #include "itkNMImageRegionSplitterMaxSize.h"
 
 #include "nmotbsupplfilters_export.h"
@@ -47,14 +49,17 @@
 
 /*  Sorts an image and any additionally specified 'depending' image accordingly.
  *
- *	This class uses otbSortFilter to sort a large (>RAM) input image #0 either
- *  ascending or descending. Any additionally specified images are sorted according
- *  to the order of input image #0. Furthermore this filter produces and 'IndexImage'
- *  which denotes the original 1D-index (offset) position of input image #0.
- *  The IndexImage is available via GetIndexImage.
- *	This filter processes the input images in RAM concumable chunks, sorts the chunks
- *  using otbSortFilter, and writes the chunks to disk. Finally, it merges the chunks
- *  on disk to one image and writes it out.
+ *	This class sorts a large (>RAM) input image #0 either ascending or descending.
+ *  Any additionally specified images are sorted according to the order of input
+ *  image #0. Furthermore this filter produces and 'IndexImage' which denotes the
+ *  original 1D-index (offset) position of input image #0.
+ *	This filter processes the input images in RAM concumable chunks, sorts each
+ *  chunk's key/index pairs with a multi-threaded (stable) radix sort, and writes
+ *  the sorted chunk as a 'run' of records (the pixel values of all images plus the
+ *  32-bit index within the chunk) to disk, while the next chunk is read and sorted.
+ *  Finally, it merges the runs using a loser tree, reading each run block-wise
+ *  ahead of the merge, and writes the results out. Pixels with equal values keep
+ *  their original order.
  *
  *  inputs: fileName_image0, fileName_image1, ..., fileName_imageN
  *
@@ -87,10 +92,12 @@ public:
   typedef typename OutputImageType::RegionType OutputImageRegionType;
   typedef typename OutputImageType::PixelType  OutputImagePixelType;
 
-  typedef typename otb::SortFilter<TInputImage, TOutputImage>        SortFilterType;
-  typedef typename SortFilterType::IndexImageType                    IndexImageType;
-
-  //typedef typename otb::Image<long, OutputImageType::ImageDimension> IndexImageType;
+  /** the index image holds 32-bit offsets for images of up to 4 gigapixel;
+   *  larger images get double offsets (exact up to 2^53), since image
+   *  files don't support 64-bit integers
+   */
+  typedef typename otb::Image<unsigned int, OutputImageType::ImageDimension> IndexImageType;
+  typedef typename otb::Image<double, OutputImageType::ImageDimension>       LargeIndexImageType;
   typedef typename IndexImageType::Pointer                           IndexImagePointer;
   typedef typename IndexImageType::RegionType						 IndexImageRegionType;
   typedef typename IndexImageType::PixelType                         IndexImagePixelType;
@@ -104,6 +111,9 @@ public:
   typedef typename otb::StreamingRATImageFileWriter<IndexImageType>  IndexImageWriterType;
   typedef typename IndexImageWriterType::Pointer                     IndexImageWriterPointerType;
 
+  typedef typename RadixSortKey<InputImagePixelType>::KeyType  SortKeyType;
+  typedef typename RadixSortKey<OutputImagePixelType>::KeyType MergeKeyType;
+
   typedef typename otb::NMImageReader<OutputImageType> ChunkReaderType;
   typedef typename ChunkReaderType::Pointer            ChunkReaderPointerType;
   typedef typename otb::NMImageReader<IndexImageType> IndexReaderType;
@@ -139,46 +149,37 @@ protected:
     std::vector<std::string> PreSortChunks(
                                 std::vector<std::string>& outNames,
                                 std::vector<ImageReaderPointerType>& readers,
-                                std::vector<ImageWriterPointerType>& writers,
-                                IndexImageWriterPointerType& idxWriter,
                                 InputImageRegionType& lpr,
-                                itk::ImageIORegion& wior,
                                 int imagechunk
                                 );
 
-    bool FineSortChunks(std::vector<std::string>& chunkNames,
+    template <class TIndexImage>
+    bool FineSortChunks(std::vector<std::string>& runNames,
                         std::vector<std::string>& outNames,
+                        std::vector<ImageReaderPointerType>& readers,
                         std::vector<ImageWriterPointerType>& writers,
-                        IndexImageWriterPointerType& idxWriter,
                         InputImageRegionType& lpr,
-                        itk::ImageIORegion& wior,
                         int imagechunk
                         );
 
+    /*! writes the pixels of imgs in the given order as
+     *  records of a sorted run to runName */
+    static bool WriteRun(const std::string runName,
+                         const std::vector<InputImagePointer> imgs,
+                         const std::vector<unsigned int> order);
 
+    /*! sort key of the first value of a run record */
+    inline MergeKeyType GetMergeKey(const char* record) const;
 
-    void forwardChunkSplit(
-            const int& splitNum,
-            const int& maxSplitSplitSize,
-            itk::NMImageRegionSplitterMaxSize::Pointer& ssp,
-            std::vector< IndexReaderPointerType >&                idxChkReaders,
-            std::vector< IndexImagePixelType* >&                  idxChkBuffers,
-            std::vector< std::vector< ChunkReaderPointerType > >& imgChkReaders,
-            std::vector< std::vector< OutputImagePixelType* > >&  imgChkBuffers,
-            std::vector< InputImageRegionType >&   imgChkLPR,
-            std::vector< int >&                    imgChkOffset,
-            std::vector< int >&                    imgChkLength,
-            std::vector< int >&                    imgChkSplitNum
-            );
-
+    template <class TIndexImage>
     void forwardOutputSplit(
             int& outputSplit,
             const int& numSplits,
             const int& maxSplitSize,
             itk::NMImageRegionSplitterMaxSize::Pointer& splitter,
             std::vector< ImageWriterPointerType >& writers,
-            IndexImageWriterPointerType&           idxWriter,
-            IndexImagePixelType* &                  idxOutBuffer,
+            typename otb::StreamingRATImageFileWriter<TIndexImage>::Pointer& idxWriter,
+            typename TIndexImage::PixelType* &      idxOutBuffer,
             std::vector< OutputImagePixelType* >&  outBuffers,
             int&                    outputOffset,
             int&                    outputLength
@@ -195,6 +196,9 @@ protected:
 
     std::vector<long> m_RowOffsets;
 
+    // number of records per sorted run
+    std::vector<long long> m_RunLengths;
+
     int m_MaxChunkSize;
 
 
@@ -36,6 +36,13 @@
 #include "itkDataObject.h"
 #include "itkImageSource.h"
 
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <memory>
+#include <future>
+#include <algorithm>
+
 
 #ifdef _WIN32
     #define CHAR_PATHDEVIDE "\\"
@@ -208,16 +215,6 @@ void ExternalSortFilter<TInputImage, TOutputImage>
         writers.push_back(iw);
     }
 
-    IndexImageWriterPointerType idxWriter = IndexImageWriterType::New();
-#ifdef BUILD_RASSUPPORT
-    if (readers.at(0)->GetRasdamanConnector() != 0)
-    {
-        idxWriter->SetRasdamanConnector(readers.at(0)->GetRasdamanConnector());
-    }
-#endif
-    idxWriter->SetForcedLargestPossibleRegion(wior);
-    idxWriter->SetStreamingMethod("NO_STREAMING");
-
     // =======================================================
     // PRE-SORT CHUNKS
     // =======================================================
@@ -226,25 +223,41 @@ void ExternalSortFilter<TInputImage, TOutputImage>
     int pixsize   = readers.at(0)->GetImageIO()->GetComponentSize();
     int imagechunk = (m_MaxChunkSize * 1024*1024) / (numOutputs*2) / pixsize;
 
-    std::vector<std::string> chunknames =
-            PreSortChunks(outNames, readers, writers, idxWriter, lpr, wior, imagechunk);
+    std::vector<std::string> runNames =
+            PreSortChunks(outNames, readers, lpr, imagechunk);
 
-    if (chunknames.size() == 0)
+    if (runNames.size() == 0)
     {
         NMDebugAI(<< "Pre-sorting of image chunks failed or aborted!" << std::endl);
         NMDebugCtx(ctxExternalSortFilter, << "done!");
     }
 
     // =======================================================
-    // FINE-SORT CHUNKS
+    // MERGE SORTED RUNS
     // =======================================================
 
     bool sorted = false;
-    if (!this->GetAbortGenerateData())
+    if (!this->GetAbortGenerateData() && runNames.size() > 0)
     {
-        sorted = FineSortChunks(chunknames, outNames, writers, idxWriter, lpr, wior, imagechunk);
+        // a 32-bit index does for images of up to 4 gigapixel
+        if (static_cast<unsigned long long>(lpr.GetNumberOfPixels()) <= 0xffffffffULL)
+        {
+            sorted = FineSortChunks<IndexImageType>(
+                        runNames, outNames, readers, writers, lpr, imagechunk);
+        }
+        else
+        {
+            sorted = FineSortChunks<LargeIndexImageType>(
+                        runNames, outNames, readers, writers, lpr, imagechunk);
+        }
     }
 
+    for (int r=0; r < runNames.size(); ++r)
+    {
+        std::remove(runNames.at(r).c_str());
+    }
+    m_RunLengths.clear();
+
     if (sorted)
     {
         NMDebugAI( << "ALL SORTED MATE !!!" << std::endl);
@@ -258,260 +271,141 @@ void ExternalSortFilter<TInputImage, TOutputImage>
 }
 
 template <class TInputImage, class TOutputImage>
+template <class TIndexImage>
 bool
 ExternalSortFilter<TInputImage, TOutputImage>
-::FineSortChunks(std::vector<std::string>& chunkNames,
+::FineSortChunks(std::vector<std::string>& runNames,
                  std::vector<std::string>& outNames,
+                 std::vector<ImageReaderPointerType>& readers,
                  std::vector<ImageWriterPointerType>& writers,
-                 IndexImageWriterPointerType& idxWriter,
                  InputImageRegionType& lpr,
-                 itk::ImageIORegion& wior,
                  int imagechunk
                  )
 {
     NMDebugCtx(ctxExternalSortFilter, << "...");
 
-    // BOOK KEEPING  - PRE-SORTED IMAGES
-    std::vector< std::vector< ChunkReaderPointerType > > imgChkReaders;
-    std::vector< std::vector< OutputImagePixelType* > >  imgChkBuffers;
-    std::vector< InputImageRegionType >   imgChkLPR;
-    std::vector< int >                    imgChkOffset;
-    std::vector< int >                    imgChkLength;
-    std::vector< int >                    imgChkSplitNum;
-    std::vector< int >                    imgChkNumSplitSplits;
-
-    // BOOK KEEPING - INDEX IMAGE
-    std::vector< IndexReaderPointerType > idxChkReaders;
-    std::vector< IndexImagePixelType* >   idxChkBuffers;
-    std::vector< IndexImagePixelType >    idxChkOffset;     // since index image chunks hold
-                                                            // only 'local' chunk index rather
-                                                            // the global one, we generate a
-                                                            // buffer storing the appropriate
-                                                            // index offset to this chunk, so
-                                                            // we can piece everything together
-                                                            // as it should be
-
-
-    // BOOK KEEPING - OUTPUTIMAGES
-    std::vector< OutputImagePixelType* >  outBuffers;
-    outBuffers.resize(writers.size(), 0);
-    IndexImagePixelType*                  idxOutBuffer;
+    typedef typename otb::StreamingRATImageFileWriter<TIndexImage> IdxWriterType;
+    typedef typename TIndexImage::PixelType                       IdxPixelType;
 
-    // chunk region stuff
-    itk::NMImageRegionSplitterMaxSize::Pointer splitter =
-            itk::NMImageRegionSplitterMaxSize::New();
-    int numSplits = splitter->GetNumberOfSplits(lpr, imagechunk);
-    InputImageRegionType chunkRegion;
-
-    // probably, we've got to split the chunk regions since we're accessing
-    // all of them at the same time (may prove to be utterly slow because of lots
-    // of reading and disk access bottleneck ... we'll find out!)
-    itk::NMImageRegionSplitterMaxSize::Pointer ssp =
-            itk::NMImageRegionSplitterMaxSize::New();
-    long maxsplitsize = ((double)imagechunk / (double)(numSplits)) + 0.5;
-    long splitsize = maxsplitsize;
-    int numSplitSplits = 1;
-
-    // ==============================================================
-    // VECTOR OF READERS FOR EACH IMAGE AND FOR EACH IMAGE CHUNK
-    // ==============================================================
-
-    NMDebugAI(<< "============================" << std::endl);
-    NMDebugAI(<< "PREP WORK READERS & WRITERS" << std::endl);
-    NMDebugAI(<< "============================" << std::endl);
+    const int numRuns = runNames.size();
+    const int numImgs = writers.size();
+    const size_t recordSize = numImgs * sizeof(OutputImagePixelType) + sizeof(unsigned int);
 
     // ------------------------------------------------------
-    // INIT READERS + other book keeping preparations
+    // OPEN RUNS
     // ------------------------------------------------------
 
-    // for each image prepare numSplits readers ...
-    // except for the index readers, they've got a different type
-    for (int r=0; r < chunkNames.size(); ++r)
+    // we spend about half of the memory budget on the run
+    // blocks, each of which is double buffered
+    size_t blockRecords = (static_cast<size_t>(m_MaxChunkSize) * 1024*1024 / 2)
+                          / (numRuns * 2 * recordSize);
+    blockRecords = std::max<size_t>(blockRecords, 4096);
+
+    std::vector< std::unique_ptr<SortRunReader> > runReaders;
+    std::vector< long long > runOffsets;
+    long long runOffset = 0;
+    for (int r=0; r < numRuns; ++r)
     {
-        std::vector< ChunkReaderPointerType > chkReaders;
-        std::vector< OutputImagePixelType* >  chkBuffers;
-        for (int split=0; split < numSplits; ++split)
+        std::unique_ptr<SortRunReader> rr(new SortRunReader());
+        if (!rr->Open(runNames.at(r), recordSize, m_RunLengths.at(r), blockRecords))
         {
-            chunkRegion = lpr;
-            splitter->GetSplit(split, imagechunk, chunkRegion);
-
-            // calc the max split region (chunk region) size
-            // to get a feeling for how much memory is
-            // available for each chunk region
-            if (r == 0)   // only need to do this once
-            {
-                splitsize = chunkRegion.GetNumberOfPixels() * sizeof(IndexImagePixelType);
-                if (maxsplitsize < splitsize)
-                {
-                    numSplitSplits = ssp->GetNumberOfSplits(chunkRegion, maxsplitsize);
-                    imgChkNumSplitSplits.push_back(numSplitSplits);
-                }
-                else
-                {
-                    imgChkNumSplitSplits.push_back(1);
-                }
-            }
-
-            if (r < chunkNames.size()-1)
-            {
-                ChunkReaderPointerType cr = ChunkReaderType::New();
-#ifdef BUILD_RASSUPPORT
-                cr->SetRasdamanConnector(writers.at(r)->GetRasdamanConnector());
-#endif
-                cr->SetFileName(chunkNames.at(r));
-                cr->GetOutput()->SetLargestPossibleRegion(chunkRegion);
-                chkReaders.push_back(cr);
-                chkBuffers.push_back(0);
-            }
-            else
-            {
-                IndexReaderPointerType ir = IndexReaderType::New();
-#ifdef BUILD_RASSUPPORT
-                ir->SetRasdamanConnector(idxWriter->GetRasdamanConnector());
-#endif
-                ir->SetFileName(chunkNames.at(r));
-                ir->GetOutput()->SetLargestPossibleRegion(chunkRegion);
-                idxChkReaders.push_back(ir);
-                idxChkBuffers.push_back(0);
-                imgChkOffset.push_back(0);
-                imgChkLength.push_back(0);
-                imgChkSplitNum.push_back(-1);
-                imgChkLPR.push_back(chunkRegion);
-
-                // create index offset per chunk to map between stored 'local'
-                // index and proper whole image index
-                if (split == 0)
-                {
-                    idxChkOffset.push_back(0);
-                }
-                else
-                {
-                    IndexImagePixelType tr1 = imgChkLPR.at(split-1).GetNumberOfPixels();
-                    tr1 += idxChkOffset[split-1];
-                    idxChkOffset.push_back(tr1);
-                }
-            }
+            std::stringstream msg;
+            msg << "Couldn't open sorted run '" << runNames.at(r) << "'!";
+            throw itk::ExceptionObject(__FILE__, __LINE__, msg.str(), __FUNCTION__);
         }
+        runReaders.push_back(std::move(rr));
 
-        // add to the vector of readers of image chunks
-        if (r < chunkNames.size()-1)
+        // the run's records only hold the 'local' chunk index, so we
+        // keep track of each chunk's offset into the whole image
+        runOffsets.push_back(runOffset);
+        runOffset += m_RunLengths.at(r);
+    }
+
+    LoserTree<MergeKeyType> tree;
+    tree.Init(numRuns);
+    for (int r=0; r < numRuns; ++r)
+    {
+        if (!runReaders.at(r)->AtEnd())
         {
-            imgChkReaders.push_back(chkReaders);
-            imgChkBuffers.push_back(chkBuffers);
+            tree.SetKey(r, this->GetMergeKey(runReaders.at(r)->Current()));
         }
     }
-    NMDebugAI(<< "maxsplitsize   = " << maxsplitsize << std::endl);
-    NMDebugAI(<< "splitsize      = " << splitsize << std::endl);
-    NMDebugAI(<< "numSplitSplits = " << numSplitSplits << std::endl);
-    NMDebug(<< std::endl);
+    tree.Build();
 
+    NMDebugAI(<< "merging " << numRuns << " runs, "
+              << blockRecords << " records per block" << std::endl);
 
     // ------------------------------------------------------
     // INIT WRITERS
     // ------------------------------------------------------
-    for (int on=0; on < outNames.size()-1; ++on)
+    for (int on=0; on < numImgs; ++on)
     {
-        OutputImageType* oldImg = const_cast<OutputImageType*>(writers.at(on)->GetInput());
+        readers.at(on)->UpdateOutputInformation();
 
         OutputImagePointer outImg = OutputImageType::New();
-        outImg->CopyInformation(oldImg);
+        outImg->CopyInformation(readers.at(on)->GetOutput());
 
         writers.at(on)->SetFileName(outNames.at(on));
         writers.at(on)->SetUpdateMode(true);
         writers.at(on)->SetInput(outImg);
     }
 
-    IndexImageType* oldIdx = const_cast<IndexImageType*>(
-                idxWriter->GetInput());
+    itk::ImageIORegion wior(lpr.ImageDimension);
+    for (int d=0; d < lpr.ImageDimension; ++d)
+    {
+        wior.SetIndex(d, lpr.GetIndex(d));
+        wior.SetSize(d, lpr.GetSize(d));
+    }
 
-    IndexImagePointer idxImg = IndexImageType::New();
-    idxImg->CopyInformation(oldIdx);
+    typename IdxWriterType::Pointer idxWriter = IdxWriterType::New();
+#ifdef BUILD_RASSUPPORT
+    if (readers.at(0)->GetRasdamanConnector() != 0)
+    {
+        idxWriter->SetRasdamanConnector(readers.at(0)->GetRasdamanConnector());
+    }
+#endif
+    idxWriter->SetForcedLargestPossibleRegion(wior);
+    idxWriter->SetStreamingMethod("NO_STREAMING");
+
+    typename TIndexImage::Pointer idxImg = TIndexImage::New();
+    idxImg->CopyInformation(readers.at(0)->GetOutput());
 
     idxWriter->SetFileName(outNames.at(outNames.size()-1));
     idxWriter->SetUpdateMode(true);
     idxWriter->SetInput(idxImg);
 
-
     // ==============================================================
-    // FINE SORT
+    // K-WAY MERGE
     // ==============================================================
 
-    NMDebugAI(<< "=========================" << std::endl);
-    NMDebugAI(<< "FINE SORT ... " << std::endl);
-    NMDebugAI(<< "=========================" << std::endl);
-    OutputImagePixelType tmp, val;
+    std::vector< OutputImagePixelType* >  outBuffers;
+    outBuffers.resize(numImgs, 0);
+    IdxPixelType*                         idxOutBuffer = 0;
+
+    itk::NMImageRegionSplitterMaxSize::Pointer splitter =
+            itk::NMImageRegionSplitterMaxSize::New();
+    int numSplits = splitter->GetNumberOfSplits(lpr, imagechunk);
 
     int outputSplit = -1;
     int outputLength = 0;
     int outputOffset = 0;
 
-    long numpix = lpr.GetNumberOfPixels();
+    const long numpix = lpr.GetNumberOfPixels();
     long pixcnt = 0;
-    int valChkIdx = -1;
+    unsigned int localIdx;
 
     while (pixcnt < numpix && !this->GetAbortGenerateData())
     {
-        if (this->m_SortAscending)
-        {
-            val = itk::NumericTraits<OutputImagePixelType>::max();
-        }
-        else
-        {
-            val = itk::NumericTraits<OutputImagePixelType>::NonpositiveMin();
-        }
-        valChkIdx = -1;
-
-        // find the next biggest value out of all chunks of the
-        // primary 'sort image'
-        for (int chunk=0; chunk < numSplits; ++chunk)
+        const int run = tree.Winner();
+        if (tree.IsDone(run))
         {
-            // since each chunk is split into further chunk, we
-            // make sure there is a next pixel available;
-            if (imgChkOffset.at(chunk) >= imgChkLength.at(chunk))
-            {
-                if (imgChkSplitNum.at(chunk) < imgChkNumSplitSplits.at(chunk)-1)
-                {
-                    forwardChunkSplit(chunk, maxsplitsize, ssp,
-                                      idxChkReaders, idxChkBuffers,
-                                      imgChkReaders, imgChkBuffers,
-                                      imgChkLPR,
-                                      imgChkOffset, imgChkLength, imgChkSplitNum);
-                    NMDebugAI(<< "pixel: " << pixcnt << std::endl);
-                }
-                // if we've processed all pixels of this chunk, we skip it and
-                // go to the next
-                else
-                {
-                    //NMDebugAI(<<"nope - done this chunk ..." << std::endl);
-                    continue;
-                }
-            }
-
-            // is this pixel bigger than the ones we've looked at?
-            // if yes, remember which chunk it was
-            tmp = imgChkBuffers.at(0).at(chunk)[imgChkOffset.at(chunk)];
-            if (this->m_SortAscending)
-            {
-                if (tmp <= val)
-                {
-                    val = tmp;
-                    valChkIdx = chunk;
-                }
-            }
-            else
-            {
-                if (tmp >= val)
-                {
-                    val = tmp;
-                    valChkIdx = chunk;
-                }
-            }
+            break;
         }
 
         // make sure we've got an appropriate output region allocated
         if (outputOffset >= outputLength)
         {
-            forwardOutputSplit(outputSplit,
+            forwardOutputSplit<TIndexImage>(outputSplit,
                                numSplits,
                                imagechunk,
                                splitter,
@@ -521,20 +415,41 @@ ExternalSortFilter<TInputImage, TOutputImage>
             NMDebugAI(<< "pixel: " << pixcnt << std::endl);
         }
 
-        for (int i=0; i < writers.size(); ++i)
+        const char* rec = runReaders[run]->Current();
+        for (int i=0; i < numImgs; ++i)
         {
-            outBuffers[i][outputOffset] =
-                    static_cast<OutputImagePixelType>(
-                     imgChkBuffers[i][valChkIdx][imgChkOffset[valChkIdx]]);
+            std::memcpy(&outBuffers[i][outputOffset],
+                        rec + i * sizeof(OutputImagePixelType),
+                        sizeof(OutputImagePixelType));
         }
-        idxOutBuffer[outputOffset] = static_cast<IndexImagePixelType>(
-                    idxChkBuffers[valChkIdx][imgChkOffset.at(valChkIdx)]
-                    + idxChkOffset[valChkIdx]);
-        ++imgChkOffset.at(valChkIdx);
+        std::memcpy(&localIdx, rec + numImgs * sizeof(OutputImagePixelType),
+                    sizeof(unsigned int));
+        idxOutBuffer[outputOffset] = static_cast<IdxPixelType>(
+                    runOffsets[run] + localIdx);
+
+        runReaders[run]->Next();
+        if (runReaders[run]->AtEnd())
+        {
+            tree.SetDone(run);
+        }
+        else
+        {
+            tree.SetKey(run, this->GetMergeKey(runReaders[run]->Current()));
+        }
+        tree.Replay(run);
+
         ++outputOffset;
         ++pixcnt;
     }
 
+    if (pixcnt < numpix && !this->GetAbortGenerateData())
+    {
+        NMProcErr(<< "Sorted runs hold only " << pixcnt << " of "
+                  << numpix << " pixels!");
+        NMDebugCtx(ctxExternalSortFilter, << "done!");
+        return false;
+    }
+
     // write the final pieces
     for (int wr=0; wr < writers.size(); ++wr)
     {
@@ -548,6 +463,7 @@ ExternalSortFilter<TInputImage, TOutputImage>
 
 
 template <class TInputImage, class TOutputImage>
+template <class TIndexImage>
 void
 ExternalSortFilter<TInputImage, TOutputImage>
 ::forwardOutputSplit(int& outputSplit,
@@ -555,8 +471,8 @@ ExternalSortFilter<TInputImage, TOutputImage>
         const int& maxSplitSize,
         itk::NMImageRegionSplitterMaxSize::Pointer& splitter,
         std::vector< ImageWriterPointerType >& writers,
-        IndexImageWriterPointerType&           idxWriter,
-        IndexImagePixelType* &                  idxOutBuffer,
+        typename otb::StreamingRATImageFileWriter<TIndexImage>::Pointer& idxWriter,
+        typename TIndexImage::PixelType* &      idxOutBuffer,
         std::vector<OutputImagePixelType*>&    outBuffers,
         int&                    outputOffset,
         int&                    outputLength
@@ -642,10 +558,10 @@ ExternalSortFilter<TInputImage, TOutputImage>
         outBuffers.at(on) = outBuffer;
     }
 
-    IndexImageType* oldIdx = const_cast<IndexImageType*>(
+    TIndexImage* oldIdx = const_cast<TIndexImage*>(
                 idxWriter->GetInput());
 
-    IndexImagePointer idxImg = IndexImageType::New();
+    typename TIndexImage::Pointer idxImg = TIndexImage::New();
     idxImg->CopyInformation(oldIdx);
     idxImg->SetLargestPossibleRegion(region);
     idxImg->SetRequestedRegion(region);
@@ -655,61 +571,71 @@ ExternalSortFilter<TInputImage, TOutputImage>
     idxWriter->SetInput(idxImg);
     idxWriter->SetUpdateRegion(ioRegion);
 
-    idxOutBuffer = static_cast<IndexImagePixelType*>(idxImg->GetBufferPointer());
+    idxOutBuffer = static_cast<typename TIndexImage::PixelType*>(idxImg->GetBufferPointer());
 }
 
 
 template <class TInputImage, class TOutputImage>
-void
+typename ExternalSortFilter<TInputImage, TOutputImage>::MergeKeyType
 ExternalSortFilter<TInputImage, TOutputImage>
-::forwardChunkSplit(const int& splitNum,
-        const int& maxSplitSplitSize,
-        itk::NMImageRegionSplitterMaxSize::Pointer& ssp,
-        std::vector< IndexReaderPointerType >&                idxChkReaders,
-        std::vector< IndexImagePixelType* >&                  idxChkBuffers,
-        std::vector< std::vector< ChunkReaderPointerType > >& imgChkReaders,
-        std::vector< std::vector< OutputImagePixelType* > >&  imgChkBuffers,
-        std::vector<InputImageRegionType> &imgChkLPR,
-        std::vector<int>& imgChkOffset,
-        std::vector<int>& imgChkLength,
-        std::vector<int>& imgChkSplitNum
-        )
+::GetMergeKey(const char* record) const
 {
-    // get largest possible region as input for the region splitter
-    OutputImageType* img = static_cast<OutputImageType*>(
-                           imgChkReaders.at(0).at(splitNum)->GetOutput());
-    OutputImageRegionType ssreg = imgChkLPR.at(splitNum);
-            //img->GetLargestPossibleRegion();
+    OutputImagePixelType val;
+    std::memcpy(&val, record, sizeof(OutputImagePixelType));
 
-    // forward the splitsplit number and fetch associated new region
-    int splitsplit = imgChkSplitNum.at(splitNum) + 1;
-    ssp->GetSplit(splitsplit, maxSplitSplitSize, ssreg);
+    const MergeKeyType key = RadixSortKey<OutputImagePixelType>::Get(val);
+    return this->m_SortAscending ? key : static_cast<MergeKeyType>(~key);
+}
 
-    NMDebugAI(<< "RS: " << splitNum << "-" << splitsplit << " : "
-              << ssreg.GetIndex(0) << ", " << ssreg.GetIndex(1) << " "
-              << ssreg.GetSize(0) << "x" << ssreg.GetSize(1) << " = "
-              << ssreg.GetNumberOfPixels() << std::endl);
 
-    for (int i=0; i < imgChkReaders.size(); ++i)
+template <class TInputImage, class TOutputImage>
+bool
+ExternalSortFilter<TInputImage, TOutputImage>
+::WriteRun(const std::string runName,
+           const std::vector<InputImagePointer> imgs,
+           const std::vector<unsigned int> order)
+{
+    std::ofstream out(runName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
     {
-        OutputImageType* img = static_cast<OutputImageType*>(
-                               imgChkReaders.at(i).at(splitNum)->GetOutput());
+        return false;
+    }
 
-        img->SetRequestedRegion(ssreg);
-        img->Update();
+    const int numImgs = imgs.size();
+    const size_t valSize = sizeof(OutputImagePixelType);
+    const size_t recordSize = numImgs * valSize + sizeof(unsigned int);
 
-        imgChkBuffers[i][splitNum]  = static_cast<OutputImagePixelType*>(img->GetBufferPointer());
+    std::vector<const InputImagePixelType*> bufs;
+    for (int i=0; i < numImgs; ++i)
+    {
+        bufs.push_back(imgs.at(i)->GetBufferPointer());
     }
-    imgChkOffset[splitNum] = 0;
-    imgChkLength[splitNum] = ssreg.GetNumberOfPixels();
-    imgChkSplitNum[splitNum] = splitsplit;
 
-    IndexImageType* idxImg = static_cast<IndexImageType*>(
-                        idxChkReaders.at(splitNum)->GetOutput());
-    idxImg->SetRequestedRegion(ssreg);
-    idxImg->Update();
+    const size_t blockRecords = 1 << 16;
+    std::vector<char> block(blockRecords * recordSize);
+    OutputImagePixelType val;
 
-    idxChkBuffers[splitNum] = static_cast<IndexImagePixelType*>(idxImg->GetBufferPointer());
+    size_t pos = 0;
+    while (pos < order.size() && out.good())
+    {
+        const size_t len = std::min(blockRecords, order.size() - pos);
+        char* rec = &block[0];
+        for (size_t p=pos; p < pos + len; ++p, rec += recordSize)
+        {
+            const unsigned int idx = order[p];
+            for (int i=0; i < numImgs; ++i)
+            {
+                val = static_cast<OutputImagePixelType>(bufs[i][idx]);
+                std::memcpy(rec + i * valSize, &val, valSize);
+            }
+            std::memcpy(rec + numImgs * valSize, &idx, sizeof(unsigned int));
+        }
+        out.write(&block[0], len * recordSize);
+        pos += len;
+    }
+
+    out.close();
+    return !out.fail();
 }
 
 
@@ -718,65 +644,49 @@ std::vector<std::string>
 ExternalSortFilter<TInputImage, TOutputImage>
 ::PreSortChunks(std::vector<std::string>& outNames,
         std::vector<ImageReaderPointerType>& readers,
-        std::vector<ImageWriterPointerType>& writers,
-        IndexImageWriterPointerType& idxWriter,
         InputImageRegionType& lpr,
-        itk::ImageIORegion& wior,
         int imagechunk
         )
 {
 //    NMDebugCtx(ctxExternalSortFilter, << "...");
 
-    std::vector<std::string> chunknames;
+    std::vector<std::string> runNames;
+    m_RunLengths.clear();
 
     // ==========================================================
-    // CREATE CHUNKNAMES
+    // CREATE RUN FILE NAME STEM
     // ==========================================================
 
-    std::string fn;
-    for (int wr=0; wr < outNames.size(); ++wr)
+    std::string fn = outNames.at(outNames.size()-1);
+    std::string::size_type pos = fn.rfind(CHAR_PATHDEVIDE);
+    if (pos == std::string::npos)
     {
-        fn = outNames.at(wr);
-        std::string::size_type pos = fn.rfind(CHAR_PATHDEVIDE);
-        std::stringstream chkstr;
-        chkstr << "tmpick" << "_";
-        if (pos == std::string::npos)
-        {
-            pos = 0;
-        }
-        else
-        {
-            ++pos;
-        }
-        fn.insert(pos, chkstr.str());
-        chunknames.push_back(fn);
-
-        if (wr < outNames.size()-1)
-        {
-            writers.at(wr)->SetFileName(fn);
-            writers.at(wr)->SetUpdateMode(true);
-        }
+        pos = 0;
     }
-    idxWriter->SetFileName(chunknames[chunknames.size()-1]);
-    idxWriter->SetUpdateMode(true);
+    else
+    {
+        ++pos;
+    }
+    fn.insert(pos, "tmpick_");
 
     itk::NMImageRegionSplitterMaxSize::Pointer splitter = itk::NMImageRegionSplitterMaxSize::New();
     int numSplits = splitter->GetNumberOfSplits(lpr, imagechunk);
 
     NMDebugAI(<< "Pre-sorting " << numSplits << " chunks ..." << std::endl);
 
+    ParallelRadixSort<SortKeyType, unsigned int> radix;
+    radix.SetNumberOfThreads(this->GetNumberOfThreads());
+
+    // the sorted run of chunk s is written to disk while
+    // chunk s+1 is being read and sorted
+    std::future<bool> pendingRun;
+
     InputImageRegionType procRegion = lpr;
-    for (int s=0; s < numSplits; ++s)
+    for (int s=0; s < numSplits && !this->GetAbortGenerateData(); ++s)
     {
         procRegion = lpr;
         splitter->GetSplit(s, imagechunk, procRegion);
 
-        for (int d=0; d < lpr.ImageDimension; ++d)
-        {
-            wior.SetIndex(d, procRegion.GetIndex(d));
-            wior.SetSize(d, procRegion.GetSize(d));
-        }
-
         // ===========================================================
         // DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG DEBUG
         NMDebugAI(<< "#" << s << " - Index: ");
@@ -795,55 +705,87 @@ ExternalSortFilter<TInputImage, TOutputImage>
         // ===========================================================
 
         // ===========================================================
-        // PRIME THE SORTER & SORT
+        // READ THE CHUNK
         // ===========================================================
 
-        typename SortFilterType::Pointer sorter = SortFilterType::New();
-        sorter->SetSortAscending(this->m_SortAscending);
-
+        std::vector<InputImagePointer> imgs;
         for (int i=0; i < readers.size(); ++i)
         {
             if (readers.at(i)->GetOutput() == 0)
             {
                 std::stringstream msg;
                 msg << "Couldn't read input image '"
-                    << m_FileNames.at(s) << "'!";
+                    << m_FileNames.at(i) << "'!";
                 throw itk::ExceptionObject(__FILE__, __LINE__,
                                            msg.str(),
                                            __FUNCTION__);
-                NMDebugCtx(ctxExternalSortFilter, << "done!");
-                chunknames.clear();
-                return chunknames;
             }
 
             readers.at(i)->GetOutput()->SetRequestedRegion(procRegion);
             readers.at(i)->Update();
             InputImagePointer img = readers.at(i)->GetOutput();
             img->DisconnectPipeline();
-
-            sorter->SetInput(i, img);
+            imgs.push_back(img);
         }
 
-        sorter->Update();
+        // ===========================================================
+        // RADIX SORT KEY/INDEX PAIRS
+        // ===========================================================
+
+        const size_t numPix = procRegion.GetNumberOfPixels();
+        const InputImagePixelType* buf0 = imgs.at(0)->GetBufferPointer();
+
+        std::vector<SortKeyType> keys(numPix);
+        std::vector<unsigned int> order(numPix);
+        for (size_t p=0; p < numPix; ++p)
+        {
+            const SortKeyType key = RadixSortKey<InputImagePixelType>::Get(buf0[p]);
+            keys[p] = this->m_SortAscending ? key : static_cast<SortKeyType>(~key);
+            order[p] = static_cast<unsigned int>(p);
+        }
+        radix.Sort(keys, order);
+        std::vector<SortKeyType>().swap(keys);
 
         // ===========================================================
-        // WRITE SORTED CHUNKS
+        // WRITE SORTED RUN
         // ===========================================================
 
-        for (int wr = 0; wr < chunknames.size()-1; ++wr)
+        if (pendingRun.valid() && !pendingRun.get())
         {
-            writers.at(wr)->SetInput(sorter->GetOutput(wr));
-            writers.at(wr)->SetUpdateRegion(wior);
-            writers.at(wr)->Update();
+            std::stringstream msg;
+            msg << "Failed writing sorted run '" << runNames.back() << "'!";
+            throw itk::ExceptionObject(__FILE__, __LINE__, msg.str(), __FUNCTION__);
         }
-        idxWriter->SetInput(sorter->GetIndexImage());
-        idxWriter->SetUpdateRegion(wior);
-        idxWriter->Update();
+
+        std::stringstream runstr;
+        runstr << fn << "_" << s << ".run";
+        runNames.push_back(runstr.str());
+        m_RunLengths.push_back(numPix);
+
+        pendingRun = std::async(std::launch::async, &Self::WriteRun,
+                                runstr.str(), imgs, std::move(order));
+    }
+
+    if (pendingRun.valid() && !pendingRun.get())
+    {
+        std::stringstream msg;
+        msg << "Failed writing sorted run '" << runNames.back() << "'!";
+        throw itk::ExceptionObject(__FILE__, __LINE__, msg.str(), __FUNCTION__);
+    }
+
+    if (this->GetAbortGenerateData())
+    {
+        for (int r=0; r < runNames.size(); ++r)
+        {
+            std::remove(runNames.at(r).c_str());
+        }
+        runNames.clear();
+        m_RunLengths.clear();
     }
 
 //    NMDebugCtx(ctxExternalSortFilter, << "done!");
 
-    return chunknames;
+    return runNames;
 }
 
 } // end namespace
@@ -34,6 +34,10 @@
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkMultiThreader.h"
+#include "otbParallelRadixSort.h"
+#include <vector>
+#include <unordered_map>
 // ToDo: check, if really required
 //#include "itkConceptChecking.h"
 
@@ -72,13 +76,7 @@ public:
   typedef typename ProcImageType::IndexType                                 ProcImageIndexType;
   typedef typename ProcImageType::RegionType                                ProcImageRegionType;
 
-
-  struct HeightList
-  {
-    long col;
-    long row;
-    InputImagePixelType z;
-  };
+  typedef typename RadixSortKey<InputImagePixelType>::KeyType  SortKeyType;
 
   /*! Sets the flow accumulation algorithm. Options are
    *  Dinf          - Tarboton 1997
@@ -114,18 +112,206 @@ public:
       m_bFlowLengthUp = bflowlenup;
   }
 
+  /*! Sets the order in which cells are routed
+   *  SORTED      - (default) all cells are routed in order of height;
+   *                the cells are ordered by a parallel radix sort
+   *  TOPOLOGICAL - a cell is routed as soon as all of its donor
+   *                cells (i.e. the cells draining into it) have been routed;
+   *                the image rows are split into bands which are processed
+   *                concurrently; flow crossing band boundaries is exchanged
+   *                between rounds; cells of equal height (i.e. on flats)
+   *                depend on each other in row-major order, and the inflow
+   *                of each cell is summed up in the order of its donors'
+   *                height, so the results are the same as with SORTED
+   *  TILED       - same as TOPOLOGICAL, but the DEM (and weight) image is
+   *                read from the upstream pipeline tile by tile (s. TileSize),
+   *                i.e. only the output image and one byte per cell are
+   *                held in memory for the whole image; tiles are processed
+   *                one at a time and revisited until all flow crossing tile
+   *                boundaries has been passed on
+   */
+  itkSetStringMacro(ProcessingMode)
+  itkGetStringMacro(ProcessingMode)
+
+  /*! Sets the number of image rows per tile (TILED mode only) */
+  itkSetMacro(TileSize, long)
+  itkGetMacro(TileSize, long)
+
 
 protected:
     FlowAccumulationFilter();
     virtual ~FlowAccumulationFilter();
 
     virtual void EnlargeOutputRequestedRegion(itk::DataObject *output);
+    virtual void GenerateInputRequestedRegion();
     virtual void GenerateData(void);
 
+    // ----------------------------------------------------------------
+    //  dependency ordered routing (TOPOLOGICAL & TILED mode)
+
+    typedef enum
+    {
+        FLOW_ADD = 0,       // accumulation: adds the value
+        FLOW_ADD_UNROUNDED, // accumulation: adds the value without rounding
+                            // it to the output pixel type first (s. TFlowAcc)
+        FLOW_MAX,           // flow length: keeps the maximum value
+        FLOW_SET            // assigns the value (nodata)
+    } FlowTransferType;
+
+    /*! A value passed on to a cell by the donor cell src; srcKey
+     *  and src determine the donor's position in the SORTED routing
+     *  order, i.e. the order in which a cell's inflow is summed up
+     */
+    struct FlowTransfer
+    {
+        long long idx;
+        double value;
+        int type;
+        long long src;
+        SortKeyType srcKey;
+    };
+
+    /*! The inflow of a cell which is still waiting for
+     *  some of its donors (a cell has got 8 donors at most) */
+    struct PendingFlow
+    {
+        FlowTransfer t[7];
+        int n;
+    };
+
+    /*! A band of image rows [row0, row1) routed as one unit */
+    struct FlowBand
+    {
+        long row0;
+        long row1;
+        bool bSeeded;
+        // cells ready to be routed
+        std::vector<long long> queue;
+        // flow passed on to the band above (0) and below (1)
+        // during even and odd rounds
+        std::vector<FlowTransfer> outbox[2][2];
+        // donor cells of the boundary rows of the band above (0) and below (1)
+        std::vector<long long> crossDonors[2];
+        // inflow of the band's cells which aren't ready yet
+        std::unordered_map<long long, PendingFlow> pending;
+        // flow to cells which precede the donor in the SORTED routing
+        // order, i.e. which is applied after routing
+        std::vector<FlowTransfer> terminal;
+        long long numRouted;
+    };
+
+    /*! The DEM and weight rows [row0, row1) available for routing */
+    struct FlowDemView
+    {
+        const InputImagePixelType* dem;
+        const InputImagePixelType* weights;
+        long row0;
+        long row1;
+    };
+
+    struct FlowThreadStruct
+    {
+        FlowAccumulationFilter* Filter;
+        int phase;
+        int round;
+    };
+
+    void DependencyFlowAcc(InputImageType* pInImg,
+                           InputImageType* pWeightImg,
+                           OutputImageType* pOutImg);
+    void TiledFlowAcc(InputImageType* pInImg,
+                      InputImageType* pWeightImg,
+                      OutputImageType* pOutImg);
+
+    static ITK_THREAD_RETURN_TYPE RouteBandsFromThreader(void* arg);
+
+    /*! Counts the donors of the band's cells */
+    void countBandDonors(FlowBand& band, const FlowDemView& view);
+
+    /*! Routes all cells of the band which are ready to be routed,
+     *  after the flow passed on by the neighbouring bands during the
+     *  previous round has been added
+     */
+    void routeBand(int b, const FlowDemView& view, int inParity, int outParity);
+
+    void routeCell(FlowBand& band, const FlowDemView& view,
+                   const long long& idx, const int& outParity);
+
+    /*! Passes the flow on to a cell of the band; the cell's inflow is
+     *  summed up in routing order once all of its donors have been
+     *  routed, and the cell is queued for routing
+     */
+    void deliverTransfer(FlowBand& band, const FlowTransfer& t);
+
+    /*! Determines the cells receiving flow from the cell at
+     *  (colx, rowx) according to the selected algorithm; returns
+     *  the number of receivers; rfrac is either the flow fraction
+     *  or the distance to the receiver (flow length); nodataIdx is
+     *  set to a nodata neighbour, which blocks routing (Dinf)
+     */
+    int getReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+                     long long* ridx, double* rfrac, double* rz, long long& nodataIdx);
+    int getDinfReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+                         long long* ridx, double* rfrac, double* rz, long long& nodataIdx);
+    int getMFDReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+                        long long* ridx, double* rfrac, double* rz, bool bHolmgren);
+
+    void loadBandView(const FlowBand& band, InputImageType* img,
+                      std::vector<InputImagePixelType>& buf);
+    void applyTransfer(const FlowTransfer& t);
+    void applyTerminalTransfers();
+
+    inline double viewValue(const InputImagePixelType* buf, const FlowDemView& view,
+                            const long long& idx) const
+    {
+        return static_cast<double>(buf[idx - static_cast<long long>(view.row0) * m_NumCols]);
+    }
+
+    /*! The sort key of the cell in SORTED mode (s. sortCells) */
+    inline SortKeyType routingKey(const FlowDemView& view, const long long& idx) const
+    {
+        const SortKeyType key = RadixSortKey<InputImagePixelType>::Get(
+                    view.dem[idx - static_cast<long long>(view.row0) * m_NumCols]);
+        return m_bRouteUp ? key : static_cast<SortKeyType>(~key);
+    }
+
+    /*! Whether a cell with key akey and index a is routed before
+     *  the cell with key bkey and index b in SORTED mode, i.e. in
+     *  order of height and, for cells of equal height, in row-major order
+     */
+    static inline bool routedBefore(const SortKeyType& akey, const long long& a,
+                                    const SortKeyType& bkey, const long long& b)
+    {
+        return akey < bkey || (akey == bkey && a < b);
+    }
+
+    static inline bool transferBefore(const FlowTransfer& a, const FlowTransfer& b)
+    {
+        return routedBefore(a.srcKey, a.src, b.srcKey, b.src);
+    }
+
+    /*! orders terminal transfers by receiver and donor */
+    static inline bool terminalBefore(const FlowTransfer& a, const FlowTransfer& b)
+    {
+        return a.idx < b.idx || (a.idx == b.idx && transferBefore(a, b));
+    }
+
+    /*!
+     * \brief Routes the cells in order of height (SORTED mode)
+     */
+    template <class TIndex>
+    void SortedFlowAcc(InputImagePixelType* ibuf,
+                       InputImagePixelType* wbuf,
+                       OutputImagePixelType* obuf,
+                       const double xps, const double yps,
+                       const long ncols, const long nrows);
+
     /*!
      * \brief Flow accumulation according to Tarboton 1997
+     * \param order linear indices of the cells in routing order
      */
-    void TFlowAcc(HeightList* phlSort,
+    template <class TIndex>
+    void TFlowAcc(const TIndex* order,
                   InputImagePixelType* ibuf,
                   InputImagePixelType* wbuf,
                   OutputImagePixelType* obuf,
@@ -135,7 +321,8 @@ protected:
     /*!
      * \brief Flow accumulation according to Quinn et al. 1991
      */
-    void QFlowAcc(HeightList *phlSort,
+    template <class TIndex>
+    void QFlowAcc(const TIndex* order,
                   InputImagePixelType *ibuf,
                   InputImagePixelType* wbuf,
                   OutputImagePixelType *obuf,
@@ -148,7 +335,8 @@ protected:
      *          for cell i: fi = tan(beta)_i^h / sum_i(tan(beta)_i^h)
      *
      */
-    void HFlowAcc(HeightList *phlSort,
+    template <class TIndex>
+    void HFlowAcc(const TIndex* order,
                   InputImagePixelType *ibuf,
                   InputImagePixelType* wbuf,
                   OutputImagePixelType *obuf,
@@ -156,17 +344,18 @@ protected:
                   const long ncols, const long nrows, long &pixelcounter);
 
     /*!
-     * \brief sortHeightList sorts the input DEM according to descending height
-     *        while keeping track of the original position of each pixel; the
-     *        sortHeightListAsc variant of this method sorts the height list
-     *        according to ascending height values.
+     * \brief sortCells computes the order (permutation of linear indices)
+     *        of the DEM cells according to descending height or ascending
+     *        height (bAscending); cells of equal height keep their
+     *        relative (row-major) order
      */
-    void sortHeightList(HeightList* SortHeight, long links, long rechts, long& counter);
-    void sortHeightListAsc(HeightList *SortHeight, long links, long rechts, long &counter);
+    template <class TIndex>
+    void sortCells(const InputImagePixelType* ibuf, const long long& numpix,
+                   bool bAscending, std::vector<TIndex>& order);
 
-    void getNeighbourIndex(const int& neigpos, const int& colx, const int& rowx, int& nidx);
+    void getNeighbourIndex(const int& neigpos, const long& colx, const long& rowx, long long& nidx);
     void getNeighbourDistance(const int& neigpos, double& ndist);
-    int convert2DTo1DIdx(const int& col, const int& row);
+    long long convert2DTo1DIdx(const long& col, const long& row);
 
 private:
     double m_xdist;
@@ -184,13 +373,27 @@ private:
 
     std::string m_FlowAccAlgorithm;
 
+    std::string m_ProcessingMode;
+    long m_TileSize;
+
+    // state of the dependency ordered routing
+    int m_AlgorithmId;
+    bool m_bRouteUp;
+    double m_xps;
+    double m_yps;
+    long long m_NeighbourOffset[8];
+    std::vector<FlowBand> m_FlowBands;
+    std::vector<unsigned char> m_Donors;
+    OutputImagePixelType* m_OutBuf;
+    FlowDemView m_FullView;
+
 };
 
 template <class TInputImage, class TOutputImage>
-inline int FlowAccumulationFilter<TInputImage, TOutputImage>
-::convert2DTo1DIdx(const int &col, const int &row)
+inline long long FlowAccumulationFilter<TInputImage, TOutputImage>
+::convert2DTo1DIdx(const long &col, const long &row)
 {
-    return (row * m_NumCols + col);
+    return (static_cast<long long>(row) * m_NumCols + col);
 }
 
 template <class TInputImage, class TOutputImage>
@@ -231,34 +434,34 @@ inline void FlowAccumulationFilter<TInputImage, TOutputImage>
 
 template <class TInputImage, class TOutputImage>
 inline void FlowAccumulationFilter<TInputImage, TOutputImage>
-::getNeighbourIndex(const int& neigpos, const int& colx, const int& rowx, int& nidx)
+::getNeighbourIndex(const int& neigpos, const long& colx, const long& rowx, long long& nidx)
 {
     nidx = 0;
     switch(neigpos)
     {
     case 0 : //Submatrix-Zelle mit der Index-Nummer Null!
-        nidx = (rowx-1) * m_NumCols + (colx-1);
+        nidx = static_cast<long long>(rowx-1) * m_NumCols + (colx-1);
         break;
     case 1 :
-        nidx = (rowx-1) * m_NumCols + colx;
+        nidx = static_cast<long long>(rowx-1) * m_NumCols + colx;
         break;
     case 2 :
-        nidx = (rowx-1) * m_NumCols + (colx+1);
+        nidx = static_cast<long long>(rowx-1) * m_NumCols + (colx+1);
         break;
     case 3 :
-        nidx = rowx * m_NumCols + (colx+1);
+        nidx = static_cast<long long>(rowx) * m_NumCols + (colx+1);
         break;
     case 4 :
-        nidx = (rowx+1) * m_NumCols + (colx+1);
+        nidx = static_cast<long long>(rowx+1) * m_NumCols + (colx+1);
         break;
     case 5 :
-        nidx = (rowx+1) * m_NumCols + colx;
+        nidx = static_cast<long long>(rowx+1) * m_NumCols + colx;
         break;
     case 6 :
-        nidx = (rowx+1) * m_NumCols + (colx-1);
+        nidx = static_cast<long long>(rowx+1) * m_NumCols + (colx-1);
         break;
     case 7 :
-        nidx = rowx * m_NumCols + (colx-1);
+        nidx = static_cast<long long>(rowx) * m_NumCols + (colx-1);
         break;
     default :
         break;
@@ -266,112 +469,6 @@ inline void FlowAccumulationFilter<TInputImage, TOutputImage>
 }
 
 
-template <class TInputImage, class TOutputImage>
-inline void FlowAccumulationFilter<TInputImage, TOutputImage>
-::sortHeightListAsc(HeightList *SortHeight, long links, long rechts, long &counter)
-{
-    long li, re;
-    long col, row, mcol, mrow;
-    InputImagePixelType h, mh;
-    long mitte;
-
-    li = links;
-    re = rechts;
-    mitte = (links + rechts) / (int) 2;   //bewusste IntegerDivision --> ganzzahliger Index mitte
-
-    mh = SortHeight[mitte].z;
-    mcol = SortHeight[mitte].col;
-    mrow = SortHeight[mitte].row;
-
-    do
-    {
-        while (SortHeight[li].z < mh)
-        {
-            ++li;
-        }
-        while (SortHeight[re].z > mh)
-        {
-            --re;
-        }
-        if (li <= re)
-        {
-            h	= SortHeight[li].z;
-            col = SortHeight[li].col;
-            row = SortHeight[li].row;
-
-            SortHeight[li].z	= SortHeight[re].z;
-            SortHeight[li].col	= SortHeight[re].col;
-            SortHeight[li].row	= SortHeight[re].row;
-
-            SortHeight[re].z	= h;
-            SortHeight[re].col	= col;
-            SortHeight[re].row	= row;
-
-            ++li;
-            --re;
-            ++counter;
-        }
-
-    } while (li <= re);
-    this->UpdateProgress((float)counter/(float)m_numpixel);
-    if (links < re)  this->sortHeightListAsc(SortHeight, links, re, counter);
-    if (rechts > li) this->sortHeightListAsc(SortHeight, li, rechts, counter);
-}
-
-
-template <class TInputImage, class TOutputImage>
-inline void FlowAccumulationFilter<TInputImage, TOutputImage>
-::sortHeightList(HeightList *SortHeight, long links, long rechts, long &counter)
-{
-    long li, re;
-    long col, row, mcol, mrow;
-    InputImagePixelType h, mh;
-    long mitte;
-
-    li = links;
-    re = rechts;
-    mitte = (links + rechts) / (int) 2;   //bewusste IntegerDivision --> ganzzahliger Index mitte
-
-    mh = SortHeight[mitte].z;
-    mcol = SortHeight[mitte].col;
-    mrow = SortHeight[mitte].row;
-
-    do
-    {
-        while (SortHeight[li].z > mh)
-        {
-            li++;
-        }
-        while (SortHeight[re].z < mh)
-        {
-            re--;
-        }
-        if (li <= re)
-        {
-            h	= SortHeight[li].z;
-            col = SortHeight[li].col;
-            row = SortHeight[li].row;
-
-            SortHeight[li].z	= SortHeight[re].z;
-            SortHeight[li].col	= SortHeight[re].col;
-            SortHeight[li].row	= SortHeight[re].row;
-
-            SortHeight[re].z	= h;
-            SortHeight[re].col	= col;
-            SortHeight[re].row	= row;
-
-            li++;
-            re--;
-            ++counter;
-        }
-
-    } while (li <= re);
-    this->UpdateProgress((float)counter/(float)m_numpixel);
-    if (links < re)  this->sortHeightList(SortHeight, links, re, counter);
-    if (rechts > li) this->sortHeightList(SortHeight, li, rechts, counter);
-}
-
-
 } // end namespace
 
 //#include "otbFlowAccumulationFilter_ExplicitInst.h"
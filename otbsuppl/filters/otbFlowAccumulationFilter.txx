@@ -26,9 +26,11 @@
 #define __otbFlowAccumulationFilter_txx
 
 #include <queue>
+#include <algorithm>
 
 #include "otbFlowAccumulationFilter.h"
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkNeighborhoodIterator.h"
@@ -40,7 +42,10 @@ template <class TInputImage, class TOutputImage>
 FlowAccumulationFilter<TInputImage, TOutputImage>
 ::FlowAccumulationFilter()
     : m_xdist(1), m_ydist(1), m_nodata(0), m_FlowExponent(4),
-      m_bFlowLength(false)
+      m_bFlowLength(false), m_bFlowLengthUp(false),
+      m_ProcessingMode("SORTED"), m_TileSize(1024),
+      m_AlgorithmId(0), m_bRouteUp(false), m_xps(1), m_yps(1),
+      m_OutBuf(nullptr)
 {
     this->SetNumberOfRequiredInputs(1);
     this->SetNumberOfRequiredOutputs(1);
@@ -64,9 +69,37 @@ void FlowAccumulationFilter< TInputImage, TOutputImage >
     }
 }
 
+template< typename TInputImage, typename TOutputImage >
+void FlowAccumulationFilter< TInputImage, TOutputImage >
+::GenerateInputRequestedRegion()
+{
+    Superclass::GenerateInputRequestedRegion();
+
+    // in TILED mode, the inputs are requested tile by tile
+    // during GenerateData, so we start off with the first tile
+    if (m_ProcessingMode.compare("TILED") == 0)
+    {
+        itk::ProcessObject::DataObjectPointerArray inputs = this->GetInputs();
+        for (int i=0; i < inputs.size(); ++i)
+        {
+            InputImageType* img = dynamic_cast<InputImageType*>(inputs[i].GetPointer());
+            if (img == nullptr)
+            {
+                continue;
+            }
+
+            InputImageRegionType region = img->GetLargestPossibleRegion();
+            region.SetSize(1, std::min(static_cast<long>(region.GetSize(1)),
+                                       std::max(m_TileSize, 1L) + 1));
+            img->SetRequestedRegion(region);
+        }
+    }
+}
+
 template <class TInputImage, class TOutputImage>
+template <class TIndex>
 void FlowAccumulationFilter<TInputImage, TOutputImage>
-::QFlowAcc(HeightList *phlSort, InputImagePixelType *ibuf, InputImagePixelType *wbuf, OutputImagePixelType *obuf,
+::QFlowAcc(const TIndex* order, InputImagePixelType *ibuf, InputImagePixelType *wbuf, OutputImagePixelType *obuf,
            const double xps, const double yps, const long ncols, const long nrows, long &pixelcounter)
 {
     //HQFlowAcc calculates the flow accumulation based on a surface elevation grid
@@ -80,8 +113,8 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                                 //the processing cell (central cell)
     long col, row;		//loop variables indicating the current position in the grid
                                 //by column (col) and row
-    long colx;			//source (original) column of a "sorted" elevation value from the HeightList
-    long rowx;			//source (original) row of a "sorted" elevation value from the HeightList
+    long colx;			//source (original) column of a "sorted" elevation value
+    long rowx;			//source (original) row of a "sorted" elevation value
     double zx;					//elevation of the processing cell
     double zaehler[8];	//the numerator values for the moving window according to the used formula
     double hoehe[8];	//the elevation data of the moving window (see blow)
@@ -100,19 +133,19 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     {
         for (col = 0; col < ncols; col++)
         {
-            const int itidx = this->convert2DTo1DIdx(col, row);
+            const long long itidx = this->convert2DTo1DIdx(col, row);
 
             //assign values to helper variables
-            zx = static_cast<double>(phlSort[itidx].z);
+            const long long zidx = order[itidx];
+            zx = static_cast<double>(ibuf[zidx]);
             if (zx == static_cast<double>(m_nodata))
             {
                     continue;
                     ++pixelcounter;
             }
-            colx = phlSort[itidx].col;
-            rowx = phlSort[itidx].row;
+            colx = static_cast<long>(zidx % ncols);
+            rowx = static_cast<long>(zidx / ncols);
 
-            const int zidx = this->convert2DTo1DIdx(colx, rowx);
             flaccx = static_cast<double>(obuf[zidx]); //ppFlowAcc[rowx][colx]);
 
             //consider only those cells with 8 valid neighbors in order to define the moving window
@@ -123,7 +156,7 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                 // 2. multiply slope with weight factor depending on direction (0.5 cardinal, 0.354 diagonal)
                 //calculate the denominator (i.e. sum of numerators for all lower cells)
                 nenner = 0;
-                int nidx = -1;
+                long long nidx = -1;
                 for (i=0; i < 8; i++)
                 {
                     this->getNeighbourIndex(i, colx, rowx, nidx);
@@ -203,8 +236,9 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
 }
 
 template <class TInputImage, class TOutputImage>
+template <class TIndex>
 void FlowAccumulationFilter<TInputImage, TOutputImage>
-::HFlowAcc(HeightList *phlSort, InputImagePixelType *ibuf, InputImagePixelType *wbuf, OutputImagePixelType *obuf,
+::HFlowAcc(const TIndex* order, InputImagePixelType *ibuf, InputImagePixelType *wbuf, OutputImagePixelType *obuf,
            const double xps, const double yps, const long ncols, const long nrows, long &pixelcounter)
 {
     //calculates the flow accumulation based on a surface elevation grid
@@ -218,8 +252,8 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                                 //the processing cell (central cell)
     long col, row;		//loop variables indicating the current position in the grid
                                 //by column (col) and row
-    long colx;			//source (original) column of a "sorted" elevation value from the HeightList
-    long rowx;			//source (original) row of a "sorted" elevation value from the HeightList
+    long colx;			//source (original) column of a "sorted" elevation value
+    long rowx;			//source (original) row of a "sorted" elevation value
     double zx;					//elevation of the processing cell
     double zaehler[8];	//the numerator values for the moving window according to the used formula
     double hoehe[8];	//the elevation data of the moving window (see blow)
@@ -240,19 +274,19 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     {
         for (col = 0; col < ncols; col++)
         {
-            const int itidx = this->convert2DTo1DIdx(col, row);
+            const long long itidx = this->convert2DTo1DIdx(col, row);
 
             //assign values to helper variables
-            zx = static_cast<double>(phlSort[itidx].z);
+            const long long zidx = order[itidx];
+            zx = static_cast<double>(ibuf[zidx]);
             if (zx == static_cast<double>(m_nodata))
             {
                     continue;
                     ++pixelcounter;
             }
-            colx = phlSort[itidx].col;
-            rowx = phlSort[itidx].row;
+            colx = static_cast<long>(zidx % ncols);
+            rowx = static_cast<long>(zidx / ncols);
 
-            const int zidx = this->convert2DTo1DIdx(colx, rowx);
             flaccx = static_cast<double>(obuf[zidx]); //ppFlowAcc[rowx][colx]);
 
             //consider only those cells with 8 valid neighbors in order to define the moving window
@@ -262,7 +296,7 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                 // 1. calc slope for lower neighboring cells
                 // 2. calculate the denominator (i.e. sum of numerators for all lower cells)
                 nenner = 0;
-                int nidx = -1;
+                long long nidx = -1;
                 for (i=0; i < 8; i++)
                 {
                     this->getNeighbourIndex(i, colx, rowx, nidx);
@@ -354,8 +388,9 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
 
 
 template <class TInputImage, class TOutputImage>
+template <class TIndex>
 void FlowAccumulationFilter<TInputImage, TOutputImage>
-::TFlowAcc(HeightList *phlSort, InputImagePixelType *ibuf,
+::TFlowAcc(const TIndex* order, InputImagePixelType *ibuf,
            InputImagePixelType* wbuf, OutputImagePixelType *obuf,
            const double xps, const double yps, const long ncols, const long nrows, long &pixelcounter)
 {
@@ -381,19 +416,19 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     {
         for (col=0; col < ncols; col++)
         {
-            const int  itidx = this->convert2DTo1DIdx(col, row);
+            const long long itidx = this->convert2DTo1DIdx(col, row);
 
             //ein par Variablen initialisieren
-            zx	 = static_cast<double>(phlSort[itidx].z);
+            const long long zidx = order[itidx];
+            zx	 = static_cast<double>(ibuf[zidx]);
             if (zx == static_cast<double>(m_nodata))
             {
                 ++pixelcounter;
                 continue;
             }
-            colx = phlSort[itidx].col;
-            rowx = phlSort[itidx].row;
+            colx = static_cast<long>(zidx % ncols);
+            rowx = static_cast<long>(zidx / ncols);
 
-            const int zidx = this->convert2DTo1DIdx(colx, rowx);
             fx   = static_cast<double>(obuf[zidx]);
 
             //Berechnung nur für "innere" Pixel durchführen (solche, zu denen eine 3*3 Submatrix
@@ -417,8 +452,8 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                 if (z[6] == nodata) {obuf[(rowx+1) * ncols + (colx-1)] = static_cast<OutputImagePixelType>(nodata); continue;}
                 z[5] = static_cast<double>(ibuf[(rowx+1) * ncols + colx]);
                 if (z[5] == nodata) {obuf[(rowx+1) * ncols + colx] = static_cast<OutputImagePixelType>(nodata); continue;}
-                z[4] = static_cast<double>(ibuf[(rowx+1) * ncols + (colx-1)]);
-                if (z[4] == nodata) {obuf[(rowx+1) * ncols + (colx-1)] = static_cast<OutputImagePixelType>(nodata); continue;}
+                z[4] = static_cast<double>(ibuf[(rowx+1) * ncols + (colx+1)]);
+                if (z[4] == nodata) {obuf[(rowx+1) * ncols + (colx+1)] = static_cast<OutputImagePixelType>(nodata); continue;}
 
                 //Arrays für versch. Facettenwerte füllen
                 e1[0]=z[3];e1[1]=z[1];e1[2]=z[1];e1[3]=z[7];e1[4]=z[7];e1[5]=z[5];e1[6]=z[5];e1[7]=z[3];
@@ -594,7 +629,7 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
                 const double fxp1 = fx * p1;
                 const double fxp2 = fx * p2;
 
-                int n11didx, n21didx;
+                long long n11didx, n21didx;
                 this->getNeighbourIndex(n1idx, colx, rowx, n11didx);
                 double w1val = wbuf == nullptr ? 1.0 : static_cast<double>(wbuf[n11didx]);
 
@@ -663,6 +698,801 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     }
 }
 
+// ---------------------------------------------------------------------
+//  dependency ordered routing
+// ---------------------------------------------------------------------
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::DependencyFlowAcc(InputImageType* pInImg, InputImageType* pWeightImg,
+                    OutputImageType* pOutImg)
+{
+    const long long numpix = static_cast<long long>(m_NumCols) * m_NumRows;
+
+    m_FullView.dem = pInImg->GetBufferPointer();
+    m_FullView.weights = pWeightImg != nullptr ? pWeightImg->GetBufferPointer() : nullptr;
+    m_FullView.row0 = 0;
+    m_FullView.row1 = m_NumRows;
+
+    // split the image into one band of rows per thread
+    const long nbands = std::max(1L, std::min(static_cast<long>(this->GetNumberOfThreads()),
+                                              m_NumRows));
+    const long bandrows = m_NumRows / nbands;
+    const long rest = m_NumRows % nbands;
+
+    m_FlowBands.clear();
+    m_FlowBands.resize(nbands);
+    long row = 0;
+    for (long b=0; b < nbands; ++b)
+    {
+        m_FlowBands[b].row0 = row;
+        row += bandrows + (b < rest ? 1 : 0);
+        m_FlowBands[b].row1 = row;
+    }
+
+    m_Donors.assign(numpix, 0);
+
+    FlowThreadStruct str;
+    str.Filter = this;
+    str.phase = 0;
+    str.round = 0;
+
+    this->GetMultiThreader()->SetNumberOfThreads(nbands);
+    this->GetMultiThreader()->SetSingleMethod(this->RouteBandsFromThreader, &str);
+
+    // count the donors of each cell
+    this->GetMultiThreader()->SingleMethodExecute();
+    this->UpdateProgress(0.1);
+
+    // route the bands; flow passed on across band boundaries
+    // during one round is picked up during the next round
+    str.phase = 1;
+    bool bPending = true;
+    for (str.round = 0; bPending && !this->GetAbortGenerateData(); ++str.round)
+    {
+        this->GetMultiThreader()->SingleMethodExecute();
+
+        const int parity = str.round % 2;
+        long long numRouted = 0;
+        bPending = false;
+        for (long b=0; b < nbands; ++b)
+        {
+            numRouted += m_FlowBands[b].numRouted;
+            if (    !m_FlowBands[b].outbox[parity][0].empty()
+                 || !m_FlowBands[b].outbox[parity][1].empty()
+               )
+            {
+                bPending = true;
+            }
+        }
+        this->UpdateProgress(0.1 + 0.9 * (numRouted / static_cast<double>(numpix)));
+    }
+
+    this->applyTerminalTransfers();
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::TiledFlowAcc(InputImageType* pInImg, InputImageType* pWeightImg,
+               OutputImageType* pOutImg)
+{
+    const long long numpix = static_cast<long long>(m_NumCols) * m_NumRows;
+    const long tilerows = std::max(1L, m_TileSize);
+    const long nbands = (m_NumRows + tilerows - 1) / tilerows;
+
+    m_FlowBands.clear();
+    m_FlowBands.resize(nbands);
+    for (long b=0; b < nbands; ++b)
+    {
+        m_FlowBands[b].row0 = b * tilerows;
+        m_FlowBands[b].row1 = std::min(m_NumRows, (b+1) * tilerows);
+    }
+
+    m_Donors.assign(numpix, 0);
+
+    std::vector<InputImagePixelType> demBuf;
+    std::vector<InputImagePixelType> weightBuf;
+    FlowDemView view;
+    view.weights = nullptr;
+
+    // count the donors of each cell, tile by tile
+    for (long b=0; b < nbands && !this->GetAbortGenerateData(); ++b)
+    {
+        this->loadBandView(m_FlowBands[b], pInImg, demBuf);
+        if (pWeightImg != nullptr)
+        {
+            this->loadBandView(m_FlowBands[b], pWeightImg, weightBuf);
+            view.weights = &weightBuf[0];
+        }
+        view.dem = &demBuf[0];
+        view.row0 = std::max(0L, m_FlowBands[b].row0 - 1);
+        view.row1 = std::min(m_NumRows, m_FlowBands[b].row1 + 1);
+
+        this->countBandDonors(m_FlowBands[b], view);
+        this->UpdateProgress(0.1 * (b+1) / static_cast<double>(nbands));
+    }
+
+    // route the tiles, sweeping alternately down and up the image,
+    // until no more flow is passed on across tile boundaries; a tile
+    // is only (re-)loaded, if it hasn't been routed yet or has got
+    // flow waiting to be picked up
+    bool bPending = true;
+    for (int sweep=0; bPending && !this->GetAbortGenerateData(); ++sweep)
+    {
+        for (long i=0; i < nbands; ++i)
+        {
+            const long b = sweep % 2 == 0 ? i : nbands - 1 - i;
+            const bool bInbox =    (b > 0 && !m_FlowBands[b-1].outbox[0][1].empty())
+                                || (b+1 < nbands && !m_FlowBands[b+1].outbox[0][0].empty());
+            if (m_FlowBands[b].bSeeded && !bInbox)
+            {
+                continue;
+            }
+
+            this->loadBandView(m_FlowBands[b], pInImg, demBuf);
+            if (pWeightImg != nullptr)
+            {
+                this->loadBandView(m_FlowBands[b], pWeightImg, weightBuf);
+                view.weights = &weightBuf[0];
+            }
+            view.dem = &demBuf[0];
+            view.row0 = std::max(0L, m_FlowBands[b].row0 - 1);
+            view.row1 = std::min(m_NumRows, m_FlowBands[b].row1 + 1);
+
+            this->routeBand(b, view, 0, 0);
+
+            long long numRouted = 0;
+            for (long n=0; n < nbands; ++n)
+            {
+                numRouted += m_FlowBands[n].numRouted;
+            }
+            this->UpdateProgress(0.1 + 0.9 * (numRouted / static_cast<double>(numpix)));
+        }
+
+        bPending = false;
+        for (long b=0; b < nbands; ++b)
+        {
+            if (    !m_FlowBands[b].outbox[0][0].empty()
+                 || !m_FlowBands[b].outbox[0][1].empty()
+               )
+            {
+                bPending = true;
+                break;
+            }
+        }
+    }
+
+    this->applyTerminalTransfers();
+}
+
+template <class TInputImage, class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+FlowAccumulationFilter<TInputImage, TOutputImage>
+::RouteBandsFromThreader(void* arg)
+{
+    itk::MultiThreader::ThreadInfoStruct* info =
+            static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    FlowThreadStruct* str = static_cast<FlowThreadStruct*>(info->UserData);
+    FlowAccumulationFilter* filter = str->Filter;
+
+    const int nbands = filter->m_FlowBands.size();
+    for (int b = info->ThreadID; b < nbands; b += info->NumberOfThreads)
+    {
+        if (str->phase == 0)
+        {
+            filter->countBandDonors(filter->m_FlowBands[b], filter->m_FullView);
+        }
+        else
+        {
+            // pick up what's been passed on during the previous round
+            filter->routeBand(b, filter->m_FullView, (str->round + 1) % 2, str->round % 2);
+        }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::countBandDonors(FlowBand& band, const FlowDemView& view)
+{
+    band.bSeeded = false;
+    band.numRouted = 0;
+    band.queue.clear();
+    band.pending.clear();
+    band.crossDonors[0].clear();
+    band.crossDonors[1].clear();
+
+    const long long bandBeg = static_cast<long long>(band.row0) * m_NumCols;
+    const long long bandEnd = static_cast<long long>(band.row1) * m_NumCols;
+    const double nodata = static_cast<double>(m_nodata);
+
+    long long ridx[8];
+    double rfrac[8];
+    double rz[8];
+
+    for (long row = std::max(1L, band.row0); row < std::min(m_NumRows-1, band.row1); ++row)
+    {
+        for (long col=1; col < m_NumCols-1; ++col)
+        {
+            const long long idx = static_cast<long long>(row) * m_NumCols + col;
+            const double zx = this->viewValue(view.dem, view, idx);
+            if (zx == nodata)
+            {
+                continue;
+            }
+
+            // only receivers routed after the cell in SORTED mode wait
+            // for its flow, which keeps the dependency graph acyclic
+            const SortKeyType key = this->routingKey(view, idx);
+            long long nodataIdx = -1;
+            const int nrec = this->getReceivers(view, col, row, ridx, rfrac, rz, nodataIdx);
+            for (int k=0; k < nrec; ++k)
+            {
+                if (!routedBefore(key, idx, this->routingKey(view, ridx[k]), ridx[k]))
+                {
+                    continue;
+                }
+
+                if (ridx[k] >= bandBeg && ridx[k] < bandEnd)
+                {
+                    ++m_Donors[ridx[k]];
+                }
+                else
+                {
+                    band.crossDonors[ridx[k] < bandBeg ? 0 : 1].push_back(ridx[k]);
+                }
+            }
+        }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::routeBand(int b, const FlowDemView& view, int inParity, int outParity)
+{
+    FlowBand& band = m_FlowBands[b];
+    const int nbands = m_FlowBands.size();
+
+    if (!band.bSeeded)
+    {
+        // add the donors located in the neighbouring bands
+        // and queue all cells without any donors
+        if (b > 0)
+        {
+            std::vector<long long>& cross = m_FlowBands[b-1].crossDonors[1];
+            for (size_t i=0; i < cross.size(); ++i)
+            {
+                ++m_Donors[cross[i]];
+            }
+            std::vector<long long>().swap(cross);
+        }
+
+        if (b+1 < nbands)
+        {
+            std::vector<long long>& cross = m_FlowBands[b+1].crossDonors[0];
+            for (size_t i=0; i < cross.size(); ++i)
+            {
+                ++m_Donors[cross[i]];
+            }
+            std::vector<long long>().swap(cross);
+        }
+
+        const long long bandEnd = static_cast<long long>(band.row1) * m_NumCols;
+        for (long long idx = static_cast<long long>(band.row0) * m_NumCols; idx < bandEnd; ++idx)
+        {
+            if (m_Donors[idx] == 0)
+            {
+                band.queue.push_back(idx);
+            }
+        }
+        band.bSeeded = true;
+    }
+
+    // pick up the flow passed on by the neighbouring bands
+    for (int n=0; n < 2; ++n)
+    {
+        const int nb = n == 0 ? b-1 : b+1;
+        if (nb < 0 || nb >= nbands)
+        {
+            continue;
+        }
+
+        std::vector<FlowTransfer>& inbox = m_FlowBands[nb].outbox[inParity][n == 0 ? 1 : 0];
+        for (size_t i=0; i < inbox.size(); ++i)
+        {
+            this->deliverTransfer(band, inbox[i]);
+        }
+        inbox.clear();
+    }
+
+    while (!band.queue.empty())
+    {
+        const long long idx = band.queue.back();
+        band.queue.pop_back();
+        this->routeCell(band, view, idx, outParity);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::routeCell(FlowBand& band, const FlowDemView& view,
+            const long long& idx, const int& outParity)
+{
+    ++band.numRouted;
+
+    const long colx = static_cast<long>(idx % m_NumCols);
+    const long rowx = static_cast<long>(idx / m_NumCols);
+
+    // as with the sorted routing, only cells with 8 neighbours
+    // and valid elevation pass on any flow
+    if (    colx <= 0 || colx >= m_NumCols-1
+         || rowx <= 0 || rowx >= m_NumRows-1
+       )
+    {
+        return;
+    }
+
+    const double zx = this->viewValue(view.dem, view, idx);
+    if (zx == static_cast<double>(m_nodata))
+    {
+        return;
+    }
+
+    long long ridx[8];
+    double rfrac[8];
+    double rz[8];
+    long long nodataIdx = -1;
+    const int nrec = this->getReceivers(view, colx, rowx, ridx, rfrac, rz, nodataIdx);
+    if (nodataIdx >= 0)
+    {
+        FlowTransfer t = {nodataIdx, static_cast<double>(m_nodata), FLOW_SET, idx, 0};
+        band.terminal.push_back(t);
+        return;
+    }
+
+    const SortKeyType key = this->routingKey(view, idx);
+    const double fx = static_cast<double>(m_OutBuf[idx]);
+    const long long bandBeg = static_cast<long long>(band.row0) * m_NumCols;
+    const long long bandEnd = static_cast<long long>(band.row1) * m_NumCols;
+
+    for (int k=0; k < nrec; ++k)
+    {
+        const double w = view.weights == nullptr ? 1.0 : this->viewValue(view.weights, view, ridx[k]);
+
+        FlowTransfer t;
+        t.idx = ridx[k];
+        t.src = idx;
+        t.srcKey = key;
+        if (m_bFlowLength)
+        {
+            t.value = rfrac[k] * w + fx;
+            t.type = FLOW_MAX;
+        }
+        else
+        {
+            t.value = (rfrac[k] * fx) * w;
+            // TFlowAcc doesn't round the flow passed on
+            // to a single (cardinal or diagonal) receiver
+            t.type = m_AlgorithmId == 0 && nrec == 1 ? FLOW_ADD_UNROUNDED : FLOW_ADD;
+        }
+
+        // receivers routed before this cell in SORTED mode (i.e. higher
+        // cells or, on flats, preceding cells) have already passed on their
+        // flow, so they just keep what they get and aren't waiting for it
+        if (!routedBefore(key, idx, this->routingKey(view, t.idx), t.idx))
+        {
+            band.terminal.push_back(t);
+        }
+        else if (t.idx >= bandBeg && t.idx < bandEnd)
+        {
+            this->deliverTransfer(band, t);
+        }
+        else
+        {
+            band.outbox[outParity][t.idx < bandBeg ? 0 : 1].push_back(t);
+        }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::deliverTransfer(FlowBand& band, const FlowTransfer& t)
+{
+    // wait for the remaining donors, if any
+    if (--m_Donors[t.idx] > 0)
+    {
+        // (value initialised, i.e. n == 0, when inserted)
+        PendingFlow& pf = band.pending[t.idx];
+        pf.t[pf.n++] = t;
+        return;
+    }
+
+    // the cell's ready, so we add up its inflow in
+    // the same order as the SORTED routing does
+    typename std::unordered_map<long long, PendingFlow>::iterator it = band.pending.find(t.idx);
+    if (it == band.pending.end())
+    {
+        this->applyTransfer(t);
+    }
+    else
+    {
+        PendingFlow& pf = it->second;
+        pf.t[pf.n] = t;
+        std::sort(pf.t, pf.t + pf.n + 1, transferBefore);
+        for (int i=0; i <= pf.n; ++i)
+        {
+            this->applyTransfer(pf.t[i]);
+        }
+        band.pending.erase(it);
+    }
+
+    band.queue.push_back(t.idx);
+}
+
+template <class TInputImage, class TOutputImage>
+int FlowAccumulationFilter<TInputImage, TOutputImage>
+::getReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+               long long* ridx, double* rfrac, double* rz, long long& nodataIdx)
+{
+    nodataIdx = -1;
+    switch(m_AlgorithmId)
+    {
+    case 0:
+        return this->getDinfReceivers(view, colx, rowx, ridx, rfrac, rz, nodataIdx);
+    case 1:
+        return this->getMFDReceivers(view, colx, rowx, ridx, rfrac, rz, false);
+    case 2:
+        return this->getMFDReceivers(view, colx, rowx, ridx, rfrac, rz, true);
+    default:
+        break;
+    }
+    return 0;
+}
+
+template <class TInputImage, class TOutputImage>
+int FlowAccumulationFilter<TInputImage, TOutputImage>
+::getMFDReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+                  long long* ridx, double* rfrac, double* rz, bool bHolmgren)
+{
+    // s. QFlowAcc and HFlowAcc
+    const long long cidx = static_cast<long long>(rowx) * m_NumCols + colx;
+    const double zx = this->viewValue(view.dem, view, cidx);
+    const double nodata = static_cast<double>(m_nodata);
+    const double diags = sqrt(m_xps*m_xps + m_yps*m_yps);
+
+    int nrec = 0;
+    double nenner = 0;
+    for (int i=0; i < 8; ++i)
+    {
+        const long long nidx = cidx + m_NeighbourOffset[i];
+        const double hoehe = this->viewValue(view.dem, view, nidx);
+        if (hoehe == nodata)
+        {
+            continue;
+        }
+
+        if (m_bFlowLength)
+        {
+            if ((m_bRouteUp ? hoehe - zx : zx - hoehe) > 0)
+            {
+                ridx[nrec] = nidx;
+                this->getNeighbourDistance(i, rfrac[nrec]);
+                rz[nrec] = hoehe;
+                ++nrec;
+            }
+            continue;
+        }
+
+        if ((zx - hoehe) <= 0)
+        {
+            continue;
+        }
+
+        double zaehler = 0;
+        if (bHolmgren)
+        {
+            if ((i % 2) == 0)
+            {
+                zaehler = pow(((zx - hoehe) / diags), m_FlowExponent);
+            }
+            else if (i == 7 || i == 3)
+            {
+                zaehler = pow(((zx - hoehe) / m_xps), m_FlowExponent);
+            }
+            else
+            {
+                zaehler = pow(((zx - hoehe) / m_yps), m_FlowExponent);
+            }
+
+            if (std::isnan(zaehler) || std::isinf(zaehler))
+            {
+                continue;
+            }
+
+            // like HFlowAcc, we count any valid numerator towards
+            // the denominator, but pass on flow only for positive ones
+            if (zaehler <= 0)
+            {
+                nenner += zaehler;
+                continue;
+            }
+        }
+        else
+        {
+            if ((i % 2) == 0)
+            {
+                zaehler = ((zx - hoehe) / (m_yps * sqrt(2))) * 0.354 * m_yps;
+            }
+            else if (i == 7 || i == 3)
+            {
+                zaehler = ((zx - hoehe) / m_xps) * 0.5 * m_xps;
+            }
+            else
+            {
+                zaehler = ((zx - hoehe) / m_yps) * 0.5 * m_yps;
+            }
+        }
+
+        ridx[nrec] = nidx;
+        rfrac[nrec] = zaehler;
+        rz[nrec] = hoehe;
+        nenner += zaehler;
+        ++nrec;
+    }
+
+    if (!m_bFlowLength)
+    {
+        if (nenner <= 0)
+        {
+            return 0;
+        }
+
+        for (int k=0; k < nrec; ++k)
+        {
+            rfrac[k] /= nenner;
+        }
+    }
+
+    return nrec;
+}
+
+template <class TInputImage, class TOutputImage>
+int FlowAccumulationFilter<TInputImage, TOutputImage>
+::getDinfReceivers(const FlowDemView& view, const long& colx, const long& rowx,
+                   long long* ridx, double* rfrac, double* rz, long long& nodataIdx)
+{
+    // s. TFlowAcc
+    const double Pi = 3.1415926535897932384626433832795;
+    const double xps = m_xps;
+    const double yps = m_yps;
+    const double nodata = static_cast<double>(m_nodata);
+
+    const long long cidx = static_cast<long long>(rowx) * m_NumCols + colx;
+    const double zx = this->viewValue(view.dem, view, cidx);
+
+    // any nodata neighbour blocks the routing of the cell
+    static const int zorder[8] = {0, 1, 2, 7, 3, 6, 5, 4};
+    double z[8];
+    for (int k=0; k < 8; ++k)
+    {
+        const int i = zorder[k];
+        z[i] = this->viewValue(view.dem, view, cidx + m_NeighbourOffset[i]);
+        if (z[i] == nodata)
+        {
+            nodataIdx = cidx + m_NeighbourOffset[i];
+            return 0;
+        }
+    }
+
+    double r[8], s[8], e1[8], e2[8];
+    static const double ac[8] = {0, 1, 1, 2, 2, 3, 3, 4};
+    static const double af[8] = {1, -1, 1, -1, 1, -1, 1, -1};
+    e1[0]=z[3];e1[1]=z[1];e1[2]=z[1];e1[3]=z[7];e1[4]=z[7];e1[5]=z[5];e1[6]=z[5];e1[7]=z[3];
+    e2[0]=z[2];e2[1]=z[2];e2[2]=z[0];e2[3]=z[0];e2[4]=z[6];e2[5]=z[6];e2[6]=z[4];e2[7]=z[4];
+
+    for (int i=0; i < 8; i++)
+    {
+        const double s1i = (zx - e1[i]) / xps;
+        const double s2i = (e1[i] - e2[i]) / yps;
+        r[i] = atan2(s2i,s1i);
+        if (r[i] < 0)
+        {
+            r[i] = 0;
+            s[i] = s1i;
+        }
+        else if ( r[i] > (atan2(yps,xps)) )
+        {
+            r[i] = atan2(yps,xps);
+            s[i] = (zx - e2[i]) / pow(((yps*yps)+(xps*xps)),0.5);
+        }
+        else
+        {
+            s[i] = pow(((s1i*s1i) + (s2i*s2i)),0.5);
+        }
+    }
+
+    double simax = 0;
+    double simin = 0;
+    int simaxindex = 0;
+    int siminindex = 0;
+    for (int i=0; i < 8; i++)
+    {
+        if (s[i] > simax)
+        {
+            simax = s[i];
+            simaxindex = i;
+        }
+
+        if (s[i] < simin)
+        {
+            simin = s[i];
+            siminindex = i;
+        }
+    }
+
+    const int sidx = m_bRouteUp ? siminindex : simaxindex;
+    const double rx = (af[sidx] * r[sidx]) + (ac[sidx] * (Pi / 2.));
+
+    int n1idx = -1;
+    int n2idx = -1;
+    int cardia = 0; // 0: cardinal/diagonal, 1: car-dia, 2: dia-car
+    double p1 = 0;
+    double p2 = 0;
+
+    if (itk::Math::FloatAlmostEqual(rx, 0.))                    n1idx = 3;
+    else if (itk::Math::FloatAlmostEqual(rx, (Pi/4.)))          n1idx = 2;
+    else if (itk::Math::FloatAlmostEqual(rx, (Pi/2.)))          n1idx = 1;
+    else if (itk::Math::FloatAlmostEqual(rx, ((3*Pi)/4.)))      n1idx = 0;
+    else if (itk::Math::FloatAlmostEqual(rx, Pi))               n1idx = 7;
+    else if (itk::Math::FloatAlmostEqual(rx, ((5*Pi)/4.)))      n1idx = 6;
+    else if (itk::Math::FloatAlmostEqual(rx, ((3*Pi)/2.)))      n1idx = 5;
+    else if (itk::Math::FloatAlmostEqual(rx, ((7*Pi)/4.)))      n1idx = 4;
+    else
+    {
+        const double alpha2 = r[sidx];
+        const double alpha1 = (Pi / 4.) - alpha2;
+        p1 = alpha1 / (double)(alpha1 + alpha2);
+        p2 = alpha2 / (double)(alpha1 + alpha2);
+
+        //allow only positive fractions
+        if (p1 < 0) p1 = 0;
+        if (p2 < 0) p2 = 0;
+
+        // facet sidx drains into the neighbours
+        // n1 and n2 (cardinal first for odd facets)
+        static const int n1[8] = {3, 2, 1, 0, 7, 6, 5, 4};
+        static const int n2[8] = {2, 1, 0, 7, 6, 5, 4, 3};
+        n1idx = n1[sidx];
+        n2idx = n2[sidx];
+        cardia = (sidx % 2) == 0 ? 1 : 2;
+    }
+
+    int nrec = 0;
+    if (m_bFlowLength)
+    {
+        const int nn[2] = {n1idx, n2idx};
+        for (int k=0; k < 2; ++k)
+        {
+            if (    nn[k] != -1
+                 && (m_bRouteUp ? z[nn[k]] - zx : zx - z[nn[k]]) > 0
+               )
+            {
+                ridx[nrec] = cidx + m_NeighbourOffset[nn[k]];
+                this->getNeighbourDistance(nn[k], rfrac[nrec]);
+                rz[nrec] = z[nn[k]];
+                ++nrec;
+            }
+        }
+        return nrec;
+    }
+
+    ridx[0] = cidx + m_NeighbourOffset[n1idx];
+    rz[0] = z[n1idx];
+    if (cardia == 0)
+    {
+        rfrac[0] = 1.0;
+        return 1;
+    }
+
+    ridx[1] = cidx + m_NeighbourOffset[n2idx];
+    rz[1] = z[n2idx];
+    rfrac[0] = cardia == 1 ? p1 : p2;
+    rfrac[1] = cardia == 1 ? p2 : p1;
+
+    return 2;
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::loadBandView(const FlowBand& band, InputImageType* img,
+               std::vector<InputImagePixelType>& buf)
+{
+    // fetch the band's rows plus one row above and below
+    const long row0 = std::max(0L, band.row0 - 1);
+    const long row1 = std::min(m_NumRows, band.row1 + 1);
+
+    InputImageRegionType region = img->GetLargestPossibleRegion();
+    region.SetIndex(1, region.GetIndex(1) + row0);
+    region.SetSize(1, row1 - row0);
+
+    img->SetRequestedRegion(region);
+    img->PropagateRequestedRegion();
+    img->UpdateOutputData();
+
+    buf.resize(region.GetNumberOfPixels());
+    itk::ImageRegionConstIterator<InputImageType> it(img, region);
+    size_t i = 0;
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++i)
+    {
+        buf[i] = it.Get();
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+inline void FlowAccumulationFilter<TInputImage, TOutputImage>
+::applyTransfer(const FlowTransfer& t)
+{
+    switch(t.type)
+    {
+    case FLOW_ADD:
+        m_OutBuf[t.idx] += static_cast<OutputImagePixelType>(t.value);
+        break;
+    case FLOW_ADD_UNROUNDED:
+        m_OutBuf[t.idx] += t.value;
+        break;
+    case FLOW_MAX:
+        if (static_cast<double>(m_OutBuf[t.idx]) < t.value)
+        {
+            m_OutBuf[t.idx] = static_cast<OutputImagePixelType>(t.value);
+        }
+        break;
+    default:
+        m_OutBuf[t.idx] = static_cast<OutputImagePixelType>(t.value);
+        break;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::applyTerminalTransfers()
+{
+    // like the SORTED routing, we add the flow to each
+    // cell in the order in which the donors are routed
+    std::vector<FlowTransfer> terminal;
+    for (size_t b=0; b < m_FlowBands.size(); ++b)
+    {
+        std::vector<FlowTransfer>& bt = m_FlowBands[b].terminal;
+        for (size_t i=0; i < bt.size(); ++i)
+        {
+            if (bt[i].type != FLOW_SET)
+            {
+                terminal.push_back(bt[i]);
+            }
+        }
+    }
+    std::sort(terminal.begin(), terminal.end(), terminalBefore);
+    for (size_t i=0; i < terminal.size(); ++i)
+    {
+        this->applyTransfer(terminal[i]);
+    }
+    std::vector<FlowTransfer>().swap(terminal);
+
+    // nodata assignments go last, since they
+    // override anything else passed on to a cell
+    for (size_t b=0; b < m_FlowBands.size(); ++b)
+    {
+        const std::vector<FlowTransfer>& bt = m_FlowBands[b].terminal;
+        for (size_t i=0; i < bt.size(); ++i)
+        {
+            if (bt[i].type == FLOW_SET)
+            {
+                this->applyTransfer(bt[i]);
+            }
+        }
+    }
+}
+
 template <class TInputImage, class TOutputImage>
 void FlowAccumulationFilter<TInputImage, TOutputImage>
 ::GenerateData(void)
@@ -725,11 +1555,12 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     m_ydist = abs(spacing[1]);
     m_ddist = sqrt(m_xdist * m_xdist + m_ydist * m_ydist);
 
-    // get the number of pixels
-    long numcols = pInImg->GetRequestedRegion().GetSize(0);
-    long numrows = pInImg->GetRequestedRegion().GetSize(1);
+    // get the number of pixels; note: in TILED mode, the input's
+    // requested region covers just the first tile
+    long numcols = pOutImg->GetRequestedRegion().GetSize(0);
+    long numrows = pOutImg->GetRequestedRegion().GetSize(1);
     long numpix = numcols * numrows;
-    m_numpixel = numpix * 2 + (numpix * std::log10(numpix));
+    m_numpixel = numpix * 3;
     m_NumCols = numcols;
     m_NumRows = numrows;
 
@@ -738,48 +1569,117 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
     NMProcDebug(<< "  numcols: " << numcols << ", numrows: " << numrows <<
             ", numpix: " << numpix << std::endl);
 
-    // -----------------------------------------------------------------
-    // read the input dem into height structre
-    HeightList* hlDemSort = new HeightList[numpix];
-    InputImagePixelType* ibuf = pInImg->GetBufferPointer();
-    OutputImagePixelType* obuf = pOutImg->GetBufferPointer();
-    InputImagePixelType* wbuf = nullptr;
-    if (pWeightImg.IsNotNull())
+    if (m_FlowAccAlgorithm.compare("MFDw") == 0 && m_FlowExponent < 1)
     {
-        wbuf = pWeightImg->GetBufferPointer();
+        m_FlowExponent = 1;
     }
 
-    long pixelcounter = 1;
-    long maxpixcount = numpix * 3;
-    for (long row=0; row < numrows; ++row)
+    // -----------------------------------------------------------------
+    // dependency ordered routing
+    if (m_ProcessingMode.compare("SORTED") != 0)
     {
-        for (long col=0; col < numcols; ++col)
+        if (m_FlowAccAlgorithm.compare("Dinf") == 0)
         {
-            const long idx = row * numcols + col;
-            hlDemSort[idx].col = col;
-            hlDemSort[idx].row = row;
-            hlDemSort[idx].z   = ibuf[idx];
-            ++pixelcounter;
+            m_AlgorithmId = 0;
         }
-        this->UpdateProgress((float)pixelcounter/(float)(m_numpixel));
+        else if (m_FlowAccAlgorithm.compare("MFD") == 0)
+        {
+            m_AlgorithmId = 1;
+        }
+        else if (m_FlowAccAlgorithm.compare("MFDw") == 0)
+        {
+            m_AlgorithmId = 2;
+        }
+        else
+        {
+            this->UpdateProgress(1.0);
+            return;
+        }
+
+        m_xps = spacing[0];
+        m_yps = spacing[1];
+        m_bRouteUp = m_bFlowLength && m_bFlowLengthUp;
+        m_OutBuf = pOutImg->GetBufferPointer();
+
+        // linear index offset of each neighbour
+        //		0 1 2
+        //		7 x 3
+        //		6 5 4
+        const long long nc = numcols;
+        m_NeighbourOffset[0] = -nc - 1;
+        m_NeighbourOffset[1] = -nc;
+        m_NeighbourOffset[2] = -nc + 1;
+        m_NeighbourOffset[3] = 1;
+        m_NeighbourOffset[4] = nc + 1;
+        m_NeighbourOffset[5] = nc;
+        m_NeighbourOffset[6] = nc - 1;
+        m_NeighbourOffset[7] = -1;
+
+        if (m_ProcessingMode.compare("TILED") == 0)
+        {
+            NMProcDebug(<< "tiled flowacc ...");
+            this->TiledFlowAcc(pInImg, pWeightImg, pOutImg);
+        }
+        else
+        {
+            NMProcDebug(<< "topological flowacc ...");
+            this->DependencyFlowAcc(pInImg, pWeightImg, pOutImg);
+        }
+
+        m_FlowBands.clear();
+        std::vector<unsigned char>().swap(m_Donors);
+        m_OutBuf = nullptr;
+
+        this->UpdateProgress(1.0);
+        NMProcDebug(<< "Leave FlowAcc::GenerateData" << std::endl);
+        return;
     }
 
     // -----------------------------------------------------------------
-    // read the input dem into height structre
-    // sort the height list
-    //this->UpdateProgress(0.0);
-    NMProcDebug( << "sorting ...");
-    if (m_bFlowLength && m_bFlowLengthUp)
+    // route cells in order of height
+    InputImagePixelType* ibuf = pInImg->GetBufferPointer();
+    OutputImagePixelType* obuf = pOutImg->GetBufferPointer();
+    InputImagePixelType* wbuf = nullptr;
+    if (pWeightImg.IsNotNull())
     {
-        this->sortHeightListAsc(hlDemSort, 0, numpix-1, pixelcounter);
+        wbuf = pWeightImg->GetBufferPointer();
+    }
+
+    // a 32-bit permutation does for images of up to 4 gigapixel
+    if (static_cast<unsigned long long>(numpix) <= 0xffffffffULL)
+    {
+        this->SortedFlowAcc<unsigned int>(ibuf, wbuf, obuf, spacing[0], spacing[1],
+                                          numcols, numrows);
     }
     else
     {
-        this->sortHeightList(hlDemSort, 0, numpix-1, pixelcounter);
+        this->SortedFlowAcc<unsigned long long>(ibuf, wbuf, obuf, spacing[0], spacing[1],
+                                                numcols, numrows);
     }
+
+    this->UpdateProgress(1.0);
+
+    NMProcDebug(<< "Leave FlowAcc::GenerateData" << std::endl);
+}
+
+template <class TInputImage, class TOutputImage>
+template <class TIndex>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::SortedFlowAcc(InputImagePixelType* ibuf, InputImagePixelType* wbuf,
+                OutputImagePixelType* obuf, const double xps, const double yps,
+                const long ncols, const long nrows)
+{
+    const long long numpix = static_cast<long long>(ncols) * nrows;
+
+    // -----------------------------------------------------------------
+    // sort the cells
+    NMProcDebug( << "sorting ...");
+    std::vector<TIndex> order;
+    this->sortCells(ibuf, numpix, m_bFlowLength && m_bFlowLengthUp, order);
+
     this->UpdateProgress((float)2/3.0);
     m_numpixel = 3 * numpix;
-    pixelcounter = 2 * numpix;
+    long pixelcounter = 2 * numpix;
 
     // ---------------------------
     // compute flow acc
@@ -787,37 +1687,48 @@ void FlowAccumulationFilter<TInputImage, TOutputImage>
 
     if (m_FlowAccAlgorithm.compare("Dinf") == 0)
     {
-        this->TFlowAcc(hlDemSort, ibuf, wbuf, obuf, spacing[0], spacing[1],
-                   numcols, numrows, pixelcounter);
+        this->TFlowAcc(&order[0], ibuf, wbuf, obuf, xps, yps,
+                   ncols, nrows, pixelcounter);
     }
     else if (m_FlowAccAlgorithm.compare("MFD") == 0)
     {
-        this->QFlowAcc(hlDemSort, ibuf, wbuf, obuf, spacing[0], spacing[1],
-                   numcols, numrows, pixelcounter);
+        this->QFlowAcc(&order[0], ibuf, wbuf, obuf, xps, yps,
+                   ncols, nrows, pixelcounter);
     }
     else if (m_FlowAccAlgorithm.compare("MFDw") == 0)
     {
-        if (m_FlowExponent < 1)
-        {
-            m_FlowExponent = 1;
-        }
-        this->HFlowAcc(hlDemSort, ibuf, wbuf, obuf, spacing[0], spacing[1],
-                numcols, numrows, pixelcounter);
+        this->HFlowAcc(&order[0], ibuf, wbuf, obuf, xps, yps,
+                ncols, nrows, pixelcounter);
     }
 
     NMProcDebug(<< "pixelcounter: " << pixelcounter);
     NMProcDebug(<< "m_numpixel" << m_numpixel);
     NMProcDebug(<< "pix ratio" << (pixelcounter / (float)m_numpixel));
+}
 
-    // -----------------------------------------------------------------
-    // clean up
-    delete hlDemSort;
-    this->UpdateProgress(1.0);
+template <class TInputImage, class TOutputImage>
+template <class TIndex>
+void FlowAccumulationFilter<TInputImage, TOutputImage>
+::sortCells(const InputImagePixelType* ibuf, const long long& numpix,
+            bool bAscending, std::vector<TIndex>& order)
+{
+    // map the heights onto unsigned integer keys of the same
+    // size; inverting the keys yields the descending order
+    std::vector<SortKeyType> keys(numpix);
+    order.resize(numpix);
+    for (long long i=0; i < numpix; ++i)
+    {
+        const SortKeyType key = RadixSortKey<InputImagePixelType>::Get(ibuf[i]);
+        keys[i] = bAscending ? key : static_cast<SortKeyType>(~key);
+        order[i] = static_cast<TIndex>(i);
+    }
+    this->UpdateProgress((float)1/6.0);
 
-    NMProcDebug(<< "Leave FlowAcc::GenerateData" << std::endl);
+    ParallelRadixSort<SortKeyType, TIndex> sorter;
+    sorter.SetNumberOfThreads(this->GetNumberOfThreads());
+    sorter.Sort(keys, order);
 }
 
-
 } // end namespace
 
 #endif
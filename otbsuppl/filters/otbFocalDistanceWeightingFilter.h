@@ -77,6 +77,13 @@ namespace otb
  *         ordered std::vector<InputPixelType> Values (i.e. Weights(i,0) represents
  *         the weight of pixel value Values[i] for the smallest distance class.
  *
+ *         The circular kernel is precomputed as a list of row spans, with
+ *         the weight of each kernel offset for each of the Values. Each
+ *         thread looks up the Values row of the pixels of its (padded) region
+ *         once, so weighting a pixel just sums up the table entries of the
+ *         kernel offsets showing any of the Values. 3D images are processed
+ *         slice by slice. Pixels outside the image are considered 0.
+ *
  */
 template <class TInputImage, class TOutputImage>
 class NMOTBSUPPLFILTERS_EXPORT FocalDistanceWeightingFilter :
@@ -168,6 +175,21 @@ protected:
    */
   void BeforeThreadedGenerateData(void);
 
+  /** Row of the weights matrix for pixel value v; -1 if
+   *  v is not one of the Values */
+  inline int GetValueRow(const InputPixelType& v) const
+  {
+    const float fv = static_cast<float>(v);
+    for (int row=0; row < static_cast<int>(m_Values.size()); ++row)
+      {
+      if (fv == static_cast<float>(m_Values[row]))
+        {
+        return row;
+        }
+      }
+    return -1;
+  }
+
 private:
   FocalDistanceWeightingFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -176,6 +198,15 @@ private:
   WeightMatrixType m_Weights;
   std::vector<InputPixelType> m_Values;
 
+  // circular kernel: half width and index of the first
+  // offset of each kernel row (dy = -radius ... radius)
+  std::vector<int> m_RowSpans;
+  std::vector<int> m_RowOffsetStart;
+
+  // weight of each kernel offset for each value row
+  // (offset-major, i.e. k * numValues + row)
+  std::vector<WeightType> m_KernelWeights;
+
 };
   
 } // end namespace itk
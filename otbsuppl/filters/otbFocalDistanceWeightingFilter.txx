@@ -36,12 +36,8 @@
 
 #include <algorithm>
 #include "otbFocalDistanceWeightingFilter.h"
-#include "itkConstShapedNeighborhoodIterator.h"
 #include "itkImageRegionIterator.h"
-#include "itkConstantBoundaryCondition.h"
-#include "itkOffset.h"
 #include "itkProgressReporter.h"
-#include "itkNeighborhoodAlgorithm.h"
 #include "itkExceptionObject.h"
 
 
@@ -150,6 +146,58 @@ FocalDistanceWeightingFilter< TInputImage, TOutputImage>
 		throw e;
 	}
 
+	// precompute the circular kernel as row spans; the distance classes
+	// are the unique (non-zero) distances of the kernel offsets in
+	// ascending order
+	const int radius = m_Radius;
+	std::vector<float> distcl_sorted;
+	for (int y = -radius; y <= radius; ++y)
+	{
+		for (int x = -radius; x <= radius; ++x)
+		{
+			float dist = ::sqrt((double)(x * x + y * y));
+			if (dist <= radius && dist > 0)
+			{
+				distcl_sorted.push_back(dist);
+			}
+		}
+	}
+	std::sort(distcl_sorted.begin(), distcl_sorted.end());
+	distcl_sorted.erase(std::unique(distcl_sorted.begin(), distcl_sorted.end()),
+			distcl_sorted.end());
+
+	const int numValues = m_Values.size();
+	m_RowSpans.clear();
+	m_RowOffsetStart.clear();
+	m_KernelWeights.clear();
+	int numOffsets = 0;
+	for (int y = -radius; y <= radius; ++y)
+	{
+		int hw = radius;
+		while (hw >= 0 && static_cast<float>(::sqrt((double)(hw * hw + y * y))) > radius)
+		{
+			--hw;
+		}
+		m_RowSpans.push_back(hw);
+		m_RowOffsetStart.push_back(numOffsets);
+
+		for (int x = -hw; x <= hw; ++x, ++numOffsets)
+		{
+			float dist = ::sqrt((double)(x * x + y * y));
+			const int col = std::lower_bound(distcl_sorted.begin(), distcl_sorted.end(), dist)
+					        - distcl_sorted.begin();
+			for (int row=0; row < numValues; ++row)
+			{
+				// the centre pixel doesn't count
+				WeightType w = 0;
+				if (dist > 0 && col < static_cast<int>(m_Weights.cols()))
+				{
+					w = static_cast<WeightType>(m_Weights(row, col));
+				}
+				m_KernelWeights.push_back(w);
+			}
+		}
+	}
 }
 
 template< class TInputImage, class TOutputImage>
@@ -158,114 +206,91 @@ FocalDistanceWeightingFilter< TInputImage, TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        itk::ThreadIdType threadId)
 {
-	unsigned int i;
-	itk::ConstantBoundaryCondition<InputImageType> nbc;
-	nbc.SetConstant(0);
-
-	typedef typename itk::ConstShapedNeighborhoodIterator<InputImageType> ShapedIteratorType;
-	ShapedIteratorType inIt;
-	typename ShapedIteratorType::RadiusType itradius;
-
-	int radius = m_Radius;
-	itradius.Fill(radius);
-	itk::ImageRegionIterator<OutputImageType> outIt;
-
-	// Allocate output
 	typename OutputImageType::Pointer output = this->GetOutput();
 	typename InputImageType::ConstPointer input = this->GetInput();
 
-	// Find the data-set boundary "faces"
-	typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<
-			InputImageType>::FaceListType faceList;
-	itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<InputImageType> bC;
-	faceList = bC(input, outputRegionForThread, itradius);
-
-	typename itk::NeighborhoodAlgorithm::ImageBoundaryFacesCalculator<
-			InputImageType>::FaceListType::iterator fit;
-
 	// support progress methods/callbacks
 	itk::ProgressReporter progress(this, threadId,
 			outputRegionForThread.GetNumberOfPixels());
 
-	// Process each of the boundary faces.  These are N-d regions which border
-	// the edge of the buffer.
-	for (fit = faceList.begin(); fit != faceList.end(); ++fit)
+	// the kernel is applied to the x/y plane (1D images are
+	// treated as one row, 3D images slice by slice)
+	const unsigned int ydim = InputImageDimension > 1 ? 1 : 0;
+	const unsigned int zdim = InputImageDimension > 2 ? 2 : 0;
+	const long radius = m_Radius;
+	const long ry = InputImageDimension > 1 ? radius : 0;
+	const int numValues = m_Values.size();
+
+	const InputImageRegionType& inReg = input->GetBufferedRegion();
+	const long ix0 = inReg.GetIndex(0);
+	const long iw = static_cast<long>(inReg.GetSize(0));
+	const long iy0 = InputImageDimension > 1 ? inReg.GetIndex(ydim) : 0;
+	const long ih = InputImageDimension > 1 ? static_cast<long>(inReg.GetSize(ydim)) : 1;
+	const long iz0 = InputImageDimension > 2 ? inReg.GetIndex(zdim) : 0;
+
+	const long ox0 = outputRegionForThread.GetIndex(0);
+	const long ow = static_cast<long>(outputRegionForThread.GetSize(0));
+	const long oy0 = InputImageDimension > 1 ? outputRegionForThread.GetIndex(ydim) : 0;
+	const long oh = InputImageDimension > 1 ? static_cast<long>(outputRegionForThread.GetSize(ydim)) : 1;
+	const long oz0 = InputImageDimension > 2 ? outputRegionForThread.GetIndex(zdim) : 0;
+	const long oz = InputImageDimension > 2 ? static_cast<long>(outputRegionForThread.GetSize(zdim)) : 1;
+
+	// the Values row of each pixel of the output region padded by
+	// the radius; pixels outside the input buffer are considered 0
+	const long pw = ow + 2 * radius;
+	const long ph = oh + 2 * ry;
+	std::vector<int> vrow(pw * ph);
+	const int zeroRow = this->GetValueRow(itk::NumericTraits<InputPixelType>::Zero);
+
+	const InputPixelType* inBuf = input->GetBufferPointer();
+	itk::ImageRegionIterator<OutputImageType> outIt(output, outputRegionForThread);
+	outIt.GoToBegin();
+
+	for (long z = oz0; z < oz0 + oz && !this->GetAbortGenerateData(); ++z)
 	{
-		inIt = ShapedIteratorType(itradius, input, *fit);
-		outIt = itk::ImageRegionIterator<OutputImageType>(output, *fit);
-
-		// create a list of unique distances
-		std::vector<float> distcl;
-		std::vector<float>::const_iterator it;
-		std::vector<float> distcl_sorted;
-		std::vector<unsigned int> neighidx;
-		for (int x = radius; x >= -radius; --x)
+		const InputPixelType* inSlice = inBuf + (z - iz0) * iw * ih;
+		for (long j = 0; j < ph; ++j)
 		{
-			for (int y = radius; y >= -radius; --y)
+			const long y = oy0 - ry + j;
+			int* vr = &vrow[j * pw];
+			for (long i = 0; i < pw; ++i)
 			{
-				typename ShapedIteratorType::OffsetType off;
-
-				float dist = ::sqrt((double)(x * x + y * y));
-				if (dist <= radius)
+				const long x = ox0 - radius + i;
+				if (y < iy0 || y >= iy0 + ih || x < ix0 || x >= ix0 + iw)
 				{
-					off[0] = static_cast<int>(x);
-					off[1] = static_cast<int>(y);
-					inIt.ActivateOffset(off);
-					distcl.push_back(dist);
-					neighidx.push_back(inIt.GetNeighborhoodIndex(off));
-
-					it = std::find(distcl_sorted.begin(), distcl_sorted.end(), dist);
-					if ((it == distcl_sorted.end() || distcl_sorted.size() == 0) && dist > 0)
-					{
-						distcl_sorted.push_back(dist);
-					}
+					vr[i] = zeroRow;
+				}
+				else
+				{
+					vr[i] = this->GetValueRow(inSlice[(y - iy0) * iw + (x - ix0)]);
 				}
 			}
 		}
-		std::sort(distcl_sorted.begin(), distcl_sorted.end());
-		std::vector<float>::size_type floatIdx;
-		std::vector<unsigned int>::size_type uintIdx;
-
-		inIt.OverrideBoundaryCondition(&nbc);
-		inIt.GoToBegin();
-		outIt.GoToBegin();
-		int cnt=0;
-		while (!inIt.IsAtEnd() && !this->GetAbortGenerateData())
+
+		// sum up the weights of the kernel offsets
+		// showing any of the values
+		for (long j = 0; j < oh && !this->GetAbortGenerateData(); ++j)
 		{
-			float sum = 0;
-			for (size_t i=0; i < neighidx.size(); ++i)
+			for (long i = 0; i < ow; ++i, ++outIt)
 			{
-				float v = inIt.GetPixel(neighidx[i]);
-
-				// determine the row of the weights matrix
-				int row;
-				bool bRow = false;
-				for (row=0; row < m_Values.size(); ++row)
+				float sum = 0;
+				for (long d = radius - ry; d <= radius + ry; ++d)
 				{
-					if (v == static_cast<float>(m_Values[row]))
+					const int hw = m_RowSpans[d];
+					const int* vr = &vrow[(j + d - (radius - ry)) * pw + i + radius - hw];
+					const WeightType* kw = m_KernelWeights.data() + m_RowOffsetStart[d] * numValues;
+					for (int k = 0; k <= 2 * hw; ++k, kw += numValues)
 					{
-						bRow = true;
-						break;
+						if (vr[k] >= 0)
+						{
+							sum += kw[vr[k]];
+						}
 					}
 				}
-				if (!bRow) continue;
 
-				// determine the column of the weight matrix
-				for (int col=0; col < distcl_sorted.size(); ++col)
-				{
-					if (distcl_sorted[col] == distcl[i])
-					{
-						sum += (float)m_Weights(row, col);
-						break;
-					}
-				}
+				outIt.Set(static_cast<OutputPixelType>(sum));
+				progress.CompletedPixel();
 			}
-
-			outIt.Set(static_cast<OutputPixelType>(sum));
-
-			++inIt;
-			++outIt;
-			progress.CompletedPixel();
 		}
 	}
 }
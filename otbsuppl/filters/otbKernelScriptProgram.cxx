@@ -0,0 +1,1748 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "otbKernelScriptProgram.h"
+
+#include <sstream>
+#include <locale>
+#include <algorithm>
+
+namespace otb
+{
+
+namespace
+{
+
+typedef KernelScriptProgram::Instruction Instruction;
+typedef KernelScriptProgram::ValueType   ValueType;
+
+// syntax flags, s. mu::ParserTokenReader::ESynCodes
+enum SynFlags
+{
+    noBO      = 1 << 0,
+    noBC      = 1 << 1,
+    noVAL     = 1 << 2,
+    noVAR     = 1 << 3,
+    noARG_SEP = 1 << 4,
+    noFUN     = 1 << 5,
+    noOPT     = 1 << 6,
+    noPOSTOP  = 1 << 7,
+    noINFIXOP = 1 << 8,
+    noEND     = 1 << 9,
+    noSTR     = 1 << 10,
+    noASSIGN  = 1 << 11,
+    noIF      = 1 << 12,
+    noELSE    = 1 << 13,
+    sfSTART_OF_LINE = noOPT | noBC | noPOSTOP | noASSIGN | noIF | noELSE | noARG_SEP,
+    noANY     = ~0
+};
+
+enum TokenType
+{
+    TOK_VAL,
+    TOK_VAR,
+    TOK_STR,
+    TOK_FUNC,
+    TOK_INFIX,
+    TOK_BINOP,
+    TOK_BO,
+    TOK_BC,
+    TOK_IF,
+    TOK_ELSE,
+    TOK_SEP,
+    TOK_END
+};
+
+enum FuncKind
+{
+    FUNC_PLAIN,
+    FUNC_KWIN,
+    FUNC_TAB,
+    FUNC_NDIST
+};
+
+struct Token
+{
+    Token() : type(TOK_END), op(-1), slot(-1), val(0),
+              str(-1), strKind(-1), fun(nullptr), argc(0), funKind(FUNC_PLAIN),
+              bVolatile(false) {}
+
+    TokenType type;
+    // binary operator or infix operator code
+    int op;
+    int slot;
+    ValueType val;
+    // image or table index
+    int str;
+    // 0: image, 1: table
+    int strKind;
+    mu::generic_fun_type fun;
+    // number of numeric arguments; -1: variable number
+    int argc;
+    int funKind;
+    // function isn't optimisable, e.g. returns random numbers
+    bool bVolatile;
+    std::string name;
+};
+
+// same order as mu::ParserBase::c_DefaultOprt
+struct BuiltInOprt
+{
+    const char* str;
+    TokenType type;
+    int op;
+};
+
+const BuiltInOprt builtInOprt[] =
+{
+    {"<=", TOK_BINOP, KernelScriptProgram::OP_LE},
+    {">=", TOK_BINOP, KernelScriptProgram::OP_GE},
+    {"!=", TOK_BINOP, KernelScriptProgram::OP_NEQ},
+    {"==", TOK_BINOP, KernelScriptProgram::OP_EQ},
+    {"<",  TOK_BINOP, KernelScriptProgram::OP_LT},
+    {">",  TOK_BINOP, KernelScriptProgram::OP_GT},
+    {"+",  TOK_BINOP, KernelScriptProgram::OP_ADD},
+    {"-",  TOK_BINOP, KernelScriptProgram::OP_SUB},
+    {"*",  TOK_BINOP, KernelScriptProgram::OP_MUL},
+    {"/",  TOK_BINOP, KernelScriptProgram::OP_DIV},
+    {"^",  TOK_BINOP, KernelScriptProgram::OP_POW},
+    {"&&", TOK_BINOP, KernelScriptProgram::OP_LAND},
+    {"||", TOK_BINOP, KernelScriptProgram::OP_LOR},
+    {"=",  TOK_BINOP, KernelScriptProgram::OP_ASSIGN},
+    {"(",  TOK_BO,    -1},
+    {")",  TOK_BC,    -1},
+    {"?",  TOK_IF,    -1},
+    {":",  TOK_ELSE,  -1},
+    {nullptr, TOK_END, -1}
+};
+
+const char* const nameChars =
+        "0123456789_abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const char* const infixOprtChars = "/+-*^?<>=#!$%&|~'_";
+
+/*! Splits an expression into tokens; mirrors
+ *  mu::ParserTokenReader incl. its syntax checks
+ */
+class Tokenizer
+{
+public:
+    Tokenizer(const std::string& expr, const KernelScriptProgram::SymbolTable& sym)
+        : m_Expr(expr + " "), m_Sym(sym), m_Pos(0),
+          m_SynFlags(sfSTART_OF_LINE), m_Brackets(0), m_LastType(TOK_END)
+    {}
+
+    bool next(Token& tok, std::string& err)
+    {
+        while (m_Pos < m_Expr.size()
+               && m_Expr[m_Pos] > 0 && m_Expr[m_Pos] <= 0x20)
+        {
+            ++m_Pos;
+        }
+
+        bool ok = isEOF(tok, err)
+                || isFunTok(tok, err)
+                || isBuiltIn(tok, err)
+                || isArgSep(tok, err)
+                || isValTok(tok, err)
+                || isVarTok(tok, err)
+                || isStrVarTok(tok, err)
+                || isInfixOpTok(tok, err);
+
+        if (!ok && err.empty())
+        {
+            err = "Unexpected token '" + m_Expr.substr(m_Pos) + "'";
+        }
+        m_LastType = tok.type;
+        return err.empty() && ok;
+    }
+
+protected:
+
+    size_t extract(const char* charSet, std::string& str) const
+    {
+        size_t end = m_Expr.find_first_not_of(charSet, m_Pos);
+        end = end == std::string::npos ? m_Expr.size() : end;
+        str = m_Expr.substr(m_Pos, end - m_Pos);
+        return end;
+    }
+
+    bool fail(std::string& err, const std::string& msg)
+    {
+        std::stringstream sstr;
+        sstr << msg << " at position " << m_Pos;
+        err = sstr.str();
+        return false;
+    }
+
+    bool isEOF(Token& tok, std::string& err)
+    {
+        if (m_Pos < m_Expr.size() && m_Expr[m_Pos] != 0)
+        {
+            return false;
+        }
+
+        if (m_SynFlags & noEND)
+        {
+            return fail(err, "Unexpected end of expression");
+        }
+
+        if (m_Brackets > 0)
+        {
+            return fail(err, "Missing ')'");
+        }
+
+        m_SynFlags = 0;
+        tok.type = TOK_END;
+        return true;
+    }
+
+    bool isFunTok(Token& tok, std::string& err)
+    {
+        std::string name;
+        const size_t end = this->extract(nameChars, name);
+        if (end == m_Pos || m_Sym.funs == nullptr)
+        {
+            return false;
+        }
+
+        mu::funmap_type::const_iterator it = m_Sym.funs->find(name);
+        if (it == m_Sym.funs->end() || end >= m_Expr.size() || m_Expr[end] != '(')
+        {
+            return false;
+        }
+
+        tok.type = TOK_FUNC;
+        tok.name = name;
+        tok.argc = it->second.GetArgc();
+        tok.fun = reinterpret_cast<mu::generic_fun_type>(it->second.GetAddr());
+        tok.bVolatile = !it->second.IsOptimizable();
+
+        if (name == "kwinVal")
+        {
+            tok.funKind = FUNC_KWIN;
+        }
+        else if (name == "tabVal")
+        {
+            tok.funKind = FUNC_TAB;
+        }
+        else if (name == "neigDist")
+        {
+            tok.funKind = FUNC_NDIST;
+        }
+        else if (it->second.GetCode() != mu::cmFUNC)
+        {
+            return fail(err, "Unsupported function '" + name + "'");
+        }
+
+        m_Pos = end;
+        if (m_SynFlags & noFUN)
+        {
+            return fail(err, "Unexpected function '" + name + "'");
+        }
+
+        m_SynFlags = noANY ^ noBO;
+        return true;
+    }
+
+    bool isBuiltIn(Token& tok, std::string& err)
+    {
+        for (int i=0; builtInOprt[i].str != nullptr; ++i)
+        {
+            const std::string op(builtInOprt[i].str);
+            if (m_Expr.compare(m_Pos, op.size(), op) != 0)
+            {
+                continue;
+            }
+
+            switch(builtInOprt[i].type)
+            {
+            case TOK_BINOP:
+                if (builtInOprt[i].op == KernelScriptProgram::OP_ASSIGN
+                        && (m_SynFlags & noASSIGN))
+                {
+                    return fail(err, "Unexpected operator '='");
+                }
+
+                if (m_SynFlags & noOPT)
+                {
+                    // could be an infix operator (sign)
+                    if (this->isInfixOpTok(tok, err))
+                    {
+                        return true;
+                    }
+                    return fail(err, "Unexpected operator '" + op + "'");
+                }
+                m_SynFlags = noBC | noOPT | noARG_SEP | noPOSTOP | noASSIGN | noIF | noELSE | noEND;
+                break;
+
+            case TOK_BO:
+                if (m_SynFlags & noBO)
+                {
+                    return fail(err, "Unexpected '('");
+                }
+
+                if (m_LastType == TOK_FUNC)
+                {
+                    m_SynFlags = noOPT | noEND | noARG_SEP | noPOSTOP | noASSIGN | noIF | noELSE;
+                }
+                else
+                {
+                    m_SynFlags = noBC | noOPT | noEND | noARG_SEP | noPOSTOP | noASSIGN | noIF | noELSE;
+                }
+                ++m_Brackets;
+                break;
+
+            case TOK_BC:
+                if (m_SynFlags & noBC)
+                {
+                    return fail(err, "Unexpected ')'");
+                }
+
+                m_SynFlags = noBO | noVAR | noVAL | noFUN | noINFIXOP | noSTR | noASSIGN;
+                if (--m_Brackets < 0)
+                {
+                    return fail(err, "Unexpected ')'");
+                }
+                break;
+
+            case TOK_ELSE:
+            case TOK_IF:
+                if (   (builtInOprt[i].type == TOK_IF && (m_SynFlags & noIF))
+                    || (builtInOprt[i].type == TOK_ELSE && (m_SynFlags & noELSE))
+                   )
+                {
+                    return fail(err, "Unexpected conditional '" + op + "'");
+                }
+                m_SynFlags = noBC | noPOSTOP | noEND | noOPT | noIF | noELSE;
+                break;
+
+            default:
+                break;
+            }
+
+            m_Pos += op.size();
+            tok.type = builtInOprt[i].type;
+            tok.op = builtInOprt[i].op;
+            tok.name = op;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool isArgSep(Token& tok, std::string& err)
+    {
+        if (m_Expr[m_Pos] != ',')
+        {
+            return false;
+        }
+
+        if (m_SynFlags & noARG_SEP)
+        {
+            return fail(err, "Unexpected ','");
+        }
+
+        m_SynFlags = noBC | noOPT | noEND | noARG_SEP | noPOSTOP | noASSIGN;
+        ++m_Pos;
+        tok.type = TOK_SEP;
+        return true;
+    }
+
+    bool isValTok(Token& tok, std::string& err)
+    {
+        std::string name;
+        const size_t end = this->extract(nameChars, name);
+        if (end != m_Pos)
+        {
+            std::map<std::string, ValueType>::const_iterator it = m_Sym.consts.find(name);
+            if (it != m_Sym.consts.end())
+            {
+                m_Pos = end;
+                tok.type = TOK_VAL;
+                tok.val = it->second;
+                tok.name = name;
+                if (m_SynFlags & noVAL)
+                {
+                    return fail(err, "Unexpected value '" + name + "'");
+                }
+                m_SynFlags = noVAL | noVAR | noFUN | noBO | noINFIXOP | noSTR | noASSIGN;
+                return true;
+            }
+        }
+
+        // read a number the same way as mu::Parser::IsVal does
+        std::istringstream stream(m_Expr.substr(m_Pos));
+        stream.imbue(std::locale::classic());
+        ValueType val;
+        stream >> val;
+        const std::istringstream::pos_type len = stream.tellg();
+        if (stream.fail() || len == std::istringstream::pos_type(-1))
+        {
+            return false;
+        }
+
+        tok.name = m_Expr.substr(m_Pos, static_cast<size_t>(len));
+        m_Pos += static_cast<size_t>(len);
+        if (m_SynFlags & noVAL)
+        {
+            return fail(err, "Unexpected value '" + tok.name + "'");
+        }
+
+        tok.type = TOK_VAL;
+        tok.val = val;
+        m_SynFlags = noVAL | noVAR | noFUN | noBO | noINFIXOP | noSTR | noASSIGN;
+        return true;
+    }
+
+    bool isVarTok(Token& tok, std::string& err)
+    {
+        std::string name;
+        const size_t end = this->extract(nameChars, name);
+        if (end == m_Pos)
+        {
+            return false;
+        }
+
+        std::map<std::string, int>::const_iterator it = m_Sym.vars.find(name);
+        if (it == m_Sym.vars.end())
+        {
+            return false;
+        }
+
+        if (m_SynFlags & noVAR)
+        {
+            return fail(err, "Unexpected variable '" + name + "'");
+        }
+
+        m_Pos = end;
+        tok.type = TOK_VAR;
+        tok.slot = it->second;
+        tok.name = name;
+        m_SynFlags = noVAL | noVAR | noFUN | noBO | noINFIXOP | noSTR;
+        return true;
+    }
+
+    bool isStrVarTok(Token& tok, std::string& err)
+    {
+        std::string name;
+        const size_t end = this->extract(nameChars, name);
+        if (end == m_Pos)
+        {
+            return false;
+        }
+
+        std::map<std::string, int>::const_iterator it = m_Sym.images.find(name);
+        if (it != m_Sym.images.end())
+        {
+            tok.strKind = 0;
+        }
+        else if ((it = m_Sym.tables.find(name)) != m_Sym.tables.end())
+        {
+            tok.strKind = 1;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (m_SynFlags & noSTR)
+        {
+            return fail(err, "Unexpected string '" + name + "'");
+        }
+
+        m_Pos = end;
+        tok.type = TOK_STR;
+        tok.str = it->second;
+        tok.name = name;
+        m_SynFlags = noANY ^ (noBC | noOPT | noEND | noARG_SEP);
+        return true;
+    }
+
+    bool isInfixOpTok(Token& tok, std::string& err)
+    {
+        std::string str;
+        const size_t end = this->extract(infixOprtChars, str);
+        if (end == m_Pos)
+        {
+            return false;
+        }
+
+        // mu::Parser only defines the signs as infix operators
+        if (str[0] != '-' && str[0] != '+')
+        {
+            return false;
+        }
+
+        tok.type = TOK_INFIX;
+        tok.op = str[0] == '-' ? KernelScriptProgram::OP_NEG : KernelScriptProgram::OP_POS;
+        tok.name = str.substr(0, 1);
+        ++m_Pos;
+
+        if (m_SynFlags & noINFIXOP)
+        {
+            return fail(err, "Unexpected operator '" + tok.name + "'");
+        }
+
+        m_SynFlags = noPOSTOP | noINFIXOP | noOPT | noBC | noSTR | noASSIGN;
+        return true;
+    }
+
+    std::string m_Expr;
+    const KernelScriptProgram::SymbolTable& m_Sym;
+    size_t m_Pos;
+    int m_SynFlags;
+    int m_Brackets;
+    TokenType m_LastType;
+};
+
+/*! Bytecode writer; applies the same optimisations
+ *  as mu::ParserByteCode
+ */
+class ByteCodeWriter
+{
+public:
+    ByteCodeWriter(std::vector<Instruction>& rpn)
+        : m_Rpn(rpn), m_StackPos(0), m_MaxStackSize(0)
+    {}
+
+    int GetMaxStackSize() const {return m_MaxStackSize;}
+
+    void AddVar(int slot)
+    {
+        push();
+        Instruction ins = make(KernelScriptProgram::OP_VAR);
+        ins.arg = slot;
+        ins.data = 1;
+        ins.data2 = 0;
+        m_Rpn.push_back(ins);
+    }
+
+    void AddVal(ValueType val)
+    {
+        push();
+        Instruction ins = make(KernelScriptProgram::OP_VAL);
+        ins.arg = -1;
+        ins.data = 0;
+        ins.data2 = val;
+        m_Rpn.push_back(ins);
+    }
+
+    void AddOp(int op)
+    {
+        typedef KernelScriptProgram P;
+        const size_t sz = m_Rpn.size();
+        bool bOptimized = false;
+
+        if (sz >= 2 && m_Rpn[sz-2].op == P::OP_VAL && m_Rpn[sz-1].op == P::OP_VAL)
+        {
+            constantFolding(op);
+            bOptimized = true;
+        }
+        else if (sz >= 2)
+        {
+            Instruction& a = m_Rpn[sz-2];
+            Instruction& b = m_Rpn[sz-1];
+            switch(op)
+            {
+            case P::OP_POW:
+                if (a.op == P::OP_VAR && b.op == P::OP_VAL)
+                {
+                    if (b.data2 == 2)
+                        a.op = P::OP_VARPOW2;
+                    else if (b.data2 == 3)
+                        a.op = P::OP_VARPOW3;
+                    else if (b.data2 == 4)
+                        a.op = P::OP_VARPOW4;
+                    else
+                        break;
+
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                break;
+
+            case P::OP_SUB:
+            case P::OP_ADD:
+                if (   (b.op == P::OP_VAR    && a.op == P::OP_VAL)
+                    || (b.op == P::OP_VAL    && a.op == P::OP_VAR)
+                    || (b.op == P::OP_VAL    && a.op == P::OP_VARMUL)
+                    || (b.op == P::OP_VARMUL && a.op == P::OP_VAL)
+                    || (b.op == P::OP_VAR    && a.op == P::OP_VAR    && a.arg == b.arg)
+                    || (b.op == P::OP_VAR    && a.op == P::OP_VARMUL && a.arg == b.arg)
+                    || (b.op == P::OP_VARMUL && a.op == P::OP_VAR    && a.arg == b.arg)
+                    || (b.op == P::OP_VARMUL && a.op == P::OP_VARMUL && a.arg == b.arg)
+                   )
+                {
+                    const ValueType sign = op == P::OP_SUB ? -1 : 1;
+                    a.op = P::OP_VARMUL;
+                    a.arg = std::max(a.arg, b.arg);
+                    a.data2 += sign * b.data2;
+                    a.data  += sign * b.data;
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                break;
+
+            case P::OP_MUL:
+                if (   (b.op == P::OP_VAR && a.op == P::OP_VAL)
+                    || (b.op == P::OP_VAL && a.op == P::OP_VAR)
+                   )
+                {
+                    a.op = P::OP_VARMUL;
+                    a.arg = std::max(a.arg, b.arg);
+                    a.data = a.data2 + b.data2;
+                    a.data2 = 0;
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                else if (   (b.op == P::OP_VAL    && a.op == P::OP_VARMUL)
+                         || (b.op == P::OP_VARMUL && a.op == P::OP_VAL)
+                        )
+                {
+                    a.op = P::OP_VARMUL;
+                    a.arg = std::max(a.arg, b.arg);
+                    if (b.op == P::OP_VAL)
+                    {
+                        a.data  *= b.data2;
+                        a.data2 *= b.data2;
+                    }
+                    else
+                    {
+                        a.data  = b.data  * a.data2;
+                        a.data2 = b.data2 * a.data2;
+                    }
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                else if (b.op == P::OP_VAR && a.op == P::OP_VAR && a.arg == b.arg)
+                {
+                    a.op = P::OP_VARPOW2;
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                break;
+
+            case P::OP_DIV:
+                if (b.op == P::OP_VAL && a.op == P::OP_VARMUL && b.data2 != 0)
+                {
+                    a.data  /= b.data2;
+                    a.data2 /= b.data2;
+                    m_Rpn.pop_back();
+                    bOptimized = true;
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        if (!bOptimized)
+        {
+            --m_StackPos;
+            m_Rpn.push_back(make(op));
+        }
+    }
+
+    void AddIfElse(int op)
+    {
+        m_Rpn.push_back(make(op));
+    }
+
+    void AddAssignOp(int slot)
+    {
+        --m_StackPos;
+        Instruction ins = make(KernelScriptProgram::OP_ASSIGN);
+        ins.arg = slot;
+        m_Rpn.push_back(ins);
+    }
+
+    void AddInfix(int op)
+    {
+        m_Rpn.push_back(make(op));
+    }
+
+    void AddFun(mu::generic_fun_type fun, int argc, bool bVolatile)
+    {
+        // argc < 0: function with variable number of arguments
+        m_StackPos = argc >= 0 ? m_StackPos - argc + 1 : m_StackPos + argc + 1;
+        m_MaxStackSize = std::max(m_MaxStackSize, m_StackPos);
+
+        Instruction ins = make(argc >= 0 ? KernelScriptProgram::OP_FUNC
+                                         : KernelScriptProgram::OP_FUNC_MULTI);
+        ins.arg = argc >= 0 ? argc : -argc;
+        ins.arg2 = bVolatile ? 1 : 0;
+        ins.fun = fun;
+        m_Rpn.push_back(ins);
+    }
+
+    void AddIntrinsic(int op, int idx, int argc)
+    {
+        m_StackPos = m_StackPos - argc + 1;
+        m_MaxStackSize = std::max(m_MaxStackSize, m_StackPos);
+
+        Instruction ins = make(op);
+        ins.arg = idx;
+        m_Rpn.push_back(ins);
+    }
+
+protected:
+
+    static Instruction make(int op)
+    {
+        Instruction ins;
+        ins.op = op;
+        ins.arg = -1;
+        ins.arg2 = 0;
+        ins.data = 0;
+        ins.data2 = 0;
+        ins.fun = nullptr;
+        return ins;
+    }
+
+    void push()
+    {
+        ++m_StackPos;
+        m_MaxStackSize = std::max(m_MaxStackSize, m_StackPos);
+    }
+
+    void constantFolding(int op)
+    {
+        typedef KernelScriptProgram P;
+        const size_t sz = m_Rpn.size();
+        ValueType& x = m_Rpn[sz-2].data2;
+        const ValueType y = m_Rpn[sz-1].data2;
+
+        switch(op)
+        {
+        case P::OP_LAND: x = (int)x && (int)y; break;
+        case P::OP_LOR:  x = (int)x || (int)y; break;
+        case P::OP_LT:   x = x < y;  break;
+        case P::OP_GT:   x = x > y;  break;
+        case P::OP_LE:   x = x <= y; break;
+        case P::OP_GE:   x = x >= y; break;
+        case P::OP_NEQ:  x = x != y; break;
+        case P::OP_EQ:   x = x == y; break;
+        case P::OP_ADD:  x = x + y;  break;
+        case P::OP_SUB:  x = x - y;  break;
+        case P::OP_MUL:  x = x * y;  break;
+        case P::OP_DIV:  x = x / y;  break;
+        case P::OP_POW:  x = std::pow(x, y); break;
+        default:
+            // e.g. assignment to a constant; not
+            // folded, same as muParser
+            return;
+        }
+        m_Rpn.pop_back();
+    }
+
+    std::vector<Instruction>& m_Rpn;
+    int m_StackPos;
+    int m_MaxStackSize;
+};
+
+int precedence(const Token& tok)
+{
+    typedef KernelScriptProgram P;
+    switch(tok.type)
+    {
+    case TOK_IF:
+    case TOK_ELSE:
+        return 0;
+    case TOK_INFIX:
+        return 6;
+    case TOK_BINOP:
+        switch(tok.op)
+        {
+        case P::OP_ASSIGN: return -1;
+        case P::OP_LOR:    return 1;
+        case P::OP_LAND:   return 2;
+        case P::OP_ADD:
+        case P::OP_SUB:    return 5;
+        case P::OP_MUL:
+        case P::OP_DIV:    return 6;
+        case P::OP_POW:    return 7;
+        default:           return 4;
+        }
+    default:
+        return -5;
+    }
+}
+
+/*! Translates tokens into RPN; mirrors mu::ParserBase::CreateRPN */
+class RPNCompiler
+{
+public:
+    RPNCompiler(Tokenizer& tokenizer, ByteCodeWriter& writer)
+        : m_Tokenizer(tokenizer), m_Writer(writer), m_IfElseCounter(0)
+    {}
+
+    bool run(int& numResults, std::string& err)
+    {
+        Token opt, opta;
+        m_ArgCount.push_back(1);
+
+        for (;;)
+        {
+            if (!m_Tokenizer.next(opt, err))
+            {
+                return false;
+            }
+
+            switch(opt.type)
+            {
+            case TOK_STR:
+                m_Val.push_back(opt);
+                break;
+
+            case TOK_VAR:
+                m_Val.push_back(opt);
+                m_Writer.AddVar(opt.slot);
+                break;
+
+            case TOK_VAL:
+                m_Val.push_back(opt);
+                m_Writer.AddVal(opt.val);
+                break;
+
+            case TOK_ELSE:
+                if (--m_IfElseCounter < 0)
+                {
+                    err = "Misplaced colon";
+                    return false;
+                }
+                if (!applyRemainingOprt(err))
+                {
+                    return false;
+                }
+                m_Writer.AddIfElse(KernelScriptProgram::OP_ELSE);
+                m_Opt.push_back(opt);
+                break;
+
+            case TOK_SEP:
+                if (m_ArgCount.empty())
+                {
+                    err = "Unexpected argument separator";
+                    return false;
+                }
+                ++m_ArgCount.back();
+                if (!applyRemainingOprt(err))
+                {
+                    return false;
+                }
+                break;
+
+            case TOK_END:
+                if (!applyRemainingOprt(err))
+                {
+                    return false;
+                }
+                break;
+
+            case TOK_BC:
+                {
+                    if (opta.type == TOK_BO)
+                    {
+                        --m_ArgCount.back();
+                    }
+
+                    if (!applyRemainingOprt(err))
+                    {
+                        return false;
+                    }
+
+                    if (!m_Opt.empty() && m_Opt.back().type == TOK_BO)
+                    {
+                        const int argCount = m_ArgCount.back();
+                        m_ArgCount.pop_back();
+                        m_Opt.pop_back();
+
+                        if (argCount > 1 && (m_Opt.empty() || m_Opt.back().type != TOK_FUNC))
+                        {
+                            err = "Unexpected argument";
+                            return false;
+                        }
+
+                        if (!m_Opt.empty() && m_Opt.back().type == TOK_FUNC)
+                        {
+                            if (!applyFunc(argCount, err))
+                            {
+                                return false;
+                            }
+                        }
+                    }
+                }
+                break;
+
+            case TOK_IF:
+                ++m_IfElseCounter;
+                // fall through
+
+            case TOK_BINOP:
+                while (   !m_Opt.empty()
+                       && m_Opt.back().type != TOK_BO
+                       && m_Opt.back().type != TOK_ELSE
+                       && m_Opt.back().type != TOK_IF
+                      )
+                {
+                    const Token& top = m_Opt.back();
+                    const int prec1 = precedence(top);
+                    const int prec2 = precedence(opt);
+
+                    if (top.type == opt.type && top.op == opt.op)
+                    {
+                        // only the power operator is right associative
+                        const bool right = opt.type == TOK_BINOP
+                                && opt.op == KernelScriptProgram::OP_POW;
+                        if (   (right && prec1 <= prec2)
+                            || (!right && prec1 < prec2)
+                           )
+                        {
+                            break;
+                        }
+                    }
+                    else if (prec1 < prec2)
+                    {
+                        break;
+                    }
+
+                    const bool ok = top.type == TOK_INFIX
+                            ? applyFunc(1, err)
+                            : applyBinOprt(err);
+                    if (!ok)
+                    {
+                        return false;
+                    }
+                }
+
+                if (opt.type == TOK_IF)
+                {
+                    m_Writer.AddIfElse(KernelScriptProgram::OP_IF);
+                }
+                m_Opt.push_back(opt);
+                break;
+
+            case TOK_BO:
+                m_ArgCount.push_back(1);
+                m_Opt.push_back(opt);
+                break;
+
+            case TOK_INFIX:
+            case TOK_FUNC:
+                m_Opt.push_back(opt);
+                break;
+
+            default:
+                err = "Internal error";
+                return false;
+            }
+
+            opta = opt;
+            if (opt.type == TOK_END)
+            {
+                break;
+            }
+        }
+
+        if (m_IfElseCounter > 0)
+        {
+            err = "Missing else clause";
+            return false;
+        }
+
+        if (m_ArgCount.size() != 1 || m_ArgCount.back() == 0)
+        {
+            err = "Internal error";
+            return false;
+        }
+        numResults = m_ArgCount.back();
+
+        if (m_Val.empty())
+        {
+            err = "Empty expression";
+            return false;
+        }
+
+        if (m_Val.back().type == TOK_STR)
+        {
+            err = "String result";
+            return false;
+        }
+
+        return true;
+    }
+
+protected:
+
+    bool applyRemainingOprt(std::string& err)
+    {
+        while (   !m_Opt.empty()
+               && m_Opt.back().type != TOK_BO
+               && m_Opt.back().type != TOK_IF
+              )
+        {
+            bool ok = true;
+            switch(m_Opt.back().type)
+            {
+            case TOK_INFIX:
+                ok = applyFunc(1, err);
+                break;
+            case TOK_BINOP:
+                ok = applyBinOprt(err);
+                break;
+            case TOK_ELSE:
+                ok = applyIfElse(err);
+                break;
+            default:
+                err = "Internal error";
+                ok = false;
+            }
+
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool applyIfElse(std::string& err)
+    {
+        while (!m_Opt.empty() && m_Opt.back().type == TOK_ELSE)
+        {
+            m_Opt.pop_back();
+            if (m_Opt.empty() || m_Opt.back().type != TOK_IF || m_Val.size() < 3)
+            {
+                err = "Misplaced colon";
+                return false;
+            }
+            m_Opt.pop_back();
+
+            for (int v=0; v < 3; ++v)
+            {
+                if (m_Val.back().type == TOK_STR)
+                {
+                    err = "Value expected in conditional expression";
+                    return false;
+                }
+                m_Val.pop_back();
+            }
+            m_Val.push_back(dummy());
+
+            m_Writer.AddIfElse(KernelScriptProgram::OP_ENDIF);
+        }
+        return true;
+    }
+
+    bool applyBinOprt(std::string& err)
+    {
+        if (m_Val.size() < 2)
+        {
+            err = "Missing operand";
+            return false;
+        }
+
+        const Token valTok1 = m_Val.back(); m_Val.pop_back();
+        const Token valTok2 = m_Val.back(); m_Val.pop_back();
+        const Token optTok = m_Opt.back(); m_Opt.pop_back();
+
+        if (valTok1.type == TOK_STR || valTok2.type == TOK_STR)
+        {
+            err = "Operator type conflict '" + optTok.name + "'";
+            return false;
+        }
+
+        if (optTok.op == KernelScriptProgram::OP_ASSIGN)
+        {
+            if (valTok2.type != TOK_VAR)
+            {
+                err = "Unexpected operator '='";
+                return false;
+            }
+            m_Writer.AddAssignOp(valTok2.slot);
+        }
+        else
+        {
+            m_Writer.AddOp(optTok.op);
+        }
+
+        m_Val.push_back(dummy());
+        return true;
+    }
+
+    bool applyFunc(int argCount, std::string& err)
+    {
+        const Token funTok = m_Opt.back();
+        m_Opt.pop_back();
+
+        if (funTok.type == TOK_INFIX)
+        {
+            if (m_Val.empty() || m_Val.back().type == TOK_STR)
+            {
+                err = "Value expected";
+                return false;
+            }
+            m_Val.pop_back();
+            m_Writer.AddInfix(funTok.op);
+            m_Val.push_back(dummy());
+            return true;
+        }
+
+        // the string argument (kwinVal, tabVal) counts as argument
+        // but isn't part of the function's numerical arguments
+        const bool bStrFun = funTok.funKind == FUNC_KWIN || funTok.funKind == FUNC_TAB;
+        const int argRequired = funTok.argc + (bStrFun ? 1 : 0);
+        const int argNumerical = argCount - (bStrFun ? 1 : 0);
+
+        if (funTok.argc >= 0 && argCount > argRequired)
+        {
+            err = "Too many parameters for function '" + funTok.name + "'";
+            return false;
+        }
+
+        if (argCount < argRequired)
+        {
+            err = "Too few parameters for function '" + funTok.name + "'";
+            return false;
+        }
+
+        if (funTok.argc == -1 && argCount == 0)
+        {
+            err = "Too few parameters for function '" + funTok.name + "'";
+            return false;
+        }
+
+        if (static_cast<int>(m_Val.size()) < argCount)
+        {
+            err = "Missing function argument";
+            return false;
+        }
+
+        for (int a=0; a < argNumerical; ++a)
+        {
+            if (m_Val.back().type == TOK_STR)
+            {
+                err = "Value expected in function '" + funTok.name + "'";
+                return false;
+            }
+            m_Val.pop_back();
+        }
+
+        switch(funTok.funKind)
+        {
+        case FUNC_KWIN:
+        case FUNC_TAB:
+            {
+                const Token strTok = m_Val.back();
+                m_Val.pop_back();
+                const int kind = funTok.funKind == FUNC_KWIN ? 0 : 1;
+                if (strTok.type != TOK_STR || strTok.strKind != kind)
+                {
+                    err = "Invalid image or table name in function '" + funTok.name + "'";
+                    return false;
+                }
+                m_Writer.AddIntrinsic(funTok.funKind == FUNC_KWIN
+                                        ? KernelScriptProgram::OP_KWIN
+                                        : KernelScriptProgram::OP_TAB,
+                                      strTok.str, argNumerical);
+            }
+            break;
+
+        case FUNC_NDIST:
+            m_Writer.AddIntrinsic(KernelScriptProgram::OP_NDIST, -1, argNumerical);
+            break;
+
+        default:
+            if (funTok.argc > 5)
+            {
+                err = "Unsupported number of arguments of function '" + funTok.name + "'";
+                return false;
+            }
+            m_Writer.AddFun(funTok.fun, funTok.argc == -1 ? -argNumerical : argNumerical,
+                            funTok.bVolatile);
+        }
+
+        m_Val.push_back(dummy());
+        return true;
+    }
+
+    static Token dummy()
+    {
+        Token tok;
+        tok.type = TOK_VAL;
+        tok.val = 1;
+        return tok;
+    }
+
+    Tokenizer& m_Tokenizer;
+    ByteCodeWriter& m_Writer;
+
+    std::vector<Token> m_Opt;
+    std::vector<Token> m_Val;
+    std::vector<int> m_ArgCount;
+    int m_IfElseCounter;
+};
+
+} // anonymous namespace
+
+KernelScriptProgram::KernelScriptProgram()
+    : m_StackSize(0),
+      m_bLinked(false)
+{
+}
+
+void
+KernelScriptProgram::Clear()
+{
+    m_SlotNames.clear();
+    m_SlotIndex.clear();
+    m_Statements.clear();
+    m_Code.clear();
+    m_StackSize = 0;
+    m_bLinked = false;
+}
+
+int
+KernelScriptProgram::AddSlot(const std::string& name)
+{
+    std::map<std::string, int>::const_iterator it = m_SlotIndex.find(name);
+    if (it != m_SlotIndex.end())
+    {
+        return it->second;
+    }
+
+    const int slot = static_cast<int>(m_SlotNames.size());
+    m_SlotNames.push_back(name);
+    m_SlotIndex[name] = slot;
+    return slot;
+}
+
+int
+KernelScriptProgram::GetSlot(const std::string& name) const
+{
+    std::map<std::string, int>::const_iterator it = m_SlotIndex.find(name);
+    return it != m_SlotIndex.end() ? it->second : -1;
+}
+
+bool
+KernelScriptProgram::compile(const std::string& expr, const SymbolTable& symbols,
+                             std::vector<Instruction>& rpn, int& numResults,
+                             int& stackSize, std::string& errMsg) const
+{
+    Tokenizer tokenizer(expr, symbols);
+    ByteCodeWriter writer(rpn);
+    RPNCompiler compiler(tokenizer, writer);
+
+    if (!compiler.run(numResults, errMsg))
+    {
+        return false;
+    }
+
+    stackSize = writer.GetMaxStackSize();
+    return true;
+}
+
+bool
+KernelScriptProgram::AddStatement(const std::string& expr, int target,
+                                  const SymbolTable& symbols, std::string& errMsg)
+{
+    m_bLinked = false;
+    if (target < 0 || target >= this->GetNumSlots())
+    {
+        errMsg = "Invalid target variable!";
+        return false;
+    }
+
+    Statement stmt;
+    stmt.target = target;
+    stmt.numResults = 0;
+    int stackSize = 0;
+    if (!this->compile(expr, symbols, stmt.rpn, stmt.numResults, stackSize, errMsg))
+    {
+        errMsg = "'" + expr + "': " + errMsg;
+        return false;
+    }
+
+    // if-else branches are accounted for cumulatively, so
+    // the stack size is an upper bound
+    m_StackSize = std::max(m_StackSize, stackSize + stmt.numResults + 2);
+    m_Statements.push_back(stmt);
+    return true;
+}
+
+void
+KernelScriptProgram::emitStatement(int idx)
+{
+    // copy the statement's code omitting the ENDIF markers and
+    // resolve the relative if-else jumps into absolute positions
+    const std::vector<Instruction>& rpn = m_Statements[idx].rpn;
+    std::vector<size_t> stIf, stElse;
+    const size_t offset = m_Code.size();
+
+    for (size_t i=0; i < rpn.size(); ++i)
+    {
+        switch(rpn[i].op)
+        {
+        case OP_IF:
+            stIf.push_back(m_Code.size());
+            m_Code.push_back(rpn[i]);
+            break;
+
+        case OP_ELSE:
+            m_Code[stIf.back()].arg = static_cast<int>(m_Code.size() + 1);
+            stIf.pop_back();
+            stElse.push_back(m_Code.size());
+            m_Code.push_back(rpn[i]);
+            break;
+
+        case OP_ENDIF:
+            m_Code[stElse.back()].arg = static_cast<int>(m_Code.size());
+            stElse.pop_back();
+            break;
+
+        default:
+            m_Code.push_back(rpn[i]);
+        }
+    }
+
+    Instruction store;
+    store.op = OP_STORE;
+    store.arg = m_Statements[idx].target;
+    store.arg2 = m_Statements[idx].numResults;
+    store.data = store.data2 = 0;
+    store.fun = nullptr;
+    m_Code.push_back(store);
+}
+
+void
+KernelScriptProgram::emitBlock(int start, int end, const std::vector<int>& blockLen)
+{
+    for (int p=start; p < end; ++p)
+    {
+        this->emitStatement(p);
+        if (blockLen[p] > 1)
+        {
+            // for (init; test; counter) {body}
+            //
+            //       init                (just emitted)
+            // test: test
+            //       jz test end
+            //       body
+            //       counter
+            //       jmp test
+            // end:
+            const int testStmt = p + 1;
+            const int counterStmt = p + 2;
+
+            const int testPos = static_cast<int>(m_Code.size());
+            this->emitStatement(testStmt);
+
+            Instruction jz;
+            jz.op = OP_JZ_SLOT;
+            jz.arg = m_Statements[testStmt].target;
+            jz.arg2 = -1;
+            jz.data = jz.data2 = 0;
+            jz.fun = nullptr;
+            const size_t jzPos = m_Code.size();
+            m_Code.push_back(jz);
+
+            this->emitBlock(p + 3, p + blockLen[p], blockLen);
+            this->emitStatement(counterStmt);
+
+            Instruction jmp = jz;
+            jmp.op = OP_JMP;
+            jmp.arg = testPos;
+            m_Code.push_back(jmp);
+
+            m_Code[jzPos].arg2 = static_cast<int>(m_Code.size());
+
+            p += blockLen[p] - 1;
+        }
+    }
+}
+
+bool
+KernelScriptProgram::Link(const std::vector<int>& blockLen, std::string& errMsg)
+{
+    m_Code.clear();
+    m_bLinked = false;
+
+    if (blockLen.size() != m_Statements.size())
+    {
+        errMsg = "Number of statements doesn't match the script structure!";
+        return false;
+    }
+
+    for (size_t b=0; b < blockLen.size(); ++b)
+    {
+        if (blockLen[b] < 1 || (blockLen[b] > 1 && blockLen[b] < 3)
+                || b + blockLen[b] > blockLen.size())
+        {
+            errMsg = "Malformed for-loop!";
+            return false;
+        }
+    }
+
+    this->emitBlock(0, static_cast<int>(m_Statements.size()), blockLen);
+
+    Instruction end;
+    end.op = OP_END;
+    end.arg = end.arg2 = 0;
+    end.data = end.data2 = 0;
+    end.fun = nullptr;
+    m_Code.push_back(end);
+
+    m_bLinked = true;
+    return true;
+}
+
+bool
+KernelScriptProgram::IsBatchable(int idx) const
+{
+    const std::vector<Instruction>& rpn = m_Statements[idx].rpn;
+    for (size_t i=0; i < rpn.size(); ++i)
+    {
+        switch(rpn[i].op)
+        {
+        case OP_ASSIGN:
+        case OP_KWIN:
+        case OP_TAB:
+        case OP_NDIST:
+            return false;
+
+        case OP_FUNC:
+        case OP_FUNC_MULTI:
+            // non-optimisable, e.g. random number functions
+            if (rpn[i].arg2 != 0)
+            {
+                return false;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+void
+KernelScriptProgram::GetReadSlots(int idx, std::vector<int>& slots) const
+{
+    const std::vector<Instruction>& rpn = m_Statements[idx].rpn;
+    for (size_t i=0; i < rpn.size(); ++i)
+    {
+        switch(rpn[i].op)
+        {
+        case OP_VAR:
+        case OP_VARMUL:
+        case OP_VARPOW2:
+        case OP_VARPOW3:
+        case OP_VARPOW4:
+            if (std::find(slots.begin(), slots.end(), rpn[i].arg) == slots.end())
+            {
+                slots.push_back(rpn[i].arg);
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+bool
+KernelScriptProgram::ResolveBatchSources(std::vector<std::vector<int> >& sources) const
+{
+    const int numSlots = this->GetNumSlots();
+    const int numStmts = this->GetNumStatements();
+    sources.assign(numStmts, std::vector<int>(numSlots, -1));
+
+    std::vector<int> lastWriter(numSlots, -1);
+    std::vector<bool> written(numSlots, false);
+    for (int s=0; s < numStmts; ++s)
+    {
+        written[m_Statements[s].target] = true;
+    }
+
+    std::vector<int> readSlots;
+    for (int s=0; s < numStmts; ++s)
+    {
+        readSlots.clear();
+        this->GetReadSlots(s, readSlots);
+        for (size_t r=0; r < readSlots.size(); ++r)
+        {
+            const int slot = readSlots[r];
+            if (lastWriter[slot] >= 0)
+            {
+                sources[s][slot] = lastWriter[slot];
+            }
+            // only written further down (or by this very statement)
+            else if (written[slot])
+            {
+                sources.clear();
+                return false;
+            }
+        }
+        lastWriter[m_Statements[s].target] = s;
+    }
+    return true;
+}
+
+namespace
+{
+
+// column-wise operations used by ExecuteBatch; a is the
+// left operand and receives the result
+
+template<class TOp>
+inline void batchBinary(ValueType* a, const ValueType* b, int n, TOp op)
+{
+    for (int i=0; i < n; ++i)
+    {
+        a[i] = op(a[i], b[i]);
+    }
+}
+
+inline void batchLoad(ValueType* a, const ValueType* v, int stride, int n)
+{
+    if (stride)
+    {
+        std::copy(v, v + n, a);
+    }
+    else
+    {
+        std::fill(a, a + n, *v);
+    }
+}
+
+} // anonymous namespace
+
+void
+KernelScriptProgram::ExecuteBatch(int idx, const ValueType* const* values, const int* strides,
+                                  int numValues, ValueType* const* results,
+                                  std::vector<ValueType>& work) const
+{
+    typedef ValueType (*Fun0)();
+    typedef ValueType (*Fun1)(ValueType);
+    typedef ValueType (*Fun2)(ValueType, ValueType);
+    typedef ValueType (*Fun3)(ValueType, ValueType, ValueType);
+    typedef ValueType (*Fun4)(ValueType, ValueType, ValueType, ValueType);
+    typedef ValueType (*Fun5)(ValueType, ValueType, ValueType, ValueType, ValueType);
+    typedef ValueType (*FunN)(const ValueType*, int);
+
+    const std::vector<Instruction>& rpn = m_Statements[idx].rpn;
+    const int numResults = m_Statements[idx].numResults;
+
+    // work buffer layout: stack columns (starting at index 1,
+    // as in Execute), one condition column per if-else, and
+    // the argument buffer for multi-arg functions
+    int numIf = 0;
+    int maxArgc = 0;
+    for (size_t c=0; c < rpn.size(); ++c)
+    {
+        numIf += rpn[c].op == OP_IF ? 1 : 0;
+        if (rpn[c].op == OP_FUNC_MULTI)
+        {
+            maxArgc = std::max(maxArgc, rpn[c].arg);
+        }
+    }
+
+    const int B = BatchBlockSize;
+    const size_t numStackCols = static_cast<size_t>(m_StackSize + 1);
+    const size_t workSize = (numStackCols + numIf) * B + maxArgc;
+    if (work.size() < workSize)
+    {
+        work.resize(workSize);
+    }
+    ValueType* const stack = &work[0];
+    ValueType* const masks = stack + numStackCols * B;
+    ValueType* const args = masks + numIf * B;
+
+    for (int off=0; off < numValues; off += B)
+    {
+        const int n = std::min(B, numValues - off);
+        int sidx = 0;
+        int midx = 0;
+
+        for (size_t c=0; c < rpn.size(); ++c)
+        {
+            const Instruction& ins = rpn[c];
+            ValueType* a = nullptr;
+            const ValueType* b = nullptr;
+            const ValueType* v = nullptr;
+
+            switch(ins.op)
+            {
+            case OP_LE:
+            case OP_GE:
+            case OP_NEQ:
+            case OP_EQ:
+            case OP_LT:
+            case OP_GT:
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+            case OP_DIV:
+            case OP_POW:
+            case OP_LAND:
+            case OP_LOR:
+                --sidx;
+                a = stack + sidx * B;
+                b = a + B;
+                break;
+            default:
+                break;
+            }
+
+            switch(ins.op)
+            {
+            case OP_LE:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x <= y;}); break;
+            case OP_GE:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x >= y;}); break;
+            case OP_NEQ: batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x != y;}); break;
+            case OP_EQ:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x == y;}); break;
+            case OP_LT:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x <  y;}); break;
+            case OP_GT:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x >  y;}); break;
+            case OP_ADD: batchBinary(a, b, n, [](ValueType x, ValueType y) {return x + y;}); break;
+            case OP_SUB: batchBinary(a, b, n, [](ValueType x, ValueType y) {return x - y;}); break;
+            case OP_MUL: batchBinary(a, b, n, [](ValueType x, ValueType y) {return x * y;}); break;
+            case OP_DIV: batchBinary(a, b, n, [](ValueType x, ValueType y) {return x / y;}); break;
+            case OP_POW: batchBinary(a, b, n, [](ValueType x, ValueType y) {return std::pow(x, y);}); break;
+            case OP_LAND: batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x && y;}); break;
+            case OP_LOR:  batchBinary(a, b, n, [](ValueType x, ValueType y) -> ValueType {return x || y;}); break;
+
+            // both branches are evaluated; the condition is kept
+            // aside until the branches are blended at ENDIF
+            case OP_IF:
+                a = stack + sidx * B;
+                std::copy(a, a + n, masks + midx * B);
+                ++midx;
+                --sidx;
+                break;
+            case OP_ELSE:
+                break;
+            case OP_ENDIF:
+                --sidx;
+                --midx;
+                a = stack + sidx * B;
+                b = a + B;
+                v = masks + midx * B;
+                for (int i=0; i < n; ++i)
+                {
+                    a[i] = v[i] != 0 ? a[i] : b[i];
+                }
+                break;
+
+            case OP_VAL:
+                a = stack + (++sidx) * B;
+                std::fill(a, a + n, ins.data2);
+                break;
+            case OP_VAR:
+                a = stack + (++sidx) * B;
+                batchLoad(a, values[ins.arg] + off * strides[ins.arg], strides[ins.arg], n);
+                break;
+            case OP_VARMUL:
+            case OP_VARPOW2:
+            case OP_VARPOW3:
+            case OP_VARPOW4:
+                a = stack + (++sidx) * B;
+                batchLoad(a, values[ins.arg] + off * strides[ins.arg], strides[ins.arg], n);
+                switch(ins.op)
+                {
+                case OP_VARMUL:
+                    for (int i=0; i < n; ++i) a[i] = a[i] * ins.data + ins.data2;
+                    break;
+                case OP_VARPOW2:
+                    for (int i=0; i < n; ++i) a[i] = a[i] * a[i];
+                    break;
+                case OP_VARPOW3:
+                    for (int i=0; i < n; ++i) a[i] = a[i] * a[i] * a[i];
+                    break;
+                default:
+                    for (int i=0; i < n; ++i) a[i] = a[i] * a[i] * a[i] * a[i];
+                    break;
+                }
+                break;
+
+            case OP_NEG:
+                a = stack + sidx * B;
+                for (int i=0; i < n; ++i) a[i] = -a[i];
+                break;
+            case OP_POS:
+                break;
+
+            case OP_FUNC:
+                switch(ins.arg)
+                {
+                case 0:
+                    a = stack + (++sidx) * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun0)ins.fun)();
+                    break;
+                case 1:
+                    a = stack + sidx * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun1)ins.fun)(a[i]);
+                    break;
+                case 2:
+                    sidx -= 1;
+                    a = stack + sidx * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun2)ins.fun)(a[i], a[B+i]);
+                    break;
+                case 3:
+                    sidx -= 2;
+                    a = stack + sidx * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun3)ins.fun)(a[i], a[B+i], a[2*B+i]);
+                    break;
+                case 4:
+                    sidx -= 3;
+                    a = stack + sidx * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun4)ins.fun)(a[i], a[B+i], a[2*B+i], a[3*B+i]);
+                    break;
+                case 5:
+                    sidx -= 4;
+                    a = stack + sidx * B;
+                    for (int i=0; i < n; ++i) a[i] = (*(Fun5)ins.fun)(a[i], a[B+i], a[2*B+i], a[3*B+i], a[4*B+i]);
+                    break;
+                }
+                break;
+            case OP_FUNC_MULTI:
+                sidx -= ins.arg - 1;
+                a = stack + sidx * B;
+                for (int i=0; i < n; ++i)
+                {
+                    for (int k=0; k < ins.arg; ++k)
+                    {
+                        args[k] = a[k*B+i];
+                    }
+                    a[i] = (*(FunN)ins.fun)(args, ins.arg);
+                }
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        for (int r=0; r < numResults; ++r)
+        {
+            if (results[r] != nullptr)
+            {
+                const ValueType* res = stack + (r + 1) * B;
+                std::copy(res, res + n, results[r] + off);
+            }
+        }
+    }
+}
+
+} // end namespace otb
@@ -0,0 +1,309 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef __otbKernelScriptProgram_h
+#define __otbKernelScriptProgram_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+
+#include "utils/muParser/muParserDef.h"
+#include "utils/muParser/muParserCallback.h"
+#include "nmotbsupplfilters_export.h"
+
+namespace otb
+{
+
+/*! \class KernelScriptProgram
+ *  \brief Flat bytecode representation of a (NMScriptableKernelFilter2)
+ *         kernel script
+ *
+ *  The whole kernel script, i.e. all statements including for-loops,
+ *  is translated into a single instruction sequence operating on a
+ *  contiguous frame of variable slots. Variables, constants, images
+ *  and tables are resolved at compile time, so that executing the
+ *  script doesn't involve any name lookups or per-statement parser
+ *  calls.
+ *
+ *  Statements are parsed with muParser's grammar, i.e. operator
+ *  precedence, associativity and the ternary operator are handled
+ *  the same way as in mu::ParserBase::CreateRPN, and the same
+ *  bytecode optimisations (constant folding, var*c+d, x^2 ...)
+ *  are applied. Math functions are called via the very callbacks
+ *  registered with the parser. Hence, the compiled program produces
+ *  the same results as evaluating the script statement by statement
+ *  with muParser.
+ *
+ *  The image, table and neighbour distance functions (kwinVal, tabVal,
+ *  neigDist) are mapped onto dedicated instructions which are served
+ *  by the accessor object passed to Execute; their administrative
+ *  arguments (thid, addr) are evaluated but not used.
+ *
+ *  If a statement can't be compiled (e.g. unknown token, syntax error),
+ *  AddStatement returns false and the caller is supposed to fall back
+ *  on muParser, which reports the error in detail.
+ */
+class NMOTBSUPPLFILTERS_EXPORT KernelScriptProgram
+{
+public:
+    typedef mu::value_type ValueType;
+
+    /*! Names and values a statement may refer to */
+    struct SymbolTable
+    {
+        SymbolTable() : funs(nullptr) {}
+
+        // variable name -> frame slot
+        std::map<std::string, int> vars;
+        // numeric constants
+        std::map<std::string, ValueType> consts;
+        // string constants -> image (kernel) index
+        std::map<std::string, int> images;
+        // string constants -> table index
+        std::map<std::string, int> tables;
+        // the parser's function definitions
+        const mu::funmap_type* funs;
+    };
+
+    KernelScriptProgram();
+
+    void Clear();
+
+    /*! Registers a variable slot; returns the slot index */
+    int AddSlot(const std::string& name);
+    int GetSlot(const std::string& name) const;
+    int GetNumSlots() const {return static_cast<int>(m_SlotNames.size());}
+    const std::string& GetSlotName(int slot) const {return m_SlotNames[slot];}
+
+    /*! Compiles the RHS expression of a script statement whose
+     *  value is stored in slot target; returns false and sets
+     *  errMsg, if the expression can't be compiled
+     */
+    bool AddStatement(const std::string& expr, int target,
+                      const SymbolTable& symbols, std::string& errMsg);
+
+    /*! Assembles the compiled statements into the final program
+     *  according to the filter's script block structure (s.
+     *  NMScriptableKernelFilter2::m_vecBlockLen)
+     */
+    bool Link(const std::vector<int>& blockLen, std::string& errMsg);
+
+    bool IsValid() const {return m_bLinked;}
+
+    /*! Minimum size of the stack buffer to be passed to Execute */
+    int GetStackSize() const {return m_StackSize;}
+
+    /*! Statement level access for batched (column-wise) evaluation */
+    int GetNumStatements() const {return static_cast<int>(m_Statements.size());}
+    int GetStatementTarget(int idx) const {return m_Statements[idx].target;}
+    int GetNumResults(int idx) const {return m_Statements[idx].numResults;}
+
+    /*! Returns true, if statement idx can be evaluated for many
+     *  elements at once with ExecuteBatch, i.e. it neither assigns
+     *  variables nor calls kwinVal, tabVal, neigDist or any
+     *  non-optimisable (e.g. random number) function
+     */
+    bool IsBatchable(int idx) const;
+
+    /*! Collects the slots read by statement idx */
+    void GetReadSlots(int idx, std::vector<int>& slots) const;
+
+    /*! Determines for each statement and each slot the index of the
+     *  (preceding) statement providing the slot's value when the
+     *  statements are evaluated in order (-1: the slot isn't written
+     *  by any preceding statement); returns false if any statement
+     *  depends on a value computed for the previous element, i.e. if
+     *  it reads a slot before it is written in the same pass
+     */
+    bool ResolveBatchSources(std::vector<std::vector<int> >& sources) const;
+
+    /*! Evaluates statement idx for numValues elements; values[slot]
+     *  points to the slot's values, which are either read as an array
+     *  (strides[slot] == 1) or as a single scalar (strides[slot] == 0);
+     *  the r-th result of the statement is written into results[r]
+     *  (skipped if nullptr), which has to hold numValues values; work
+     *  is a scratch buffer managed by the function
+     *
+     *  The statement is evaluated operation by operation over blocks of
+     *  BatchBlockSize elements, i.e. the per instruction loops are plain
+     *  array loops the compiler is free to vectorise. Both branches of
+     *  an if-else are evaluated and blended according to the condition.
+     */
+    void ExecuteBatch(int idx, const ValueType* const* values, const int* strides,
+                      int numValues, ValueType* const* results,
+                      std::vector<ValueType>& work) const;
+
+    static const int BatchBlockSize = 256;
+
+    /*! Executes the program; TAccessor has to provide
+     *
+     *      ValueType KernelValue(int image, ValueType idx)
+     *      ValueType TableValue(int table, ValueType col, ValueType row)
+     *      ValueType NeighbourDistance(ValueType idx)
+     */
+    template<class TAccessor>
+    void Execute(ValueType* slots, ValueType* stack, TAccessor& acc) const;
+
+    enum OpCode
+    {
+        OP_LE = 0, OP_GE, OP_NEQ, OP_EQ, OP_LT, OP_GT,
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW,
+        OP_LAND, OP_LOR,
+        OP_ASSIGN,
+        OP_IF, OP_ELSE, OP_ENDIF,
+        OP_VAL, OP_VAR, OP_VARMUL,
+        OP_VARPOW2, OP_VARPOW3, OP_VARPOW4,
+        OP_NEG, OP_POS,
+        OP_FUNC, OP_FUNC_MULTI,
+        OP_KWIN, OP_TAB, OP_NDIST,
+        OP_STORE, OP_JZ_SLOT, OP_JMP,
+        OP_END
+    };
+
+    struct Instruction
+    {
+        int op;
+        // slot, jump target, image, table, argc
+        int arg;
+        // OP_STORE: index of the result on the stack
+        int arg2;
+        ValueType data;
+        ValueType data2;
+        mu::generic_fun_type fun;
+    };
+
+protected:
+
+    bool compile(const std::string& expr, const SymbolTable& symbols,
+                 std::vector<Instruction>& rpn, int& numResults,
+                 int& stackSize, std::string& errMsg) const;
+
+    void emitBlock(int start, int end, const std::vector<int>& blockLen);
+    void emitStatement(int idx);
+
+    struct Statement
+    {
+        std::vector<Instruction> rpn;
+        int target;
+        int numResults;
+    };
+
+    std::vector<std::string> m_SlotNames;
+    std::map<std::string, int> m_SlotIndex;
+    std::vector<Statement> m_Statements;
+    std::vector<Instruction> m_Code;
+    int m_StackSize;
+    bool m_bLinked;
+};
+
+template<class TAccessor>
+inline void
+KernelScriptProgram::Execute(ValueType* slots, ValueType* stack, TAccessor& acc) const
+{
+    typedef ValueType (*Fun0)();
+    typedef ValueType (*Fun1)(ValueType);
+    typedef ValueType (*Fun2)(ValueType, ValueType);
+    typedef ValueType (*Fun3)(ValueType, ValueType, ValueType);
+    typedef ValueType (*Fun4)(ValueType, ValueType, ValueType, ValueType);
+    typedef ValueType (*Fun5)(ValueType, ValueType, ValueType, ValueType, ValueType);
+    typedef ValueType (*FunN)(const ValueType*, int);
+
+    // note: as in muParser, the stack is filled starting at index 1
+    ValueType buf;
+    int sidx = 0;
+    const Instruction* const base = &m_Code[0];
+    for (const Instruction* ins = base; ins->op != OP_END; ++ins)
+    {
+        switch(ins->op)
+        {
+        case OP_LE:  --sidx; stack[sidx] = stack[sidx] <= stack[sidx+1]; continue;
+        case OP_GE:  --sidx; stack[sidx] = stack[sidx] >= stack[sidx+1]; continue;
+        case OP_NEQ: --sidx; stack[sidx] = stack[sidx] != stack[sidx+1]; continue;
+        case OP_EQ:  --sidx; stack[sidx] = stack[sidx] == stack[sidx+1]; continue;
+        case OP_LT:  --sidx; stack[sidx] = stack[sidx] <  stack[sidx+1]; continue;
+        case OP_GT:  --sidx; stack[sidx] = stack[sidx] >  stack[sidx+1]; continue;
+        case OP_ADD: --sidx; stack[sidx] += stack[sidx+1]; continue;
+        case OP_SUB: --sidx; stack[sidx] -= stack[sidx+1]; continue;
+        case OP_MUL: --sidx; stack[sidx] *= stack[sidx+1]; continue;
+        case OP_DIV: --sidx; stack[sidx] /= stack[sidx+1]; continue;
+        case OP_POW: --sidx; stack[sidx] = std::pow(stack[sidx], stack[sidx+1]); continue;
+        case OP_LAND: --sidx; stack[sidx] = stack[sidx] && stack[sidx+1]; continue;
+        case OP_LOR:  --sidx; stack[sidx] = stack[sidx] || stack[sidx+1]; continue;
+
+        case OP_ASSIGN: --sidx; stack[sidx] = slots[ins->arg] = stack[sidx+1]; continue;
+
+        case OP_IF:
+            if (stack[sidx--] == 0)
+            {
+                ins = base + ins->arg - 1;
+            }
+            continue;
+        case OP_ELSE:
+            ins = base + ins->arg - 1;
+            continue;
+
+        case OP_VAL: stack[++sidx] = ins->data2; continue;
+        case OP_VAR: stack[++sidx] = slots[ins->arg]; continue;
+        case OP_VARMUL: stack[++sidx] = slots[ins->arg] * ins->data + ins->data2; continue;
+        case OP_VARPOW2: buf = slots[ins->arg]; stack[++sidx] = buf*buf; continue;
+        case OP_VARPOW3: buf = slots[ins->arg]; stack[++sidx] = buf*buf*buf; continue;
+        case OP_VARPOW4: buf = slots[ins->arg]; stack[++sidx] = buf*buf*buf*buf; continue;
+
+        case OP_NEG: stack[sidx] = -stack[sidx]; continue;
+        case OP_POS: continue;
+
+        case OP_FUNC:
+            switch(ins->arg)
+            {
+            case 0: stack[++sidx] = (*(Fun0)ins->fun)(); continue;
+            case 1: stack[sidx] = (*(Fun1)ins->fun)(stack[sidx]); continue;
+            case 2: sidx -= 1; stack[sidx] = (*(Fun2)ins->fun)(stack[sidx], stack[sidx+1]); continue;
+            case 3: sidx -= 2; stack[sidx] = (*(Fun3)ins->fun)(stack[sidx], stack[sidx+1], stack[sidx+2]); continue;
+            case 4: sidx -= 3; stack[sidx] = (*(Fun4)ins->fun)(stack[sidx], stack[sidx+1], stack[sidx+2], stack[sidx+3]); continue;
+            case 5: sidx -= 4; stack[sidx] = (*(Fun5)ins->fun)(stack[sidx], stack[sidx+1], stack[sidx+2], stack[sidx+3], stack[sidx+4]); continue;
+            }
+            continue;
+        case OP_FUNC_MULTI:
+            sidx -= ins->arg - 1;
+            stack[sidx] = (*(FunN)ins->fun)(&stack[sidx], ins->arg);
+            continue;
+
+        // kwinVal(img, idx, thid, addr)
+        case OP_KWIN: sidx -= 2; stack[sidx] = acc.KernelValue(ins->arg, stack[sidx]); continue;
+        // tabVal(tab, col, row, addr)
+        case OP_TAB: sidx -= 2; stack[sidx] = acc.TableValue(ins->arg, stack[sidx], stack[sidx+1]); continue;
+        // neigDist(idx, addr)
+        case OP_NDIST: sidx -= 1; stack[sidx] = acc.NeighbourDistance(stack[sidx]); continue;
+
+        case OP_STORE: slots[ins->arg] = stack[ins->arg2]; sidx = 0; continue;
+        case OP_JZ_SLOT:
+            if (slots[ins->arg] == 0)
+            {
+                ins = base + ins->arg2 - 1;
+            }
+            continue;
+        case OP_JMP: ins = base + ins->arg - 1; continue;
+
+        default:
+            continue;
+        }
+    }
+}
+
+} // end namespace otb
+
+#endif // __otbKernelScriptProgram_h
@@ -31,6 +31,7 @@ void MultiParser::PrintSelf(std::ostream& os, itk::Indent indent) const
 
 
 MultiParser::MultiParser()
+    : m_BatchMode(BATCH_UNKNOWN)
 {
     // define constants
     m_InternalMultiParser.DefineConst( "e",      CONST_E );
@@ -48,8 +49,8 @@ MultiParser::MultiParser()
     // init fmod function
     m_InternalMultiParser.DefineFun("fmod", (mu::fun_type2)MultiParser::calcMod);
 
-    m_InternalMultiParser.DefineFun("unifdist_int", (mu::fun_type2)MultiParser::unifdist_int);
-    m_InternalMultiParser.DefineFun("unifdist_real", (mu::fun_type2)MultiParser::unifdist_real);
+    m_InternalMultiParser.DefineFun("unifdist_int", (mu::fun_type2)MultiParser::unifdist_int, false);
+    m_InternalMultiParser.DefineFun("unifdist_real", (mu::fun_type2)MultiParser::unifdist_real, false);
 
     m_InternalMultiParser.DefineFun("lndist", (mu::fun_type2)MultiParser::lndist, false);
     m_InternalMultiParser.DefineFun("normdist", (mu::fun_type2)MultiParser::normdist, false);
@@ -64,6 +65,7 @@ MultiParser::~MultiParser()
 void MultiParser::SetExpr(const std::string & Expression)
 {
   m_InternalMultiParser.SetExpr(Expression);
+  m_BatchMode = BATCH_UNKNOWN;
 }
 
 MultiParser::ValueType MultiParser::Eval()
@@ -84,21 +86,145 @@ const MultiParser::CharType* MultiParser::ValidNameChars() const
 void MultiParser::DefineVar(const StringType &sName, MultiParser::ValueType *fVar)
 {
   m_InternalMultiParser.DefineVar(sName, fVar);
+  m_BatchMode = BATCH_UNKNOWN;
 }
 
 void MultiParser::DefineConst(const StringType &sName, const ValueType &val)
 {
     m_InternalMultiParser.DefineConst(sName, val);
+    m_BatchMode = BATCH_UNKNOWN;
 }
 
 void MultiParser::DefineStrConst(const StringType &sName, const StringType& sVal)
 {
     m_InternalMultiParser.DefineStrConst(sName, sVal);
+    m_BatchMode = BATCH_UNKNOWN;
 }
 
 void MultiParser::ClearVar()
 {
   m_InternalMultiParser.ClearVar();
+  m_BatchMode = BATCH_UNKNOWN;
+}
+
+void MultiParser::DefineBatchVar(const StringType &sName, const ValueType* values)
+{
+    for (size_t v=0; v < m_BatchVarNames.size(); ++v)
+    {
+        if (m_BatchVarNames[v] == sName)
+        {
+            m_BatchVarValues[v] = values;
+            return;
+        }
+    }
+
+    m_BatchVarNames.push_back(sName);
+    m_BatchVarValues.push_back(values);
+}
+
+void MultiParser::ClearBatchVars()
+{
+    m_BatchVarNames.clear();
+    m_BatchVarValues.clear();
+}
+
+void MultiParser::compileBatchProgram()
+{
+    m_BatchProgram.Clear();
+    m_BatchMode = BATCH_ELEMENTWISE;
+
+    const std::map<std::string, ValueType*>& vars = m_InternalMultiParser.GetVar();
+
+    // slot 0 takes the (unused) statement target
+    KernelScriptProgram::SymbolTable symbols;
+    m_BatchProgram.AddSlot("$result");
+    m_BatchSlotScalars.assign(1, nullptr);
+    std::map<std::string, ValueType*>::const_iterator vit = vars.begin();
+    for (; vit != vars.end(); ++vit)
+    {
+        symbols.vars[vit->first] = m_BatchProgram.AddSlot(vit->first);
+        m_BatchSlotScalars.push_back(vit->second);
+    }
+
+    const mu::valmap_type& consts = m_InternalMultiParser.GetConst();
+    symbols.consts.insert(consts.begin(), consts.end());
+    symbols.funs = &m_InternalMultiParser.GetFunDef();
+
+    // anything we can't compile is left to the internal
+    // parser, which reports any errors in detail
+    std::string errMsg;
+    if (    m_BatchProgram.AddStatement(m_InternalMultiParser.GetExpr(), 0, symbols, errMsg)
+         && m_BatchProgram.IsBatchable(0)
+       )
+    {
+        m_BatchMode = BATCH_COLUMNWISE;
+    }
+}
+
+void MultiParser::EvalBatch(int numValues, ValueType* const* results, int numResults)
+{
+    if (m_BatchMode == BATCH_UNKNOWN)
+    {
+        this->compileBatchProgram();
+    }
+
+    if (m_BatchMode == BATCH_COLUMNWISE)
+    {
+        // scalars are read from their DefineVar address
+        m_BatchSlotValues.assign(m_BatchSlotScalars.begin(), m_BatchSlotScalars.end());
+        m_BatchSlotStrides.assign(m_BatchSlotScalars.size(), 0);
+
+        for (size_t v=0; v < m_BatchVarNames.size(); ++v)
+        {
+            const int slot = m_BatchProgram.GetSlot(m_BatchVarNames[v]);
+            if (slot > 0)
+            {
+                m_BatchSlotValues[slot] = m_BatchVarValues[v];
+                m_BatchSlotStrides[slot] = 1;
+            }
+        }
+
+        const int nres = m_BatchProgram.GetNumResults(0);
+        std::vector<ValueType*> res(nres, nullptr);
+        for (int r=0; r < nres && r < numResults; ++r)
+        {
+            res[r] = results[r];
+        }
+
+        m_BatchProgram.ExecuteBatch(0, &m_BatchSlotValues[0], &m_BatchSlotStrides[0],
+                                    numValues, &res[0], m_BatchWork);
+        return;
+    }
+
+    // element-wise evaluation
+    const std::map<std::string, ValueType*>& vars = m_InternalMultiParser.GetVar();
+    std::vector<ValueType*> scalars(m_BatchVarNames.size(), nullptr);
+    for (size_t v=0; v < m_BatchVarNames.size(); ++v)
+    {
+        std::map<std::string, ValueType*>::const_iterator it = vars.find(m_BatchVarNames[v]);
+        if (it != vars.end())
+        {
+            scalars[v] = it->second;
+        }
+    }
+
+    for (int i=0; i < numValues; ++i)
+    {
+        for (size_t v=0; v < scalars.size(); ++v)
+        {
+            if (scalars[v] != nullptr)
+            {
+                *scalars[v] = m_BatchVarValues[v][i];
+            }
+        }
+
+        int nNum = 0;
+        const ValueType* val = m_InternalMultiParser.Eval(nNum);
+        for (int r=0; r < nNum && r < numResults; ++r)
+        {
+            results[r][i] = val[r];
+        }
+    }
 }
 
 bool MultiParser::CheckExpr()
@@ -138,6 +264,18 @@ const std::map<std::string, MultiParser::ValueType*>& MultiParser::GetVar() cons
   return m_InternalMultiParser.GetVar();
 }
 
+// Get the map with the numeric constants
+const mu::valmap_type& MultiParser::GetConst() const
+{
+  return m_InternalMultiParser.GetConst();
+}
+
+// Get the map with the function definitions
+const mu::funmap_type& MultiParser::GetFunDef() const
+{
+  return m_InternalMultiParser.GetFunDef();
+}
+
 //// Get the map with the functions
 //MultiParser::FunctionMapType MultiParser::GetFunList() const
 //{
@@ -23,6 +23,8 @@
 #include "utils/muParser/muParser.h"
 #include "utils/muParser/muParserDef.h"
 #include <random>
+#include <vector>
+#include "otbKernelScriptProgram.h"
 //#include "otbsuppl/filters/otbMultiParserImpl.h"
 
 #include "nmotbsupplfilters_export.h"
@@ -85,8 +87,30 @@ public:
     void DefineFun(const mu::string_type& sName, T funPtr, bool bIsOptimisable=true)
     {
         m_InternalMultiParser.DefineFun(sName, funPtr, bIsOptimisable);
+        m_BatchMode = BATCH_UNKNOWN;
     }
 
+    /** Binds an array of values to the (already defined) variable
+     *  sName for subsequent calls of EvalBatch; variables without
+     *  an array binding are read from their DefineVar address
+     */
+    void DefineBatchVar(const StringType& sName, const ValueType* values);
+
+    /** Removes all array bindings */
+    void ClearBatchVars();
+
+    /** Evaluates the expression for numValues elements at once;
+     *  the r-th result of the i-th element is written into
+     *  results[r][i] (r < numResults)
+     *
+     *  Expressions which don't assign variables nor call
+     *  non-optimisable functions (e.g. rand, unifdist_int, normdist)
+     *  are evaluated column-wise, i.e. operation by operation for a
+     *  whole block of elements; any other expression is evaluated
+     *  element by element with the internal parser.
+     */
+    void EvalBatch(int numValues, ValueType* const* results, int numResults);
+
     /** set of valid name charcters, i.e. variables, constants **/
     const CharType* ValidNameChars() const;
 
@@ -99,6 +123,12 @@ public:
     /** Return the list of variables */
     const std::map<std::string, MultiParser::ValueType*>& GetVar() const;
 
+    /** Return the map of numeric constants */
+    const mu::valmap_type& GetConst() const;
+
+    /** Return the map of function definitions */
+    const mu::funmap_type& GetFunDef() const;
+
     /** Return a map of function names and associated number of arguments */
     //FunctionMapType GetFunList() const;
 
@@ -170,6 +200,21 @@ private:
 
     mu::Parser m_InternalMultiParser;
 
+    // batched evaluation
+    void compileBatchProgram();
+
+    typedef enum {BATCH_UNKNOWN = 0, BATCH_COLUMNWISE, BATCH_ELEMENTWISE} BatchModeType;
+    BatchModeType m_BatchMode;
+    KernelScriptProgram m_BatchProgram;
+
+    std::vector<StringType> m_BatchVarNames;
+    std::vector<const ValueType*> m_BatchVarValues;
+
+    std::vector<ValueType*> m_BatchSlotScalars;
+    std::vector<const ValueType*> m_BatchSlotValues;
+    std::vector<int> m_BatchSlotStrides;
+    std::vector<ValueType> m_BatchWork;
+
 }; // end class
 
 }//end namespace otb
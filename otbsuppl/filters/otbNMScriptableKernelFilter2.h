@@ -53,10 +53,12 @@
 #include "itkNumericTraits.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
 #include "itkNMConstShapedNeighborhoodIterator.h"
 #include "itkNeighborhood.h"
 
 #include "otbMultiParser.h"
+#include "otbKernelScriptProgram.h"
 #include "otbAttributeTable.h"
 #include "otbSQLiteTable.h"
 
@@ -226,6 +228,27 @@ namespace otb
  *      rand(lower_limit, upper_limit)  : returns random value using std::rand
  *      fmod(numerator, denominator)    : returns remainder of float division using std::fmod
  *
+ *   EXECUTION MODES
+ *
+ *      PARSER (default)  : each statement is evaluated by its own muParser
+ *                          instance (reference implementation)
+ *      COMPILED          : the kernel script is translated into a single
+ *                          bytecode program (s. otb::KernelScriptProgram),
+ *                          which evaluates all statements and for loops
+ *                          without any variable lookups and per statement
+ *                          parser calls; if the script can't be compiled,
+ *                          the filter falls back on PARSER mode; scripts
+ *                          without kernel (neighbourhood) and for loops
+ *                          are evaluated a whole image row at a time, unless
+ *                          they use assignment operators, random numbers,
+ *                          or values computed for the previous pixel;
+ *                          use VERIFY to check a script's results first
+ *      VERIFY            : runs both of the above for each pixel and throws
+ *                          an exception as soon as any of the script variables
+ *                          differ; note: scripts using random numbers (rand,
+ *                          unifdist_int, unifdist_real, lndist, normdist)
+ *                          can't be verified
+ *
  */
 template <class TInputImage, class TOutputImage>
 class NMOTBSUPPLFILTERS_EXPORT NMScriptableKernelFilter2 :
@@ -313,6 +336,10 @@ public:
    *  the output image pixel value */
   itkSetStringMacro(OutputVarName)
 
+  /*! Set the execution mode <PARSER, COMPILED, VERIFY> */
+  itkSetStringMacro(ExecutionMode)
+  itkGetStringMacro(ExecutionMode)
+
   /*! Set the nodata value of the computation */
   //itkSetMacro(Nodata, OutputPixelType)
   void SetNodata(const double& nodata);
@@ -390,6 +417,16 @@ protected:
   void ParseCommand(bool binit, const std::string& expr,
                     std::vector<std::vector<ParserPointerType> >& initScript);
   void RunInitScript();
+  void CompileScript();
+  void VerifyProgram(const itk::ThreadIdType& threadId,
+                     const std::vector<ParserValue>& slots,
+                     const IndexType& index);
+  void ExecuteBatchRows(const itk::ThreadIdType& threadId,
+                        const OutputImageRegionType& outputRegionForThread,
+                        std::vector<InputRegionIterator>& vInputIt,
+                        OutputRegionIterator& outIt,
+                        std::vector<ParserValue>& progSlots,
+                        itk::ProgressReporter& progress);
   void LoopInit(int i, int th,
                 std::vector<ParserPointerType>& vParsers,
                 std::vector<int>& vBlockLen);
@@ -430,6 +467,32 @@ protected:
       }
   }
 
+  /*!
+   * \brief ProgramAccessor provides the image, table and neighbour
+   *        distance values to the compiled kernel script of a thread
+   */
+  struct ProgramAccessor
+  {
+      inline ParserValue KernelValue(int img, ParserValue idx)
+      {
+          return static_cast<ParserValue>(vIter[img]->GetPixel(static_cast<long>(idx)));
+      }
+
+      inline ParserValue TableValue(int tab, ParserValue col, ParserValue row)
+      {
+          return (*vTable[tab])[static_cast<size_t>(col)][static_cast<size_t>(row)];
+      }
+
+      inline ParserValue NeighbourDistance(ParserValue idx)
+      {
+          return (*pNeigDist)[static_cast<size_t>(idx)];
+      }
+
+      std::vector<InputShapedIterator*> vIter;
+      std::vector<std::vector<std::vector<ParserValue> >*> vTable;
+      std::vector<ParserValue>* pNeigDist;
+  };
+
 private:
   NMScriptableKernelFilter2(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -450,6 +513,7 @@ private:
   std::string m_KernelShape;
   std::string m_OutputVarName;
   std::string m_WorkspacePath;
+  std::string m_ExecutionMode;
 
   otb::SQLiteTable::Pointer m_AuxTable;
 
@@ -500,6 +564,18 @@ private:
   // or a for loop including the test and counter variables
   std::vector<int> m_vecBlockLen;
 
+  // the compiled kernel script per thread (empty, if the
+  // script is evaluated by the parsers) and the frame slots
+  // of the coordinates, the first (non-kernel) image value
+  // and the output value
+  std::vector<KernelScriptProgram> m_vecPrograms;
+  int m_ProgXCoordSlot;
+  int m_ProgImgSlot;
+  int m_ProgOutSlot;
+  // per statement and slot: the statement providing the slot's
+  // value during row-wise evaluation (empty: evaluate per pixel)
+  std::vector<std::vector<int> > m_ProgBatchSources;
+
   // the over- and underflows per thread
   std::vector<long long> m_NumOverflows;
   std::vector<long long> m_NumUnderflows;
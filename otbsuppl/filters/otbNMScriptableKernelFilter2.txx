@@ -84,6 +84,11 @@ NMScriptableKernelFilter2<TInputImage, TOutputImage>
 
     m_OutputVarName = "out";
 
+    m_ExecutionMode = "PARSER";
+    m_ProgXCoordSlot = -1;
+    m_ProgImgSlot = -1;
+    m_ProgOutSlot = -1;
+
     m_Nodata = itk::NumericTraits<OutputPixelType>::NonpositiveMin();
 
     m_This = static_cast<double>(reinterpret_cast<uintptr_t>(this));
@@ -159,6 +164,7 @@ NMScriptableKernelFilter2<TInputImage, TOutputImage>
 
     m_vecParsers.clear();
     m_mapParserName.clear();
+    m_vecPrograms.clear();
 
     m_mapNameAuxValue.clear();
     m_mapXCoord.clear();
@@ -406,6 +412,9 @@ NMScriptableKernelFilter2<TInputImage, TOutputImage>
         std::vector<int> blen;
         this->ParseScript(false, iscript, blen);
 
+        // translate the parsed script into bytecode
+        this->CompileScript();
+
         m_minVal.resize(m_mapNameAuxValue[0].size(), itk::NumericTraits<ParserValue>::max());
         m_maxVal.resize(m_mapNameAuxValue[0].size(), itk::NumericTraits<ParserValue>::NonpositiveMin());
         m_sumVal.resize(m_mapNameAuxValue[0].size(),0);
@@ -464,6 +473,336 @@ NMScriptableKernelFilter2<TInputImage, TOutputImage>
     }
 }
 
+template <class TInputImage, class TOutputImage>
+void
+NMScriptableKernelFilter2<TInputImage, TOutputImage>
+::CompileScript()
+{
+    m_vecPrograms.clear();
+    m_ProgXCoordSlot = -1;
+    m_ProgImgSlot = -1;
+    m_ProgOutSlot = -1;
+    m_ProgBatchSources.clear();
+
+    if (m_ExecutionMode == "PARSER")
+    {
+        return;
+    }
+
+    // the output value is read from the script variables,
+    // so we leave undefined outputs to the parsers
+    if (    m_mapNameAuxValue.size() == 0
+        ||  m_mapNameAuxValue.at(0).find(m_OutputVarName) == m_mapNameAuxValue.at(0).end()
+       )
+    {
+        NMProcWarn(<< "The output variable '" << m_OutputVarName
+                   << "' is not defined by the KernelScript! "
+                   << "Falling back on PARSER execution mode!");
+        return;
+    }
+
+    // the slot layout of the program frame is the same for all threads:
+    //   aux values (in map order), x-, y-, zcoord, image values (no kernel)
+    std::string errMsg;
+    bool bCompiled = true;
+    const int nthreads = this->GetNumberOfThreads();
+    m_vecPrograms.resize(nthreads);
+    for (int th=0; th < nthreads && bCompiled; ++th)
+    {
+        KernelScriptProgram& prog = m_vecPrograms[th];
+        std::map<const ParserValue*, int> mapPtrSlot;
+
+        std::map<std::string, ParserValue>::iterator auxIt = m_mapNameAuxValue[th].begin();
+        while (auxIt != m_mapNameAuxValue[th].end())
+        {
+            mapPtrSlot[&auxIt->second] = prog.AddSlot(auxIt->first);
+            ++auxIt;
+        }
+
+        // note: slot names of non-aux values are decorated, so
+        // they can't clash with any of the user variables
+        m_ProgXCoordSlot = prog.AddSlot("$xcoord");
+        mapPtrSlot[&m_mapXCoord[th]] = m_ProgXCoordSlot;
+        mapPtrSlot[&m_mapYCoord[th]] = prog.AddSlot("$ycoord");
+        mapPtrSlot[&m_mapZCoord[th]] = prog.AddSlot("$zcoord");
+
+        KernelScriptProgram::SymbolTable symbols;
+        int idx = 0;
+        if (m_NumNeighbourPixel)
+        {
+            typename std::map<std::string, InputImageType*>::const_iterator imgIt = m_mapNameImg.begin();
+            while (imgIt != m_mapNameImg.end())
+            {
+                symbols.images[imgIt->first] = idx++;
+                ++imgIt;
+            }
+        }
+        else
+        {
+            m_ProgImgSlot = prog.GetNumSlots();
+            std::map<std::string, ParserValue>::iterator valIt = m_mapNameImgValue[m_This][th].begin();
+            while (valIt != m_mapNameImgValue[m_This][th].end())
+            {
+                mapPtrSlot[&valIt->second] = prog.AddSlot("$" + valIt->first);
+                ++valIt;
+            }
+        }
+
+        idx = 0;
+        std::map<std::string, std::vector<std::vector<ParserValue> > >::const_iterator tabIt =
+                m_mapNameTable[m_This].begin();
+        while (tabIt != m_mapNameTable[m_This].end())
+        {
+            symbols.tables[tabIt->first] = idx++;
+            ++tabIt;
+        }
+
+        for (int p=0; p < m_vecParsers[th].size() && bCompiled; ++p)
+        {
+            const ParserPointerType& parser = m_vecParsers[th][p];
+
+            symbols.vars.clear();
+            std::map<std::string, ParserValue*>::const_iterator varIt = parser->GetVar().begin();
+            while (varIt != parser->GetVar().end() && bCompiled)
+            {
+                std::map<const ParserValue*, int>::const_iterator slotIt = mapPtrSlot.find(varIt->second);
+                if (slotIt != mapPtrSlot.end())
+                {
+                    symbols.vars[varIt->first] = slotIt->second;
+                }
+                else
+                {
+                    errMsg = "Unknown variable '" + varIt->first + "'";
+                    bCompiled = false;
+                }
+                ++varIt;
+            }
+
+            symbols.consts = parser->GetConst();
+            symbols.funs = &parser->GetFunDef();
+
+            const int target = prog.GetSlot(m_mapParserName[parser.GetPointer()]);
+            bCompiled = bCompiled && prog.AddStatement(parser->GetExpr(), target, symbols, errMsg);
+        }
+
+        bCompiled = bCompiled && prog.Link(m_vecBlockLen, errMsg);
+        m_ProgOutSlot = prog.GetSlot(m_OutputVarName);
+    }
+
+    if (!bCompiled)
+    {
+        NMProcWarn(<< "Failed compiling the KernelScript: " << errMsg
+                   << " - Falling back on PARSER execution mode!");
+        m_vecPrograms.clear();
+        m_ProgXCoordSlot = -1;
+        m_ProgImgSlot = -1;
+        m_ProgOutSlot = -1;
+        return;
+    }
+
+    // scripts without kernel and for loops, whose statements only
+    // depend on the current pixel, are evaluated row by row
+    // (s. ExecuteBatchRows)
+    if (m_NumNeighbourPixel == 0 && m_ExecutionMode == "COMPILED")
+    {
+        const KernelScriptProgram& prog = m_vecPrograms[0];
+        bool bBatch = true;
+        for (int s=0; s < prog.GetNumStatements() && bBatch; ++s)
+        {
+            bBatch = m_vecBlockLen[s] == 1 && prog.IsBatchable(s);
+        }
+
+        if (bBatch && prog.ResolveBatchSources(m_ProgBatchSources))
+        {
+            NMDebugAI(<< "KernelScript is evaluated row by row" << std::endl);
+        }
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+NMScriptableKernelFilter2<TInputImage, TOutputImage>
+::VerifyProgram(const itk::ThreadIdType& threadId,
+                const std::vector<ParserValue>& slots,
+                const IndexType& index)
+{
+    int n = 0;
+    std::map<std::string, ParserValue>::const_iterator auxIt = m_mapNameAuxValue[threadId].begin();
+    while (auxIt != m_mapNameAuxValue[threadId].end())
+    {
+        const ParserValue& pv = auxIt->second;
+        const ParserValue& cv = slots[n];
+        if (!(pv == cv || (pv != pv && cv != cv)))
+        {
+            std::stringstream sstr;
+            sstr.precision(17);
+            sstr << "Verification error at pixel " << index << ": "
+                 << "'" << auxIt->first << "' = " << pv << " (parser) vs. "
+                 << cv << " (compiled)!";
+            NMProcErr(<< "MapKernelScript2: "  << sstr.str())
+            KernelScriptParserError ve;
+            ve.SetLocation(ITK_LOCATION);
+            ve.SetDescription(sstr.str());
+            throw ve;
+        }
+        ++n;
+        ++auxIt;
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+NMScriptableKernelFilter2<TInputImage, TOutputImage>
+::ExecuteBatchRows(const itk::ThreadIdType& threadId,
+                   const OutputImageRegionType& outputRegionForThread,
+                   std::vector<InputRegionIterator>& vInputIt,
+                   OutputRegionIterator& outIt,
+                   std::vector<ParserValue>& progSlots,
+                   itk::ProgressReporter& progress)
+{
+    const KernelScriptProgram& prog = m_vecPrograms[threadId];
+    const int numStmts = prog.GetNumStatements();
+    const int numSlots = prog.GetNumSlots();
+    const int numImgs = vInputIt.size();
+    const long rowLen = outputRegionForThread.GetSize(0);
+
+    // row buffers of the statements' results, the input
+    // images' values and the x coordinate
+    std::vector<std::vector<ParserValue> > vStmtRow(numStmts, std::vector<ParserValue>(rowLen));
+    std::vector<std::vector<ParserValue> > vImgRow(numImgs, std::vector<ParserValue>(rowLen));
+    std::vector<ParserValue> vXRow(rowLen);
+
+    // bind the statements' variable slots either to one of the above
+    // row buffers or to the frame, e.g. for y-, zcoord and constant
+    // script variables
+    std::vector<std::vector<const ParserValue*> > vValues(numStmts, std::vector<const ParserValue*>(numSlots));
+    std::vector<std::vector<int> > vStrides(numStmts, std::vector<int>(numSlots, 0));
+    std::vector<std::vector<ParserValue*> > vResults(numStmts);
+    std::vector<int> lastWriter(numSlots, -1);
+    for (int s=0; s < numStmts; ++s)
+    {
+        for (int v=0; v < numSlots; ++v)
+        {
+            const int src = m_ProgBatchSources[s][v];
+            if (src >= 0)
+            {
+                vValues[s][v] = &vStmtRow[src][0];
+                vStrides[s][v] = 1;
+            }
+            else if (v == m_ProgXCoordSlot)
+            {
+                vValues[s][v] = &vXRow[0];
+                vStrides[s][v] = 1;
+            }
+            else if (v >= m_ProgImgSlot && v < m_ProgImgSlot + numImgs)
+            {
+                vValues[s][v] = &vImgRow[v - m_ProgImgSlot][0];
+                vStrides[s][v] = 1;
+            }
+            else
+            {
+                vValues[s][v] = &progSlots[v];
+            }
+        }
+
+        // the variable is assigned the last result of a statement
+        vResults[s].resize(prog.GetNumResults(s), nullptr);
+        vResults[s].back() = &vStmtRow[s][0];
+        lastWriter[prog.GetStatementTarget(s)] = s;
+    }
+
+    const int outStmt = lastWriter[m_ProgOutSlot];
+    const ParserValue* outRow = outStmt >= 0 ? &vStmtRow[outStmt][0] : &progSlots[m_ProgOutSlot];
+    const int outStride = outStmt >= 0 ? 1 : 0;
+
+    std::vector<ParserValue> work;
+    while (!outIt.IsAtEnd() && !this->GetAbortGenerateData())
+    {
+        const IndexType rowIdx = outIt.GetIndex();
+        m_mapYCoord[threadId] = static_cast<double>(m_Origin[1])
+                + static_cast<double>(rowIdx[1])
+                    * static_cast<double>(m_Spacing[1]);
+
+        if (m_Radius.GetSizeDimension() == 3)
+        {
+            m_mapZCoord[threadId] = static_cast<double>(m_Origin[2])
+                    + static_cast<double>(rowIdx[2])
+                        * static_cast<double>(m_Spacing[2]);
+        }
+        progSlots[m_ProgXCoordSlot+1] = m_mapYCoord[threadId];
+        progSlots[m_ProgXCoordSlot+2] = m_mapZCoord[threadId];
+
+        // fetch the row's image values
+        long n = 0;
+        for (; n < rowLen; ++n)
+        {
+            vXRow[n] = static_cast<double>(m_Origin[0])
+                    + static_cast<double>(rowIdx[0] + n)
+                        * static_cast<double>(m_Spacing[0]);
+
+            typename std::map<std::string, InputImageType*>::const_iterator inImgIt = m_mapNameImg.begin();
+            for (int cnt=0; cnt < numImgs; ++cnt, ++inImgIt)
+            {
+                const InputPixelType pv = vInputIt[cnt].Get();
+                if (    pv < itk::NumericTraits<ParserValue>::NonpositiveMin()
+                     || pv > itk::NumericTraits<ParserValue>::max()
+                   )
+                {
+                    std::stringstream sstr;
+                    sstr << "Data type range error: Image " << inImgIt->first
+                         << "'s value is out of the parser's data type range!" << std::endl;
+                    NMProcErr(<< "MapKernelScript2: "  << sstr.str())
+                    KernelScriptParserError dre;
+                    dre.SetLocation(ITK_LOCATION);
+                    dre.SetDescription(sstr.str());
+                    throw dre;
+                }
+                vImgRow[cnt][n] = static_cast<ParserValue>(pv);
+                ++vInputIt[cnt];
+            }
+        }
+
+        // let's run the script now
+        for (int s=0; s < numStmts; ++s)
+        {
+            prog.ExecuteBatch(s, &vValues[s][0], &vStrides[s][0], n, &vResults[s][0], work);
+        }
+
+        for (long p=0; p < n; ++p)
+        {
+            const ParserValue outValue = outRow[p * outStride];
+            if (outValue < itk::NumericTraits<OutputPixelType>::NonpositiveMin())
+            {
+                ++m_NumUnderflows[threadId];
+                outIt.Set(m_Nodata);
+            }
+            else if (outValue > itk::NumericTraits<OutputPixelType>::max())
+            {
+                ++m_NumOverflows[threadId];
+                outIt.Set(m_Nodata);
+            }
+            else
+            {
+                outIt.Set(static_cast<OutputPixelType>(outValue));
+            }
+
+            ++outIt;
+            ++m_vthPixelCounter[threadId];
+            progress.CompletedPixel();
+        }
+
+        // keep the frame up to date, i.e. the script variables
+        // hold the values computed for the last pixel
+        for (int v=0; v < numSlots && n > 0; ++v)
+        {
+            if (lastWriter[v] >= 0)
+            {
+                progSlots[v] = vStmtRow[lastWriter[v]][n-1];
+            }
+        }
+    }
+}
+
 template <class TInputImage, class TOutputImage>
 void
 NMScriptableKernelFilter2<TInputImage, TOutputImage>
@@ -1102,6 +1441,48 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
     // support progress methods/callbacks
     itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
 
+    // set up the compiled script's frame for this thread, i.e.
+    // initialise the slots with the current variable values
+    const bool bCompiled = !m_vecPrograms.empty();
+    const bool bParse = !bCompiled || m_ExecutionMode == "VERIFY";
+    std::vector<ParserValue> progSlots;
+    std::vector<ParserValue> progStack;
+    ProgramAccessor progAcc;
+    if (bCompiled)
+    {
+        const KernelScriptProgram& prog = m_vecPrograms[threadId];
+        progSlots.resize(prog.GetNumSlots(), 0);
+        progStack.resize(prog.GetStackSize(), 0);
+
+        int n = 0;
+        std::map<std::string, ParserValue>::const_iterator auxIt = m_mapNameAuxValue[threadId].begin();
+        while (auxIt != m_mapNameAuxValue[threadId].end())
+        {
+            progSlots[n++] = auxIt->second;
+            ++auxIt;
+        }
+
+        if (m_ProgImgSlot >= 0)
+        {
+            n = m_ProgImgSlot;
+            std::map<std::string, ParserValue>::const_iterator valIt = m_mapNameImgValue[m_This][threadId].begin();
+            while (valIt != m_mapNameImgValue[m_This][threadId].end())
+            {
+                progSlots[n++] = valIt->second;
+                ++valIt;
+            }
+        }
+
+        std::map<std::string, std::vector<std::vector<ParserValue> > >::iterator tabIt =
+                m_mapNameTable[m_This].begin();
+        while (tabIt != m_mapNameTable[m_This].end())
+        {
+            progAcc.vTable.push_back(&tabIt->second);
+            ++tabIt;
+        }
+        progAcc.pNeigDist = &m_mapNeighbourDistance[m_This];
+    }
+
     if (m_NumNeighbourPixel)
     {
         // set up the neighborhood iteration, e.g. create a list of boundary faces
@@ -1135,6 +1516,18 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
                 ++inImgIt;
             }
 
+            // note: the iterators are re-assigned for each face, so
+            // we only need to collect their addresses once
+            if (bCompiled && progAcc.vIter.empty())
+            {
+                inImgIt = m_mapNameImg.begin();
+                while (inImgIt != m_mapNameImg.end())
+                {
+                    progAcc.vIter.push_back(&mapInputIter[inImgIt->first]);
+                    ++inImgIt;
+                }
+            }
+
             //unsigned int neighborhoodSize = vInputIt[0].Size();
             outIt = OutputRegionIterator(output, *fit);
             outIt.GoToBegin();
@@ -1158,40 +1551,58 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
                 }
 
                 // let's run the script now
-                try
+                if (bCompiled)
                 {
-                    for (int p=0; p < m_vecParsers[threadId].size(); ++p)
-                    {
-                        const ParserPointerType& exprParser = m_vecParsers[threadId][p];
-                        ParserValue& exprVal = m_mapNameAuxValue[threadId][m_mapParserName[exprParser.GetPointer()]];
-                        exprVal = exprParser->Eval();
+                    progSlots[m_ProgXCoordSlot]   = m_mapXCoord[threadId];
+                    progSlots[m_ProgXCoordSlot+1] = m_mapYCoord[threadId];
+                    progSlots[m_ProgXCoordSlot+2] = m_mapZCoord[threadId];
+                    m_vecPrograms[threadId].Execute(&progSlots[0], &progStack[0], progAcc);
+                }
 
-                        if (m_vecBlockLen[p] > 1)
+                if (bParse)
+                {
+                    try
+                    {
+                        for (int p=0; p < m_vecParsers[threadId].size(); ++p)
                         {
-                            Loop(p, threadId);
-                            p += m_vecBlockLen[p]-1;
+                            const ParserPointerType& exprParser = m_vecParsers[threadId][p];
+                            ParserValue& exprVal = m_mapNameAuxValue[threadId][m_mapParserName[exprParser.GetPointer()]];
+                            exprVal = exprParser->Eval();
+
+                            if (m_vecBlockLen[p] > 1)
+                            {
+                                Loop(p, threadId);
+                                p += m_vecBlockLen[p]-1;
+                            }
                         }
                     }
-                }
-                catch (mu::ParserError& evalerr)
-                {
-                    std::stringstream errmsg;
-                    errmsg << std::endl
-                           << "Message:    " << evalerr.GetMsg() << std::endl
-                           << "Formula:    " << evalerr.GetExpr() << std::endl
-                           << "Token:      " << evalerr.GetToken() << std::endl
-                           << "Position:   " << evalerr.GetPos() << std::endl << std::endl;
-                    NMProcErr(<< "MapKernelScript2: "  << errmsg.str())
+                    catch (mu::ParserError& evalerr)
+                    {
+                        std::stringstream errmsg;
+                        errmsg << std::endl
+                               << "Message:    " << evalerr.GetMsg() << std::endl
+                               << "Formula:    " << evalerr.GetExpr() << std::endl
+                               << "Token:      " << evalerr.GetToken() << std::endl
+                               << "Position:   " << evalerr.GetPos() << std::endl << std::endl;
+                        NMProcErr(<< "MapKernelScript2: "  << errmsg.str())
+
+                        KernelScriptParserError kse;
+                        kse.SetDescription(errmsg.str());
+                        kse.SetLocation(ITK_LOCATION);
+                        throw kse;
+                    }
 
-                    KernelScriptParserError kse;
-                    kse.SetDescription(errmsg.str());
-                    kse.SetLocation(ITK_LOCATION);
-                    throw kse;
+                    if (bCompiled)
+                    {
+                        this->VerifyProgram(threadId, progSlots, outIt.GetIndex());
+                    }
                 }
 
                 // now we set the result value for the
                 //const ParserValue outValue = m_vOutputValue[threadId];
-                const ParserValue outValue = m_mapNameAuxValue[threadId][m_OutputVarName];
+                const ParserValue outValue = bParse
+                        ? m_mapNameAuxValue[threadId][m_OutputVarName]
+                        : progSlots[m_ProgOutSlot];
                 if (outValue < itk::NumericTraits<OutputPixelType>::NonpositiveMin())
                 {
                     ++m_NumUnderflows[threadId];
@@ -1239,6 +1650,14 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
         }
         outIt = OutputRegionIterator(output, outputRegionForThread);
 
+        // scripts qualifying for row-wise evaluation are processed
+        // here in full, i.e. the per pixel loop below is skipped
+        if (bCompiled && !m_ProgBatchSources.empty())
+        {
+            this->ExecuteBatchRows(threadId, outputRegionForThread, vInputIt,
+                                   outIt, progSlots, progress);
+        }
+
         while (!outIt.IsAtEnd() && !this->GetAbortGenerateData())
         {
 
@@ -1277,7 +1696,14 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
 
                 if (!bDataTypeRangeError)
                 {
-                    m_mapNameImgValue[m_This][threadId][inImgIt->first] = static_cast<ParserValue>(pv);
+                    if (bParse)
+                    {
+                        m_mapNameImgValue[m_This][threadId][inImgIt->first] = static_cast<ParserValue>(pv);
+                    }
+                    if (bCompiled)
+                    {
+                        progSlots[m_ProgImgSlot + cnt] = static_cast<ParserValue>(pv);
+                    }
                 }
                 else
                 {
@@ -1295,40 +1721,58 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
             }
 
             // let's run the script now
-            try
+            if (bCompiled)
             {
-                for (int p=0; p < m_vecParsers[threadId].size(); ++p)
-                {
-                    const ParserPointerType& exprParser = m_vecParsers[threadId][p];
-                    ParserValue& exprVal = m_mapNameAuxValue[threadId][m_mapParserName[exprParser.GetPointer()]];
-                    exprVal = exprParser->Eval();
+                progSlots[m_ProgXCoordSlot]   = m_mapXCoord[threadId];
+                progSlots[m_ProgXCoordSlot+1] = m_mapYCoord[threadId];
+                progSlots[m_ProgXCoordSlot+2] = m_mapZCoord[threadId];
+                m_vecPrograms[threadId].Execute(&progSlots[0], &progStack[0], progAcc);
+            }
 
-                    if (m_vecBlockLen[p] > 1)
+            if (bParse)
+            {
+                try
+                {
+                    for (int p=0; p < m_vecParsers[threadId].size(); ++p)
                     {
-                        Loop(p, threadId);
-                        p += m_vecBlockLen[p]-1;
+                        const ParserPointerType& exprParser = m_vecParsers[threadId][p];
+                        ParserValue& exprVal = m_mapNameAuxValue[threadId][m_mapParserName[exprParser.GetPointer()]];
+                        exprVal = exprParser->Eval();
+
+                        if (m_vecBlockLen[p] > 1)
+                        {
+                            Loop(p, threadId);
+                            p += m_vecBlockLen[p]-1;
+                        }
                     }
                 }
-            }
-            catch (mu::ParserError& evalerr)
-            {
-                std::stringstream errmsg;
-                errmsg << std::endl
-                       << "Message:    " << evalerr.GetMsg() << std::endl
-                       << "Formula:    " << evalerr.GetExpr() << std::endl
-                       << "Token:      " << evalerr.GetToken() << std::endl
-                       << "Position:   " << evalerr.GetPos() << std::endl << std::endl;
-                NMProcErr(<< "MapKernelScript2: "  << errmsg.str())
-
-                KernelScriptParserError kse;
-                kse.SetDescription(errmsg.str());
-                kse.SetLocation(ITK_LOCATION);
-                throw kse;
+                catch (mu::ParserError& evalerr)
+                {
+                    std::stringstream errmsg;
+                    errmsg << std::endl
+                           << "Message:    " << evalerr.GetMsg() << std::endl
+                           << "Formula:    " << evalerr.GetExpr() << std::endl
+                           << "Token:      " << evalerr.GetToken() << std::endl
+                           << "Position:   " << evalerr.GetPos() << std::endl << std::endl;
+                    NMProcErr(<< "MapKernelScript2: "  << errmsg.str())
+
+                    KernelScriptParserError kse;
+                    kse.SetDescription(errmsg.str());
+                    kse.SetLocation(ITK_LOCATION);
+                    throw kse;
+                }
+
+                if (bCompiled)
+                {
+                    this->VerifyProgram(threadId, progSlots, outIt.GetIndex());
+                }
             }
 
             // now we set the result value for the
             //const ParserValue outValue = m_vOutputValue[threadId];
-            const ParserValue outValue = m_mapNameAuxValue[threadId][m_OutputVarName];
+            const ParserValue outValue = bParse
+                    ? m_mapNameAuxValue[threadId][m_OutputVarName]
+                    : progSlots[m_ProgOutSlot];
             if (outValue < itk::NumericTraits<OutputPixelType>::NonpositiveMin())
             {
                 ++m_NumUnderflows[threadId];
@@ -1355,6 +1799,19 @@ NMScriptableKernelFilter2< TInputImage, TOutputImage>
         }
     }
 
+    // write the script variables back into the value store
+    // for the summary statistics and the next chunk of data
+    if (bCompiled && !bParse)
+    {
+        int n = 0;
+        std::map<std::string, ParserValue>::iterator auxIt = m_mapNameAuxValue[threadId].begin();
+        while (auxIt != m_mapNameAuxValue[threadId].end())
+        {
+            auxIt->second = progSlots[n++];
+            ++auxIt;
+        }
+    }
+
 //    CALLGRIND_STOP_INSTRUMENTATION;
 //    CALLGRIND_DUMP_STATS;
 }
@@ -1522,6 +1979,7 @@ NMScriptableKernelFilter2<TInputImage, TOutputImage>
     int nimgs = m_mapNameImg.size();
     os << indent << "Radius:    " << m_Radius << std::endl;
     os << indent << "KernelShape: " << m_KernelShape << std::endl;
+    os << indent << "ExecutionMode: " << m_ExecutionMode << std::endl;
     os << indent << "No. Parser: " << m_mapParserName.size()  - nimgs << std::endl;
     os << indent << "Images: ";
 
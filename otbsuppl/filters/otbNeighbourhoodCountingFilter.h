@@ -51,6 +51,9 @@
 //#include "itkOptMeanImageFilter.h"
 //#else
 
+#include <vector>
+#include <algorithm>
+
 #include "nmlog.h"
 #include "itkImageToImageFilter.h"
 #include "itkImage.h"
@@ -63,8 +66,17 @@ namespace otb
 /*  \brief Counts occurrence of a particular pixel value in the central's pixel
  *         neighbourhood and writes it into the output image's corresponding pixel.
  *
+ *  Several test values may be specified, in which case the pixels matching
+ *  any of them are counted. The neighbourhood is either the rectangular
+ *  (2*Radius+1) window (default) or, if Circular is set, the ellipse
+ *  (circle) inscribed into that window. Beyond the image boundary, the
+ *  edge pixels are replicated (zero flux Neumann boundary condition).
  *
- *
+ *  For 1D and 2D images, each thread builds a summed-area table of the
+ *  test value indicator image of its (padded) region, so a rectangular
+ *  count takes four lookups and a circular count two lookups per row of
+ *  the window, regardless of the window's width. 3D images are processed
+ *  with a neighbourhood iterator.
  */
 template <class TInputImage, class TOutputImage>
 class ITK_EXPORT NeighbourhoodCountingFilter :
@@ -106,7 +118,20 @@ public:
   itkSetMacro(Radius, InputSizeType);
 
   /** Set the pixel value to look out for during the counting. */
-  itkSetMacro(Testvalue, InputRealType);
+  void SetTestvalue(InputRealType val)
+  {
+    std::vector<int> vals(1, static_cast<int>(val));
+    this->SetTestvalues(vals);
+  }
+
+  /** Set the pixel values to look out for during the counting */
+  void SetTestvalues(const std::vector<int>& vals);
+
+  /** Count the pixels of the ellipse (circle) inscribed into the
+   *  rectangular (2*Radius+1) neighbourhood only */
+  itkSetMacro(Circular, bool);
+  itkGetConstMacro(Circular, bool);
+  itkBooleanMacro(Circular);
 
   /** Get the radius of the neighbourhood used to compute the mean */
   itkGetConstReferenceMacro(Radius, InputSizeType);
@@ -141,12 +166,40 @@ protected:
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                             itk::ThreadIdType threadId );
 
+  void BeforeThreadedGenerateData();
+
+  /** Counts by means of a summed-area table (1D and 2D images) */
+  void SummedAreaGenerateData(const OutputImageRegionType& outputRegionForThread,
+                              itk::ThreadIdType threadId );
+
+  /** Counts by iterating over the neighbourhood (3D images) */
+  void NeighbourhoodGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                 itk::ThreadIdType threadId );
+
+  /** Whether an offset from the central pixel lies inside the window */
+  bool IsInsideWindow(const long* offset) const;
+
+  inline bool IsTestvalue(const InputPixelType& pix) const
+  {
+    const int val = static_cast<int>(pix);
+    if (m_Testvalues.size() == 1)
+      {
+      return val == m_Testvalues[0];
+      }
+    return std::binary_search(m_Testvalues.begin(), m_Testvalues.end(), val);
+  }
+
 private:
   NeighbourhoodCountingFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
   InputSizeType m_Radius;
-  int m_Testvalue;
+  std::vector<int> m_Testvalues;
+  bool m_Circular;
+
+  // half width of the (circular) window per row
+  // of the window (2D only)
+  std::vector<long> m_RowSpans;
 };
   
 } // end namespace itk
@@ -54,14 +54,83 @@
 #include "itkOffset.h"
 #include "itkProgressReporter.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
 template <class TInputImage, class TOutputImage>
 NeighbourhoodCountingFilter<TInputImage, TOutputImage>
 ::NeighbourhoodCountingFilter()
+  : m_Circular(false)
 {
   m_Radius.Fill(1);
+  m_Testvalues.push_back(0);
+}
+
+template <class TInputImage, class TOutputImage>
+void
+NeighbourhoodCountingFilter<TInputImage, TOutputImage>
+::SetTestvalues(const std::vector<int>& vals)
+{
+  std::vector<int> tv = vals;
+  std::sort(tv.begin(), tv.end());
+  tv.erase(std::unique(tv.begin(), tv.end()), tv.end());
+  if (tv != m_Testvalues)
+    {
+    m_Testvalues = tv;
+    this->Modified();
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+bool
+NeighbourhoodCountingFilter<TInputImage, TOutputImage>
+::IsInsideWindow(const long* offset) const
+{
+  if (!m_Circular)
+    {
+    return true;
+    }
+
+  double dist = 0.0;
+  for (unsigned int d=0; d < InputImageDimension; ++d)
+    {
+    const double rel = offset[d] / (m_Radius[d] + 0.5);
+    dist += rel * rel;
+    }
+  return dist <= 1.0;
+}
+
+template <class TInputImage, class TOutputImage>
+void
+NeighbourhoodCountingFilter<TInputImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  // work out the half width of the window for each
+  // of its rows (dy = -ry ... ry)
+  m_RowSpans.clear();
+  if (InputImageDimension > 2)
+    {
+    return;
+    }
+
+  const unsigned int ydim = InputImageDimension > 1 ? 1 : 0;
+  const long rx = static_cast<long>(m_Radius[0]);
+  const long ry = InputImageDimension > 1 ? static_cast<long>(m_Radius[ydim]) : 0;
+
+  long offset[InputImageDimension];
+  for (long dy=-ry; dy <= ry; ++dy)
+    {
+    long hw = rx;
+    offset[ydim] = dy;
+    offset[0] = hw;
+    while (hw >= 0 && !this->IsInsideWindow(offset))
+      {
+      offset[0] = --hw;
+      }
+    m_RowSpans.push_back(hw);
+    }
 }
 
 template <class TInputImage, class TOutputImage>
@@ -119,6 +188,120 @@ void
 NeighbourhoodCountingFilter< TInputImage, TOutputImage>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        itk::ThreadIdType threadId)
+{
+  if (InputImageDimension > 2)
+    {
+    this->NeighbourhoodGenerateData(outputRegionForThread, threadId);
+    }
+  else
+    {
+    this->SummedAreaGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template< class TInputImage, class TOutputImage>
+void
+NeighbourhoodCountingFilter< TInputImage, TOutputImage>
+::SummedAreaGenerateData(const OutputImageRegionType& outputRegionForThread,
+                         itk::ThreadIdType threadId)
+{
+  // the sums are computed modulo 2^32, which yields the exact
+  // window counts as long as those are smaller than 2^32
+  typedef unsigned int CountType;
+
+  typename OutputImageType::Pointer output = this->GetOutput();
+  typename  InputImageType::ConstPointer input  = this->GetInput();
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // (1D images are treated as images of one row)
+  const unsigned int ydim = InputImageDimension > 1 ? 1 : 0;
+  const long rx = static_cast<long>(m_Radius[0]);
+  const long ry = InputImageDimension > 1 ? static_cast<long>(m_Radius[ydim]) : 0;
+
+  const InputImageRegionType& inReg = input->GetBufferedRegion();
+  const long ix0 = inReg.GetIndex(0);
+  const long ixn = ix0 + static_cast<long>(inReg.GetSize(0)) - 1;
+  const long iy0 = InputImageDimension > 1 ? inReg.GetIndex(ydim) : 0;
+  const long iyn = InputImageDimension > 1 ? iy0 + static_cast<long>(inReg.GetSize(ydim)) - 1 : 0;
+  const long inWidth = static_cast<long>(inReg.GetSize(0));
+
+  const long ox0 = outputRegionForThread.GetIndex(0);
+  const long ow = static_cast<long>(outputRegionForThread.GetSize(0));
+  const long oy0 = InputImageDimension > 1 ? outputRegionForThread.GetIndex(ydim) : 0;
+  const long oh = InputImageDimension > 1 ? static_cast<long>(outputRegionForThread.GetSize(ydim)) : 1;
+
+  // summed-area table of the indicator image of the output region
+  // padded by the radius; pixels beyond the buffered region are
+  // replicated from its edges; sat(j, i) is the number of test value
+  // pixels in rows [0, j) and columns [0, i) of the padded region
+  const long sw = ow + 2 * rx + 1;
+  const long sh = oh + 2 * ry + 1;
+  std::vector<CountType> sat(static_cast<size_t>(sw) * sh, 0);
+
+  const InputPixelType* inBuf = input->GetBufferPointer();
+  for (long j=1; j < sh && !this->GetAbortGenerateData(); ++j)
+    {
+    const long y = std::min(std::max(oy0 - ry + j - 1, iy0), iyn);
+    const InputPixelType* inRow = inBuf + (y - iy0) * inWidth;
+
+    const CountType* prev = &sat[(j-1) * sw];
+    CountType* cur = &sat[j * sw];
+    CountType rowSum = 0;
+    for (long i=1; i < sw; ++i)
+      {
+      const long x = std::min(std::max(ox0 - rx + i - 1, ix0), ixn);
+      if (this->IsTestvalue(inRow[x - ix0]))
+        {
+        ++rowSum;
+        }
+      cur[i] = prev[i] + rowSum;
+      }
+    }
+
+  itk::ImageRegionIterator<OutputImageType> it(output, outputRegionForThread);
+  it.GoToBegin();
+  for (long j=0; j < oh && !this->GetAbortGenerateData(); ++j)
+    {
+    for (long i=0; i < ow; ++i, ++it)
+      {
+      CountType count = 0;
+      if (m_Circular)
+        {
+        // sum up the row spans of the window
+        for (long d=0; d <= 2 * ry; ++d)
+          {
+          const long hw = m_RowSpans[d];
+          if (hw < 0)
+            {
+            continue;
+            }
+          const CountType* top = &sat[(j + d) * sw];
+          const CountType* bot = top + sw;
+          const long c0 = i + rx - hw;
+          const long c1 = i + rx + hw + 1;
+          count += (bot[c1] - top[c1]) - (bot[c0] - top[c0]);
+          }
+        }
+      else
+        {
+        const CountType* top = &sat[j * sw];
+        const CountType* bot = &sat[(j + 2 * ry + 1) * sw];
+        const long c1 = i + 2 * rx + 1;
+        count = bot[c1] - top[c1] - bot[i] + top[i];
+        }
+
+      it.Set( static_cast<OutputPixelType>(count) );
+      progress.CompletedPixel();
+      }
+    }
+}
+
+template< class TInputImage, class TOutputImage>
+void
+NeighbourhoodCountingFilter< TInputImage, TOutputImage>
+::NeighbourhoodGenerateData(const OutputImageRegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId)
 {
   unsigned int i;
   itk::ZeroFluxNeumannBoundaryCondition<InputImageType> nbc;
@@ -139,18 +322,34 @@ NeighbourhoodCountingFilter< TInputImage, TOutputImage>
 
   // support progress methods/callbacks
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // the neighbourhood pixels inside the window
+  std::vector<unsigned int> window;
+  {
+    itk::ConstNeighborhoodIterator<InputImageType> nit(m_Radius, input, outputRegionForThread);
+    long offset[InputImageDimension];
+    for (i = 0; i < nit.Size(); ++i)
+      {
+      const typename itk::ConstNeighborhoodIterator<InputImageType>::OffsetType off = nit.GetOffset(i);
+      for (unsigned int d=0; d < InputImageDimension; ++d)
+        {
+        offset[d] = off[d];
+        }
+      if (this->IsInsideWindow(offset))
+        {
+        window.push_back(i);
+        }
+      }
+  }
   
   int count;
-  int val;
 
-  //std::cout << "all right, we're in ... " << std::endl;
   // Process each of the boundary faces.  These are N-d regions which border
   // the edge of the buffer.
   for (fit=faceList.begin(); fit != faceList.end(); ++fit)
     { 
     bit = itk::ConstNeighborhoodIterator<InputImageType>(m_Radius,
                                                     input, *fit);
-    unsigned int neighborhoodSize = bit.Size();
     it = itk::ImageRegionIterator<OutputImageType>(output, *fit);
     bit.OverrideBoundaryCondition(&nbc);
     bit.GoToBegin();
@@ -158,14 +357,12 @@ NeighbourhoodCountingFilter< TInputImage, TOutputImage>
     while ( ! bit.IsAtEnd() && !this->GetAbortGenerateData())
       {
       count = 0;
-      for (i = 0; i < neighborhoodSize; ++i)
+      for (i = 0; i < window.size(); ++i)
         {
-           val = static_cast<int>( bit.GetPixel(i) );
-           if (val == m_Testvalue)
+           if (this->IsTestvalue(bit.GetPixel(window[i])))
         	   ++count;
         }
       
-      // get the mean value
       it.Set( static_cast<OutputPixelType>(count) );
       
       ++bit;
@@ -173,8 +370,6 @@ NeighbourhoodCountingFilter< TInputImage, TOutputImage>
       progress.CompletedPixel();
       }
     }
-
-  //std::cout << "now we're out again!" << std::endl;
 }
 
 /**
@@ -189,7 +384,13 @@ NeighbourhoodCountingFilter<TInputImage, TOutput>
 {
   Superclass::PrintSelf( os, indent );
   os << indent << "Radius:    " << m_Radius << std::endl;
-  os << indent << "Testvalue: " << m_Testvalue << std::endl;
+  os << indent << "Testvalues:";
+  for (unsigned int v=0; v < m_Testvalues.size(); ++v)
+    {
+    os << " " << m_Testvalues[v];
+    }
+  os << std::endl;
+  os << indent << "Circular:  " << m_Circular << std::endl;
 
 }
 
@@ -0,0 +1,210 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef OTBPACKEDKEYHASHMAP_H_
+#define OTBPACKEDKEYHASHMAP_H_
+
+#include <vector>
+#include <cstddef>
+
+namespace otb
+{
+
+/** \class PackedKeyHashMap
+ *  \brief Open addressing (linear probing) hash map of fixed-length
+ *         keys of NumberOfWords 64-bit words onto non-negative
+ *         values
+ *
+ *  Keys and values are stored in flat arrays, so a lookup touches
+ *  (mostly) one cache line for the key and one for the value. The
+ *  table doubles its capacity once it is half full.
+ */
+class PackedKeyHashMap
+{
+public:
+    typedef unsigned long long WordType;
+
+    PackedKeyHashMap()
+        : m_NumWords(1), m_Mask(0), m_Size(0)
+    {
+        this->Init(1);
+    }
+
+    void Init(int numWords, size_t capacity=1024)
+    {
+        m_NumWords = numWords < 1 ? 1 : numWords;
+        size_t cap = 16;
+        while (cap < capacity)
+        {
+            cap <<= 1;
+        }
+        m_Mask = cap - 1;
+        m_Size = 0;
+        m_Keys.assign(cap * m_NumWords, 0);
+        m_Values.assign(cap, -1);
+    }
+
+    /** Removes all entries, but keeps the current capacity */
+    void Clear()
+    {
+        m_Size = 0;
+        m_Values.assign(m_Values.size(), -1);
+    }
+
+    int GetNumberOfWords() const {return m_NumWords;}
+    size_t Size() const {return m_Size;}
+
+    /** Memory (bytes) occupied by the table */
+    size_t GetMemorySize() const
+    {return m_Keys.size() * sizeof(WordType) + m_Values.size() * sizeof(long long);}
+
+    static inline size_t Hash(const WordType* key, int numWords)
+    {
+        WordType h = 0x9e3779b97f4a7c15ULL;
+        for (int w=0; w < numWords; ++w)
+        {
+            // splitmix64 finaliser
+            WordType z = key[w] + h;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            h = z ^ (z >> 31);
+        }
+        return static_cast<size_t>(h);
+    }
+
+    /** Returns the value of key; if the key isn't in the
+     *  map yet, it is inserted with value and inserted
+     *  is set to true
+     */
+    long long Insert(const WordType* key, long long value, bool& inserted)
+    {
+        if ((m_Size + 1) * 2 > m_Values.size())
+        {
+            this->Grow();
+        }
+
+        size_t slot = Hash(key, m_NumWords) & m_Mask;
+        while (m_Values[slot] >= 0)
+        {
+            if (this->KeyEquals(slot, key))
+            {
+                inserted = false;
+                return m_Values[slot];
+            }
+            slot = (slot + 1) & m_Mask;
+        }
+
+        WordType* skey = &m_Keys[slot * m_NumWords];
+        for (int w=0; w < m_NumWords; ++w)
+        {
+            skey[w] = key[w];
+        }
+        m_Values[slot] = value;
+        ++m_Size;
+        inserted = true;
+        return value;
+    }
+
+    /** Returns a pointer to the value of key
+     *  or NULL if the key isn't in the map
+     */
+    long long* Find(const WordType* key)
+    {
+        size_t slot = Hash(key, m_NumWords) & m_Mask;
+        while (m_Values[slot] >= 0)
+        {
+            if (this->KeyEquals(slot, key))
+            {
+                return &m_Values[slot];
+            }
+            slot = (slot + 1) & m_Mask;
+        }
+        return 0;
+    }
+
+    /** Calls func(const WordType* key, long long value)
+     *  for each entry of the map
+     */
+    template <class TFunc>
+    void ForEach(TFunc func) const
+    {
+        for (size_t slot=0; slot < m_Values.size(); ++slot)
+        {
+            if (m_Values[slot] >= 0)
+            {
+                func(&m_Keys[slot * m_NumWords], m_Values[slot]);
+            }
+        }
+    }
+
+protected:
+
+    inline bool KeyEquals(size_t slot, const WordType* key) const
+    {
+        const WordType* skey = &m_Keys[slot * m_NumWords];
+        for (int w=0; w < m_NumWords; ++w)
+        {
+            if (skey[w] != key[w])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Grow()
+    {
+        std::vector<WordType> oldKeys;
+        std::vector<long long> oldValues;
+        oldKeys.swap(m_Keys);
+        oldValues.swap(m_Values);
+
+        const size_t cap = oldValues.size() * 2;
+        m_Mask = cap - 1;
+        m_Keys.assign(cap * m_NumWords, 0);
+        m_Values.assign(cap, -1);
+
+        for (size_t o=0; o < oldValues.size(); ++o)
+        {
+            if (oldValues[o] < 0)
+            {
+                continue;
+            }
+
+            const WordType* key = &oldKeys[o * m_NumWords];
+            size_t slot = Hash(key, m_NumWords) & m_Mask;
+            while (m_Values[slot] >= 0)
+            {
+                slot = (slot + 1) & m_Mask;
+            }
+            WordType* skey = &m_Keys[slot * m_NumWords];
+            for (int w=0; w < m_NumWords; ++w)
+            {
+                skey[w] = key[w];
+            }
+            m_Values[slot] = oldValues[o];
+        }
+    }
+
+    int m_NumWords;
+    size_t m_Mask;
+    size_t m_Size;
+    std::vector<WordType> m_Keys;
+    std::vector<long long> m_Values;
+};
+
+} // end namespace otb
+
+#endif /* OTBPACKEDKEYHASHMAP_H_ */
@@ -0,0 +1,245 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef OTBPARALLELRADIXSORT_H_
+#define OTBPARALLELRADIXSORT_H_
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+
+#include "itkMultiThreader.h"
+
+namespace otb
+{
+
+template <size_t TSize> struct RadixUIntType;
+template <> struct RadixUIntType<1> {typedef unsigned char Type;};
+template <> struct RadixUIntType<2> {typedef unsigned short Type;};
+template <> struct RadixUIntType<4> {typedef unsigned int Type;};
+template <> struct RadixUIntType<8> {typedef unsigned long long Type;};
+
+/** \struct RadixSortKey
+ *  \brief Maps a value of type T onto an unsigned integer of the
+ *         same size, such that the integers sort like the values
+ *
+ *  Floating point values are ordered as -inf < ... < -0 < +0 < ... < +inf;
+ *  NaNs are sorted to the ends, depending on their sign.
+ */
+template <class T,
+          bool bFloat = std::is_floating_point<T>::value,
+          bool bSigned = std::is_signed<T>::value>
+struct RadixSortKey
+{
+    // unsigned integer
+    typedef typename RadixUIntType<sizeof(T)>::Type KeyType;
+
+    static inline KeyType Get(const T& val)
+    {
+        return static_cast<KeyType>(val);
+    }
+};
+
+template <class T>
+struct RadixSortKey<T, false, true>
+{
+    // signed integer: flip the sign bit
+    typedef typename RadixUIntType<sizeof(T)>::Type KeyType;
+
+    static inline KeyType Get(const T& val)
+    {
+        return static_cast<KeyType>(val) ^ (KeyType(1) << (sizeof(T) * 8 - 1));
+    }
+};
+
+template <class T>
+struct RadixSortKey<T, true, true>
+{
+    // floating point: flip all bits of negative values,
+    // and just the sign bit of positive values
+    typedef typename RadixUIntType<sizeof(T)>::Type KeyType;
+
+    static inline KeyType Get(const T& val)
+    {
+        KeyType bits;
+        std::memcpy(&bits, &val, sizeof(T));
+        const KeyType sign = KeyType(1) << (sizeof(T) * 8 - 1);
+        return (bits & sign) ? static_cast<KeyType>(~bits) : static_cast<KeyType>(bits | sign);
+    }
+};
+
+/** \class ParallelRadixSort
+ *  \brief Stable LSD radix sort of unsigned integer keys and their
+ *         associated (index) values
+ *
+ *  Each pass sorts by one byte of the key: every thread counts the
+ *  keys of its contiguous chunk of the input, and then scatters them
+ *  into its own range of each bucket, which keeps the sort stable.
+ *  Passes over bytes which are the same for all keys are skipped.
+ *
+ *  Memory: the keys and values are double buffered for the duration
+ *  of the sort, i.e. 2 * n * (sizeof(TKey) + sizeof(TValue)) bytes.
+ */
+template <class TKey, class TValue>
+class ParallelRadixSort
+{
+public:
+    ParallelRadixSort()
+        : m_NumThreads(1), m_MinChunkSize(1 << 16)
+    {}
+
+    /** Sets the maximum number of threads used for sorting */
+    void SetNumberOfThreads(int numThreads)
+    {
+        m_NumThreads = numThreads < 1 ? 1 : numThreads;
+    }
+
+    /** Sorts keys in ascending order and permutes values accordingly;
+     *  both vectors must be of the same size
+     */
+    void Sort(std::vector<TKey>& keys, std::vector<TValue>& values)
+    {
+        const size_t n = keys.size();
+        if (n < 2 || values.size() != n)
+        {
+            return;
+        }
+
+        m_Keys[0] = &keys[0];
+        m_Values[0] = &values[0];
+
+        std::vector<TKey> tmpKeys(n);
+        std::vector<TValue> tmpValues(n);
+        m_Keys[1] = &tmpKeys[0];
+        m_Values[1] = &tmpValues[0];
+
+        m_Size = n;
+        size_t nthreads = n / m_MinChunkSize;
+        nthreads = nthreads < 1 ? 1 : nthreads;
+        nthreads = nthreads > static_cast<size_t>(m_NumThreads) ? m_NumThreads : nthreads;
+        m_Counts.assign(nthreads * 256, 0);
+
+        itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+        threader->SetNumberOfThreads(nthreads);
+        threader->SetSingleMethod(this->SortFromThreader, this);
+
+        m_Src = 0;
+        for (m_Shift = 0; m_Shift < static_cast<int>(sizeof(TKey)) * 8; m_Shift += 8)
+        {
+            m_Phase = 0;
+            threader->SingleMethodExecute();
+
+            // turn the counts into the start position of each
+            // thread's range within each bucket
+            size_t pos = 0;
+            bool bSkip = false;
+            for (int b=0; b < 256 && !bSkip; ++b)
+            {
+                size_t bucket = 0;
+                for (size_t t=0; t < nthreads; ++t)
+                {
+                    const size_t cnt = m_Counts[t * 256 + b];
+                    m_Counts[t * 256 + b] = pos;
+                    pos += cnt;
+                    bucket += cnt;
+                }
+                bSkip = bucket == n;
+            }
+
+            if (bSkip)
+            {
+                continue;
+            }
+
+            m_Phase = 1;
+            threader->SingleMethodExecute();
+            m_Src = 1 - m_Src;
+        }
+
+        if (m_Src == 1)
+        {
+            keys.swap(tmpKeys);
+            values.swap(tmpValues);
+        }
+    }
+
+protected:
+
+    static ITK_THREAD_RETURN_TYPE SortFromThreader(void* arg)
+    {
+        itk::MultiThreader::ThreadInfoStruct* info =
+                static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+        ParallelRadixSort* sorter = static_cast<ParallelRadixSort*>(info->UserData);
+
+        sorter->SortChunk(info->ThreadID, info->NumberOfThreads);
+
+        return ITK_THREAD_RETURN_VALUE;
+    }
+
+    void SortChunk(int threadId, int numThreads)
+    {
+        const size_t beg = m_Size / numThreads * threadId
+                           + (static_cast<size_t>(threadId) < m_Size % numThreads ? threadId : m_Size % numThreads);
+        const size_t end = beg + m_Size / numThreads
+                           + (static_cast<size_t>(threadId) < m_Size % numThreads ? 1 : 0);
+
+        const TKey* keys = m_Keys[m_Src];
+        size_t* counts = &m_Counts[threadId * 256];
+        const int shift = m_Shift;
+
+        if (m_Phase == 0)
+        {
+            for (int b=0; b < 256; ++b)
+            {
+                counts[b] = 0;
+            }
+
+            for (size_t i=beg; i < end; ++i)
+            {
+                ++counts[(keys[i] >> shift) & 0xff];
+            }
+        }
+        else
+        {
+            const TValue* values = m_Values[m_Src];
+            TKey* dstKeys = m_Keys[1 - m_Src];
+            TValue* dstValues = m_Values[1 - m_Src];
+
+            for (size_t i=beg; i < end; ++i)
+            {
+                const size_t pos = counts[(keys[i] >> shift) & 0xff]++;
+                dstKeys[pos] = keys[i];
+                dstValues[pos] = values[i];
+            }
+        }
+    }
+
+    int m_NumThreads;
+    size_t m_MinChunkSize;
+
+    // state of the current sort
+    TKey* m_Keys[2];
+    TValue* m_Values[2];
+    std::vector<size_t> m_Counts;
+    size_t m_Size;
+    int m_Src;
+    int m_Shift;
+    int m_Phase;
+};
+
+} // end namespace otb
+
+#endif /* OTBPARALLELRADIXSORT_H_ */
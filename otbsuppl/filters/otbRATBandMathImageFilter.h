@@ -187,6 +187,19 @@ public:
   itkGetMacro(UseTableColumnCache, bool)
   itkBooleanMacro(UseTableColumnCache)
 
+  /** Number of column pages (see otb::SQLiteTable::SetCacheSize)
+   *  each thread keeps in memory for cell lookups in SQLite
+   *  based attribute tables; 0 (default) disables the cache */
+  itkSetMacro(TableCacheSize, long long)
+  itkGetMacro(TableCacheSize, long long)
+
+  /** Memory (MiB) available for binding referenced table columns
+   *  to dense arrays indexed by pixel value (default: 512); tables
+   *  exceeding the remaining budget are accessed through the
+   *  (cached) table API instead; 0 disables column binding */
+  itkSetMacro(ColumnBindingMemoryCap, long long)
+  itkGetMacro(ColumnBindingMemoryCap, long long)
+
   void ResetPipeline();
 
 protected :
@@ -199,6 +212,8 @@ protected :
   void AfterThreadedGenerateData();
 
   void CacheTableColumns(int idx);
+  void BindTableColumns(unsigned int nbInputImages);
+  void RestoreTableCacheSize(void);
 
 private :
   RATBandMathImageFilter(const Self&); //purposely not implemented
@@ -221,7 +236,21 @@ private :
   OriginType                            m_Origin;
 
   bool                                  m_UseTableColumnCache;
+  long long                             m_TableCacheSize;
+  /** page cache size of the tables before we've set m_TableCacheSize;
+   *  the thread-0 tables are shared with the caller */
+  std::vector<std::pair<AttributeTable::Pointer, long long> >  m_PrevTableCacheSize;
   std::vector<std::map<int, std::map<long long, double> > >  m_TableColumnCache;
+
+  /** column binding: values of the numeric columns of input j
+   *  are stored at m_VBindValues[j][c][pixel value - m_VBindOffset[j]] */
+  long long                             m_ColumnBindingMemoryCap;
+  itk::TimeStamp                        m_ColumnBindingTime;
+  std::vector<char>                     m_VColumnBound;
+  std::vector<long long>                m_VBindOffset;
+  std::vector<unsigned long long>       m_VBindRange;
+  std::vector< std::vector< std::vector<double> > > m_VBindValues;
+  std::vector< std::vector<double> >    m_VBindNodata;
   long                                  m_UnderflowCount;
   long                                  m_OverflowCount;
   itk::Array<long>                      m_ThreadUnderflow;
@@ -233,6 +262,7 @@ private :
   std::vector< std::vector<int> > 	m_VTabAttr;
   std::vector< std::vector< ColumnType > > m_VAttrTypes;
   std::vector< std::vector< std::vector<double> > >	m_VAttrValues;
+  std::vector< std::vector< std::string > >          m_VAttrVarName;
 
 };
 
@@ -75,6 +75,7 @@
 
 #include <iostream>
 #include <string>
+#include <algorithm>
 
 namespace otb
 {
@@ -96,6 +97,8 @@ RATBandMathImageFilter<TImage>
     m_ThreadOverflow.SetSize(1);
     m_ConcatChar = "__";
     m_UseTableColumnCache = false;
+    m_TableCacheSize = 0;
+    m_ColumnBindingMemoryCap = 512;
 
     for (int t=0; t < this->GetNumberOfThreads(); ++t)
     {
@@ -320,7 +323,10 @@ template<class TImage>
 void RATBandMathImageFilter<TImage>
 ::ResetPipeline()
 {
+    this->RestoreTableCacheSize();
     m_TableColumnCache.clear();
+    m_VColumnBound.clear();
+    m_VBindValues.clear();
     /*
     m_VAttrTypes.clear();
     m_VAttrValues.clear();
@@ -401,6 +407,141 @@ void RATBandMathImageFilter<TImage>
     }
 }
 
+template<class TImage>
+void RATBandMathImageFilter<TImage>
+::BindTableColumns(unsigned int nbInputImages)
+{
+    // the binding is kept across streamed regions, as long as
+    // neither the filter nor any of the tables have been modified
+    bool bUpToDate = m_VColumnBound.size() == nbInputImages
+                     && m_ColumnBindingTime.GetMTime() > this->GetMTime();
+    for (unsigned int j=0; bUpToDate && j < nbInputImages && j < m_VRAT[0].size(); ++j)
+    {
+        if (    m_VRAT[0][j].IsNotNull()
+            &&  m_VRAT[0][j]->GetMTime() > m_ColumnBindingTime.GetMTime()
+           )
+        {
+            bUpToDate = false;
+        }
+    }
+    if (bUpToDate)
+    {
+        return;
+    }
+
+    m_VColumnBound.assign(nbInputImages, 0);
+    m_VBindOffset.assign(nbInputImages, 0);
+    m_VBindRange.assign(nbInputImages, 0);
+    m_VBindValues.clear();
+    m_VBindValues.resize(nbInputImages);
+    m_VBindNodata.clear();
+    m_VBindNodata.resize(nbInputImages);
+
+    const unsigned long long budget = static_cast<unsigned long long>(
+                std::max(m_ColumnBindingMemoryCap, 0LL)) << 20;
+    unsigned long long used = 0;
+
+    for (unsigned int j=0; j < nbInputImages && j < m_VRAT[0].size() && j < m_VTabAttr.size(); ++j)
+    {
+        AttributeTable::Pointer tab = m_VRAT[0][j];
+        if (tab.IsNull() || m_VTabAttr[j].size() == 0 || tab->GetNumRows() == 0)
+        {
+            continue;
+        }
+
+        // determine the range of row indices (RAMTable) or
+        // primary key values (SQLiteTable), i.e. pixel values
+        long long minKey = 0;
+        long long maxKey = tab->GetNumRows() - 1;
+        if (tab->GetTableType() == AttributeTable::ATTABLE_TYPE_SQLITE)
+        {
+            otb::SQLiteTable* stab = static_cast<otb::SQLiteTable*>(tab.GetPointer());
+            minKey = stab->GetMinPKValue();
+            maxKey = stab->GetMaxPKValue();
+        }
+        if (maxKey < minKey)
+        {
+            continue;
+        }
+        const unsigned long long range = static_cast<unsigned long long>(maxKey - minKey) + 1;
+
+        std::vector<std::string> dblNames;
+        std::vector<std::string> intNames;
+        std::vector<int> dblIdx;
+        std::vector<int> intIdx;
+        for (int c=0; c < m_VTabAttr[j].size(); ++c)
+        {
+            if (m_VAttrTypes[j][c] == AttributeTable::ATTYPE_DOUBLE)
+            {
+                dblNames.push_back(tab->GetColumnName(m_VTabAttr[j][c]));
+                dblIdx.push_back(c);
+            }
+            else if (m_VAttrTypes[j][c] == AttributeTable::ATTYPE_INT)
+            {
+                intNames.push_back(tab->GetColumnName(m_VTabAttr[j][c]));
+                intIdx.push_back(c);
+            }
+        }
+
+        const unsigned long long need = range * (dblIdx.size() + intIdx.size() * 2) * sizeof(double);
+        if (used + need > budget)
+        {
+            NMDebugAI(<< "column binding of " << this->GetNthInputName(j)
+                      << "'s table exceeds the memory cap - using table access"
+                      << std::endl);
+            continue;
+        }
+
+        std::vector< std::vector<double> >& values = m_VBindValues[j];
+        std::vector<double>& nodata = m_VBindNodata[j];
+        values.resize(m_VTabAttr[j].size());
+        nodata.assign(m_VTabAttr[j].size(), 0);
+
+        bool bOk = true;
+        if (dblIdx.size() > 0)
+        {
+            std::vector<double*> buffers;
+            for (int c=0; c < dblIdx.size(); ++c)
+            {
+                values[dblIdx[c]].resize(range);
+                buffers.push_back(&values[dblIdx[c]][0]);
+                nodata[dblIdx[c]] = tab->GetDblNodata();
+            }
+            bOk = tab->GetColumnRange(dblNames, minKey, range, buffers);
+        }
+
+        if (bOk && intIdx.size() > 0)
+        {
+            std::vector< std::vector<long long> > intValues(intIdx.size(), std::vector<long long>(range));
+            std::vector<long long*> buffers;
+            for (int c=0; c < intIdx.size(); ++c)
+            {
+                buffers.push_back(&intValues[c][0]);
+            }
+            bOk = tab->GetColumnRange(intNames, minKey, range, buffers);
+
+            for (int c=0; bOk && c < intIdx.size(); ++c)
+            {
+                values[intIdx[c]].assign(intValues[c].begin(), intValues[c].end());
+                nodata[intIdx[c]] = static_cast<double>(tab->GetIntNodata());
+            }
+        }
+
+        if (!bOk)
+        {
+            std::vector< std::vector<double> >().swap(values);
+            continue;
+        }
+
+        m_VColumnBound[j] = 1;
+        m_VBindOffset[j] = minKey;
+        m_VBindRange[j] = range;
+        used += range * (dblIdx.size() + intIdx.size()) * sizeof(double);
+    }
+
+    m_ColumnBindingTime.Modified();
+}
+
 template<class TImage>
 AttributeTable::Pointer RATBandMathImageFilter<TImage>
 ::GetNthAttributeTable(unsigned int idx)
@@ -624,6 +765,8 @@ void RATBandMathImageFilter<TImage>
 
     // attribute table support
     m_VAttrValues.resize(nbThreads);
+    m_VAttrVarName.clear();
+    m_VAttrVarName.resize(nbInputImages);
     m_VParser.clear();
 
     for(i = 0; i < nbThreads; i++)
@@ -737,6 +880,10 @@ void RATBandMathImageFilter<TImage>
                         // pixel value for RAMTables or SQLiteTables respectively
                         std::string vname = bname + m_VRAT[0][j]->GetColumnName(m_VTabAttr[j][c]);
                         parser->DefineVar(vname, &(m_VAttrValues[i][j][c]));
+                        if (i == 0)
+                        {
+                            m_VAttrVarName[j].push_back(vname);
+                        }
                     }
                 }
             }
@@ -757,6 +904,38 @@ void RATBandMathImageFilter<TImage>
         parser->SetExpr(m_Expression);
         m_VParser.push_back(parser);
     }
+
+    // set up the page cache of (per-thread) SQLite tables
+    this->RestoreTableCacheSize();
+    if (m_TableCacheSize > 0)
+    {
+        for (int t=0; t < m_VRAT.size(); ++t)
+        {
+            for (int j=0; j < m_VRAT[t].size(); ++j)
+            {
+                if (    m_VRAT[t][j].IsNotNull()
+                    &&  m_VRAT[t][j]->GetTableType() == AttributeTable::ATTABLE_TYPE_SQLITE
+                   )
+                {
+                    otb::SQLiteTable* stab = static_cast<otb::SQLiteTable*>(m_VRAT[t][j].GetPointer());
+                    bool bRecorded = false;
+                    for (int p=0; !bRecorded && p < m_PrevTableCacheSize.size(); ++p)
+                    {
+                        bRecorded = m_PrevTableCacheSize[p].first == m_VRAT[t][j];
+                    }
+                    if (!bRecorded)
+                    {
+                        m_PrevTableCacheSize.push_back(std::make_pair(m_VRAT[t][j], stab->GetCacheSize()));
+                    }
+                    stab->SetCacheSize(m_TableCacheSize);
+                    stab->ResetCacheStatistics();
+                }
+            }
+        }
+    }
+
+    // resolve the referenced table columns once for all threads
+    this->BindTableColumns(nbInputImages);
 }
 
 template< typename TImage >
@@ -784,17 +963,52 @@ void RATBandMathImageFilter<TImage>
                    << "The Parsed Expression, The Inputs And The Output "
                    << "Type May Be Incompatible !");
 
+    if (m_TableCacheSize > 0)
+    {
+        long long hits = 0;
+        long long misses = 0;
+        for (int t=0; t < m_VRAT.size(); ++t)
+        {
+            for (int j=0; j < m_VRAT[t].size(); ++j)
+            {
+                if (    m_VRAT[t][j].IsNotNull()
+                    &&  m_VRAT[t][j]->GetTableType() == AttributeTable::ATTABLE_TYPE_SQLITE
+                   )
+                {
+                    otb::SQLiteTable* stab = static_cast<otb::SQLiteTable*>(m_VRAT[t][j].GetPointer());
+                    hits += stab->GetCacheHits();
+                    misses += stab->GetCacheMisses();
+                }
+            }
+        }
+        NMDebugAI(<< "table cache: " << hits << " hits, "
+                  << misses << " misses" << std::endl);
+    }
+    this->RestoreTableCacheSize();
+
 //    m_VVarName.clear();
 //    m_VAttrValues.clear();
 //    m_VParser.clear();
 }
 
+template< typename TImage >
+void RATBandMathImageFilter<TImage>
+::RestoreTableCacheSize(void)
+{
+    for (int p=0; p < m_PrevTableCacheSize.size(); ++p)
+    {
+        otb::SQLiteTable* stab = static_cast<otb::SQLiteTable*>(
+                    m_PrevTableCacheSize[p].first.GetPointer());
+        stab->SetCacheSize(m_PrevTableCacheSize[p].second);
+    }
+    m_PrevTableCacheSize.clear();
+}
+
 template< typename TImage >
 void RATBandMathImageFilter<TImage>
 ::ThreadedGenerateData(const ImageRegionType& outputRegionForThread,
                        itk::ThreadIdType threadId)
 {
-    double* value;
     unsigned int j, r;
     unsigned int nbInputImages = this->GetNumberOfInputs();
     unsigned int nbOutputImages = this->GetNumberOfOutputs();
@@ -851,16 +1065,55 @@ void RATBandMathImageFilter<TImage>
     itk::ProgressReporter progress(this, threadId,
                                    outputRegionForThread.GetNumberOfPixels());
 
+    // scanline buffers bound to the parser's variables, i.e. the
+    // expression is evaluated for a whole line at once (s. MultiParser::EvalBatch)
+    const long lineLen = outputRegionForThread.GetSize(0);
+    ParserType::Pointer parser = m_VParser.at(threadId);
+    parser->ClearBatchVars();
+
+    std::vector< std::vector<double> > vImgLine(m_NbVar, std::vector<double>(lineLen));
+    for (j = 0; j < m_NbVar; ++j)
+    {
+        parser->DefineBatchVar(m_VVarName.at(j), &vImgLine[j][0]);
+    }
+
+    std::vector< std::vector< std::vector<double> > > vAttrLine(m_VAttrValues[threadId].size());
+    for (j = 0; j < vAttrLine.size(); ++j)
+    {
+        const size_t nattr = std::min(m_VAttrValues[threadId][j].size(), m_VAttrVarName[j].size());
+        vAttrLine[j].resize(nattr, std::vector<double>(lineLen));
+        for (unsigned int c = 0; c < nattr; ++c)
+        {
+            parser->DefineBatchVar(m_VAttrVarName[j][c], &vAttrLine[j][c][0]);
+        }
+    }
+
+    const int nbResults = std::max(static_cast<int>(nbOutputImages), this->m_NbExpr);
+    std::vector< std::vector<double> > vResLine(nbResults, std::vector<double>(lineLen));
+    std::vector<double*> vResPtr(nbResults);
+    for (int e = 0; e < nbResults; ++e)
+    {
+        vResPtr[e] = &vResLine[e][0];
+    }
+
+    // inputs whose table columns are bound to dense arrays
+    std::vector<char> vBound(nbInputImages, 0);
+    for (j = 0; j < nbInputImages && j < m_VColumnBound.size(); ++j)
+    {
+        vBound[j] = vTabAvail[j] && j < vAttrLine.size() ? m_VColumnBound[j] : 0;
+    }
+
     while (!Vit.at(0).IsAtEnd())
     {
+        long n = 0;
         while (!Vit.at(0).IsAtEndOfLine())
         {
             for (j = 0; j < nbInputImages; j++)
             {
-                m_AImage.at(threadId).at(j) = static_cast<double>(Vit.at(j).Get());
+                vImgLine[j][n] = static_cast<double>(Vit.at(j).Get());
 
                 // raster attribute table support ......................................................................
-                if (vTabAvail[j])
+                if (vTabAvail[j] && !vBound[j])
                 {
                     if (m_UseTableColumnCache)
                     {
@@ -893,6 +1146,14 @@ void RATBandMathImageFilter<TImage>
                             }
                         }
                     }
+
+                    if (j < vAttrLine.size())
+                    {
+                        for (unsigned int c = 0; c < vAttrLine[j].size(); ++c)
+                        {
+                            vAttrLine[j][c][n] = m_VAttrValues[threadId][j][c];
+                        }
+                    }
                 }
                 // .......................................................................................................
 
@@ -901,69 +1162,106 @@ void RATBandMathImageFilter<TImage>
             //// Image Indexes
             for (j = 0; j < 2; j++)
             {
-                m_AImage.at(threadId).at(nbInputImages + j) =
+                vImgLine[nbInputImages + j][n] =
                         static_cast<double>(Vit.at(0).GetIndex()[j]);
             }
             for (j = 0; j < 2; j++)
             {
-                m_AImage.at(threadId).at(nbInputImages + 2 + j) =
+                vImgLine[nbInputImages + 2 + j][n] =
                         static_cast<double>(m_Origin[j])
                         + static_cast<double>(Vit.at(0).GetIndex()[j])
                         * static_cast<double>(m_Spacing[j]);
             }
+            ++n;
 
-            try
+            for (j = 0; j < nbInputImages; j++)
             {
-                value = m_VParser.at(threadId)->Eval(this->m_NbExpr);
+                ++(Vit.at(j));
             }
-            catch (itk::ExceptionObject& err)
+        }
+
+        // look up the bound table columns for the whole line
+        for (j = 0; j < nbInputImages; ++j)
+        {
+            if (!vBound[j])
             {
-                if (threadId == 0)
-                {
-                    NMProcErr(<< "Map Algebra: " << err.GetDescription() << std::endl)
-                            NMErr("MapAlgebra", << err.GetDescription() << std::endl);
-                }
-                throw;
+                continue;
             }
-            catch (mu::ParserError& mpe)
+
+            const double* pix = &vImgLine[j][0];
+            const unsigned long long offset = static_cast<unsigned long long>(m_VBindOffset[j]);
+            const unsigned long long range = m_VBindRange[j];
+            for (unsigned int c = 0; c < vAttrLine[j].size(); ++c)
             {
-                if (threadId == 0)
+                double* attr = &vAttrLine[j][c][0];
+                if (m_VAttrTypes[j][c] == AttributeTable::ATTYPE_STRING)
+                {
+                    std::copy(pix, pix + n, attr);
+                }
+                else
                 {
-                    NMProcErr(<< "Map Algebra: " << mpe.GetMsg());
-                    NMErr("Map Algebra", << mpe.GetMsg());
+                    const double* values = &m_VBindValues[j][c][0];
+                    const double nodata = m_VBindNodata[j][c];
+                    for (long p = 0; p < n; ++p)
+                    {
+                        const unsigned long long k = static_cast<unsigned long long>(
+                                    static_cast<long long>(pix[p])) - offset;
+                        attr[p] = k < range ? values[k] : nodata;
+                    }
                 }
-                throw;
             }
+        }
+
+        try
+        {
+            parser->EvalBatch(n, &vResPtr[0], nbResults);
+        }
+        catch (itk::ExceptionObject& err)
+        {
+            if (threadId == 0)
+            {
+                NMProcErr(<< "Map Algebra: " << err.GetDescription() << std::endl)
+                        NMErr("MapAlgebra", << err.GetDescription() << std::endl);
+            }
+            throw;
+        }
+        catch (mu::ParserError& mpe)
+        {
+            if (threadId == 0)
+            {
+                NMProcErr(<< "Map Algebra: " << mpe.GetMsg());
+                NMErr("Map Algebra", << mpe.GetMsg());
+            }
+            throw;
+        }
 
+        for (long p = 0; p < n; ++p)
+        {
             // Case value is equal to -inf or inferior to the minimum value
             // allowed by the pixelType cast
             for (r = 0; r < nbOutputImages; ++r)
             {
-                if (value[r] < double(itk::NumericTraits<PixelType>::NonpositiveMin()))
+                const double value = vResLine[r][p];
+                if (value < double(itk::NumericTraits<PixelType>::NonpositiveMin()))
                 {
                     Vot.at(r).Set(itk::NumericTraits<PixelType>::NonpositiveMin());
                     m_ThreadUnderflow[threadId]++;
                 }
                 // Case value is equal to inf or superior to the maximum value
                 // allowed by the pixelType cast
-                else if (value[r] > double(itk::NumericTraits<PixelType>::max()))
+                else if (value > double(itk::NumericTraits<PixelType>::max()))
                 {
                     Vot.at(r).Set(itk::NumericTraits<PixelType>::max());
                     m_ThreadOverflow[threadId]++;
                 }
                 else
                 {
-                    Vot.at(r).Set(static_cast<PixelType>(value[r]));
+                    Vot.at(r).Set(static_cast<PixelType>(value));
                 }
 
                 ++(Vot.at(r));
             }
 
-            for (j = 0; j < nbInputImages; j++)
-            {
-                ++(Vit.at(j));
-            }
-
             progress.CompletedPixel();
         }
 
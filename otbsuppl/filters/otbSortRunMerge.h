@@ -0,0 +1,245 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef OTBSORTRUNMERGE_H_
+#define OTBSORTRUNMERGE_H_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <future>
+#include <algorithm>
+
+namespace otb
+{
+
+/** \class SortRunReader
+ *  \brief Reads the fixed-size records of a sorted run file one
+ *         block at a time, while the next block is being read
+ *         on a separate thread
+ */
+class SortRunReader
+{
+public:
+    SortRunReader()
+        : m_RecordSize(0), m_NumRecords(0), m_BlockRecords(0),
+          m_Read(0), m_Pos(0), m_BlockLen(0)
+    {}
+
+    ~SortRunReader()
+    {
+        if (m_Next.valid())
+        {
+            m_Next.wait();
+        }
+    }
+
+    /** Opens the run file and reads its first block; returns
+     *  false if the file couldn't be opened
+     */
+    bool Open(const std::string& fileName, size_t recordSize,
+              size_t numRecords, size_t blockRecords)
+    {
+        m_File.open(fileName.c_str(), std::ios::in | std::ios::binary);
+        if (!m_File.is_open())
+        {
+            return false;
+        }
+
+        m_RecordSize = recordSize;
+        m_NumRecords = numRecords;
+        m_BlockRecords = blockRecords < 1 ? 1 : blockRecords;
+        m_Block.resize(m_BlockRecords * m_RecordSize);
+        m_NextBlock.resize(m_BlockRecords * m_RecordSize);
+
+        m_Next = std::async(std::launch::async, &SortRunReader::ReadBlock, this);
+        this->SwapBlocks();
+
+        return true;
+    }
+
+    bool AtEnd() const
+    {return m_Pos >= m_BlockLen;}
+
+    /** The current record; only valid if !AtEnd() */
+    const char* Current() const
+    {return &m_Block[m_Pos * m_RecordSize];}
+
+    void Next()
+    {
+        if (++m_Pos >= m_BlockLen)
+        {
+            this->SwapBlocks();
+        }
+    }
+
+protected:
+
+    size_t ReadBlock()
+    {
+        const size_t n = std::min(m_BlockRecords, m_NumRecords - m_Read);
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        m_File.read(&m_NextBlock[0], n * m_RecordSize);
+        const size_t nread = static_cast<size_t>(m_File.gcount()) / m_RecordSize;
+        m_Read += nread;
+        return nread;
+    }
+
+    void SwapBlocks()
+    {
+        m_Pos = 0;
+        if (!m_Next.valid())
+        {
+            m_BlockLen = 0;
+            return;
+        }
+
+        m_BlockLen = m_Next.get();
+        m_Block.swap(m_NextBlock);
+        if (m_BlockLen > 0 && m_Read < m_NumRecords)
+        {
+            m_Next = std::async(std::launch::async, &SortRunReader::ReadBlock, this);
+        }
+    }
+
+    std::ifstream m_File;
+    size_t m_RecordSize;
+    size_t m_NumRecords;
+    size_t m_BlockRecords;
+
+    // number of records read so far; only touched by
+    // the prefetching thread while m_Next is pending
+    size_t m_Read;
+
+    std::vector<char> m_Block;
+    std::vector<char> m_NextBlock;
+    std::future<size_t> m_Next;
+    size_t m_Pos;
+    size_t m_BlockLen;
+
+private:
+    SortRunReader(const SortRunReader&); //purposely not implemented
+    void operator=(const SortRunReader&); //purposely not implemented
+};
+
+/** \class LoserTree
+ *  \brief Tournament tree of losers for the k-way merge of sorted runs
+ *
+ *  Runs are compared by their current key and then by their number, so
+ *  the merge keeps the order of the runs for equal keys; exhausted runs
+ *  lose against any other run. After the winner's key has been changed
+ *  (or the run marked as done), Replay() restores the tree in
+ *  log2(k) comparisons.
+ */
+template <class TKey>
+class LoserTree
+{
+public:
+    LoserTree() : m_K(0) {}
+
+    void Init(int k)
+    {
+        m_K = k < 1 ? 1 : k;
+        m_Keys.assign(m_K, TKey());
+        m_Done.assign(m_K, 1);
+        m_Tree.assign(m_K, 0);
+    }
+
+    void SetKey(int run, const TKey& key)
+    {
+        m_Keys[run] = key;
+        m_Done[run] = 0;
+    }
+
+    void SetDone(int run)
+    {m_Done[run] = 1;}
+
+    bool IsDone(int run) const
+    {return m_Done[run] != 0;}
+
+    /** Plays the initial tournament; call after all keys have been set */
+    void Build()
+    {
+        m_Tree[0] = m_K > 1 ? this->Play(1) : 0;
+    }
+
+    int Winner() const
+    {return m_Tree[0];}
+
+    /** Replays the matches along the path of the given run */
+    void Replay(int run)
+    {
+        int winner = run;
+        for (int node = (run + m_K) / 2; node > 0; node /= 2)
+        {
+            if (this->Less(m_Tree[node], winner))
+            {
+                std::swap(m_Tree[node], winner);
+            }
+        }
+        m_Tree[0] = winner;
+    }
+
+protected:
+
+    inline bool Less(int a, int b) const
+    {
+        if (m_Done[a])
+        {
+            return false;
+        }
+        if (m_Done[b])
+        {
+            return true;
+        }
+        if (m_Keys[a] != m_Keys[b])
+        {
+            return m_Keys[a] < m_Keys[b];
+        }
+        return a < b;
+    }
+
+    // internal nodes are 1 .. k-1, run r is leaf k+r
+    int Play(int node)
+    {
+        if (node >= m_K)
+        {
+            return node - m_K;
+        }
+
+        const int left = this->Play(2 * node);
+        const int right = this->Play(2 * node + 1);
+        if (this->Less(left, right))
+        {
+            m_Tree[node] = right;
+            return left;
+        }
+        m_Tree[node] = left;
+        return right;
+    }
+
+    int m_K;
+    std::vector<TKey> m_Keys;
+    std::vector<unsigned char> m_Done;
+    std::vector<int> m_Tree;
+};
+
+} // end namespace otb
+
+#endif /* OTBSORTRUNMERGE_H_ */
@@ -24,6 +24,7 @@
 #include <string>
 
 #include "otbSQLiteTable.h"
+#include "otbZoneStatsAccumulator.h"
 #include "itkImageToImageFilter.h"
 #include "otbImage.h"
 
@@ -90,8 +91,7 @@ public:
 
       typedef long long ZoneKeyType;
 
-	  typedef typename std::map< ZoneKeyType, std::vector<double> >  ZoneMapType;
-          typedef typename ZoneMapType::iterator                         ZoneMapTypeIterator;
+          typedef ZoneStatsAccumulator                                   ZoneStoreType;
 
           //itkSetMacro(NodataValue, InputPixelType);
           void SetNodataValue(InputPixelType nodata);
@@ -104,6 +104,15 @@ public:
           itkGetMacro(Workspace, std::string);
           itkSetMacro(Workspace, std::string);
 
+          /** Maximum range of zone ids (max - min + 1) a thread
+           *  accumulates in a plain array indexed by zone id rather
+           *  than in a hash table; the array is only used if the
+           *  range doesn't exceed the number of pixels of the
+           *  thread's region either. The default value is 2^20.
+           */
+          itkSetMacro(MaxDenseZoneRange, long long);
+          itkGetMacro(MaxDenseZoneRange, long long);
+
           /** Enforces the zone table to have MaxKey rows with a
            *  0-based index. Note: this options overrides KeyIsRowIdx;
            *  The default value is 'false'.
@@ -151,6 +160,16 @@ protected:
           void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId );
 	  void AfterThreadedGenerateData();
 
+          struct ThreadStruct
+          {
+              Pointer Filter;
+          };
+
+          /** merges the thread stores into the partitions of the
+           *  global store, one partition per thread */
+          static ITK_THREAD_RETURN_TYPE MergeFromThreader(void* arg);
+          void MergeThreadStores(int threadId, int numThreads);
+
 
 private:
 	  SumZonesFilter(const Self&); //purposely not implemented
@@ -170,10 +189,12 @@ private:
 
           bool mStreamingProc;
           InputPixelType m_NodataValue;
-          typename std::vector<ZoneMapType> mThreadValueStore;
+          long long m_MaxDenseZoneRange;
+          std::vector<ZoneStoreType> mThreadValueStore;
 
-          // need to keep track of zone(key), min, max, count, sum for each zone
-          ZoneMapType mGlobalValueStore;
+          // need to keep track of zone(key), min, max, count, sum for each zone;
+          // zones are distributed across partitions by ZoneStoreType::Partition
+          std::vector<ZoneStoreType> mGlobalValueStore;
           std::vector<long long> mThreadPixCount;
           long long mTotalPixCount;
           long long mLPRPixCount;
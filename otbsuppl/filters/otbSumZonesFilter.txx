@@ -32,6 +32,8 @@
 #include "itkProgressReporter.h"
 #include "itkMacro.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
@@ -49,6 +51,7 @@ SumZonesFilter< TInputImage, TOutputImage >
     m_NextZoneId = 0;
     mStreamingProc = false;
     m_ZoneTableFileName = "";
+    m_MaxDenseZoneRange = 1 << 20;
 
     mZoneTable = SQLiteTable::New();
 }
@@ -282,10 +285,17 @@ void SumZonesFilter< TInputImage, TOutputImage >
     mThreadValueStore.clear();
     for (int t=0; t < numThreads; ++t)
     {
-        mThreadValueStore.push_back(ZoneMapType());
+        mThreadValueStore.push_back(ZoneStoreType());
         mThreadPixCount.push_back(0);
     }
 
+    // the global store's partitions are kept across
+    // streaming passes
+    if (mGlobalValueStore.size() == 0)
+    {
+        mGlobalValueStore.resize(numThreads);
+    }
+
     NMDebugCtx(ctx, << "done!");
 }
 
@@ -308,8 +318,41 @@ void SumZonesFilter< TInputImage, TOutputImage >
     typename InputIterType::IndexType pixIdx;
 
     mThreadPixCount[threadId] += outputRegionForThread.GetNumberOfPixels();
-    ZoneMapType& vMap = mThreadValueStore[threadId];
-    ZoneMapTypeIterator mapIt;
+    ZoneStoreType& vStore = mThreadValueStore[threadId];
+
+    // if the zone ids of this region are compact enough, we
+    // accumulate them in an array rather than in the hash table;
+    // scanning the zones upfront is cheap compared to hashing
+    // each pixel's zone id
+    const long long numPix = outputRegionForThread.GetNumberOfPixels();
+    ZoneKeyType minZone = itk::NumericTraits<ZoneKeyType>::max();
+    ZoneKeyType maxZone = itk::NumericTraits<ZoneKeyType>::NonpositiveMin();
+    zoneIt.GoToBegin();
+    while (!zoneIt.IsAtEnd())
+    {
+        while (!zoneIt.IsAtEndOfLine())
+        {
+            const ZoneKeyType zone = static_cast<ZoneKeyType>(zoneIt.Get());
+            minZone = zone < minZone ? zone : minZone;
+            maxZone = zone > maxZone ? zone : maxZone;
+            ++zoneIt;
+        }
+        zoneIt.NextLine();
+    }
+
+    // the zone ids may span the whole range of ZoneKeyType,
+    // so we take the difference in unsigned arithmetic
+    const unsigned long long zoneRange = numPix > 0
+            ? static_cast<unsigned long long>(maxZone) - static_cast<unsigned long long>(minZone)
+            : 0;
+    if (    numPix > 0
+        &&  m_MaxDenseZoneRange > 0
+        &&  zoneRange < static_cast<unsigned long long>(m_MaxDenseZoneRange)
+        &&  zoneRange < static_cast<unsigned long long>(numPix)
+       )
+    {
+        vStore.SetDenseRange(minZone, maxZone);
+    }
 
     itk::ProgressReporter progress(this, threadId,
             outputRegionForThread.GetNumberOfPixels());
@@ -326,62 +369,26 @@ void SumZonesFilter< TInputImage, TOutputImage >
         //typedef itk::ImageRegionConstIterator<TInputImage> OutputIterType;
         using OutputIterType = itk::ImageScanlineConstIterator<TInputImage>;
         OutputIterType valueIt(mValueImage, outputRegionForThread);
+        const double nodata = static_cast<double>(m_NodataValue);
 
         valueIt.GoToBegin();
         while (!zoneIt.IsAtEnd() && !valueIt.IsAtEnd() && !this->GetAbortGenerateData())
         {
+            // we're iterating along a scan line, so only x changes
+            pixIdx = zoneIt.GetIndex();
+            long long x = pixIdx[0];
+            const long long y = pixIdx[1];
             while( !valueIt.IsAtEndOfLine() )
             {
-                const ZoneKeyType zone = static_cast<ZoneKeyType>(zoneIt.Get());
                 const double val = static_cast<double>(valueIt.Get());
-                if (	m_IgnoreNodataValue
-                        &&	val == static_cast<double>(m_NodataValue)
-                        )
-                {
-                    ++zoneIt;
-                    ++valueIt;
-
-                    progress.CompletedPixel();
-                    continue;
-                }
-
-
-                mapIt = vMap.find(zone);
-                if (mapIt == vMap.end())
+                if (!(m_IgnoreNodataValue && val == nodata))
                 {
-                    // idx 0, 1, 2. 3, 4 are min, max, sum, count, sum^2
-                    vMap[zone] = std::vector<double>(9,0);
-                    vMap[zone][0] = itk::NumericTraits<double>::max();
-                    vMap[zone][1] = itk::NumericTraits<double>::NonpositiveMin();
-
-                    // idx 5, 6, 7, 8 are minX, minY, maxX, maxY
-                    vMap[zone][5] = itk::NumericTraits<double>::max();
-                    vMap[zone][6] = itk::NumericTraits<double>::max();
-                    vMap[zone][7] = itk::NumericTraits<double>::NonpositiveMin();
-                    vMap[zone][8] = itk::NumericTraits<double>::NonpositiveMin();
+                    vStore.Add(static_cast<ZoneKeyType>(zoneIt.Get()), val, x, y);
                 }
-                std::vector<double>& params = vMap[zone];
-
-                // min
-                params[0] = params[0] < val ? params[0] : val;
-                // max
-                params[1] = params[1] > val ? params[1] : val;
-                // sum_val
-                params[2] += val;
-                // count
-                params[3] += 1;
-                // sum_val^2
-                params[4] += val * val;
-
-                pixIdx = zoneIt.GetIndex();
-
-                params[5] = pixIdx[0] < params[5] ? pixIdx[0] : params[5];
-                params[6] = pixIdx[1] < params[6] ? pixIdx[1] : params[6];
-                params[7] = pixIdx[0] > params[7] ? pixIdx[0] : params[7];
-                params[8] = pixIdx[1] > params[8] ? pixIdx[1] : params[8];
 
                 ++zoneIt;
                 ++valueIt;
+                ++x;
 
                 progress.CompletedPixel();
             }
@@ -393,43 +400,16 @@ void SumZonesFilter< TInputImage, TOutputImage >
     {
         while (!zoneIt.IsAtEnd() && !this->GetAbortGenerateData())
         {
+            pixIdx = zoneIt.GetIndex();
+            long long x = pixIdx[0];
+            const long long y = pixIdx[1];
             while (!zoneIt.IsAtEndOfLine())
             {
                 const ZoneKeyType zone = static_cast<ZoneKeyType>(zoneIt.Get());
-                double val = static_cast<double>(zone);
-                mapIt = vMap.find(zone);
-                if (mapIt == vMap.end())
-                {
-                    vMap[zone] = std::vector<double>(9,0);
-
-                    // idx 5, 6, 7, 8 are minX, minY, maxX, maxY
-                    vMap[zone][5] = itk::NumericTraits<double>::max();
-                    vMap[zone][6] = itk::NumericTraits<double>::max();
-                    vMap[zone][7] = itk::NumericTraits<double>::NonpositiveMin();
-                    vMap[zone][8] = itk::NumericTraits<double>::NonpositiveMin();
-                }
-                std::vector<double>& params = vMap[zone];
-
-                // min
-                params[0] = params[0] < val ? params[0] : val;
-                // max
-                params[1] = params[1] > val ? params[1] : val;
-                // sum_val
-                params[2] += val;
-                // count
-                params[3] += 1;
-                // sum_val^2
-                params[4] += val * val;
-
-                pixIdx = zoneIt.GetIndex();
-
-                params[5] = pixIdx[0] < params[5] ? pixIdx[0] : params[5];
-                params[6] = pixIdx[1] < params[6] ? pixIdx[1] : params[6];
-                params[7] = pixIdx[0] > params[7] ? pixIdx[0] : params[7];
-                params[8] = pixIdx[1] > params[8] ? pixIdx[1] : params[8];
-
+                vStore.Add(zone, static_cast<double>(zone), x, y);
 
                 ++zoneIt;
+                ++x;
                 progress.CompletedPixel();
             }
             zoneIt.NextLine();
@@ -465,89 +445,43 @@ void SumZonesFilter< TInputImage, TOutputImage >
     // global map
 
     NMDebugAI(<< "update set of zones - adding: ");
-    ZoneKeyType numzones = mGlobalValueStore.size();
-    ZoneKeyType newzones = 0;
-    ZoneKeyType maxKey = 0;
-    ZoneMapTypeIterator mapIt;
-    ZoneMapTypeIterator globalIt;
-
-    /*  keep track of zones ...
-     *  0: min
-     *  1: max
-     *  2: sum_v
-     *  3: count
-     *  4: sum_v^2
-     *  5: minX
-     *  6: minY
-     *  7: maxX
-     *  8: maxY
-     */
-
-    for (int t=0; t < this->GetNumberOfThreads(); ++t)
+    ZoneKeyType numzones = 0;
+    for (int p=0; p < mGlobalValueStore.size(); ++p)
     {
-        mTotalPixCount += mThreadPixCount[t];
-        ZoneMapType& vMap = mThreadValueStore[t];
-        mapIt = vMap.begin();
-        while(mapIt != vMap.end())
-        {
-            ZoneKeyType zone = mapIt->first;
-            globalIt = mGlobalValueStore.find(zone);
-            if (globalIt == mGlobalValueStore.end())
-            {
-                mGlobalValueStore[zone] = mapIt->second;
-
-                // keep track of max key and number of new keys
-                ++newzones;
-            }
-            else
-            {
-                // ..................................
-                // update parameters for current zone
-                // ..................................
-
-                std::vector<double>&  params = globalIt->second;
-
-                // min
-                params[0] = params[0] < mapIt->second[0] ?
-                            params[0] : mapIt->second[0];
-                // max
-                params[1] = params[1] > mapIt->second[1] ?
-                            params[1] : mapIt->second[1];
-                // sum_val
-                params[2] += mapIt->second[2];
-
-                // count
-                params[3] += mapIt->second[3];
-
-                // sum_val^2
-                params[4] += mapIt->second[4];
-
-                // minX
-                params[5] = params[5] < mapIt->second[5] ?
-                            params[5] : mapIt->second[5];
+        numzones += mGlobalValueStore[p].Size();
+    }
 
-                // minY
-                params[6] = params[6] < mapIt->second[6] ?
-                            params[6] : mapIt->second[6];
+    for (int t=0; t < mThreadPixCount.size(); ++t)
+    {
+        mTotalPixCount += mThreadPixCount[t];
+    }
 
-                // maxX
-                params[7] = params[7] > mapIt->second[7] ?
-                            params[7] : mapIt->second[7];
+    // each thread merges the zones of its partition(s) of the
+    // global store from all thread stores
+    ThreadStruct str;
+    str.Filter = this;
 
-                // maxY
-                params[8] = params[8] > mapIt->second[8] ?
-                            params[8] : mapIt->second[8];
+    this->GetMultiThreader()->SetNumberOfThreads(mGlobalValueStore.size());
+    this->GetMultiThreader()->SetSingleMethod(this->MergeFromThreader, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
 
-            }
+    mThreadValueStore.clear();
 
-            ++mapIt;
-        }
+    ZoneKeyType newzones = -numzones;
+    for (int p=0; p < mGlobalValueStore.size(); ++p)
+    {
+        newzones += mGlobalValueStore[p].Size();
     }
 
     // get the maximum key up this point
-    globalIt = mGlobalValueStore.end();
-    --globalIt;
-    maxKey = globalIt->first;
+    ZoneKeyType maxKey = 0;
+    for (int p=0; p < mGlobalValueStore.size(); ++p)
+    {
+        mGlobalValueStore[p].ForEach([&maxKey](const ZoneKeyType& key, const ZoneStats& s)
+        {
+            maxKey = key > maxKey ? key : maxKey;
+        });
+    }
 
     NMDebug(<< std::endl);
     NMDebugAI(<< "Merged threads ... " << std::endl);
@@ -612,17 +546,28 @@ void SumZonesFilter< TInputImage, TOutputImage >
             fillIns.push_back(v);
         }
 
+        // the zone table is ordered by zone id
+        std::vector<std::pair<ZoneKeyType, const ZoneStats*> > zones;
+        for (int p=0; p < mGlobalValueStore.size(); ++p)
+        {
+            mGlobalValueStore[p].AppendZones(zones);
+        }
+        std::sort(zones.begin(), zones.end(),
+                  [](const std::pair<ZoneKeyType, const ZoneStats*>& a,
+                     const std::pair<ZoneKeyType, const ZoneStats*>& b)
+                  {return a.first < b.first;});
+
         NMDebugAI(<< "writing zone table ..." << std::endl);
         mZoneTable->BeginTransaction();
         mZoneTable->PrepareBulkSet(colnames, true);
-        globalIt = mGlobalValueStore.begin();
 
         m_NextZoneId = 0;
-        while (globalIt != mGlobalValueStore.end() && !this->GetAbortGenerateData())
+        for (size_t z=0; z < zones.size() && !this->GetAbortGenerateData(); ++z)
         {
+            const ZoneKeyType zoneKey = zones[z].first;
             if (m_HaveMaxKeyRows)
             {
-                while (globalIt->first > m_NextZoneId)
+                while (zoneKey > m_NextZoneId)
                 {
                     fillIns[0].ival = m_NextZoneId;
                     mZoneTable->DoBulkSet(fillIns);
@@ -630,27 +575,24 @@ void SumZonesFilter< TInputImage, TOutputImage >
                 }
             }
 
-            std::vector<double>& p = globalIt->second;
-            values[0].ival = globalIt->first;                // rowidx
+            const ZoneStats& p = *zones[z].second;
+            const double cnt = p.count > 0 ? static_cast<double>(p.count) : 1.0;
+            values[0].ival = zoneKey;                        // rowidx
             values[1].ival = m_NextZoneId;                   // zone id
-            values[2].ival = static_cast<long long>(p[3]);   // count
-            values[3].dval = p[0];                           // min
-            values[4].dval = p[1];                           // max
-            values[5].dval = p[2] / (p[3] > 0 ? p[3] : 1.0); // mean
-//            values[6].dval = values[5].dval != p[2]
-//                             ? ::sqrt( (p[4] / p[3]) - (values[5].dval * values[5].dval))
-//                             : 0;                            // stddev
-            values[6].dval = ::sqrt((p[4] / (p[3] > 0 ? p[3] : 1.0)) - (values[5].dval * values[5].dval));
-            values[7].dval = p[2];                           // sum
+            values[2].ival = p.count;                        // count
+            values[3].dval = p.min;                          // min
+            values[4].dval = p.max;                          // max
+            values[5].dval = p.sum / cnt;                    // mean
+            values[6].dval = ::sqrt((p.sumsq / cnt) - (values[5].dval * values[5].dval));
+            values[7].dval = p.sum;                          // sum
 
             // set the extent
-            values[8].ival = p[5];                          // minX
-            values[9].ival = p[6];                          // minY
-            values[10].ival = p[7];                         // maxX
-            values[11].ival = p[8];                         // maxY
+            values[8].ival = p.minX;                        // minX
+            values[9].ival = p.minY;                        // minY
+            values[10].ival = p.maxX;                       // maxX
+            values[11].ival = p.maxY;                       // maxY
 
             mZoneTable->DoBulkSet(values);
-            ++globalIt;
             ++m_NextZoneId;
         }
         mZoneTable->EndTransaction();
@@ -664,6 +606,35 @@ void SumZonesFilter< TInputImage, TOutputImage >
     NMDebugCtx(ctx, << "done!");
 }
 
+template< class TInputImage, class TOutputImage >
+ITK_THREAD_RETURN_TYPE
+SumZonesFilter< TInputImage, TOutputImage >
+::MergeFromThreader(void* arg)
+{
+    itk::MultiThreader::ThreadInfoStruct* info =
+            static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    ThreadStruct* str = static_cast<ThreadStruct*>(info->UserData);
+
+    str->Filter->MergeThreadStores(info->ThreadID, info->NumberOfThreads);
+
+    return ITK_THREAD_RETURN_VALUE;
+}
+
+template< class TInputImage, class TOutputImage >
+void SumZonesFilter< TInputImage, TOutputImage >
+::MergeThreadStores(int threadId, int numThreads)
+{
+    // the threader might run fewer threads than we've got partitions
+    const int numParts = mGlobalValueStore.size();
+    for (int p=threadId; p < numParts; p += numThreads)
+    {
+        for (int t=0; t < mThreadValueStore.size(); ++t)
+        {
+            mGlobalValueStore[p].MergePartition(mThreadValueStore[t], p, numParts);
+        }
+    }
+}
+
 template< class TInputImage, class TOutputImage >
 void SumZonesFilter< TInputImage, TOutputImage >
 ::ResetPipeline()
@@ -677,6 +648,7 @@ void SumZonesFilter< TInputImage, TOutputImage >
     }
     mZoneTable = 0;
     m_NextZoneId = 0;
+    mGlobalValueStore.clear();
 
     mZoneTable = SQLiteTable::New();
 
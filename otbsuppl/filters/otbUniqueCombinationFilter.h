@@ -95,6 +95,12 @@ public:
     itkGetMacro(Workspace, std::string);
     itkSetMacro(Workspace, std::string);
 
+    /*! Memory (MiB) the unique combinations may occupy
+     *  before they're spilled to disk (default: 1024)
+     */
+    itkGetMacro(MemoryBudget, int);
+    itkSetMacro(MemoryBudget, int);
+
     void SetInput(unsigned int idx, const InputImageType * image);
 
     void setRAT(unsigned int idx, AttributeTable::Pointer table);
@@ -123,10 +129,9 @@ protected:
     void AllocateOutputs(){}
 
     std::string getRandomString(int length=15);
-    unsigned int nextUpperIterationIdx(unsigned int idx, unsigned long long& accIdx);
-    void determineProcOrder(void);
 
     std::string m_Workspace;
+    int m_MemoryBudget;
     std::string m_OutputImageFileName;
     std::vector<AttributeTable::Pointer> m_vInRAT;
     std::vector<AttributeTable::Pointer> m_vOutRAT;
@@ -145,7 +150,6 @@ protected:
     std::vector<typename InputImageType::Pointer> m_InputImages;
     std::vector<InputPixelType> m_InputNodata;
     std::vector<std::string> m_ImageNames;
-    std::vector<int> m_ProcOrder;
 
 
 private:
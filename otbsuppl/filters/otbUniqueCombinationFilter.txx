@@ -31,22 +31,22 @@
 
 #include "nmlog.h"
 #include "otbUniqueCombinationFilter.h"
-#include "otbCombineTwoFilter.h"
+#include "otbCombinationHashFilter.h"
 #include "otbNMImageReader.h"
 #include "otbStreamingRATImageFileWriter.h"
 //#include "otbRATBandMathImageFilter.h"
-#include "otbRATValExtractor.h"
 #include "otbSQLiteTable.h"
 
 
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIterator.h"
+#include "itkUnaryFunctorImageFilter.h"
 #include "itkProgressReporter.h"
 #include "itkMacro.h"
 #include "itkNMLogEvent.h"
 
 #include <ctime>
+#include <cstdio>
 #include <random>
 
 namespace otb
@@ -61,6 +61,7 @@ UniqueCombinationFilter< TInputImage, TOutputImage >
       m_UVTableIndex(0),
       m_UVTableName(""),
       m_Workspace(""),
+      m_MemoryBudget(1024),
       m_OutputImageFileName(""),
       m_OutIdx(0)
 {
@@ -209,26 +210,6 @@ UniqueCombinationFilter< TInputImage, TOutputImage >
 
 }
 
-template< class TInputImage, class TOutputImage >
-void
-UniqueCombinationFilter< TInputImage, TOutputImage >
-::determineProcOrder()
-{
-    std::multimap<long, int> orderMap;
-    for (int i=0; i < m_vInRAT.size(); ++i)
-    {
-        orderMap.insert(std::pair<long ,int>(m_vInRAT.at(i)->GetNumRows(), i));
-    }
-
-    m_ProcOrder.clear();
-    std::multimap<long, int>::iterator it = orderMap.begin();
-    while (it != orderMap.end())
-    {
-        m_ProcOrder.push_back(it->second);
-        ++it;
-    }
-}
-
 template< class TInputImage, class TOutputImage >
 void
 UniqueCombinationFilter< TInputImage, TOutputImage >
@@ -299,36 +280,22 @@ UniqueCombinationFilter< TInputImage, TOutputImage >
     }
 
     /// here's what we do:
-    /// - determine the number of images for the initial iteration
-    /// - according to the above iterate over internal pipeline
-    ///   which does the following:
-    ///   - take the first n images and combine them using otbCombineTwo
-    ///     - set a name for the resulting table
-    ///   - normalise the resulting image of the above:
-    ///     use a another internal pipeline: reader->BandMath->writer
-    ///     - use b_1__UvId as the output image values
-    ///   - join the CombineTwo result table onto the new BandMath output
-    ///
-    ///   - determine the next n images for the next iteration
-    ///
-
-    determineProcOrder();
-
-    // set up objects for the first pipline
-    typedef typename otb::CombineTwoFilter<TInputImage, TOutputImage> CombFilterType;
-    typedef typename otb::RATValExtractor<TOutputImage> ExtractorType;
-    typedef typename otb::NMImageReader<TOutputImage> ReaderType;
+    /// - identify the unique combinations of all input layers in
+    ///   one streamed pass using the CombinationHashFilter, which
+    ///   writes provisional combination ids into a temp image
+    /// - write the normalised unique combination table, i.e.
+    ///   rowidx = UvId and the input values (by image name)
+    /// - remap the provisional ids of the temp image onto the
+    ///   final ids and write the normalised result image
+
+    typedef otb::Image<long long, OutputImageDimension> IdImageType;
+    typedef typename otb::CombinationHashFilter<TInputImage, IdImageType> HashFilterType;
+    typedef typename otb::Functor::CombinationIdRemap<HashFilterType, OutputPixelType> RemapFunctorType;
+    typedef typename itk::UnaryFunctorImageFilter<IdImageType, TOutputImage, RemapFunctorType> RemapFilterType;
+    typedef typename otb::NMImageReader<IdImageType> IdReaderType;
+    typedef typename otb::StreamingRATImageFileWriter<IdImageType> IdWriterType;
     typedef typename otb::StreamingRATImageFileWriter<TOutputImage> WriterType;
 
-    typename ReaderType::Pointer iterReader = 0;
-    typename CombFilterType::Pointer ctFilter = CombFilterType::New();
-    ctFilter->SetReleaseDataFlag(true);
-    ctFilter->SetWorkspace(m_Workspace);
-
-    otb::SQLiteTable::Pointer uvTable = otb::SQLiteTable::New();
-    uvTable->SetUseSharedCache(false);
-
-
     std::string temppath = "";
 #ifndef _WIN32
     temppath = std::tmpnam(0);
@@ -352,451 +319,240 @@ UniqueCombinationFilter< TInputImage, TOutputImage >
         }
     }
 
-    std::stringstream uvTableName;
-    uvTableName << temppath << "uv_" << this->getRandomString(10) << ".ldb";
-    if (uvTable->CreateTable(uvTableName.str()) == otb::SQLiteTable::ATCREATE_ERROR)
-    {
-        this->InvokeEvent(itk::NMLogEvent("Failed to create the combinations table!",
-                                          itk::NMLogEvent::NM_LOG_ERROR));
-        itkExceptionMacro(<< "Combinatorial analysis failed!");
-        NMDebugCtx(ctx, << "done!");
-        return;
-    }
-    std::string uvTableTabName = uvTable->GetTableName();
-    uvTable->CloseTable();
-
-    int numIter = 1;
-    unsigned long long accIdx = static_cast<unsigned long long>(m_vInRAT.at(m_ProcOrder.at(0))->GetNumRows());
-    int fstImg = 0;
-    int lastImg = this->nextUpperIterationIdx(static_cast<unsigned int>(fstImg), accIdx);
-    int pos = fstImg;
     std::vector<long long> nodata;
+    std::vector<long long> domains;
     std::vector<std::string> names;
-    std::vector<std::string> doneNames;
-
-    float progr = 0.0f;
-    float chunk;
-
-    while (lastImg < nbRAT && !this->GetAbortGenerateData())
-    {
-        // ------------------------------------------------------------------------
-        //      SET UP THE COMBINE-TWO-FILTER  - THE WORKHORSE OF THE ANALYSIS
-        // ------------------------------------------------------------------------
 
-        chunk = (float)(lastImg - fstImg + 1) / (float)nbRAT;
-        chunk *= 0.33;
+    // ------------------------------------------------------------------------
+    //      IDENTIFY UNIQUE COMBINATIONS
+    // ------------------------------------------------------------------------
 
-        // do  the combinatorial analysis ...
-        std::stringstream msg;
-        //NMDebugAI( << ">>>>> Iteration " << numIter << " <<<<<<" << std::endl);
-        msg << ">>>>> Iteration " << numIter << " <<<<<<" << std::endl;
-        this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
+    typename HashFilterType::Pointer hashFilter = HashFilterType::New();
+    hashFilter->SetReleaseDataFlag(true);
+    hashFilter->SetWorkspace(temppath);
+    hashFilter->SetMemoryBudget(m_MemoryBudget);
 
-        //NMDebugAI( << "  combining imgs #" << fstImg << " to #" << lastImg << std::endl);
-        msg.str("");
-        msg << "combining imgs #" << fstImg << " to #" << lastImg << std::endl;
-        this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
-        // set up the combination filter
-
-        for (int i=fstImg; i <= lastImg; ++i, ++pos)
+    for (int i=0; i < nbInputs; ++i)
+    {
+        hashFilter->SetInput(i, m_InputImages.at(i));
+        if (i < nbRAT)
         {
-            ctFilter->SetInput(pos, m_InputImages.at(m_ProcOrder.at(i)));
-            ctFilter->setRAT(pos, m_vInRAT.at(m_ProcOrder.at(i)));
-
-            if (m_InputNodata.size() == 0)
-            {
-                nodata.push_back(itk::NumericTraits<long long>::NonpositiveMin());
-            }
-            else if (m_ProcOrder.at(i) < m_InputNodata.size())
-            {
-                nodata.push_back(static_cast<long long>(m_InputNodata.at(m_ProcOrder.at(i))));
-            }
-            else
-            {
-               nodata.push_back(static_cast<long long>(m_InputNodata.at(m_InputNodata.size()-1)));
-            }
-
-            if (m_ProcOrder.at(i) < m_ImageNames.size())
-            {
-                names.push_back(m_ImageNames.at(m_ProcOrder.at(i)));
-            }
-            else
-            {
-                std::stringstream n;
-                n << "L" << i+1;
-                names.push_back(n.str());
-            }
+            domains.push_back(m_vInRAT.at(i)->GetNumRows());
         }
 
-        ctFilter->SetInputNodata(nodata);
-        ctFilter->SetImageNames(names);
-        std::stringstream ctTableNameStr;
-        ctTableNameStr << temppath << "cttab" << numIter << "_" << this->getRandomString(10) << ".ldb";
-        ctFilter->SetOutputTableFileName(ctTableNameStr.str());
-
-
-        typename WriterType::Pointer ctWriter = WriterType::New();
-        std::stringstream ctImgNameStr;
-        ctImgNameStr << temppath << "ctimg" << numIter << "_"  << this->getRandomString(10) << ".nc:/uv";
-        ctWriter->SetFileName(ctImgNameStr.str());
-        ctWriter->SetResamplingType("NONE");
-        ctWriter->SetInput(ctFilter->GetOutput());
-        ctWriter->SetReleaseDataFlag(true);
-
-        msg.str("");
-        //NMDebugAI( << "  do combinatorial analysis ..." << std::endl);
-        msg << "  do combinatorial analysis ..." << std::endl;
-        this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
-        ctWriter->Update();
-
-        otb::AttributeTable::Pointer tempUvTable = ctFilter->getRAT(0);
-        accIdx = static_cast<unsigned long long>(ctFilter->GetNumUniqueCombinations());
-
-        for (int d=fstImg; d <= lastImg; ++d)
+        if (m_InputNodata.size() == 0)
         {
-            m_InputImages.at(m_ProcOrder.at(d))->ReleaseData();
+            nodata.push_back(itk::NumericTraits<long long>::NonpositiveMin());
         }
-        ctFilter->GetOutput()->ReleaseData();
-        ctFilter = 0;
-        ctWriter = 0;
-
-        progr += chunk;
-        this->UpdateProgress(progr);
-
-        // ------------------------------------------------------------------------
-        //          CREATE/UDATE THE NORMALISED UNIQUE VALUE ATTRIBUTE TABLE
-        // ------------------------------------------------------------------------
-
-        if (this->GetAbortGenerateData())
+        else if (i < m_InputNodata.size())
         {
-            NMDebugCtx(ctx, << "done!");
-            return;
+            nodata.push_back(static_cast<long long>(m_InputNodata.at(i)));
         }
-        // .........................
-        // some prep work
-        // .........................
-
-        // update the final table
-        //NMDebugAI( << "  do table magic ..." << std::endl);
-        msg.str("");
-        msg << "  do table magic ..." << std::endl;
-        this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
-        otb::SQLiteTable::Pointer sqlTemp = static_cast<otb::SQLiteTable*>(tempUvTable.GetPointer());
-
-        // create some shortcut strings for programmer's readability ....
-        // most recent table incl. 'uvimg'
-        std::string tt = sqlTemp->GetTableName();
-        // tab from prev. iter cont. rowidx: -> tt.uvimg = uv.rowidx
-        std::string uv = uvTableTabName;//uvTable->GetTableName();
-
-        // list of images already combined ...
-        std::stringstream sql;
-        std::stringstream uv_doneNamesStr;
-        std::stringstream tt_newNamesStr;
-
-        for (int n=0; n < names.size(); ++n)
+        else
         {
-            tt_newNamesStr << tt << "." << names.at(n);
-            if (n < names.size()-1)
-            {
-                tt_newNamesStr << ", ";
-            }
+            nodata.push_back(static_cast<long long>(m_InputNodata.at(m_InputNodata.size()-1)));
         }
 
-        for (int n=0; n < doneNames.size(); ++n)
+        if (i < m_ImageNames.size())
         {
-            uv_doneNamesStr << uv << "." << doneNames.at(n);
-            if (n < doneNames.size()-1)
-            {
-                uv_doneNamesStr << ", ";
-            }
+            names.push_back(m_ImageNames.at(i));
+        }
+        else
+        {
+            std::stringstream n;
+            n << "L" << i+1;
+            names.push_back(n.str());
         }
+    }
+    hashFilter->SetValueDomains(domains);
+    hashFilter->SetInputNodata(nodata);
+
+    std::stringstream idImgNameStr;
+    idImgNameStr << temppath << "ucids_" << this->getRandomString(10) << ".nc";
+    const std::string idImgFileName = idImgNameStr.str();
+    idImgNameStr << ":/uv";
+
+    typename IdWriterType::Pointer idWriter = IdWriterType::New();
+    idWriter->SetFileName(idImgNameStr.str());
+    idWriter->SetResamplingType("NONE");
+    idWriter->SetInput(hashFilter->GetOutput());
+    idWriter->SetReleaseDataFlag(true);
+
+    std::stringstream msg;
+    msg << "  do combinatorial analysis ..." << std::endl;
+    this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
+    idWriter->Update();
+
+    for (int d=0; d < nbInputs; ++d)
+    {
+        m_InputImages.at(d)->ReleaseData();
+    }
+    hashFilter->GetOutput()->ReleaseData();
+    idWriter = 0;
 
+    if (this->GetAbortGenerateData())
+    {
+        hashFilter->ResetPipeline();
+        std::remove(idImgFileName.c_str());
+        NMDebugCtx(ctx, << "done!");
+        return;
+    }
 
-        // .........................
-        // join new and previous results
-        // .........................
+    const long long numCombis = hashFilter->GetNumUniqueCombinations();
+    if (hashFilter->GetNumInvalidPixels() > 0)
+    {
+        msg.str("");
+        msg << hashFilter->GetNumInvalidPixels() << " pixels exceed the "
+            << "number of rows of their raster attribute table and have "
+            << "been treated as nodata!";
+        this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_WARN));
+    }
 
-        // if this is the second round of combinations, join the
-        // signature (= index columns denoted by images' name)
-        // of previously processed images to the result set of the
-        // current round
-        if (numIter > 1)
-        {
-            // we just close the uv table here for a minute,
-            // so we ('unlock' the database and) don't have
-            // a locked data base later when we try to
-            // re-create/update the unique value attribute table
-            uvTable->CloseTable();
+    msg.str("");
+    msg << "  found " << numCombis << " unique combinations" << std::endl;
+    this->InvokeEvent(itk::NMLogEvent(msg.str(), itk::NMLogEvent::NM_LOG_INFO));
 
-            if (!sqlTemp->AttachDatabase(uvTableName.str(), "uvdb"))
-            {
-                itkExceptionMacro(<< "Combinatorial analysis failed to attach database '"
-                << uvTableName.str() << "'!");
-                return;
-            }
+    this->UpdateProgress(0.5f);
 
-            NMDebugAI(<< "JOINING CURRENT & PREVIOUS RESULTS ... " << std::endl);
-            std::stringstream ssuvtmp;
-            ssuvtmp << "_uv_tmp_" << numIter;
-            std::string uvtmp_ = ssuvtmp.str();
-
-            sql.str("");
-            sql << "BEGIN TRANSACTION;";
-            sql << "CREATE TEMP TABLE _uv_tmp_ AS "
-                <<  "SELECT "
-                    << tt << ".rowidx, " << tt << ".UvId, "
-                    << uv_doneNamesStr.str() << ", " << tt_newNamesStr.str()
-                << " FROM " << tt <<  " LEFT JOIN " << uv
-                << " ON " << tt << ".uvimg = "<< uv << ".rowidx; ";
-            sql << "DROP TABLE " << tt << "; ";
-            sql << "CREATE TABLE " << tt << " AS SELECT * FROM _uv_tmp_;";
-            sql << "CREATE TABLE " << uvtmp_ << " AS SELECT * FROM _uv_tmp_;";
-            sql << "DROP TABLE _uv_tmp_;";
-            sql << "END TRANSACTION;";
-
-            // ", "<< uv <<
-
-            NMDebugAI(<< sql.str() << std::endl);
-
-            if (!sqlTemp->SqlExec(sql.str()))
-            {
-                NMDebugAI(<< "Failed joining previous with current results!\n");
-                itkExceptionMacro(<< "Combinatorial analysis failed to join previous with current results!");
-                return;
-            }
+    // ------------------------------------------------------------------------
+    //          CREATE THE NORMALISED UNIQUE VALUE ATTRIBUTE TABLE
+    // ------------------------------------------------------------------------
 
-            if (!sqlTemp->DetachDatabase("uvdb"))
-            {
-                NMDebugAI(<< "Failed detaching uvdb database!\n");
-                itkExceptionMacro(<< "Combinatorial analysis failed to detach database 'uvdb'!");
-                return;
-            }
-        }
-        // add the current image names to the list of already processed ones
-        // note: we don't add 'uvimg' since we're only interested in the
-        // original normalised image values of the input layers
-        int startid = numIter == 1 ? 0 : 1;
-        for (int n=startid; n < names.size(); ++n)
-        {
-            doneNames.push_back(names.at(n));
-        }
+    otb::SQLiteTable::Pointer uvTable = otb::SQLiteTable::New();
+    uvTable->SetUseSharedCache(false);
 
+    std::stringstream uvTableName;
+    uvTableName << temppath << "uv_" << this->getRandomString(10) << ".ldb";
+    if (uvTable->CreateTable(uvTableName.str()) == otb::SQLiteTable::ATCREATE_ERROR)
+    {
+        hashFilter->ResetPipeline();
+        std::remove(idImgFileName.c_str());
+        this->InvokeEvent(itk::NMLogEvent("Failed to create the combinations table!",
+                                          itk::NMLogEvent::NM_LOG_ERROR));
+        itkExceptionMacro(<< "Combinatorial analysis failed!");
+        NMDebugCtx(ctx, << "done!");
+        return;
+    }
 
-        // .........................
-        // (re-)create the normalised unique combination attribute table
-        // .........................
+    std::vector<std::string> uvColumns;
+    uvColumns.push_back(uvTable->GetPrimaryKey());
+    uvTable->BeginTransaction();
+    for (int n=0; n < names.size(); ++n)
+    {
+        uvTable->AddColumn(names.at(n), AttributeTable::ATTYPE_INT);
+        uvColumns.push_back(names.at(n));
+    }
+    uvTable->EndTransaction();
 
-        NMDebugAI(<< "\nCREATING NORMALISED UV TABLE ... \n");
-        std::stringstream tt_doneColsStr;
-        for (int n=0; n < doneNames.size(); ++n)
-        {
-            tt_doneColsStr << tt << "." << doneNames.at(n);
-            if (n < doneNames.size()-1)
-            {
-                tt_doneColsStr << ", ";
-            }
-        }
+    std::vector<AttributeTable::ColumnValue> uvValues(uvColumns.size());
+    for (int c=0; c < uvValues.size(); ++c)
+    {
+        uvValues[c].type = AttributeTable::ATTYPE_INT;
+    }
 
+    uvTable->PrepareBulkSet(uvColumns, true);
+    uvTable->BeginTransaction();
 
-        if (    !uvTable->CreateTable(uvTableName.str())
-            ||  !uvTable->AttachDatabase(sqlTemp->GetDbFileName(), "sqltmp")
-           )
-        {
-            NMDebugAI(<< "Failed attaching sqltmp database!\n");
-            itkExceptionMacro(<< "Combinatorial analysis failed to create or attach '"
-                << uvTableName.str() << "'!");
-            return;
-        }
+    // row 0 denotes nodata
+    uvValues[0].ival = 0;
+    for (int n=0; n < nodata.size(); ++n)
+    {
+        uvValues[n+1].ival = nodata.at(n);
+    }
+    uvTable->DoBulkSet(uvValues);
 
-        // create a normalised unique value table including results from
-        // all previous combination iterations
-        sql.str("");
-        sql << "BEGIN TRANSACTION;";
-        sql << "DROP TABLE IF EXISTS main." << uv << ";";
-        //sql << "ALTER TABLE main." << uv << " RENAME TO main." << uv << "_" << numIter << ";";
-        sql << "CREATE TABLE main." << uv << " AS "
-             << " SELECT UvId as rowidx, " << (numIter == 1 ? tt_newNamesStr.str() : tt_doneColsStr.str())
-             << " FROM sqltmp." << tt << ";";
-        sql << "CREATE TABLE main." << uv << "_" << numIter << " AS SELECT * from " << uv << ";";
-        sql << "END TRANSACTION;";
-
-        NMDebugAI(<< sql.str() << std::endl);
-
-        if (!uvTable->SqlExec(sql.str()))
+    std::vector<long long> combi;
+    for (long long uvid=1; uvid <= numCombis && !this->GetAbortGenerateData(); ++uvid)
+    {
+        hashFilter->GetCombination(uvid, combi);
+        uvValues[0].ival = uvid;
+        for (int n=0; n < combi.size(); ++n)
         {
-            NMDebugAI(<< "Failed updating normalised unique value table!\n");
-            itkExceptionMacro(<< "Combinatorial analysis failed to update the normalised unique value table!");
-            return;
+            uvValues[n+1].ival = combi.at(n);
         }
+        uvTable->DoBulkSet(uvValues);
+    }
+    uvTable->EndTransaction();
 
-        if (!uvTable->DetachDatabase("sqltmp"))
-        {
-            {
-                NMDebugAI(<< "Detaching database uvdb from sqlTemp failed!\n");
-                itkExceptionMacro(<< "Combinatorial analysis failed to detach 'uvdb' from the temp database!");
-                return;
-            }
-        }
+    this->UpdateProgress(0.67f);
 
-        // repopulate the table admin structures
-        uvTable->PopulateTableAdmin();
+    // ------------------------------------------------------------------------
+    //      CREATE THE NORMALISED RESULT IMAGE
+    // ------------------------------------------------------------------------
 
-        progr += chunk;
-        this->UpdateProgress(progr);
+    if (this->GetAbortGenerateData())
+    {
+        uvTable->CloseTable();
+        hashFilter->ResetPipeline();
+        std::remove(idImgFileName.c_str());
+        NMDebugCtx(ctx, << "done!");
+        return;
+    }
 
-        // ------------------------------------------------------------------------
-        //      CREATE THE NORMALISED RESULT IMAGE
-        // ------------------------------------------------------------------------
+    typename IdReaderType::Pointer idReader = IdReaderType::New();
+    idReader->SetReleaseDataFlag(true);
+    idReader->SetFileName(idImgNameStr.str());
 
-        if (this->GetAbortGenerateData())
-        {
-            NMDebugCtx(ctx, << "done!");
-            return;
-        }
+    typename RemapFilterType::Pointer remapFilter = RemapFilterType::New();
+    remapFilter->SetReleaseDataFlag(true);
+    remapFilter->GetFunctor().SetSource(hashFilter.GetPointer());
+    remapFilter->SetInput(idReader->GetOutput());
 
-        // do the normalisation
-
-        // no exece the normalisation pipeline
-        typename ReaderType::Pointer imgReader = ReaderType::New();
-        imgReader->SetReleaseDataFlag(true);
-        imgReader->SetFileName(ctImgNameStr.str());
-
-        typename ExtractorType::Pointer normFilter = ExtractorType::New();
-        normFilter->SetReleaseDataFlag(true);
-        normFilter->SetUseTableColumnCache(true);
-        normFilter->SetNthInput(0, imgReader->GetOutput());
-        normFilter->SetExpression("UvId");
-        std::vector<std::string> vColumns;
-        vColumns.push_back("UvId");
-        normFilter->SetNthAttributeTable(0, tempUvTable, vColumns);
-
-        OutputPixelType maxCombis = itk::NumericTraits<OutputPixelType>::max();
-        unsigned int maxUintC = itk::NumericTraits<unsigned int>::max();
-        bool bNetCDF = false;
-        if (accIdx > maxCombis && accIdx > maxUintC)
-        {
-            bNetCDF = true;
-        }
+    OutputPixelType maxCombis = itk::NumericTraits<OutputPixelType>::max();
+    unsigned int maxUintC = itk::NumericTraits<unsigned int>::max();
+    bool bNetCDF = false;
+    if (numCombis > maxCombis && numCombis > maxUintC)
+    {
+        bNetCDF = true;
+    }
 
-        // if this is the last iteration, we use the user specified
-        // image file name for the final output (if specified)
-        // otherwise we just keep using temp filenames!
-        std::stringstream normImgNameStr;
-        unsigned long long tmpIdx = accIdx;
-        if (    this->nextUpperIterationIdx(lastImg+1, tmpIdx) >= nbRAT
-            &&  !m_OutputImageFileName.empty()
-           )
+    std::stringstream normImgNameStr;
+    if (!m_OutputImageFileName.empty())
+    {
+        if (bNetCDF)
         {
-            if (bNetCDF)
-            {
-                size_t pos = m_OutputImageFileName.find_last_of('.');
-                std::string outNameWOSuf = m_OutputImageFileName.substr(0, pos);
-                size_t pos2 = outNameWOSuf.find_last_of("/\\");
-                std::string baseName = outNameWOSuf.substr(pos2+1);
-                std::string ncOutName = outNameWOSuf + ".nc:/" + baseName;
-                normImgNameStr << ncOutName;
-            }
-            else
-            {
-                normImgNameStr << m_OutputImageFileName;
-            }
+            size_t pos = m_OutputImageFileName.find_last_of('.');
+            std::string outNameWOSuf = m_OutputImageFileName.substr(0, pos);
+            size_t pos2 = outNameWOSuf.find_last_of("/\\");
+            std::string baseName = outNameWOSuf.substr(pos2+1);
+            std::string ncOutName = outNameWOSuf + ".nc:/" + baseName;
+            normImgNameStr << ncOutName;
         }
         else
         {
-
-            normImgNameStr << temppath << "norm_" << numIter << this->getRandomString(10) << ".kea";//".nc:/uv";//".img";//<< ".kea";
-        }
-
-        typename WriterType::Pointer normWriter = WriterType::New();
-        normWriter->SetReleaseDataFlag(true);
-        normWriter->SetFileName(normImgNameStr.str());
-        normWriter->SetResamplingType(bNetCDF ? "NONE" : "NEAREST");
-        normWriter->SetInput(normFilter->GetOutput());
-        normWriter->SetInputRAT(uvTable);
-        NMDebugAI( << "  normalise the image ..." << std::endl);
-        normWriter->Update();
-
-        imgReader->GetOutput()->ReleaseData();
-        normFilter->GetOutput()->ReleaseData();
-        normFilter->ResetPipeline();
-        normWriter = 0;
-        normFilter = 0;
-        imgReader = 0;
-        sqlTemp->CloseTable();
-
-
-        progr += chunk;
-        this->UpdateProgress(progr);
-
-        // ------------------------------------------------------------
-        //      PREPARE THE NEXT ITERATION STEP
-        // ------------------------------------------------------------
-
-        fstImg = lastImg+1;
-        lastImg = this->nextUpperIterationIdx(fstImg, accIdx);
-        ++numIter;
-
-        nodata.clear();
-        names.clear();
-        pos = 1;
-        if (lastImg < nbRAT)
-        {
-            iterReader = ReaderType::New();
-            iterReader->SetReleaseDataFlag(true);
-            iterReader->RATSupportOn();
-            iterReader->SetRATType(otb::AttributeTable::ATTABLE_TYPE_SQLITE);
-            iterReader->SetFileName(normImgNameStr.str());
-
-            ctFilter = CombFilterType::New();
-            ctFilter->SetReleaseDataFlag(true);
-            ctFilter->SetInput(0, iterReader->GetOutput());
-            ctFilter->setRAT(0, static_cast<otb::AttributeTable*>(uvTable.GetPointer()));
-
-            nodata.push_back(0);
-            names.push_back("uvimg");
+            normImgNameStr << m_OutputImageFileName;
         }
     }
-    uvTable->CloseTable();
-
-    this->UpdateProgress(1.0f);
-    NMDebugCtx(ctx, << "done!");
-}
-
-
-template< class TInputImage, class TOutputImage >
-unsigned int
-UniqueCombinationFilter< TInputImage, TOutputImage >
-::nextUpperIterationIdx(unsigned int idx, unsigned long long &accIdx)
-{
-    unsigned int cnt = idx;
-    unsigned int nbRAT = m_vInRAT.size();
-    if (idx >= nbRAT)
+    else
     {
-        return nbRAT;
+        normImgNameStr << temppath << "norm_" << this->getRandomString(10) << ".kea";
     }
 
-    //IndexType maxIdx = itk::NumericTraits<IndexType>::max();
-    OutputPixelType maxIdx = itk::NumericTraits<OutputPixelType>::max();
-    while (   cnt < nbRAT
-           && (accIdx <= maxIdx / (m_vInRAT.at(m_ProcOrder.at(cnt))->GetNumRows() > 0
-                                    ? m_vInRAT.at(m_ProcOrder.at(cnt))->GetNumRows()
-                                    : 1)
-              )
-          )
-    {
-        accIdx *= m_vInRAT.at(m_ProcOrder.at(cnt))->GetNumRows();
-        ++cnt;
-    }
+    typename WriterType::Pointer normWriter = WriterType::New();
+    normWriter->SetReleaseDataFlag(true);
+    normWriter->SetFileName(normImgNameStr.str());
+    normWriter->SetResamplingType(bNetCDF ? "NONE" : "NEAREST");
+    normWriter->SetInput(remapFilter->GetOutput());
+    normWriter->SetInputRAT(uvTable);
+    NMDebugAI( << "  normalise the image ..." << std::endl);
+    normWriter->Update();
+
+    idReader->GetOutput()->ReleaseData();
+    remapFilter->GetOutput()->ReleaseData();
+    normWriter = 0;
+    remapFilter = 0;
+    idReader = 0;
 
-    if (cnt > idx)
-    {
-        --cnt;
-    }
+    uvTable->CloseTable();
+    hashFilter->ResetPipeline();
+    hashFilter = 0;
+    std::remove(idImgFileName.c_str());
 
-    return cnt;
+    this->UpdateProgress(1.0f);
+    NMDebugCtx(ctx, << "done!");
 }
 
+
 template< class TInputImage, class TOutputImage >
 std::string
 UniqueCombinationFilter< TInputImage, TOutputImage >
@@ -0,0 +1,344 @@
+/******************************************************************************
+ * This file is part of 'LUMASS', which is free software: you can redistribute
+ * it and/or modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the License,
+ * or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#ifndef OTBZONESTATSACCUMULATOR_H_
+#define OTBZONESTATSACCUMULATOR_H_
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace otb
+{
+
+/** \struct ZoneStats
+ *  \brief Summary statistics of a single zone
+ *
+ *  Plain record of fixed size, i.e. no per zone heap allocations;
+ *  a record with count == 0 doesn't hold any data yet.
+ */
+struct ZoneStats
+{
+    double min;
+    double max;
+    double sum;
+    double sumsq;
+    long long count;
+    long long minX;
+    long long minY;
+    long long maxX;
+    long long maxY;
+
+    inline void Add(const double& val, const long long& x, const long long& y)
+    {
+        if (count == 0)
+        {
+            min = max = val;
+            sum = val;
+            sumsq = val * val;
+            count = 1;
+            minX = maxX = x;
+            minY = maxY = y;
+            return;
+        }
+
+        min = val < min ? val : min;
+        max = val > max ? val : max;
+        sum += val;
+        sumsq += val * val;
+        ++count;
+        minX = x < minX ? x : minX;
+        minY = y < minY ? y : minY;
+        maxX = x > maxX ? x : maxX;
+        maxY = y > maxY ? y : maxY;
+    }
+
+    inline void Merge(const ZoneStats& s)
+    {
+        if (s.count == 0)
+        {
+            return;
+        }
+
+        if (count == 0)
+        {
+            *this = s;
+            return;
+        }
+
+        min = s.min < min ? s.min : min;
+        max = s.max > max ? s.max : max;
+        sum += s.sum;
+        sumsq += s.sumsq;
+        count += s.count;
+        minX = s.minX < minX ? s.minX : minX;
+        minY = s.minY < minY ? s.minY : minY;
+        maxX = s.maxX > maxX ? s.maxX : maxX;
+        maxY = s.maxY > maxY ? s.maxY : maxY;
+    }
+};
+
+/** \class ZoneStatsAccumulator
+ *  \brief Collects ZoneStats per zone id
+ *
+ *  Zones within the (optional) dense range [minKey, maxKey] are
+ *  stored in a plain array indexed by zone id; any other zone
+ *  is stored in a flat open addressing (linear probing) hash
+ *  table. Both stores hold ZoneStats records by value.
+ *
+ *  NOTE: this class is not thread safe; use one accumulator per
+ *  thread and merge them afterwards (see MergePartition).
+ */
+class ZoneStatsAccumulator
+{
+public:
+    typedef long long KeyType;
+
+    ZoneStatsAccumulator()
+        : m_DenseMin(0), m_DenseMax(-1),
+          m_NumDense(0), m_NumHashed(0), m_HashBits(0)
+    {}
+
+    /** Removes all zones (incl. the dense range) */
+    void Clear()
+    {
+        std::vector<ZoneStats>().swap(m_Dense);
+        std::vector<Slot>().swap(m_Slots);
+        m_DenseMin = 0;
+        m_DenseMax = -1;
+        m_NumDense = 0;
+        m_NumHashed = 0;
+        m_HashBits = 0;
+    }
+
+    /** Allocates the array for zones within [minKey, maxKey];
+     *  must be called before any zone is added
+     */
+    void SetDenseRange(KeyType minKey, KeyType maxKey)
+    {
+        if (maxKey < minKey || m_NumDense + m_NumHashed > 0)
+        {
+            return;
+        }
+
+        m_DenseMin = minKey;
+        m_DenseMax = maxKey;
+        m_Dense.assign(static_cast<size_t>(static_cast<unsigned long long>(maxKey)
+                                           - static_cast<unsigned long long>(minKey)) + 1,
+                       ZoneStats());
+    }
+
+    bool HasDenseRange() const {return !m_Dense.empty();}
+
+    /** Number of zones on record */
+    size_t Size() const {return m_NumDense + m_NumHashed;}
+
+    inline void Add(const KeyType& key, const double& val,
+                    const long long& x, const long long& y)
+    {
+        ZoneStats* s;
+        if (key >= m_DenseMin && key <= m_DenseMax)
+        {
+            s = &m_Dense[key - m_DenseMin];
+            m_NumDense += s->count == 0 ? 1 : 0;
+        }
+        else
+        {
+            s = &this->lookup(key);
+        }
+        s->Add(val, x, y);
+    }
+
+    inline void Merge(const KeyType& key, const ZoneStats& stats)
+    {
+        ZoneStats* s;
+        if (key >= m_DenseMin && key <= m_DenseMax)
+        {
+            s = &m_Dense[key - m_DenseMin];
+            m_NumDense += s->count == 0 ? 1 : 0;
+        }
+        else
+        {
+            s = &this->lookup(key);
+        }
+        s->Merge(stats);
+    }
+
+    /** Returns the zone's record or nullptr if it isn't on record */
+    const ZoneStats* Find(const KeyType& key) const
+    {
+        if (key >= m_DenseMin && key <= m_DenseMax)
+        {
+            const ZoneStats& s = m_Dense[key - m_DenseMin];
+            return s.count > 0 ? &s : nullptr;
+        }
+
+        if (m_Slots.empty())
+        {
+            return nullptr;
+        }
+
+        const size_t mask = m_Slots.size() - 1;
+        size_t pos = hash(key, m_HashBits);
+        while (m_Slots[pos].stats.count > 0)
+        {
+            if (m_Slots[pos].key == key)
+            {
+                return &m_Slots[pos].stats;
+            }
+            pos = (pos + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    /** Calls func(key, stats) for each zone on record (unordered) */
+    template<class TFunc>
+    void ForEach(TFunc func) const
+    {
+        for (size_t i=0; i < m_Dense.size(); ++i)
+        {
+            if (m_Dense[i].count > 0)
+            {
+                func(m_DenseMin + static_cast<KeyType>(i), m_Dense[i]);
+            }
+        }
+
+        for (size_t i=0; i < m_Slots.size(); ++i)
+        {
+            if (m_Slots[i].stats.count > 0)
+            {
+                func(m_Slots[i].key, m_Slots[i].stats);
+            }
+        }
+    }
+
+    /** Merges all zones of src, which belong to partition part of
+     *  numParts partitions, into this accumulator; calling this
+     *  for disjoint partitions on different accumulators is safe
+     *  to do concurrently
+     */
+    void MergePartition(const ZoneStatsAccumulator& src, int part, int numParts)
+    {
+        src.ForEach([this, part, numParts](const KeyType& key, const ZoneStats& s)
+        {
+            if (Partition(key, numParts) == part)
+            {
+                this->Merge(key, s);
+            }
+        });
+    }
+
+    /** Appends (key, record) pairs of all zones on record to list */
+    void AppendZones(std::vector<std::pair<KeyType, const ZoneStats*> >& list) const
+    {
+        list.reserve(list.size() + this->Size());
+        this->ForEach([&list](const KeyType& key, const ZoneStats& s)
+        {
+            list.push_back(std::make_pair(key, &s));
+        });
+    }
+
+    /** Maps a zone id onto one of numParts partitions */
+    static inline int Partition(const KeyType& key, int numParts)
+    {
+        return numParts > 1
+                ? static_cast<int>((mix(key) >> 32) % static_cast<unsigned long long>(numParts))
+                : 0;
+    }
+
+protected:
+
+    struct Slot
+    {
+        KeyType key;
+        ZoneStats stats;
+    };
+
+    static inline unsigned long long mix(const KeyType& key)
+    {
+        return static_cast<unsigned long long>(key) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    static inline size_t hash(const KeyType& key, int bits)
+    {
+        return static_cast<size_t>(mix(key) >> (64 - bits));
+    }
+
+    /** Returns the record for key, creates an empty
+     *  one (count == 0), if it isn't on record yet
+     */
+    inline ZoneStats& lookup(const KeyType& key)
+    {
+        // keep the load factor below 0.7
+        if ((m_NumHashed + 1) * 10 > m_Slots.size() * 7)
+        {
+            this->rehash();
+        }
+
+        const size_t mask = m_Slots.size() - 1;
+        size_t pos = hash(key, m_HashBits);
+        while (m_Slots[pos].stats.count > 0)
+        {
+            if (m_Slots[pos].key == key)
+            {
+                return m_Slots[pos].stats;
+            }
+            pos = (pos + 1) & mask;
+        }
+
+        // the caller is going to add to the record straight
+        // away, so the slot is going to be occupied
+        ++m_NumHashed;
+        m_Slots[pos].key = key;
+        return m_Slots[pos].stats;
+    }
+
+    void rehash()
+    {
+        std::vector<Slot> old;
+        old.swap(m_Slots);
+
+        m_HashBits = m_HashBits == 0 ? 10 : m_HashBits + 1;
+        m_Slots.assign(size_t(1) << m_HashBits, Slot());
+
+        const size_t mask = m_Slots.size() - 1;
+        for (size_t i=0; i < old.size(); ++i)
+        {
+            if (old[i].stats.count > 0)
+            {
+                size_t pos = hash(old[i].key, m_HashBits);
+                while (m_Slots[pos].stats.count > 0)
+                {
+                    pos = (pos + 1) & mask;
+                }
+                m_Slots[pos] = old[i];
+            }
+        }
+    }
+
+    std::vector<ZoneStats> m_Dense;
+    KeyType m_DenseMin;
+    KeyType m_DenseMax;
+
+    std::vector<Slot> m_Slots;
+
+    size_t m_NumDense;
+    size_t m_NumHashed;
+    int m_HashBits;
+};
+
+} // end namespace otb
+
+#endif /* OTBZONESTATSACCUMULATOR_H_ */